@@ -4,6 +4,11 @@
 #define MACRO_DEFINITION_START_NAME "mcro"
 #define MACRO_DEFINITION_END_NAME "endmcro"
 #define LABEL_ENDING_CHARACTER ':'
+#define COMMENT_STARTING_CHARACTER ';'
+#define STRING_BOUNDARY_CHARACTER '"'
+#define REGISTER_PREFIX_CHARACTER '@'
+#define REGISTER_LETTER_CHARACTER 'r'
+#define DIRECTIVE_STARTING_CHARACTER '.'
 
 #define DATA_DEFINITION_CODE 1 /* the code of a .data definition */
 #define STRING_DEFINITION_CODE 2 /* the code of a .string definition */
@@ -29,8 +34,38 @@
 #define ARE_RELOCATABLE_CODE 2
 #define ARE_EXTERNAL_CODE 1
 
-#define ENCODING_FIRST_12_BIT_MASK 0xFFF /* a bit mask to return the first 12 bits of the encoding */
-#define ENCODING_SOURCE_REGISTER_SHIFT_MASK 5
+#define ENCODING_ARE_SHIFT 0 /* the index of the first bit of the A.R.E bits in a memory word */
+#define ENCODING_DEST_ADDRESSING_SHIFT 2 /* the index of the first bit of the destination addressing in the first word */
+#define ENCODING_OPCODE_SHIFT 5 /* the index of the first bit of the opcode in the first word */
+#define ENCODING_SRC_ADDRESSING_SHIFT 9 /* the index of the first bit of the source addressing in the first word */
+#define ENCODING_OPERAND_SHIFT 2 /* the index of the first bit of an immediate/label operand in its memory word */
+#define ENCODING_DEST_REGISTER_SHIFT 2 /* the index of the first bit of a destination register in its memory word */
+#define ENCODING_SRC_REGISTER_SHIFT 7 /* the index of the first bit of a source register in its memory word */
+
+#define ENCODING_ARE_LENGTH 2 /* the number of A.R.E bits in a memory word */
+#define ENCODING_ADDRESSING_LENGTH 3 /* the number of bits of an addressing code in the first word */
+#define ENCODING_OPCODE_LENGTH 4 /* the number of bits of the opcode in the first word */
+#define ENCODING_OPERAND_LENGTH 10 /* the number of bits of an immediate/label operand in its memory word */
+#define ENCODING_REGISTER_LENGTH 5 /* the number of bits of a register number in its memory word */
+#define MAX_IMMEDIATE_VALUE ((1 << (ENCODING_OPERAND_LENGTH - 1)) - 1) /* the largest immediate operand that fits in its bits */
+#define MIN_IMMEDIATE_VALUE (-(1 << (ENCODING_OPERAND_LENGTH - 1))) /* the smallest immediate operand that fits in its bits */
+
+#define NO_OPERAND_ADDRESSING_INDEX 0 /* the index in the encoding table of an operand that doesn't exist */
+#define IMMEDIATE_ADDRESSING_INDEX 1 /* the index in the encoding table of an immediate operand */
+#define LABEL_ADDRESSING_INDEX 2 /* the index in the encoding table of a label operand */
+#define REGISTER_ADDRESSING_INDEX 3 /* the index in the encoding table of a register operand */
+
+#define LABEL_DEFINITION_TOKEN_CODE 1 /* the code of a label definition token, such as "MAIN:" */
+#define MNEMONIC_TOKEN_CODE 2 /* the code of a token that is the name of an operation */
+#define DIRECTIVE_TOKEN_CODE 3 /* the code of a token that starts with a dot, such as ".data" */
+#define REGISTER_TOKEN_CODE 4 /* the code of a register token, such as "@r3" */
+#define IMMEDIATE_TOKEN_CODE 5 /* the code of an integer token, such as "-5" */
+#define IDENTIFIER_TOKEN_CODE 6 /* the code of a token of letters and digits that starts with a letter */
+#define STRING_TOKEN_CODE 7 /* the code of a token between two double quotation marks */
+#define COMMA_TOKEN_CODE 8 /* the code of a comma token */
+#define COMMENT_TOKEN_CODE 9 /* the code of a comment token, from a semicolon in the beginning of a line to its end */
+#define INVALID_LABEL_TOKEN_CODE 10 /* the code of a token that contains a label ending character, but is not a label definition */
+#define UNKNOWN_TOKEN_CODE 11 /* the code of any other token */
 
 #define INPUT_CODE_FILE_EXTENSION ".as"
 #define OUTPUT_CODE_FILE_EXTENSION ".am"
@@ -39,6 +74,14 @@
 #define OUTPUT_ENTRIES_FILE_EXTENSION ".ent"
 #define OUTPUT_OBJECT_FILE_EXTENSION ".ob"
 #define OUTPUT_EXTERNALS_FILE_EXTENSION ".ext"
+#define OUTPUT_BINARY_OBJECT_FILE_EXTENSION ".obb"
+#define OUTPUT_LINK_STATE_FILE_EXTENSION ".lnk"
+
+#define BINARY_OBJECT_OPTION "-b" /* the command line option that also creates the binary object files */
+#define BINARY_OBJECT_MAGIC "ASOB" /* the first bytes of a binary object file */
+#define BINARY_OBJECT_MAGIC_LENGTH 4 /* the number of bytes in the magic of a binary object file */
+#define BINARY_OBJECT_VERSION 1 /* the version of the binary object format, a change in the layout should change it */
+#define BINARY_OBJECT_MAX_FIELD 0xFFFF /* the largest value of a 16-bit field of a binary object file */
 
 
 #define EMPTY_SET {UNKNOWN_ADDRESSING_CODE}
@@ -0,0 +1,320 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "build_cache.h"
+#include "absolutes.h"
+#include "segments.h"
+#include "compiler.h"
+
+/* the build of the assembler, which is a hash of its sources that the makefile passes to the compiler */
+#ifndef ASSEMBLER_BUILD_ID
+#define ASSEMBLER_BUILD_ID __DATE__ " " __TIME__
+#endif
+
+#define FNV_PRIME 16777619u /* the multiplier of the FNV-1a hash */
+#define HASH_MASK 0xFFFFFFFFUL /* the bits of a 32-bit hash */
+#define ENTRY_NAME_LENGTH 16 /* the number of hexadecimal digits in the name of a cache entry */
+#define COPY_BUFFER_SIZE 4096 /* the number of bytes that are copied at once */
+#define NO_OF_OUTPUT_FILES 5 /* the number of output files of a program */
+
+/* the extensions of the output files that are stored in a cache entry */
+const char *cached_extensions[NO_OF_OUTPUT_FILES] = {OUTPUT_NO_MACROS_FILE_EXTENSION, OUTPUT_OBJECT_FILE_EXTENSION,
+                                                     OUTPUT_ENTRIES_FILE_EXTENSION, OUTPUT_EXTERNALS_FILE_EXTENSION,
+                                                     OUTPUT_BINARY_OBJECT_FILE_EXTENSION};
+
+/*
+ * Returns the path of the cache directory, or NULL if the cache is disabled. The
+ * cache is used only if its directory is given in an environment variable.
+ */
+char *get_cache_directory() {
+    char *directory = getenv(CACHE_DIRECTORY_VARIABLE);
+    return (directory != NULL && directory[0]) ? directory : NULL;
+}
+
+/*
+ * Updates the two given hashes with the given bytes. The first hash is an FNV-1a
+ * hash and the second one is a djb2 hash, and together they form a 64-bit key.
+ *
+ * Parameters:
+ * -----------
+ * const unsigned char *bytes   the bytes to hash.
+ * size_t length                the number of bytes.
+ * unsigned long *first_hash    a pointer to the first hash.
+ * unsigned long *second_hash   a pointer to the second hash.
+ */
+void hash_bytes(const unsigned char *bytes, size_t length, unsigned long *first_hash, unsigned long *second_hash) {
+    unsigned long first = *first_hash;
+    unsigned long second = *second_hash;
+    size_t index;
+
+    for (index = 0; index < length; index++) {
+        first = ((first ^ bytes[index]) * FNV_PRIME) & HASH_MASK;
+        second = ((second << 5) + second + bytes[index]) & HASH_MASK;
+    }
+    *first_hash = first;
+    *second_hash = second;
+}
+
+/*
+ * Returns a pointer to a new string that contains the path of the cache entry of the
+ * given input file. The name of the entry is a hash of the bytes of the file, the
+ * build of the assembler and its options, so a file that has not changed since it
+ * was assembled has the same entry. If the cache is disabled, or the file can't be
+ * read, the function returns NULL. The user should free the string in the end of
+ * the usage.
+ *
+ * Parameters:
+ * -----------
+ * char *input_file     the path to the file that contains the program.
+ */
+char *get_cache_entry_path(char *input_file) {
+    char *directory = get_cache_directory();
+    char *entry_path;
+    unsigned char buffer[COPY_BUFFER_SIZE];
+    unsigned long first_hash = FNV_OFFSET_BASIS;
+    unsigned long second_hash = SECOND_HASH_BASIS;
+    size_t no_of_bytes;
+    unsigned char options;
+    FILE *file;
+
+    if (directory == NULL || (file = fopen(input_file, "rb")) == NULL) {
+        return NULL;
+    }
+    /* a program that is assembled by a different build may have different output files */
+    hash_bytes((const unsigned char *) ASSEMBLER_BUILD_ID, sizeof(ASSEMBLER_BUILD_ID), &first_hash, &second_hash);
+    /* a program that is assembled with different options has different output files */
+    options = (unsigned char) BINARY_OBJECT_FLAG;
+    hash_bytes(&options, 1, &first_hash, &second_hash);
+    while ((no_of_bytes = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        hash_bytes(buffer, no_of_bytes, &first_hash, &second_hash);
+    }
+    fclose(file);
+
+    entry_path = malloc(strlen(directory) + 1 + ENTRY_NAME_LENGTH + 1);
+    sprintf(entry_path, "%s/%08lx%08lx", directory, first_hash, second_hash);
+    return entry_path;
+}
+
+/*
+ * Copies the given source file to the given destination file. Returns 1
+ * if the file was copied, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *source_path        the path of the file to copy.
+ * char *destination_path   the path of the copy.
+ */
+int copy_file(char *source_path, char *destination_path) {
+    char buffer[COPY_BUFFER_SIZE];
+    size_t no_of_bytes;
+    FILE *source = fopen(source_path, "rb");
+    FILE *destination;
+
+    if (source == NULL) {
+        return 0;
+    }
+    if ((destination = fopen(destination_path, "wb")) == NULL) {
+        fclose(source);
+        return 0;
+    }
+    while ((no_of_bytes = fread(buffer, 1, sizeof(buffer), source)) > 0) {
+        fwrite(buffer, 1, no_of_bytes, destination);
+    }
+    fclose(source);
+    fclose(destination);
+    return 1;
+}
+
+/*
+ * Replaces the given destination file with a copy of the given source file. The
+ * destination is removed before it is written, so a file that shares its content
+ * with the destination (such as a hard link to it) is not changed.
+ *
+ * Parameters:
+ * -----------
+ * char *source_path        the path of the existing file.
+ * char *destination_path   the path of the new file.
+ */
+void replace_file(char *source_path, char *destination_path) {
+    remove(destination_path);
+    copy_file(source_path, destination_path);
+}
+
+/*
+ * Returns 1 if the two given files exist and have the same bytes, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *first_path     the path of the first file.
+ * char *second_path    the path of the second file.
+ */
+int equal_files(char *first_path, char *second_path) {
+    char first_buffer[COPY_BUFFER_SIZE];
+    char second_buffer[COPY_BUFFER_SIZE];
+    size_t first_length;
+    size_t second_length;
+    int equal = 1;
+    FILE *first_file = fopen(first_path, "rb");
+    FILE *second_file;
+
+    if (first_file == NULL) {
+        return 0;
+    }
+    if ((second_file = fopen(second_path, "rb")) == NULL) {
+        fclose(first_file);
+        return 0;
+    }
+    do {
+        first_length = fread(first_buffer, 1, sizeof(first_buffer), first_file);
+        second_length = fread(second_buffer, 1, sizeof(second_buffer), second_file);
+        equal = (first_length == second_length) && memcmp(first_buffer, second_buffer, first_length) == 0;
+    } while (equal && first_length > 0);
+    fclose(first_file);
+    fclose(second_file);
+    return equal;
+}
+
+/*
+ * Returns 1 if a file exists in the given path, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *path   the path of the file.
+ */
+int file_exists(char *path) {
+    struct stat file_status;
+    return stat(path, &file_status) == 0;
+}
+
+/*
+ * If the given cache entry is complete, and it was created from the same program as
+ * the program in the given file path, the function copies its output files to the
+ * given file path, prints the errors that were stored in the entry, and returns 1.
+ * Otherwise, returns 0. Two programs can have the same hash, so the entry is used
+ * only if the program that is stored in it is equal to the given program.
+ *
+ * Parameters:
+ * -----------
+ * char *entry_path     the path of the cache entry.
+ * char *file_path      a path to the program, without an extension.
+ */
+int restore_cache_entry(char *entry_path, char *file_path) {
+    char *diagnostics_path = create_file_path(entry_path, CACHE_DIAGNOSTICS_FILE_NAME);
+    char *program_path = create_file_path(entry_path, CACHE_PROGRAM_FILE_NAME);
+    char *source_path = create_file_path(entry_path, CACHE_SOURCE_FILE_NAME);
+    char *input_file = create_file_path(file_path, INPUT_CODE_FILE_EXTENSION);
+    char *cached_file_path;
+    char *output_file_path;
+    char buffer[COPY_BUFFER_SIZE];
+    size_t no_of_bytes;
+    FILE *diagnostics;
+    int index;
+
+    if ((diagnostics = fopen(diagnostics_path, "rb")) == NULL) {
+        free(diagnostics_path);
+        free(program_path);
+        free(source_path);
+        free(input_file);
+        return 0;
+    }
+    if (!equal_files(source_path, input_file)) {
+        fclose(diagnostics);
+        free(diagnostics_path);
+        free(program_path);
+        free(source_path);
+        free(input_file);
+        return 0;
+    }
+    for (index = 0; index < NO_OF_OUTPUT_FILES; index++) {
+        cached_file_path = create_file_path(program_path, (char *) cached_extensions[index]);
+        output_file_path = create_file_path(file_path, (char *) cached_extensions[index]);
+        if (file_exists(cached_file_path)) {
+            replace_file(cached_file_path, output_file_path);
+        }
+        free(cached_file_path);
+        free(output_file_path);
+    }
+    /* print the errors of the program, as if it was assembled */
+    while ((no_of_bytes = fread(buffer, 1, sizeof(buffer), diagnostics)) > 0) {
+        fwrite(buffer, 1, no_of_bytes, stdout);
+        ERROR_FLAG = 1;
+    }
+    fclose(diagnostics);
+    free(diagnostics_path);
+    free(program_path);
+    free(source_path);
+    free(input_file);
+    return 1;
+}
+
+/*
+ * Creates the given cache entry, and opens the diagnostics file of the entry, so
+ * that the errors of the program are stored in the entry while they are printed.
+ * An existing entry is not complete anymore until it is closed. Returns 1 if the
+ * entry was created, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *entry_path     the path of the cache entry.
+ */
+int open_cache_entry(char *entry_path) {
+    char *temporary_diagnostics_path = create_file_path(entry_path, CACHE_TEMPORARY_DIAGNOSTICS_FILE_NAME);
+    char *diagnostics_path = create_file_path(entry_path, CACHE_DIAGNOSTICS_FILE_NAME);
+
+    mkdir(get_cache_directory(), S_IRWXU | S_IRWXG | S_IRWXO);
+    mkdir(entry_path, S_IRWXU | S_IRWXG | S_IRWXO);
+    /* the entry of another program with the same hash is replaced by the entry of this program */
+    remove(diagnostics_path);
+    diagnostics_file = fopen(temporary_diagnostics_path, "wb");
+    free(temporary_diagnostics_path);
+    free(diagnostics_path);
+    return diagnostics_file != NULL;
+}
+
+/*
+ * Stores copies of the program and of its output files that exist in the given file path
+ * in the given cache entry, and closes the diagnostics file of the entry. The diagnostics
+ * file is the last file that is added to the entry, and it marks that the entry is complete.
+ *
+ * Parameters:
+ * -----------
+ * char *entry_path     the path of the cache entry.
+ * char *file_path      a path to the program, without an extension.
+ */
+void close_cache_entry(char *entry_path, char *file_path) {
+    char *temporary_diagnostics_path = create_file_path(entry_path, CACHE_TEMPORARY_DIAGNOSTICS_FILE_NAME);
+    char *diagnostics_path = create_file_path(entry_path, CACHE_DIAGNOSTICS_FILE_NAME);
+    char *program_path = create_file_path(entry_path, CACHE_PROGRAM_FILE_NAME);
+    char *source_path = create_file_path(entry_path, CACHE_SOURCE_FILE_NAME);
+    char *input_file = create_file_path(file_path, INPUT_CODE_FILE_EXTENSION);
+    char *cached_file_path;
+    char *output_file_path;
+    int index;
+
+    fclose(diagnostics_file);
+    diagnostics_file = NULL;
+
+    replace_file(input_file, source_path);
+
+    for (index = 0; index < NO_OF_OUTPUT_FILES; index++) {
+        cached_file_path = create_file_path(program_path, (char *) cached_extensions[index]);
+        output_file_path = create_file_path(file_path, (char *) cached_extensions[index]);
+        remove(cached_file_path);
+        if (file_exists(output_file_path)) {
+            copy_file(output_file_path, cached_file_path);
+        }
+        free(cached_file_path);
+        free(output_file_path);
+    }
+    /* the entry is complete only after all the output files were stored */
+    rename(temporary_diagnostics_path, diagnostics_path);
+
+    free(temporary_diagnostics_path);
+    free(diagnostics_path);
+    free(program_path);
+    free(source_path);
+    free(input_file);
+}
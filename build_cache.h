@@ -0,0 +1,121 @@
+#ifndef ASSEMBLER_SIMULATOR_BUILD_CACHE_H
+#define ASSEMBLER_SIMULATOR_BUILD_CACHE_H
+
+#include <stddef.h>
+
+#define CACHE_DIRECTORY_VARIABLE "ASSEMBLER_CACHE_DIR" /* an environment variable that enables the build cache in the given directory */
+#define CACHE_DIAGNOSTICS_FILE_NAME "/diagnostics" /* the file of a cache entry that stores the errors of the program */
+#define CACHE_TEMPORARY_DIAGNOSTICS_FILE_NAME "/diagnostics.tmp" /* the diagnostics file of an entry that is not complete */
+#define CACHE_PROGRAM_FILE_NAME "/program" /* the name of the output files in a cache entry, without an extension */
+#define CACHE_SOURCE_FILE_NAME "/source" /* the file of a cache entry that stores the program that the entry was created from */
+#define FNV_OFFSET_BASIS 2166136261u /* the initial value of the FNV-1a hash */
+#define SECOND_HASH_BASIS 5381u /* the initial value of the second hash */
+
+/*
+ * Updates the two given hashes with the given bytes. The first hash is an FNV-1a
+ * hash and the second one is a djb2 hash, and together they form a 64-bit key.
+ *
+ * Parameters:
+ * -----------
+ * const unsigned char *bytes   the bytes to hash.
+ * size_t length                the number of bytes.
+ * unsigned long *first_hash    a pointer to the first hash.
+ * unsigned long *second_hash   a pointer to the second hash.
+ */
+void hash_bytes(const unsigned char *bytes, size_t length, unsigned long *first_hash, unsigned long *second_hash);
+
+/*
+ * Returns a pointer to a new string that contains the path of the cache entry of the
+ * given input file. The name of the entry is a hash of the bytes of the file, the
+ * build of the assembler and its options, so a file that has not changed since it
+ * was assembled has the same entry. If the cache is disabled, or the file can't be
+ * read, the function returns NULL. The user should free the string in the end of
+ * the usage.
+ *
+ * Parameters:
+ * -----------
+ * char *input_file     the path to the file that contains the program.
+ */
+char *get_cache_entry_path(char *input_file);
+
+/*
+ * If the given cache entry is complete, and it was created from the same program as
+ * the program in the given file path, the function copies its output files to the
+ * given file path, prints the errors that were stored in the entry, and returns 1.
+ * Otherwise, returns 0. Two programs can have the same hash, so the entry is used
+ * only if the program that is stored in it is equal to the given program.
+ *
+ * Parameters:
+ * -----------
+ * char *entry_path     the path of the cache entry.
+ * char *file_path      a path to the program, without an extension.
+ */
+int restore_cache_entry(char *entry_path, char *file_path);
+
+/*
+ * Creates the given cache entry, and opens the diagnostics file of the entry, so
+ * that the errors of the program are stored in the entry while they are printed.
+ * An existing entry is not complete anymore until it is closed. Returns 1 if the
+ * entry was created, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *entry_path     the path of the cache entry.
+ */
+int open_cache_entry(char *entry_path);
+
+/*
+ * Stores copies of the program and of its output files that exist in the given file path
+ * in the given cache entry, and closes the diagnostics file of the entry. The diagnostics
+ * file is the last file that is added to the entry, and it marks that the entry is complete.
+ *
+ * Parameters:
+ * -----------
+ * char *entry_path     the path of the cache entry.
+ * char *file_path      a path to the program, without an extension.
+ */
+void close_cache_entry(char *entry_path, char *file_path);
+
+/*
+ * Copies the given source file to the given destination file. Returns 1
+ * if the file was copied, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *source_path        the path of the file to copy.
+ * char *destination_path   the path of the copy.
+ */
+int copy_file(char *source_path, char *destination_path);
+
+/*
+ * Replaces the given destination file with a copy of the given source file. The
+ * destination is removed before it is written, so a file that shares its content
+ * with the destination (such as a hard link to it) is not changed.
+ *
+ * Parameters:
+ * -----------
+ * char *source_path        the path of the existing file.
+ * char *destination_path   the path of the new file.
+ */
+void replace_file(char *source_path, char *destination_path);
+
+/*
+ * Returns 1 if the two given files exist and have the same bytes, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *first_path     the path of the first file.
+ * char *second_path    the path of the second file.
+ */
+int equal_files(char *first_path, char *second_path);
+
+/*
+ * Returns 1 if a file exists in the given path, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *path   the path of the file.
+ */
+int file_exists(char *path);
+
+#endif
@@ -6,22 +6,86 @@
 #include "../data_structures/dynamic_array.h"
 
 /*
- * Gets a content that represent a command_content in the program, then breaks
- * it into parts using 'strtok' and other functions, and in the end
- * returns a pointer to the DynamicArray that was created during the
- * function execution, and stores in it Field structures, with order
- * that correspond to the order of the fields of the command_content.
+ * Returns a pointer to a new Field structure that stores the characters of the
+ * given command between the given indexes (including both of them). The content
+ * of the field is stored in the same memory block as the structure, and therefore
+ * freeing the field frees its content as well. If the field starts with a letter,
+ * it is an identifier, and it is interned into the string pool without its label
+ * ending character.
  *
  * Parameters:
  * -----------
- * char *command_content    a content that contains the command_content to tokenize.
+ * char *command_content    the string of the command.
+ * int start_index          the index in which the field starts in the command.
+ * int end_index            the index in which the field ends in the command.
  */
-DynamicArray *get_positions_array(char *command_content);
+Field *create_field(char *command_content, int start_index, int end_index);
+
+/*
+ * Returns a pointer to a DynamicArray that stores a Field structure for each token
+ * of the given command, except of the commas, in the order of the tokens in the command.
+ * Each field stores the type and the value of its token, and the number of commas
+ * between the previous field and itself. The tokens are the tokens that the lexer
+ * found in the command, when the command was read.
+ *
+ * Parameters:
+ * -----------
+ * char *command_content        the string of the command.
+ * TokensList *tokens_list      the tokens of the command.
+ */
+DynamicArray *get_positions_array(char *command_content, TokensList *tokens_list);
+
+/*
+ * Returns a pointer to a new null-terminated string that contains the given
+ * characters. The user should free the string in the end of the usage.
+ *
+ * Parameters:
+ * -----------
+ * const char *characters   the characters of the line, not necessarily null-terminated.
+ * size_t length            the number of characters.
+ */
+char *copy_line(const char *characters, size_t length);
+
+/*
+ * Returns a pointer to a new ProgramLine structure that stores the given line, and
+ * its tokens and fields. The line is lexed only here, and the ProgramLine takes the
+ * ownership of the given string, which is freed with the line by 'free_program_lines'.
+ *
+ * Parameters:
+ * -----------
+ * char *content    a string that contains the line, that was allocated dynamically.
+ */
+ProgramLine *create_program_line(char *content);
+
+/*
+ * Returns a pointer to a DynamicArray that is created during the execution of
+ * the function, and contains a ProgramLine structure in the 'array' field for
+ * each line of the given source. If the source ends with a new line, its last
+ * line is a single space.
+ *
+ * Parameters:
+ * -----------
+ * const char *source   the characters of the program.
+ * size_t length        the number of characters in the program.
+ */
+DynamicArray *split_program_lines(const char *source, size_t length);
+
+/*
+ * Returns a pointer to a new string that contains all the characters of the given
+ * file, and stores their number in the given pointer. The string is not null-terminated.
+ * The user should free the string in the end of the usage.
+ *
+ * Parameters:
+ * -----------
+ * char *file_path  the path to file that contains the program.
+ * long *length     a pointer to store the number of characters in.
+ */
+char *read_source_file(char *file_path, long *length);
 
 /*
  * Returns a pointer to a DynamicArray that is created during the
- * execution of the function, and contains strings in the 'array'
- * field, that each represent a line in the program.
+ * execution of the function, and contains a ProgramLine structure
+ * in the 'array' field for each line in the program.
  *
  * Parameters:
  * -----------
@@ -29,19 +93,120 @@ DynamicArray *get_positions_array(char *command_content);
  */
 DynamicArray *get_program_lines(char *file_path);
 
+/*
+ * Frees the dynamic memory that was allocated to contain the given line, its
+ * tokens and its fields, and in the end frees the line itself.
+ *
+ * Parameters:
+ * -----------
+ * ProgramLine *line    a pointer to the line.
+ */
+void free_program_line(ProgramLine *line);
+
+/*
+ * Frees the dynamic memory that was allocated to contain the given lines, their
+ * tokens and their fields, and in the end frees the array itself.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *program_lines  a DynamicArray of ProgramLine structures.
+ */
+void free_program_lines(DynamicArray *program_lines);
+
+/*
+ * Creates a Macro structure for each definition of a macro in the given lines,
+ * and adds it to a DynamicArray that is created during the program. In the
+ * end, the function returns a pointer to the DynamicArray. In addition, the
+ * function adds each line of the program to the given expanded lines, with the
+ * calls of the macros expanded, and without the definitions of the macros. The
+ * expanded lines point to the ProgramLine structures of the given lines, so they
+ * are not lexed again, and the user should free them with 'free_array'.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *program_lines      the ProgramLine of each line of the program.
+ * DynamicArray *expanded_lines     the DynamicArray to add the lines of the new program to.
+ */
+DynamicArray *expand_macro_lines(DynamicArray *program_lines, DynamicArray *expanded_lines);
+
+/*
+ * Returns 1 if the given line starts or ends the definition of a macro, and 0 otherwise.
+ * A program without such lines has no macros, and its expanded lines are its lines.
+ *
+ * Parameters:
+ * -----------
+ * ProgramLine *line    a pointer to the line.
+ */
+int is_macro_line(ProgramLine *line);
+
 /*
  * Creates a Macro structure for each definition of a macro in the program,
  * and adds it to a DynamicArray that is created during the program. In the
  * end, the function returns a pointer to the DynamicArray. In addition, the
- * function re-writes the content or creates a new file, expand the macros
- * calls to it, and remove the definitions and the calls of the macros.
+ * function adds the lines of the program to the given expanded lines like
+ * 'expand_macro_lines', and re-writes the content or creates a new file with
+ * the expanded lines.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *program_lines      the ProgramLine of each line of the program.
+ * DynamicArray *expanded_lines     the DynamicArray to add the lines of the new program to.
+ * char *dest_file                  the destination file to write the new program to.
+ */
+DynamicArray *expand_macros(DynamicArray *program_lines, DynamicArray *expanded_lines, char *dest_file);
+
+/*
+ * Frees the given macros table, that was returned by 'expand_macro_lines' or
+ * 'expand_macros': the list of the calls of each macro, the macros and the table.
+ * The lines in the lists of the calls belong to the program, and are not freed.
  *
  * Parameters:
  * -----------
- * char *source_file    the source file that contains the program.
- * char *dest_file      the destination file to write the new program to.
+ * DynamicArray *macros_table   the Macro of each definition of a macro in the program.
  */
-DynamicArray *expand_macros(char *source_file, char *dest_file);
+void free_macros_table(DynamicArray *macros_table);
+
+/*
+ * Writes the given expanded lines to the given file, from the line in the given index,
+ * that starts in the given offset in the file. The lines before it are not written
+ * again, so they must be in the file from a previous assembly. If the offset is 0, or
+ * the file doesn't exist, the whole file is written. Returns the length of the file,
+ * which may be shorter than its previous length.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *expanded_lines     the lines of the program after its macros were expanded.
+ * int first_line                   the index of the first line to write.
+ * long offset                      the offset of the first line in the file.
+ * char *dest_file                  the file to write the lines to.
+ */
+long update_expanded_lines(DynamicArray *expanded_lines, int first_line, long offset, char *dest_file);
+
+/*
+ * Returns a pointer to a new Label structure with the name that has the given
+ * id in the string pool. The name is owned by the string pool, and therefore it
+ * is stored only once. The other fields of the label are not set.
+ *
+ * Parameters:
+ * -----------
+ * int label_id     the id of the name of the label in the string pool.
+ */
+Label *create_label(int label_id);
+
+/*
+ * Adds a label with the given name id, address and type to the given symbols table,
+ * and returns 1. If a similar label is already in the table, the function prints the
+ * error, sets the error flag, and returns 0 without adding the label.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ * int label_id                     the id of the name of the label in the string pool.
+ * int address                      the address of the label (IC/DC, or 0 if it's external).
+ * int type                         the type of the label.
+ * int row_index                    the index of the row that the label is found in.
+ */
+int add_symbol(DynamicArray *symbols_table, int label_id, int address, int type, int row_index);
 
 /*
  * Returns a pointer to a DynamicArray that contains Label structures.
@@ -52,9 +217,9 @@ DynamicArray *expand_macros(char *source_file, char *dest_file);
  *
  * Parameters:
  * -----------
- * char *file_path  the path to the file that contains the program.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
  */
-DynamicArray (*get_symbols_table(char *file_path));
+DynamicArray (*get_symbols_table(DynamicArray *program_lines));
 
 /*
  * Returns a pointer to a DynamicArray which contains Operand structures.
@@ -63,10 +228,55 @@ DynamicArray (*get_symbols_table(char *file_path));
  *
  * Parameters:
  * -----------
- * char *command_content            the string of the command.
+ * ProgramLine *line                the line of the command.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ */
+DynamicArray *get_operands_array(ProgramLine *line, DynamicArray *symbols_table);
+
+/*
+ * Returns a pointer to a CommandsTable that contains the Command structure of each
+ * regular command in the given program, in the order of the commands in the program.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *program_lines      a DynamicArray that stores the ProgramLine of each line of the program.
  * DynamicArray *symbols_table      a DynamicArray pointer.
  */
-DynamicArray *get_operands_array(char *command_content, DynamicArray *symbols_table);
+CommandsTable *get_commands_table(DynamicArray *program_lines, DynamicArray *symbols_table);
+
+/*
+ * Analyzes the given command, and adds its Command structure to the end of the
+ * given commands table. The table grows automatically if it's full.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table.
+ * ProgramLine *line                the line of the command.
+ * int row_index                    the index of the row of the command.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ */
+void add_command(CommandsTable *commands_table, ProgramLine *line, int row_index, DynamicArray *symbols_table);
+
+/*
+ * Adds a copy of the given Command structure, that was already analyzed, to the end
+ * of the given commands table. The table grows automatically if it's full.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table.
+ * Command *command                 a pointer to the command to add.
+ */
+void append_command(CommandsTable *commands_table, Command *command);
+
+/*
+ * Frees the dynamic memory that was allocated to contain the commands
+ * of the given commands table, and in the end frees the table itself.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table.
+ */
+void free_commands_table(CommandsTable *commands_table);
 
 /*
  * The following function is responsible to change the type of any label in
@@ -76,44 +286,167 @@ DynamicArray *get_operands_array(char *command_content, DynamicArray *symbols_ta
  * the program, after it had changed the type of each entry definition label.
  *
  * Parameters:
- * char *file_path      the path to the file that stores the program.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
  */
-DynamicArray *second_iteration(char *file_path);
+DynamicArray *second_iteration(DynamicArray *program_lines);
 
 /*
- * Creates the object file of a program that is stored in the given file.
+ * Changes the type of the label with the given name id in the given symbols table,
+ * to the type of an entry definition. If the label is external, or it wasn't defined
+ * in the program, the function prints the error and sets the error flag.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ * int label_id                     the id of the name of the label in the string pool.
+ * int row_index                    the index of the row of the .entry declaration.
+ */
+void mark_entry_label(DynamicArray *symbols_table, int label_id, int row_index);
+
+/*
+ * Creates the object file of the given program.
  * In the beginning of the file, the IC and DC are written, and each following
  * line contains the encodings of the program in base 64.
  *
  * Parameters:
  * -----------
- * char *file_path      the path to the file that stores the program.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
+ * char *output_file            the path that the output file will be stored in.
+ */
+void create_object_file(DynamicArray *program_lines, char *output_path);
+
+/*
+ * Writes the object file of the program that is encoded in the code segment and
+ * the data segment. In the beginning of the file, the final IC and DC are written,
+ * and each following line contains the encodings of the program in base 64.
+ *
+ * Parameters:
+ * -----------
  * char *output_file    the path that the output file will be stored in.
  */
-void create_object_file(char *file_path, char *output_path);
+void write_object_file(char *output_path);
+
+/*
+ * Writes the words of the program that is encoded in the code segment and the data
+ * segment to the given object file, from the word in the given index, where the data
+ * words come after the code words. The words before the index are not written again,
+ * so they must be in the file from a previous assembly. If the file doesn't exist, or
+ * its first line has a different length, the whole file is written. Returns the length
+ * of the file, which may be shorter than its previous length.
+ *
+ * Parameters:
+ * -----------
+ * char *output_file    the path of the object file.
+ * int first_word       the index of the first word to write.
+ */
+long update_object_file(char *output_path, int first_word);
 
 /*
- * Creates the entries file of a program that is stored in the given file.
+ * Creates the entries file of the given program.
  * Each line contains the name of a label that is defined in the program, and
  * the memory address it is defined in.
  *
  * Parameters:
  * -----------
- * char *file_path      the path to the file that stores the program.
- * char *output_file    the path that the output file will be stored in.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
+ * char *output_file            the path that the output file will be stored in.
  */
-void create_entries_file(char *file_path, char *output_path);
+void create_entries_file(DynamicArray *program_lines, char *output_path);
 
 /*
- * Creates the externals file of a program that is stored in the given file.
+ * Writes the entries file of a program with the given symbols table, after its
+ * entry labels were marked. Each line contains the name of an entry label, and
+ * the memory address it is defined in. If the program has no entry labels, the
+ * file is not created.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ * char *output_file                the path that the output file will be stored in.
+ */
+void write_entries_file(DynamicArray *symbols_table, char *output_path);
+
+/*
+ * Creates the externals file of the given program.
  * Each line contains the name of a label that is defined in the program as
  * external, and the memory address it is used in.
  *
  * Parameters:
  * -----------
- * char *file_path      the path to the file that stores the program.
- * char *output_file    the path that the output file will be stored in.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
+ * char *output_file            the path that the output file will be stored in.
+ */
+void create_externals_file(DynamicArray *program_lines, char *output_path);
+
+/*
+ * Writes the externals file of a program with the given commands table and symbols
+ * table. Each line contains the name of an external label, and the memory address it
+ * is used in. If the program doesn't use external labels, the file is not created.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table of the program.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ * char *output_file                the path that the output file will be stored in.
+ */
+void write_externals_file(CommandsTable *commands_table, DynamicArray *symbols_table, char *output_path);
+
+/*
+ * Returns a pointer to a DynamicArray that contains a Label structure for each use
+ * of an external label in the given commands, in the order of the commands. The
+ * address of each label is the address of the memory word that the label is used in.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table of the program.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ */
+DynamicArray *get_external_references(CommandsTable *commands_table, DynamicArray *symbols_table);
+
+/*
+ * Creates the binary object file of the given program.
+ * The binary object file stores the same encodings as the object file, and also
+ * the entry labels and the uses of external labels of the program.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
+ * char *output_file            the path that the output file will be stored in.
+ */
+void create_binary_object_file(DynamicArray *program_lines, char *output_path);
+
+/*
+ * Writes the binary object file of the program that is encoded in the code segment
+ * and the data segment. The file starts with an ObjectHeader, followed by the code
+ * words and the data words, an ObjectSymbol for each entry label and for each use of
+ * an external label, and in the end the names of the labels. Every field is a 16-bit
+ * little-endian word, so that a loader can map the file and use it without parsing.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table of the program.
+ * DynamicArray *symbols_table      a DynamicArray pointer, after the entry labels were marked.
+ * char *output_file                the path that the output file will be stored in.
+ */
+void write_binary_object_file(CommandsTable *commands_table, DynamicArray *symbols_table, char *output_path);
+
+/*
+ * Writes the binary object file like 'write_binary_object_file', but writes the words
+ * of the program only from the word in the given index, where the data words come after
+ * the code words. The header and the tables after the words are always written. If the
+ * file doesn't exist, the whole file is written. Returns the length of the file, which
+ * may be shorter than its previous length. If a count or a size of the tables doesn't
+ * fit in its 16-bit field, the file is removed instead of being written, and the
+ * function returns 0.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table of the program.
+ * DynamicArray *symbols_table      a DynamicArray pointer, after the entry labels were marked.
+ * char *output_file                the path of the binary object file.
+ * int first_word                   the index of the first word to write.
  */
-void create_externals_file(char *file_path, char *output_path);
+long update_binary_object_file(CommandsTable *commands_table, DynamicArray *symbols_table, char *output_path,
+                               int first_word);
 
 #endif
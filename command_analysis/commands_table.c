@@ -1,4 +1,184 @@
 #include <stdlib.h>
 #include "command_analysis.h"
+#include "helpers.h"
+#include "../function_macros.h"
 #include "../data_structures/dynamic_array.h"
 
+#define INITIAL_COMMANDS_TABLE_CAPACITY 64 /* the number of commands that a commands table can store after its first growth */
+
+/* the encoding templates of every operation, for every pair of source and destination addressing methods */
+EncodingTemplate encoding_table[NO_OF_OPERATIONS][NO_OF_ADDRESSING_INDEXES][NO_OF_ADDRESSING_INDEXES];
+/* indicates if the encoding table has already been built */
+int encoding_table_built = 0;
+
+/*
+ * Returns the index of the given addressing code in the encoding table.
+ * A missing operand and an unknown addressing code both have the index
+ * of a missing operand.
+ *
+ * Parameters:
+ * -----------
+ * int addressing_code  the addressing code of an operand.
+ */
+int get_addressing_index(int addressing_code) {
+    switch (addressing_code) {
+        case IMMEDIATE_ADDRESSING_CODE:
+            return IMMEDIATE_ADDRESSING_INDEX;
+        case LABEL_ADDRESSING_CODE:
+            return LABEL_ADDRESSING_INDEX;
+        case REGISTER_ADDRESSING_CODE:
+            return REGISTER_ADDRESSING_INDEX;
+        default:
+            return NO_OPERAND_ADDRESSING_INDEX;
+    }
+}
+
+/*
+ * Fills the encoding table with the encoding template of every operation
+ * and every pair of addressing methods. The first memory word of each template
+ * stores the opcode and the addressing codes of the operands, and the number of
+ * memory words is 1 word for the command, and 1 word for each operand, except of
+ * two register operands that share the same memory word.
+ */
+void build_encoding_table() {
+    const int addressing_codes[NO_OF_ADDRESSING_INDEXES] = {0, IMMEDIATE_ADDRESSING_CODE, LABEL_ADDRESSING_CODE,
+                                                            REGISTER_ADDRESSING_CODE};
+    EncodingTemplate *template;
+    int opcode;
+    int src_index;
+    int dest_index;
+
+    for (opcode = 0; opcode < NO_OF_OPERATIONS; opcode++) {
+        for (src_index = 0; src_index < NO_OF_ADDRESSING_INDEXES; src_index++) {
+            for (dest_index = 0; dest_index < NO_OF_ADDRESSING_INDEXES; dest_index++) {
+                template = &encoding_table[opcode][src_index][dest_index];
+
+                template->first_word =
+                        encode_bit_field(ARE_ABSOLUTE_CODE, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT) |
+                        encode_bit_field(addressing_codes[dest_index], ENCODING_ADDRESSING_LENGTH,
+                                         ENCODING_DEST_ADDRESSING_SHIFT) |
+                        encode_bit_field(opcode, ENCODING_OPCODE_LENGTH, ENCODING_OPCODE_SHIFT) |
+                        encode_bit_field(addressing_codes[src_index], ENCODING_ADDRESSING_LENGTH,
+                                         ENCODING_SRC_ADDRESSING_SHIFT);
+
+                template->memory_words = MIN_NO_OF_WORDS_IN_COMMAND;
+                if (src_index != NO_OPERAND_ADDRESSING_INDEX) {
+                    template->memory_words += 1;
+                }
+                if (dest_index != NO_OPERAND_ADDRESSING_INDEX) {
+                    template->memory_words += 1;
+                }
+                /* two registers are stored in the same memory word */
+                if (src_index == REGISTER_ADDRESSING_INDEX && dest_index == REGISTER_ADDRESSING_INDEX) {
+                    template->memory_words -= 1;
+                }
+            }
+        }
+    }
+    encoding_table_built = 1;
+}
+
+/*
+ * Returns a pointer to the encoding template of a command with the given
+ * opcode and the given addressing codes of its source and destination
+ * operands. A command that doesn't have a source/destination operand
+ * should pass 0 as the addressing code of the missing operand.
+ *
+ * Parameters:
+ * -----------
+ * int opcode               the opcode of the command.
+ * int src_addressing       the addressing code of the source operand.
+ * int dest_addressing      the addressing code of the destination operand.
+ */
+const EncodingTemplate *get_encoding_template(int opcode, int src_addressing, int dest_addressing) {
+    if (!encoding_table_built) {
+        build_encoding_table();
+    }
+    return &encoding_table[opcode][get_addressing_index(src_addressing)][get_addressing_index(dest_addressing)];
+}
+
+/*
+ * Grows the given commands table if it's full, so that another command
+ * could be added to its end.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table.
+ */
+void reserve_command(CommandsTable *commands_table) {
+    if ((commands_table->length) == (commands_table->capacity)) {
+        commands_table->capacity = (commands_table->capacity) ? 2 * (commands_table->capacity) :
+                                   INITIAL_COMMANDS_TABLE_CAPACITY;
+        commands_table->commands = realloc(commands_table->commands, (commands_table->capacity) * sizeof(Command));
+    }
+}
+
+/*
+ * Analyzes the given command, and adds its Command structure to the end of the
+ * given commands table. The table grows automatically if it's full.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table.
+ * ProgramLine *line                the line of the command.
+ * int row_index                    the index of the row of the command.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ */
+void add_command(CommandsTable *commands_table, ProgramLine *line, int row_index, DynamicArray *symbols_table) {
+    reserve_command(commands_table);
+    get_command_object(line, row_index, symbols_table,
+                       &(commands_table->commands)[commands_table->length]);
+    commands_table->length += 1;
+}
+
+/*
+ * Adds a copy of the given Command structure, that was already analyzed, to the end
+ * of the given commands table. The table grows automatically if it's full.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table.
+ * Command *command                 a pointer to the command to add.
+ */
+void append_command(CommandsTable *commands_table, Command *command) {
+    reserve_command(commands_table);
+    (commands_table->commands)[commands_table->length] = *command;
+    commands_table->length += 1;
+}
+
+/*
+ * Returns a pointer to a CommandsTable that contains the Command structure of each
+ * regular command in the given program, in the order of the commands in the program.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *program_lines      a DynamicArray that stores the ProgramLine of each line of the program.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ */
+CommandsTable *get_commands_table(DynamicArray *program_lines, DynamicArray *symbols_table) {
+    CommandsTable *commands_table = calloc(1, sizeof(CommandsTable));
+    ProgramLine *temp_line;
+    int row_index;
+
+    for (row_index = 0; row_index < (program_lines->length); row_index++) {
+        temp_line = GET_POINTER(program_lines, ProgramLine*, row_index);
+        if (is_empty_command(temp_line->content) || get_definition_type(temp_line) != COMMAND_DEFINITION_CODE) {
+            continue;
+        }
+        add_command(commands_table, temp_line, row_index, symbols_table);
+    }
+    return commands_table;
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the commands
+ * of the given commands table, and in the end frees the table itself.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table.
+ */
+void free_commands_table(CommandsTable *commands_table) {
+    free(commands_table->commands);
+    free(commands_table);
+}
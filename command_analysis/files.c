@@ -1,164 +1,405 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "helpers.h"
 #include "command_analysis.h"
 #include "../function_macros.h"
 #include "../segments.h"
 
 /*
- * Creates the object file of a program that is stored in the given file.
+ * Creates the object file of the given program.
  * In the beginning of the file, the IC and DC are written, and each following
  * line contains the encodings of the program in base 64.
  *
  * Parameters:
  * -----------
- * char *file_path      the path to the file that stores the program.
- * char *output_file    the path that the output file will be stored in.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
+ * char *output_file            the path that the output file will be stored in.
  */
-void create_object_file(char *file_path, char *output_path) {
-    FILE *file;
-    int index;
-    char *base_64_code;
+void create_object_file(DynamicArray *program_lines, char *output_path) {
+    /* encode the data */
+    free_dynamic_array(get_symbols_table(program_lines));
+    /* encode the commands */
+    free_dynamic_array(second_iteration(program_lines));
 
-    /* re-write the file */
-    file = fopen(output_path, "w");
-    file = fopen(output_path, "a");
+    write_object_file(output_path);
+}
 
-    /* encode the data */
-    get_symbols_table(file_path);
-    fprintf(file, "%d %d\n", final_IC, final_DC);
+/*
+ * Writes the object file of the program that is encoded in the code segment and
+ * the data segment. In the beginning of the file, the final IC and DC are written,
+ * and each following line contains the encodings of the program in base 64.
+ *
+ * Parameters:
+ * -----------
+ * char *output_file    the path that the output file will be stored in.
+ */
+void write_object_file(char *output_path) {
+    update_object_file(output_path, 0);
+}
 
-    /* encode the commands */
-    second_iteration(file_path);
+/*
+ * Writes the words of the program that is encoded in the code segment and the data
+ * segment to the given object file, from the word in the given index, where the data
+ * words come after the code words. The words before the index are not written again,
+ * so they must be in the file from a previous assembly. If the file doesn't exist, or
+ * its first line has a different length, the whole file is written. Returns the length
+ * of the file, which may be shorter than its previous length.
+ *
+ * Parameters:
+ * -----------
+ * char *output_file    the path of the object file.
+ * int first_word       the index of the first word to write.
+ */
+long update_object_file(char *output_path, int first_word) {
+    FILE *file = (first_word > 0) ? fopen(output_path, "r+") : NULL;
+    char header[MAX_OBJECT_HEADER_LENGTH];
+    char previous_header[MAX_OBJECT_HEADER_LENGTH];
+    char *base_64_code;
+    unsigned int word;
+    long length;
+    int index;
 
-    /* write the instructions encodings to the file */
-    for (index = 0; index < final_IC; index++) {
-        base_64_code = convert_to_base_64(code_segment[index][0]);
-        fprintf(file, "%s\n", base_64_code);
-        free(base_64_code);
+    sprintf(header, "%d %d\n", final_IC, final_DC);
+    /* the words of the previous assembly are in the same offsets only if the first line has the same length */
+    if (file != NULL && (fgets(previous_header, sizeof(previous_header), file) == NULL ||
+                         strlen(previous_header) != strlen(header))) {
+        fclose(file);
+        file = NULL;
+    }
+    if (file == NULL) {
+        /* re-write the file */
+        file = fopen(output_path, "w");
+        first_word = 0;
     }
-    /* write the data encodings to the file */
-    for (index = 0; index < final_DC; index++) {
-        base_64_code = convert_to_base_64(data_segment[index][0]);
+    fseek(file, 0, SEEK_SET);
+    fputs(header, file);
+    fseek(file, (long) strlen(header) + (long) first_word * OBJECT_WORD_LINE_LENGTH, SEEK_SET);
+
+    /* write the instructions encodings and then the data encodings to the file */
+    for (index = first_word; index < final_IC + final_DC; index++) {
+        word = (index < final_IC) ? read_word(&code_segment, index) : read_word(&data_segment, index - final_IC);
+        base_64_code = convert_to_base_64(word);
         fprintf(file, "%s\n", base_64_code);
         free(base_64_code);
     }
+    length = ftell(file);
     fclose(file);
+    return length;
 }
 
 /*
- * Creates the entries file of a program that is stored in the given file.
+ * Creates the entries file of the given program.
  * Each line contains the name of a label that is defined in the program, and
  * the memory address it is defined in.
  *
  * Parameters:
  * -----------
- * char *file_path      the path to the file that stores the program.
- * char *output_file    the path that the output file will be stored in.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
+ * char *output_file            the path that the output file will be stored in.
  */
-void create_entries_file(char *file_path, char *output_path) {
+void create_entries_file(DynamicArray *program_lines, char *output_path) {
     /* activate the second iteration in order to create the symbols table and mark the entry labels */
-    FILE *file;
-    Label temp_label;
-    DynamicArray *symbols_table = second_iteration(file_path);
+    DynamicArray *symbols_table = second_iteration(program_lines);
+
+    write_entries_file(symbols_table, output_path);
+    free_dynamic_array(symbols_table);
+}
+
+/*
+ * Writes the entries file of a program with the given symbols table, after its
+ * entry labels were marked. Each line contains the name of an entry label, and
+ * the memory address it is defined in. If the program has no entry labels, the
+ * file is not created.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ * char *output_file                the path that the output file will be stored in.
+ */
+void write_entries_file(DynamicArray *symbols_table, char *output_path) {
+    FILE *file = NULL;
+    Label *temp_label;
 
     int index;
-    int no_of_entries = 0;
 
     for (index = 0; index < (symbols_table->length); index++) {
-        temp_label = GET_ELEMENT(symbols_table, Label*, index);
-        if (temp_label.type == ENTRY_DEFINITION_CODE) {
-            no_of_entries += 1;
+        temp_label = GET_POINTER(symbols_table, Label*, index);
+        if ((temp_label->type) == ENTRY_DEFINITION_CODE) {
             /* create the entries file only if there's at least one entry label */
-            if (no_of_entries == 1) {
-                /* re-write the file */
+            if (file == NULL) {
                 file = fopen(output_path, "w");
-                file = fopen(output_path, "a");
             }
-            fprintf(file, "%s %d\n", temp_label.name, temp_label.address);
+            fprintf(file, "%s %d\n", temp_label->name, temp_label->address);
         }
     }
-    free_dynamic_array(symbols_table);
-    fclose(file);
+    if (file != NULL) {
+        fclose(file);
+    }
 }
 
 /*
- * Creates the externals file of a program that is stored in the given file.
+ * Creates the externals file of the given program.
  * Each line contains the name of a label that is defined in the program as
  * external, and the memory address it is used in.
  *
  * Parameters:
  * -----------
- * char *file_path      the path to the file that stores the program.
- * char *output_file    the path that the output file will be stored in.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
+ * char *output_file            the path that the output file will be stored in.
  */
-void create_externals_file(char *file_path, char *output_path) {
-    DynamicArray *program_lines = get_program_lines(file_path);
-    DynamicArray *symbols_table = get_symbols_table(file_path);
-    Command temp_command;
-
-    Operand first_operand;
-    Operand second_operand;
-    Label temp_label;
-    FILE *file;
+void create_externals_file(DynamicArray *program_lines, char *output_path) {
+    DynamicArray *symbols_table = get_symbols_table(program_lines);
+    CommandsTable *commands_table = get_commands_table(program_lines, symbols_table);
+
+    write_externals_file(commands_table, symbols_table, output_path);
+    free_commands_table(commands_table);
+    free_dynamic_array(symbols_table);
+}
+
+/*
+ * Returns a pointer to a DynamicArray that contains a Label structure for each use
+ * of an external label in the given commands, in the order of the commands. The
+ * address of each label is the address of the memory word that the label is used in.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table of the program.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ */
+DynamicArray *get_external_references(CommandsTable *commands_table, DynamicArray *symbols_table) {
+    DynamicArray *references = create_dynamic_array();
+    Command *temp_command;
+    ResolvedOperand *operands[2]; /* the operands of the command, in the order of their memory words */
+    Label *temp_label;
+    Label *reference;
 
     int index;
+    int operand_index;
     int label_index;
-    int label_address;
-    char *temp_command_content;
-    int no_of_extern_labels = 0;
+    int command_address = LOAD_ADDRESS; /* the address of the first memory word of the current command */
 
-    for (index = 0; index < (program_lines->length); index++) {
-        temp_command_content = GET_STRING(program_lines, index);
-
-        /* move to the next command if it's an empty command or a command with a different definition code than a regular command */
-        if (is_empty_command(temp_command_content) ||
-                get_definition_type(temp_command_content) != COMMAND_DEFINITION_CODE) {
-            continue;
-        }
+    for (index = 0; index < (commands_table->length); index++) {
+        temp_command = &(commands_table->commands)[index];
+        operands[0] = &(temp_command->source_operand);
+        operands[1] = &(temp_command->destination_operand);
 
-        temp_command = get_command_object(temp_command_content, index, symbols_table);
-
-        first_operand = temp_command.first_operand;
-        second_operand = temp_command.second_operand;
-
-        /* check if the first operand is a label */
-        if (first_operand.addressing == LABEL_ADDRESSING_CODE) {
-            label_index = get_label_index(first_operand.data, symbols_table);
-            temp_label = GET_ELEMENT(symbols_table, Label*, label_index);
-            label_address = get_command_address(index, program_lines) + 1;
-
-            if (temp_label.type == EXTERN_DEFINITION_CODE) {
-                no_of_extern_labels += 1;
-                if (no_of_extern_labels == 1) {
-                    /* re-write the file */
-                    file = fopen(output_path, "w");
-                    file = fopen(output_path, "a");
-                }
-                fprintf(file, "%s %d\n", temp_label.name, label_address);
+        /* the word of each operand comes after the first word and after the word of the operand before it */
+        for (operand_index = 0; operand_index < 2; operand_index++) {
+            if (operands[operand_index]->addressing != LABEL_ADDRESSING_CODE) {
                 continue;
             }
-
-        }
-        /* check if the second operand is a label */
-        if (second_operand.addressing == LABEL_ADDRESSING_CODE) {
-            label_index = get_label_index(second_operand.data, symbols_table);
-            temp_label = GET_ELEMENT(symbols_table, Label*, label_index);
-            label_address = get_command_address(index, program_lines) + 2;
-
-            if (temp_label.type == EXTERN_DEFINITION_CODE) {
-                no_of_extern_labels += 1;
-                if (no_of_extern_labels == 1) {
-                    /* re-write the file */
-                    file = fopen(output_path, "w");
-                    file = fopen(output_path, "a");
-                }
-                fprintf(file, "%s %d\n", temp_label.name, label_address);
+            label_index = get_label_index(operands[operand_index]->value, symbols_table);
+            if (label_index < 0) {
                 continue;
             }
+            temp_label = GET_POINTER(symbols_table, Label*, label_index);
+            if ((temp_label->type) == EXTERN_DEFINITION_CODE) {
+                reference = create_label(temp_label->id);
+                reference->address = command_address +
+                                     ((operand_index == 0 || !(operands[0]->addressing)) ? 1 : 2);
+                reference->type = EXTERN_DEFINITION_CODE;
+                reference->index = temp_command->index;
+                add_element(references, reference);
+            }
+        }
+        command_address += get_command_memory_words(temp_command);
+    }
+    return references;
+}
+
+/*
+ * Writes the externals file of a program with the given commands table and symbols
+ * table. Each line contains the name of an external label, and the memory address it
+ * is used in. If the program doesn't use external labels, the file is not created.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table of the program.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ * char *output_file                the path that the output file will be stored in.
+ */
+void write_externals_file(CommandsTable *commands_table, DynamicArray *symbols_table, char *output_path) {
+    DynamicArray *references = get_external_references(commands_table, symbols_table);
+    Label *temp_label;
+    FILE *file;
+
+    int index;
+
+    /* create the externals file only if there's at least one external label */
+    if ((references->length) > 0) {
+        file = fopen(output_path, "w");
+        for (index = 0; index < (references->length); index++) {
+            temp_label = GET_POINTER(references, Label*, index);
+            fprintf(file, "%s %d\n", temp_label->name, temp_label->address);
         }
+        fclose(file);
     }
-    free_dynamic_array(program_lines);
+    free_dynamic_array(references);
+}
+
+/*
+ * Writes the given number to the given file as a binary word of 16 bits,
+ * starting from its lower byte.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file           the file to write to.
+ * unsigned int word    the number to write.
+ */
+void write_binary_word(FILE *file, unsigned int word) {
+    fputc((int) (word & 0xFF), file);
+    fputc((int) ((word >> 8) & 0xFF), file);
+}
+
+/*
+ * Creates the binary object file of the given program.
+ * The binary object file stores the same encodings as the object file, and also
+ * the entry labels and the uses of external labels of the program.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
+ * char *output_file            the path that the output file will be stored in.
+ */
+void create_binary_object_file(DynamicArray *program_lines, char *output_path) {
+    /* encode the program, and mark the entry labels */
+    DynamicArray *symbols_table = second_iteration(program_lines);
+    CommandsTable *commands_table = get_commands_table(program_lines, symbols_table);
+
+    write_binary_object_file(commands_table, symbols_table, output_path);
+    free_commands_table(commands_table);
     free_dynamic_array(symbols_table);
+}
+
+/*
+ * Writes the binary object file of the program that is encoded in the code segment
+ * and the data segment. The file starts with an ObjectHeader, followed by the code
+ * words and the data words, an ObjectSymbol for each entry label and for each use of
+ * an external label, and in the end the names of the labels. Every field is a 16-bit
+ * little-endian word, so that a loader can map the file and use it without parsing.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table of the program.
+ * DynamicArray *symbols_table      a DynamicArray pointer, after the entry labels were marked.
+ * char *output_file                the path that the output file will be stored in.
+ */
+void write_binary_object_file(CommandsTable *commands_table, DynamicArray *symbols_table, char *output_path) {
+    update_binary_object_file(commands_table, symbols_table, output_path, 0);
+}
+
+/*
+ * Writes the binary object file like 'write_binary_object_file', but writes the words
+ * of the program only from the word in the given index, where the data words come after
+ * the code words. The header and the tables after the words are always written. If the
+ * file doesn't exist, the whole file is written. Returns the length of the file, which
+ * may be shorter than its previous length. If a count or a size of the tables doesn't
+ * fit in its 16-bit field, the file is removed instead of being written, and the
+ * function returns 0.
+ *
+ * Parameters:
+ * -----------
+ * CommandsTable *commands_table    a pointer to the commands table of the program.
+ * DynamicArray *symbols_table      a DynamicArray pointer, after the entry labels were marked.
+ * char *output_file                the path of the binary object file.
+ * int first_word                   the index of the first word to write.
+ */
+long update_binary_object_file(CommandsTable *commands_table, DynamicArray *symbols_table, char *output_path,
+                               int first_word) {
+    DynamicArray *references = get_external_references(commands_table, symbols_table);
+    FILE *file = NULL;
+    Label *temp_label;
+    int *name_offsets = malloc(((symbols_table->length) + 1) * sizeof(int)); /* the offset of each label name */
+
+    long length;
+    int index;
+    int no_of_entries = 0;
+    int names_size = 0; /* the number of bytes in the names of the labels */
+    int strings_size; /* the number of bytes in the names, padded to a whole number of words */
+
+    if (name_offsets == NULL) {
+        printf("Could not allocate memory for the binary object file!\n");
+        exit(0);
+    }
+    /* the names of the entry and the external labels are stored once, in the order of the symbols table */
+    for (index = 0; index < (symbols_table->length); index++) {
+        temp_label = GET_POINTER(symbols_table, Label*, index);
+        name_offsets[index] = names_size;
+        if ((temp_label->type) == ENTRY_DEFINITION_CODE || (temp_label->type) == EXTERN_DEFINITION_CODE) {
+            names_size += (int) strlen(temp_label->name) + 1;
+        }
+        if ((temp_label->type) == ENTRY_DEFINITION_CODE) {
+            no_of_entries++;
+        }
+    }
+    /* the names are padded to a whole number of words */
+    strings_size = names_size + names_size % 2;
+
+    /* the offsets of the names are smaller than the size of the names, so they fit if it fits */
+    if (no_of_entries > BINARY_OBJECT_MAX_FIELD || (references->length) > BINARY_OBJECT_MAX_FIELD ||
+        strings_size > BINARY_OBJECT_MAX_FIELD) {
+        remove(output_path);
+        free(name_offsets);
+        free_dynamic_array(references);
+        return 0;
+    }
+    if (first_word > 0) {
+        file = fopen(output_path, "r+b");
+    }
+    if (file == NULL) {
+        file = fopen(output_path, "wb");
+        first_word = 0;
+    }
+    if (file == NULL) {
+        free(name_offsets);
+        free_dynamic_array(references);
+        return 0;
+    }
+    /* write the header */
+    fwrite(BINARY_OBJECT_MAGIC, 1, BINARY_OBJECT_MAGIC_LENGTH, file);
+    write_binary_word(file, BINARY_OBJECT_VERSION);
+    write_binary_word(file, (unsigned int) LOAD_ADDRESS);
+    write_binary_word(file, (unsigned int) final_IC);
+    write_binary_word(file, (unsigned int) final_DC);
+    write_binary_word(file, (unsigned int) no_of_entries);
+    write_binary_word(file, (unsigned int) (references->length));
+    write_binary_word(file, (unsigned int) strings_size);
+    write_binary_word(file, 0);
+
+    /* write the code words and the data words, from the first word that has changed */
+    fseek(file, (long) first_word * 2, SEEK_CUR);
+    for (index = first_word; index < final_IC + final_DC; index++) {
+        write_binary_word(file, ((index < final_IC) ? read_word(&code_segment, index) :
+                                 read_word(&data_segment, index - final_IC)) & MEMORY_WORD_MASK);
+    }
+    /* write the entries table */
+    for (index = 0; index < (symbols_table->length); index++) {
+        temp_label = GET_POINTER(symbols_table, Label*, index);
+        if ((temp_label->type) == ENTRY_DEFINITION_CODE) {
+            write_binary_word(file, (unsigned int) name_offsets[index]);
+            write_binary_word(file, (unsigned int) (temp_label->address));
+        }
+    }
+    /* write the external references table */
+    for (index = 0; index < (references->length); index++) {
+        temp_label = GET_POINTER(references, Label*, index);
+        write_binary_word(file, (unsigned int) name_offsets[get_label_index(temp_label->id, symbols_table)]);
+        write_binary_word(file, (unsigned int) (temp_label->address));
+    }
+    /* write the names of the labels */
+    for (index = 0; index < (symbols_table->length); index++) {
+        temp_label = GET_POINTER(symbols_table, Label*, index);
+        if ((temp_label->type) == ENTRY_DEFINITION_CODE || (temp_label->type) == EXTERN_DEFINITION_CODE) {
+            fwrite(temp_label->name, 1, strlen(temp_label->name) + 1, file);
+        }
+    }
+    if (strings_size > names_size) {
+        fputc(0, file);
+    }
+    length = ftell(file);
     fclose(file);
+    free(name_offsets);
+    free_dynamic_array(references);
+    return length;
 }
\ No newline at end of file
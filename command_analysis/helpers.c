@@ -1,9 +1,9 @@
 #include <stdio.h>
-#include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
 #include "helpers.h"
 #include "command_analysis.h"
+#include "scanner.h"
 #include "../function_macros.h"
 #include "../error_detection/helpers.h"
 #include "../error_detection/detector.h"
@@ -18,32 +18,22 @@
  * char *field_content  the content of the field.
  */
 int is_empty_field(char *field_content) {
-    int index;
-    for (index = 0; index < (signed int)strlen(field_content); index++) {
-        if (isalpha(field_content[index]))
-            return 0;
-    }
-    return 1;
+    return !contains_letter(field_content, (int) strlen(field_content));
 }
 
 /*
  * Returns 1 if all the characters of the given command content are tabs,
- * spaces and semicolons, and otherwise returns 0.
+ * spaces and semicolons, or if the command is a comment, and otherwise returns 0.
  *
  * Parameters:
  * -----------
  * char *command_content  the content of the command.
  */
 int is_empty_command(char *command_content) {
-    int index;
-    if (strcmp(command_content, "") == 0) {
-        return 1;
-    }
-    for (index = 0; index < (signed int)strlen(command_content); index++) {
-        if (isalpha(command_content[index]))
-            return 0;
-    }
-    return 1;
+    int length = (int) strlen(command_content);
+    int start = skip_delimiters(command_content, length, 0);
+    return start == length || command_content[start] == COMMENT_STARTING_CHARACTER ||
+           !contains_letter(command_content + start, length - start);
 }
 
 /*
@@ -56,61 +46,22 @@ int is_empty_command(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int get_definition_type(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    Field field_0 = GET_ELEMENT(positions_array, Field*, 0);
-    Field field_1;
-    char definition_name[MAX_FIELD_LENGTH];
+int get_definition_type(ProgramLine *line) {
+    DynamicArray *positions_array = line->positions_array;
+    Field *temp_field;
+    int definition_code = 0;
     int index;
 
-    /* store the characters of the first field in the array */
-    for (index = field_0.start; index <= field_0.end; index++) {
-        definition_name[index - field_0.start] = command_content[index];
-    }
-    definition_name[index] = 0;
-    /* check if the first field is the definition */
-    if (!strcmp(definition_name, DATA_DEFINITION_NAME)) {
-        free_dynamic_array(positions_array);
-        return DATA_DEFINITION_CODE;
-    } else if (!strcmp(definition_name, STRING_DEFINITION_NAME)) {
-        free_dynamic_array(positions_array);
-        return STRING_DEFINITION_CODE;
-    } else if (!strcmp(definition_name, EXTERN_DEFINITION_NAME)) {
-        free_dynamic_array(positions_array);
-        return EXTERN_DEFINITION_CODE;
-    } else if (!strcmp(definition_name, ENTRY_DEFINITION_NAME)) {
-        free_dynamic_array(positions_array);
-        return ENTRY_DEFINITION_CODE;
-    }
-
-    if ((positions_array->length) <= 1) {
-        free_dynamic_array(positions_array);
-        return COMMAND_DEFINITION_CODE;
-    }
-    field_1 = GET_ELEMENT(positions_array, Field*, 1);
-    /* store the characters of the second field in the array */
-    memset(definition_name, 0, sizeof(definition_name));
-    for (index = field_1.start; index <= field_1.end; index++) {
-        definition_name[index - field_1.start] = command_content[index];
-    }
-    /* check if the second field is a definition */
-    if (!strcmp(definition_name, DATA_DEFINITION_NAME)) {
-        free_dynamic_array(positions_array);
-        return DATA_DEFINITION_CODE;
-    } else if (!strcmp(definition_name, STRING_DEFINITION_NAME)) {
-        free_dynamic_array(positions_array);
-        return STRING_DEFINITION_CODE;
-    } else if (!strcmp(definition_name, EXTERN_DEFINITION_NAME)) {
-        free_dynamic_array(positions_array);
-        return EXTERN_DEFINITION_CODE;
-    } else if (!strcmp(definition_name, ENTRY_DEFINITION_NAME)) {
-        free_dynamic_array(positions_array);
-        return ENTRY_DEFINITION_CODE;
+    /* check if the first field or the second field is a definition */
+    for (index = 0; index < (positions_array->length) && index <= MAX_NAME_FIELD_INDEX && !definition_code; index++) {
+        temp_field = GET_POINTER(positions_array, Field*, index);
+        if (temp_field->type == DIRECTIVE_TOKEN_CODE) {
+            definition_code = temp_field->value;
+        }
     }
-    free_dynamic_array(positions_array);
-    return COMMAND_DEFINITION_CODE;
+    return (definition_code) ? definition_code : COMMAND_DEFINITION_CODE;
 }
 
 /*
@@ -123,34 +74,27 @@ int get_definition_type(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-char *get_label_name(char *command_content) {
-    DynamicArray *positions_array;
+char *get_label_name(ProgramLine *line) {
     Field field_0;
 
-    char delimiters[] = " "; /* separating characters */
     char *label_name;
-    int index;
+    int length; /* the number of characters in the label, without the label ending character */
 
     variable_1 = 0;
     variable_2 = 0;
 
-    command_content = command_content + strspn(command_content, delimiters);
-    positions_array = get_positions_array(command_content);
-
-    field_0 = GET_ELEMENT(positions_array, Field*, 0);
-    label_name = malloc(sizeof(char) * (MAX_FIELD_LENGTH + 1));
-
-    if (!has_valid_label(command_content)) {
+    if (!has_valid_label(line)) {
         return NULL;
     }
-    for (index = 0; index < field_0.end; index++) {
-        label_name[index] = command_content[index];
-    }
+    field_0 = GET_ELEMENT(line->positions_array, Field*, 0);
+    /* the label ends one character before the label ending character */
+    length = field_0.end - field_0.start;
+    label_name = malloc(sizeof(char) * (length + 1));
+    memcpy(label_name, field_0.content, length);
     /* add a null terminator */
-    label_name[index] = 0;
-    free_dynamic_array(positions_array);
+    label_name[length] = 0;
     return label_name;
 
 
@@ -163,26 +107,12 @@ char *get_label_name(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int has_valid_label(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    Field field_0 = GET_ELEMENT(positions_array, Field*, 0);
-    int index;
-
-    /* check that the first character of the label is a letter
-      * and that the last character of the label is ':' */
-    if (!isalpha(command_content[field_0.start]) || command_content[field_0.end] != LABEL_ENDING_CHARACTER) {
-        return 0;
-    }
-    /* check that all the inner characters of the label are letters and digits */
-    for (index = field_0.start; index < field_0.end; index++) {
-        if (!isalpha(command_content[index]) && !isdigit(command_content[index])) {
-            return 0;
-        }
-    }
-    free_dynamic_array(positions_array);
-    return 1;
+int has_valid_label(ProgramLine *line) {
+    DynamicArray *positions_array = line->positions_array;
+    return (positions_array->length) > 0 &&
+           GET_POINTER(positions_array, Field*, 0)->type == LABEL_DEFINITION_TOKEN_CODE;
 }
 
 /*
@@ -198,7 +128,7 @@ int has_valid_label(char *command_content) {
  * int row_index        the index of the row that the label is defined in.
  */
 int found_similar_label(DynamicArray *symbols_table, Label *label, int row_index) {
-    Label temp_label;
+    Label *temp_label;
 
     int index;
     int temp_label_is_external;
@@ -206,13 +136,13 @@ int found_similar_label(DynamicArray *symbols_table, Label *label, int row_index
     int have_similar_name;
 
     for (index = 0; index < (symbols_table->length); index++) {
-        temp_label = GET_ELEMENT(symbols_table, Label*, index);
-        temp_label_is_external = (temp_label.type == EXTERN_DEFINITION_CODE);
-        have_similar_name = !strcmp(temp_label.name, (label->name));
+        temp_label = GET_POINTER(symbols_table, Label*, index);
+        temp_label_is_external = ((temp_label->type) == EXTERN_DEFINITION_CODE);
+        have_similar_name = ((temp_label->id) == (label->id));
 
         if (have_similar_name) {
             if (given_label_is_external && !temp_label_is_external) {
-                print_error(INVALID_EXTERN_LABEL_DEFINITION, temp_label.index + 1);
+                print_error(INVALID_EXTERN_LABEL_DEFINITION, (temp_label->index) + 1);
                 return 1;
             } else if (!given_label_is_external && temp_label_is_external) {
                 print_error(INVALID_EXTERN_LABEL_DEFINITION, row_index + 1);
@@ -227,24 +157,21 @@ int found_similar_label(DynamicArray *symbols_table, Label *label, int row_index
 }
 
 /*
- * Checks if a label with the given name, exists in the given symbols table.
+ * Checks if a label with the given name id, exists in the given symbols table.
  * If a label with that name exists in the table, the function returns its
  * index in the symbols table. Otherwise, returns -1.
  *
  * Parameters:
  * -----------
- * char *label_name             a string that contains the label name.
+ * int label_id                 the id of the label name in the string pool.
  * DynamicArray *symbols_table  a pointer to a dynamic symbols_table.
  */
-int get_label_index(char *label_name, DynamicArray *symbols_table) {
-    Label temp_label;
-
+int get_label_index(int label_id, DynamicArray *symbols_table) {
     int index;
     int have_similar_name;
 
     for (index = 0; index < (symbols_table->length); index++) {
-        temp_label = GET_ELEMENT(symbols_table, Label*, index);
-        have_similar_name = !strcmp(temp_label.name, label_name);
+        have_similar_name = (GET_POINTER(symbols_table, Label*, index)->id == label_id);
 
         if (have_similar_name) {
             return index;
@@ -275,74 +202,69 @@ int is_data_declaration_field(char *field_content) {
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
+ */
+void encode_data(ProgramLine *line) {
+    DC += encode_data_words(line, &data_segment, DC);
+}
+
+/*
+ * Encodes the data of the given .data/.string declaration to the given segment,
+ * starting from the given index, and returns the number of memory words that the
+ * data was encoded to.
+ *
+ * Parameters:
+ * -----------
+ * ProgramLine *line        the line of the command.
+ * Segment *segment         a pointer to the segment to encode the data to.
+ * int word_index           the index of the first word of the data in the segment.
  */
-void encode_data(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
+int encode_data_words(ProgramLine *line, Segment *segment, int word_index) {
+    DynamicArray *positions_array = line->positions_array;
     Field temp_field;
 
+    int definition_type = get_definition_type(line);
     int length = (positions_array->length); /* the number of fields in the command */
     int field_index; /* the index of the field in the positions array */
-    int num; /* variable to store the data that will be added to the data segment */
+    int first_word_index = word_index;
     int index;
 
-    field_index = get_declaration_index(command_content);
+    field_index = get_declaration_index(line);
 
     /* there is no data declaration in the command */
     if (field_index == length) {
-        free_dynamic_array(positions_array);
-        return;
+        return 0;
     }
     /* check if there is another field after the data declaration */
-    if (field_index + 1 <= length) {
+    if (field_index + 1 < length) {
         ++field_index;
         temp_field = GET_ELEMENT(positions_array, Field*,
                                  field_index); /* move the field_index to the index of the data definition */
 
         /* check if the type of the data is an array of integers */
-        if (get_definition_type(command_content) == DATA_DEFINITION_CODE) {
+        if (definition_type == DATA_DEFINITION_CODE) {
             while (field_index < length) {
                 temp_field = GET_ELEMENT(positions_array, Field*, field_index);
-                sscanf(temp_field.content, "%d", &num);
-                data_segment[DC][0] = num;
+                write_word(segment, word_index, temp_field.value);
                 ++field_index; /* increment the index to scan the next integer */
-                ++DC; /* increment the DC to store the next integer */
+                ++word_index; /* increment the word index to store the next integer */
             }
         }
             /* check if the type of the data is a string */
-        else if (get_definition_type(command_content) == STRING_DEFINITION_CODE) {
-            int start = temp_field.start;
-            int end = find_last_quotations_index(command_content);
-            /* add all the characters of the string to the data segment */
-            for (index = start + 1; index < end; index++) {
-                data_segment[DC][0] = (int) command_content[index];
-                ++DC;
+        else if (definition_type == STRING_DEFINITION_CODE) {
+            /* add all the characters between the boundaries of the string to the segment */
+            if (temp_field.type == STRING_TOKEN_CODE) {
+                for (index = temp_field.start + 1; index < temp_field.end; index++) {
+                    write_word(segment, word_index, (line->content)[index]);
+                    ++word_index;
+                }
             }
             /* add a null terminator */
-            data_segment[DC][field_index] = 0;
-            ++DC;
-        }
-    }
-    free_dynamic_array(positions_array);
-}
-
-/*
- * Returns the index of the last occurrence of a double quotation mark
- * in the given command. If there is no occurrence of the double quotation
- * mark, then the function returns -1.
- *
- * Parameters:
- * -----------
- * char *command_content    the string of the command.
- */
-int find_last_quotations_index(char *command_content) {
-    int index;
-    for (index = (signed int)strlen(command_content) - 1; index >= 0; index--) {
-        if (command_content[index] == '"') {
-            return index;
+            write_word(segment, word_index, 0);
+            ++word_index;
         }
     }
-    return -1;
+    return word_index - first_word_index;
 }
 
 /*
@@ -354,24 +276,19 @@ int find_last_quotations_index(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int get_declaration_index(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    char *temp_field_content;
+int get_declaration_index(ProgramLine *line) {
+    DynamicArray *positions_array = line->positions_array;
+    Field *temp_field;
     int index;
     /* get the field_index where the declaration starts */
     for (index = 0; index < (positions_array->length); index++) {
-        temp_field_content = GET_ELEMENT(positions_array, Field*, index).content;
-        if (!strcmp(temp_field_content, DATA_DEFINITION_NAME)
-            || !strcmp(temp_field_content, STRING_DEFINITION_NAME)
-            || !strcmp(temp_field_content, EXTERN_DEFINITION_NAME)
-            || !strcmp(temp_field_content, ENTRY_DEFINITION_NAME)) {
-            free_dynamic_array(positions_array);
+        temp_field = GET_POINTER(positions_array, Field*, index);
+        if (temp_field->type == DIRECTIVE_TOKEN_CODE && temp_field->value) {
             return index;
         }
     }
-    free_dynamic_array(positions_array);
     return -1;
 }
 
@@ -385,11 +302,11 @@ int get_declaration_index(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int get_no_of_memory_words(char *command_content) {
-    DynamicArray *operands_array = get_operands_array(command_content, NULL);
-    int no_of_parameters = get_no_of_parameters(command_content);
+int get_no_of_memory_words(ProgramLine *line) {
+    DynamicArray *operands_array = get_operands_array(line, NULL);
+    int no_of_parameters = get_no_of_parameters(line);
     int exists_not_register_operand_flag = 0; /* a flag that indicates if there exists an operand in the command which isn't a register */
     int added_words = 0;
     int index;
@@ -401,7 +318,7 @@ int get_no_of_memory_words(char *command_content) {
     } else {
         /* check if the two arguments are registers */
         for (index = 0; index < (operands_array->length); index++) {
-            if (GET_ELEMENT(operands_array, Operand*, index).addressing != REGISTER_ADDRESSING_CODE) {
+            if (GET_POINTER(operands_array, Operand*, index)->addressing != REGISTER_ADDRESSING_CODE) {
                 exists_not_register_operand_flag = 1;
                 break;
             }
@@ -417,40 +334,29 @@ int get_no_of_memory_words(char *command_content) {
 }
 
 /*
- * Returns the addressing code of the given operand.
+ * Returns the addressing code of the operand in the given field, based on the
+ * type of its token. Registers that don't exist, and tokens that can't be
+ * operands, have an unknown addressing code.
  *
  * Parameters:
  * -----------
- * char *operand_content    the string of the operand.
+ * Field *field     a pointer to the field of the operand.
  */
-int get_operand_addressing_code(char *operand_content) {
-    int index;
-    int not_a_label_flag = 0;
-    int num = 0;
-    /* check if the operand is a register */
-    for (index = 0; index < (signed int)(sizeof(registers_names) / sizeof(registers_names[0])); index++) {
-        if (!strcmp(operand_content, registers_names[index])) {
-            return REGISTER_ADDRESSING_CODE;
-        }
-    }
-    /* check if the operand is an integer */
-    if (sscanf(operand_content, "%d", &num) > 0) {
-        return IMMEDIATE_ADDRESSING_CODE;
-    }
-    /* check if the operand is a label */
-    if (isalpha(operand_content[0])) {
-        /* check if there's a character which is not a letter or a digit after the first one */
-        for (index = 0; index < (signed int)strlen(operand_content); index++) {
-            if (!isalpha(operand_content[index]) && !isdigit(operand_content[index])) {
-                not_a_label_flag = 1;
-                break;
+int get_field_addressing_code(Field *field) {
+    switch (field->type) {
+        case REGISTER_TOKEN_CODE:
+            if (MIN_REGISTER_NUMBER <= (field->value) && (field->value) <= MAX_REGISTER_NUMBER) {
+                return REGISTER_ADDRESSING_CODE;
             }
-        }
-        if (!not_a_label_flag) {
+            return UNKNOWN_ADDRESSING_CODE;
+        case IMMEDIATE_TOKEN_CODE:
+            return IMMEDIATE_ADDRESSING_CODE;
+        case IDENTIFIER_TOKEN_CODE:
+        case MNEMONIC_TOKEN_CODE:
             return LABEL_ADDRESSING_CODE;
-        }
+        default:
+            return UNKNOWN_ADDRESSING_CODE;
     }
-    return UNKNOWN_ADDRESSING_CODE;
 }
 
 /*
@@ -480,20 +386,20 @@ void address_transformation(DynamicArray *symbols_table) {
 }
 
 /*
- * Returns the A.R.E code of a label with the given name that was found in the given
- * symbols table. If the label don't exist in the table, the function returns -1.
+ * Returns the A.R.E code of a label with the given name id that was found in the given
+ * symbols table. If the label don't exist in the table, the function returns the
+ * absolute A.R.E code.
  *
  * Parameters:
  * -----------
- * char *label_name                 the name of the label to search in the symbols table.
+ * int label_id                     the id of the label name in the string pool.
  * DynamicArray *symbols_table      a DynamicArray pointer.
  */
-int get_operand_ARE_code(char *label_name, DynamicArray *symbols_table) {
-    int label_index = get_label_index(label_name, symbols_table);
+int get_operand_ARE_code(int label_id, DynamicArray *symbols_table) {
+    int label_index = get_label_index(label_id, symbols_table);
     /* the label has been found in the table */
     if (label_index >= 0) {
-        Label table_label = GET_ELEMENT(symbols_table, Label*, label_index);
-        if (table_label.type == EXTERN_DEFINITION_CODE) {
+        if (GET_POINTER(symbols_table, Label*, label_index)->type == EXTERN_DEFINITION_CODE) {
             return ARE_EXTERNAL_CODE;
         }
         return ARE_RELOCATABLE_CODE;
@@ -501,144 +407,167 @@ int get_operand_ARE_code(char *label_name, DynamicArray *symbols_table) {
     return ARE_ABSOLUTE_CODE;
 }
 
+/*
+ * Returns the value of the given operand: the number of an immediate, the number
+ * of a register, or the id of a label in the string pool. An operand with an
+ * unknown addressing code has a value of 0.
+ *
+ * Parameters:
+ * -----------
+ * Operand *operand     a pointer to the operand.
+ */
+int get_operand_value(Operand *operand) {
+    if (operand->addressing == IMMEDIATE_ADDRESSING_CODE || operand->addressing == REGISTER_ADDRESSING_CODE) {
+        return operand->value;
+    } else if (operand->addressing == LABEL_ADDRESSING_CODE) {
+        return operand->id;
+    }
+    return 0;
+}
+
+/*
+ * Stores the addressing code, the A.R.E bits and the value of the given
+ * operand in the given ResolvedOperand structure.
+ *
+ * Parameters:
+ * -----------
+ * Operand *operand                     a pointer to the operand.
+ * ResolvedOperand *resolved_operand    a pointer to the structure to fill.
+ */
+void resolve_operand(Operand *operand, ResolvedOperand *resolved_operand) {
+    resolved_operand->addressing = (unsigned char) (operand->addressing);
+    resolved_operand->ARE = (unsigned char) (operand->ARE);
+    resolved_operand->value = get_operand_value(operand);
+}
+
 /*
  * Given a command from the program, and a symbols table of the program, the function
- * returns a Command structure that contains information about the command.
+ * fills the given Command structure with information about the command. The operands
+ * of the command are resolved to their values, and a command with a single operand
+ * stores it as its destination operand.
  *
  * Parameters:
  * -----------
- * char *command_content            the string of the command.
+ * ProgramLine *line                the line of the command.
  * int row_index                    the index of the row of the command.
  * DynamicArray *symbols_table      a DynamicArray pointer.
+ * Command *command                 a pointer to the structure to fill.
  */
-Command get_command_object(char *command_content, int row_index, DynamicArray *symbols_table) {
-    Command command;
-    DynamicArray *operands_array = get_operands_array(command_content, symbols_table);
-    Operation operation = get_operation(command_content);
+void get_command_object(ProgramLine *line, int row_index, DynamicArray *symbols_table, Command *command) {
+    DynamicArray *operands_array = get_operands_array(line, symbols_table);
+    Operation operation = get_operation(line);
 
-    command.opcode = operation.opcode;
-    command.type = operation.type;
-    command.index = row_index;
-    command.ARE = ARE_ABSOLUTE_CODE;
-    strcpy(command.data, command_content);
+    /* operands that the command doesn't take are marked as missing */
+    memset(command, 0, sizeof(Command));
+    command->opcode = (unsigned char) operation.opcode;
+    command->type = (unsigned char) operation.type;
+    command->index = row_index;
+    command->ARE = ARE_ABSOLUTE_CODE;
 
     if (operation.type == COMMAND_WITH_1_PARAMETERS_CODE) {
-        command.first_operand = GET_ELEMENT(operands_array, Operand*, 0);
+        resolve_operand(GET_POINTER(operands_array, Operand*, 0), &(command->destination_operand));
     } else if (operation.type == COMMAND_WITH_2_PARAMETERS_CODE) {
-        command.first_operand = GET_ELEMENT(operands_array, Operand*, 0);
-        command.second_operand = GET_ELEMENT(operands_array, Operand*, 1);
+        resolve_operand(GET_POINTER(operands_array, Operand*, 0), &(command->source_operand));
+        resolve_operand(GET_POINTER(operands_array, Operand*, 1), &(command->destination_operand));
     }
-    return command;
+    free_dynamic_array(operands_array);
 }
 
 /*
- * Returns an Encode structure that represent the encodings of the given
- * command to memory words.
+ * Returns the number of memory words that the given command is encoded to.
  *
  * Parameters:
  * -----------
- * char *command_content            the string of the command.
- * int row_index                    the index of the row of the command.
+ * Command *command     a pointer to the command.
+ */
+int get_command_memory_words(Command *command) {
+    return get_encoding_template(command->opcode, command->source_operand.addressing,
+                                 command->destination_operand.addressing)->memory_words;
+}
+
+/*
+ * Returns the encoding of the memory word of the given operand. Immediates and
+ * labels are stored in the operand bits of the word, and registers are stored
+ * in the given register shift, since a source register and a destination register
+ * are stored in different bits of the memory word.
+ *
+ * Parameters:
+ * -----------
+ * ResolvedOperand *operand         a pointer to the operand to encode.
+ * int register_shift               the index of the first bit of a register number in the word.
  * DynamicArray *symbols_table      a DynamicArray pointer.
  */
-Encode encode_command(char *command_content, int row_index, DynamicArray *symbols_table) {
-    Command command = get_command_object(command_content, row_index, symbols_table);
-    Encode encode = {0};
-
-    FirstMemoryWord first_mem_word;
-    NextMemoryWord second_mem_word;
-    NextMemoryWord third_mem_word;
-
-    int word_index = 0;
-    int first_operand_data = 0;
-    int second_operand_data = 0;
-
-    encode.memory_words = command.type + 1;
-
-    first_mem_word.ARE = command.ARE;
-    first_mem_word.dest_operand_addressing = 0;
-    first_mem_word.opcode = command.opcode;
-    first_mem_word.src_operand_addressing = 0;
-
-    if (command.type == COMMAND_WITH_0_PARAMETERS_CODE) {
-        encode.encodings_array[word_index] = (*(unsigned int *) (&first_mem_word)) & ENCODING_FIRST_12_BIT_MASK;
-        return encode;
-    } else if (command.type == COMMAND_WITH_1_PARAMETERS_CODE) {
-        /* encode the first word */
-        first_mem_word.dest_operand_addressing = command.first_operand.addressing;
-        first_mem_word.opcode = command.opcode;
-        first_mem_word.src_operand_addressing = 0;
-
-        encode.encodings_array[word_index] = (*(unsigned int *) (&first_mem_word)) & ENCODING_FIRST_12_BIT_MASK;
-        ++word_index;
+unsigned int encode_operand_word(ResolvedOperand *operand, int register_shift, DynamicArray *symbols_table) {
+    unsigned int encoding = encode_bit_field(operand->ARE, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT);
+
+    if (operand->addressing == IMMEDIATE_ADDRESSING_CODE) {
+        encoding |= encode_bit_field(operand->value, ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT);
+    } else if (operand->addressing == LABEL_ADDRESSING_CODE) {
+        encoding |= encode_bit_field(get_label_address(operand->value, symbols_table), ENCODING_OPERAND_LENGTH,
+                                     ENCODING_OPERAND_SHIFT);
+    } else if (operand->addressing == REGISTER_ADDRESSING_CODE) {
+        encoding |= encode_bit_field(operand->value, ENCODING_REGISTER_LENGTH, register_shift);
+    }
+    return encoding;
+}
 
-        second_mem_word.ARE = command.first_operand.ARE;
+/*
+ * Encodes the given command to the code segment, starting from the current IC,
+ * and returns the number of memory words that the command was encoded to. The
+ * first memory word is taken from the encoding table, and the following memory
+ * words store the operands of the command. The function doesn't change the IC.
+ *
+ * Parameters:
+ * -----------
+ * Command *command                 a pointer to the command to encode.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ */
+int encode_command(Command *command, DynamicArray *symbols_table) {
+    return encode_command_words(command, symbols_table, &code_segment, IC);
+}
 
-        if (command.first_operand.addressing == IMMEDIATE_ADDRESSING_CODE) {
-            first_operand_data = atoi(command.first_operand.data);
-        } else if (command.first_operand.addressing == LABEL_ADDRESSING_CODE) {
-            first_operand_data = get_label_address(command.first_operand.data, symbols_table);
-        } else if (command.first_operand.addressing == REGISTER_ADDRESSING_CODE) {
-            first_operand_data = get_register_number(command.first_operand.data);
-        }
-        second_mem_word.other = first_operand_data;
-        encode.encodings_array[word_index] = (*(unsigned int *) (&second_mem_word)) & ENCODING_FIRST_12_BIT_MASK;
-    } else if (command.type == COMMAND_WITH_2_PARAMETERS_CODE) {
-        /* encode the first word */
-        first_mem_word.ARE = command.ARE;
-        first_mem_word.dest_operand_addressing = command.second_operand.addressing;
-        first_mem_word.opcode = command.opcode;
-        first_mem_word.src_operand_addressing = command.first_operand.addressing;
-
-        encode.encodings_array[word_index] = (*(unsigned int *) (&first_mem_word)) & ENCODING_FIRST_12_BIT_MASK;
+/*
+ * Encodes the given command to the given segment, starting from the given index,
+ * and returns the number of memory words that the command was encoded to.
+ *
+ * Parameters:
+ * -----------
+ * Command *command                 a pointer to the command to encode.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ * Segment *segment                 a pointer to the segment to encode the command to.
+ * int word_index                   the index of the first word of the command in the segment.
+ */
+int encode_command_words(Command *command, DynamicArray *symbols_table, Segment *segment, int word_index) {
+    ResolvedOperand *source_operand = &(command->source_operand);
+    ResolvedOperand *destination_operand = &(command->destination_operand);
+    const EncodingTemplate *template = get_encoding_template(command->opcode, source_operand->addressing,
+                                                            destination_operand->addressing);
+
+    /* encode the first word */
+    write_word(segment, word_index,
+               template->first_word | encode_bit_field(command->ARE, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT));
+    ++word_index;
+
+    /* if the two operands are registers, encode their number in the same memory word */
+    if (source_operand->addressing == REGISTER_ADDRESSING_CODE &&
+        destination_operand->addressing == REGISTER_ADDRESSING_CODE) {
+        write_word(segment, word_index,
+                   encode_bit_field(ARE_ABSOLUTE_CODE, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT) |
+                   encode_bit_field(destination_operand->value, ENCODING_REGISTER_LENGTH,
+                                    ENCODING_DEST_REGISTER_SHIFT) |
+                   encode_bit_field(source_operand->value, ENCODING_REGISTER_LENGTH, ENCODING_SRC_REGISTER_SHIFT));
+        return template->memory_words;
+    }
+    if (source_operand->addressing) {
+        write_word(segment, word_index,
+                   encode_operand_word(source_operand, ENCODING_SRC_REGISTER_SHIFT, symbols_table));
         ++word_index;
-
-        /* if the two operands are registers, encode their number in the same memory word */
-        if (command.first_operand.addressing == REGISTER_ADDRESSING_CODE &&
-            command.second_operand.addressing == REGISTER_ADDRESSING_CODE) {
-            DoubleRegisterMemoryWord second_mem_word;
-
-            /* only if the two operands are registers, they are stored in the same memory word and the command
-             * takes one less memory words */
-            encode.memory_words = command.type;
-
-            second_mem_word.ARE = ARE_ABSOLUTE_CODE;
-            second_mem_word.dest_register_number = get_register_number(command.second_operand.data);
-            second_mem_word.src_register_number = get_register_number(command.first_operand.data);
-
-            encode.encodings_array[word_index] = (*(unsigned int *) (&second_mem_word)) & ENCODING_FIRST_12_BIT_MASK;
-        } else {
-            /* encode the second memory word */
-            second_mem_word.ARE = command.first_operand.ARE;
-
-            if (command.first_operand.addressing == IMMEDIATE_ADDRESSING_CODE) {
-                first_operand_data = atoi(command.first_operand.data);
-            } else if (command.first_operand.addressing == LABEL_ADDRESSING_CODE) {
-                first_operand_data = get_label_address(command.first_operand.data, symbols_table);
-            } else if (command.first_operand.addressing == REGISTER_ADDRESSING_CODE) {
-                first_operand_data =
-                        get_register_number(command.first_operand.data) << ENCODING_SOURCE_REGISTER_SHIFT_MASK;
-            }
-            second_mem_word.other = first_operand_data;
-            encode.encodings_array[word_index] = (*(unsigned int *) (&second_mem_word)) & ENCODING_FIRST_12_BIT_MASK;
-
-            /* encode the third memory word */
-            ++word_index;
-
-            third_mem_word.ARE = command.second_operand.ARE;
-
-            if (command.second_operand.addressing == IMMEDIATE_ADDRESSING_CODE) {
-                second_operand_data = atoi(command.second_operand.data);
-            } else if (command.second_operand.addressing == LABEL_ADDRESSING_CODE) {
-                second_operand_data = get_label_address(command.second_operand.data, symbols_table);
-            } else if (command.second_operand.addressing == REGISTER_ADDRESSING_CODE) {
-                second_operand_data = get_register_number(command.second_operand.data);
-            }
-            third_mem_word.other = second_operand_data;
-            encode.encodings_array[word_index] = (*(unsigned int *) (&third_mem_word)) & ENCODING_FIRST_12_BIT_MASK;
-        }
     }
-    return encode;
+    if (destination_operand->addressing) {
+        write_word(segment, word_index,
+                   encode_operand_word(destination_operand, ENCODING_DEST_REGISTER_SHIFT, symbols_table));
+    }
+    return template->memory_words;
 }
 
 /*
@@ -661,54 +590,36 @@ unsigned int encode_bit_field(int num, int length, int shift) {
 }
 
 /*
- * Checks if a label with the given name, exists in the given symbols table.
- * If a label with that name exists in the table, the function returns its
- * address in the symbols table. Otherwise, returns -1.
+ * Returns the 'length' bits of the given word that start from the bit in the
+ * index 'shift', as the first bits of the returned integer. This is the reverse
+ * of 'encode_bit_field': "decode_bit_field(16, 2, 3)" returns 2.
  *
  * Parameters:
  * -----------
- * char *label_name             a string that contains the label name.
- * DynamicArray *symbols_table  a pointer to a dynamic symbols_table.
+ * unsigned int word    the word to take the bits from.
+ * int length           the number of bits to take.
+ * int shift            the index of the first bit to take.
  */
-int get_label_address(char *label_name, DynamicArray *symbols_table) {
-    int index = get_label_index(label_name, symbols_table);
-    if (index >= 0) {
-        Label label = GET_ELEMENT(symbols_table, Label*, index);
-        return label.address;
-    }
-    return -1;
+int decode_bit_field(unsigned int word, int length, int shift) {
+    return (int) ((word >> shift) & ((1u << length) - 1));
 }
 
 /*
- * Given a name of a register, such as "@r2", the function returns
- * an integer which represent the number of the register. For example,
- * the function call: "get_register_number("@r5")", returns the number 5.
- * Returns -1 if the given name is not a register name.
+ * Checks if a label with the given name id, exists in the given symbols table.
+ * If a label with that name exists in the table, the function returns its
+ * address in the symbols table. Otherwise, returns -1.
  *
  * Parameters:
  * -----------
- * char *register_name  a name of a register
+ * int label_id                 the id of the label name in the string pool.
+ * DynamicArray *symbols_table  a pointer to a dynamic symbols_table.
  */
-int get_register_number(char *register_name) {
-    char delimiters[] = "@r"; /* separating characters */
-    char *start; /* a pointer to the beginning of the current token */
-    int digit;
-    int values;
-    int index;
-
-    start = register_name + strspn(register_name, delimiters);
-    values = sscanf(start, "%d", &digit);
-
-    for (index = 0; index < (signed int)strlen(start); index++) {
-        if (!isdigit(start[index])) {
-            return -1;
-        }
-    }
-    /* the given name is not a register name */
-    if (register_name[0] != '@' || values <= 0) {
-        return -1;
+int get_label_address(int label_id, DynamicArray *symbols_table) {
+    int index = get_label_index(label_id, symbols_table);
+    if (index >= 0) {
+        return GET_POINTER(symbols_table, Label*, index)->address;
     }
-    return digit;
+    return -1;
 }
 
 /*
@@ -745,38 +656,26 @@ char *convert_to_base_64(unsigned int num) {
  * Parameters:
  * -----------
  * int row_index                    the index of the row of the command.
- * DynamicArray *program_lines      a DynamicArray that stores the lines of the program.
+ * DynamicArray *program_lines      a DynamicArray that stores the ProgramLine of each line of the program.
  */
 int get_command_address(int row_index, DynamicArray *program_lines) {
-    char *temp_command_content;
+    ProgramLine *temp_line;
     int index;
     int temp_IC = 0;
 
     for (index = 0; index < (program_lines->length); index++) {
-        temp_command_content = GET_STRING(program_lines, index);
-        if (is_empty_command(temp_command_content) ||
-            get_definition_type(temp_command_content) != COMMAND_DEFINITION_CODE) {
+        temp_line = GET_POINTER(program_lines, ProgramLine*, index);
+        if (is_empty_command(temp_line->content) || get_definition_type(temp_line) != COMMAND_DEFINITION_CODE) {
             continue;
         }
         if (index == row_index) {
             break;
         }
-        temp_IC += get_no_of_memory_words(temp_command_content);
+        temp_IC += get_no_of_memory_words(temp_line);
     }
     return temp_IC + LOAD_ADDRESS;
 }
 
-/*
- * Returns 1 if the given string is an existing register, and 0 otherwise.
- *
- * Parameters:
- * -----------
- * char *register_name  the name of the register.
- */
-int is_existing_register(char *register_name) {
-    return (MIN_REGISTER_NUMBER <= get_register_number(register_name) && get_register_number(register_name) <= MAX_REGISTER_NUMBER);
-}
-
 /*
  * Returns 1 if the given addressing method is in the array of addressing methods
  * that was given. Otherwise, returns 0.
@@ -18,7 +18,7 @@ int is_empty_field(char *field_content);
 
 /*
  * Returns 1 if all the characters of the given command content are tabs,
- * spaces and semicolons, and otherwise returns 0.
+ * spaces and semicolons, or if the command is a comment, and otherwise returns 0.
  *
  * Parameters:
  * -----------
@@ -36,9 +36,9 @@ int is_empty_command(char *command_content);
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-char *get_label_name(char *command_content);
+char *get_label_name(ProgramLine *line);
 
 /*
  * Returns 1 if the given command has a label definition, and 0 if
@@ -47,9 +47,9 @@ char *get_label_name(char *command_content);
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int has_valid_label(char *command_content);
+int has_valid_label(ProgramLine *line);
 
 /*
  * Returns an integer that represent the type of the
@@ -61,9 +61,9 @@ int has_valid_label(char *command_content);
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int get_definition_type(char *command_content);
+int get_definition_type(ProgramLine *line);
 
 /*
  * Returns 1 if the given label was found in the given DynamicArray
@@ -80,16 +80,16 @@ int get_definition_type(char *command_content);
 int found_similar_label(DynamicArray *symbols_table, Label *label, int row_index);
 
 /*
- * Checks if a label with the given name, exists in the given symbols table.
+ * Checks if a label with the given name id, exists in the given symbols table.
  * If a label with that name exists in the table, the function returns its
  * index in the symbols table. Otherwise, returns -1.
  *
  * Parameters:
  * -----------
- * char *label_name             a string that contains the label name.
+ * int label_id                 the id of the label name in the string pool.
  * DynamicArray *symbols_table  a pointer to a dynamic symbols_table.
  */
-int get_label_index(char *label_name, DynamicArray *symbols_table);
+int get_label_index(int label_id, DynamicArray *symbols_table);
 
 /*
  * Returns 1 if the given string represent a data declaration.
@@ -111,20 +111,22 @@ int is_data_declaration_field(char *field_content);
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-void encode_data(char *command_content);
+void encode_data(ProgramLine *line);
 
 /*
- * Returns the index of the last occurrence of a double quotation mark
- * in the given command. If there is no occurrence of the double quotation
- * mark, then the function returns -1.
+ * Encodes the data of the given .data/.string declaration to the given segment,
+ * starting from the given index, and returns the number of memory words that the
+ * data was encoded to.
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line        the line of the command.
+ * Segment *segment         a pointer to the segment to encode the data to.
+ * int word_index           the index of the first word of the data in the segment.
  */
-int find_last_quotations_index(char *command_content);
+int encode_data_words(ProgramLine *line, Segment *segment, int word_index);
 
 /*
  * Returns the index of the declaration in the given command.
@@ -135,18 +137,20 @@ int find_last_quotations_index(char *command_content);
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int get_declaration_index(char *command_content);
+int get_declaration_index(ProgramLine *line);
 
 /*
- * Returns the addressing code of the given operand.
+ * Returns the addressing code of the operand in the given field, based on the
+ * type of its token. Registers that don't exist, and tokens that can't be
+ * operands, have an unknown addressing code.
  *
  * Parameters:
  * -----------
- * char *operand_content    the string of the operand.
+ * Field *field     a pointer to the field of the operand.
  */
-int get_operand_addressing_code(char *operand_content);
+int get_field_addressing_code(Field *field);
 
 /*
  * Returns the number of memory words that the given command consumes.
@@ -158,9 +162,9 @@ int get_operand_addressing_code(char *operand_content);
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int get_no_of_memory_words(char *command_content);
+int get_no_of_memory_words(ProgramLine *line);
 
 /*
  * Adds the loading address to each symbol address in the symbols table,
@@ -174,27 +178,62 @@ int get_no_of_memory_words(char *command_content);
 void address_transformation(DynamicArray *symbols_table);
 
 /*
- * Returns the A.R.E code of a label with the given name that was found in the given
- * symbols table. If the label don't exist in the table, the function returns -1.
+ * Returns the A.R.E code of a label with the given name id that was found in the given
+ * symbols table. If the label don't exist in the table, the function returns the
+ * absolute A.R.E code.
  *
  * Parameters:
  * -----------
- * char *label_name                 the name of the label to search in the symbols table.
+ * int label_id                     the id of the label name in the string pool.
  * DynamicArray *symbols_table      a DynamicArray pointer.
  */
-int get_operand_ARE_code(char *label_name, DynamicArray *symbols_table);
+int get_operand_ARE_code(int label_id, DynamicArray *symbols_table);
+
+/*
+ * Returns the value of the given operand: the number of an immediate, the number
+ * of a register, or the id of a label in the string pool. An operand with an
+ * unknown addressing code has a value of 0.
+ *
+ * Parameters:
+ * -----------
+ * Operand *operand     a pointer to the operand.
+ */
+int get_operand_value(Operand *operand);
+
+/*
+ * Stores the addressing code, the A.R.E bits and the value of the given
+ * operand in the given ResolvedOperand structure.
+ *
+ * Parameters:
+ * -----------
+ * Operand *operand                     a pointer to the operand.
+ * ResolvedOperand *resolved_operand    a pointer to the structure to fill.
+ */
+void resolve_operand(Operand *operand, ResolvedOperand *resolved_operand);
 
 /*
  * Given a command from the program, and a symbols table of the program, the function
- * returns a Command structure that contains information about the command.
+ * fills the given Command structure with information about the command. The operands
+ * of the command are resolved to their values, and a command with a single operand
+ * stores it as its destination operand.
  *
  * Parameters:
  * -----------
- * char *command_content            the string of the command.
+ * ProgramLine *line                the line of the command.
  * int row_index                    the index of the row of the command.
  * DynamicArray *symbols_table      a DynamicArray pointer.
+ * Command *command                 a pointer to the structure to fill.
  */
-Command get_command_object(char *command_content, int row_index, DynamicArray *symbols_table);
+void get_command_object(ProgramLine *line, int row_index, DynamicArray *symbols_table, Command *command);
+
+/*
+ * Returns the number of memory words that the given command is encoded to.
+ *
+ * Parameters:
+ * -----------
+ * Command *command     a pointer to the command.
+ */
+int get_command_memory_words(Command *command);
 
 /*
  * Creates a bit mask in a way that the 'length' first bits of the number
@@ -213,40 +252,103 @@ Command get_command_object(char *command_content, int row_index, DynamicArray *s
 unsigned int encode_bit_field(int num, int length, int shift);
 
 /*
- * Returns an Encode structure that represent the encodings of the given
- * command to memory words.
+ * Returns the 'length' bits of the given word that start from the bit in the
+ * index 'shift', as the first bits of the returned integer. This is the reverse
+ * of 'encode_bit_field': "decode_bit_field(16, 2, 3)" returns 2.
  *
  * Parameters:
  * -----------
- * char *command_content            the string of the command.
- * int row_index                    the index of the row of the command.
+ * unsigned int word    the word to take the bits from.
+ * int length           the number of bits to take.
+ * int shift            the index of the first bit to take.
+ */
+int decode_bit_field(unsigned int word, int length, int shift);
+
+/*
+ * Returns the index of the given addressing code in the encoding table.
+ * A missing operand and an unknown addressing code both have the index
+ * of a missing operand.
+ *
+ * Parameters:
+ * -----------
+ * int addressing_code  the addressing code of an operand.
+ */
+int get_addressing_index(int addressing_code);
+
+/*
+ * Fills the encoding table with the encoding template of every operation
+ * and every pair of addressing methods. The first memory word of each template
+ * stores the opcode and the addressing codes of the operands, and the number of
+ * memory words is 1 word for the command, and 1 word for each operand, except of
+ * two register operands that share the same memory word.
+ */
+void build_encoding_table();
+
+/*
+ * Returns a pointer to the encoding template of a command with the given
+ * opcode and the given addressing codes of its source and destination
+ * operands. A command that doesn't have a source/destination operand
+ * should pass 0 as the addressing code of the missing operand.
+ *
+ * Parameters:
+ * -----------
+ * int opcode               the opcode of the command.
+ * int src_addressing       the addressing code of the source operand.
+ * int dest_addressing      the addressing code of the destination operand.
+ */
+const EncodingTemplate *get_encoding_template(int opcode, int src_addressing, int dest_addressing);
+
+/*
+ * Returns the encoding of the memory word of the given operand. Immediates and
+ * labels are stored in the operand bits of the word, and registers are stored
+ * in the given register shift, since a source register and a destination register
+ * are stored in different bits of the memory word.
+ *
+ * Parameters:
+ * -----------
+ * ResolvedOperand *operand         a pointer to the operand to encode.
+ * int register_shift               the index of the first bit of a register number in the word.
  * DynamicArray *symbols_table      a DynamicArray pointer.
  */
-Encode encode_command(char *command_content, int row_index, DynamicArray *symbols_table);
+unsigned int encode_operand_word(ResolvedOperand *operand, int register_shift, DynamicArray *symbols_table);
 
 /*
- * Checks if a label with the given name, exists in the given symbols table.
- * If a label with that name exists in the table, the function returns its
- * address in the symbols table. Otherwise, returns -1.
+ * Encodes the given command to the code segment, starting from the current IC,
+ * and returns the number of memory words that the command was encoded to. The
+ * first memory word is taken from the encoding table, and the following memory
+ * words store the operands of the command. The function doesn't change the IC.
  *
  * Parameters:
  * -----------
- * char *label_name             a string that contains the label name.
- * DynamicArray *symbols_table  a pointer to a dynamic symbols_table.
+ * Command *command                 a pointer to the command to encode.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ */
+int encode_command(Command *command, DynamicArray *symbols_table);
+
+/*
+ * Encodes the given command to the given segment, starting from the given index,
+ * and returns the number of memory words that the command was encoded to.
+ *
+ * Parameters:
+ * -----------
+ * Command *command                 a pointer to the command to encode.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ * Segment *segment                 a pointer to the segment to encode the command to.
+ * int word_index                   the index of the first word of the command in the segment.
  */
-int get_label_address(char *label_name, DynamicArray *symbols_table);
+int encode_command_words(Command *command, DynamicArray *symbols_table, Segment *segment, int word_index);
 
 /*
- * Given a name of a register, such as "@r2", the function returns
- * an integer which represent the number of the register. For example,
- * the function call: "get_register_number("@r5")", returns the number 5.
- * Returns -1 if the given name is not a register name.
+ * Checks if a label with the given name id, exists in the given symbols table.
+ * If a label with that name exists in the table, the function returns its
+ * address in the symbols table. Otherwise, returns -1.
  *
  * Parameters:
  * -----------
- * char *register_name  a name of a register
+ * int label_id                 the id of the label name in the string pool.
+ * DynamicArray *symbols_table  a pointer to a dynamic symbols_table.
  */
-int get_register_number(char *register_name);
+int get_label_address(int label_id, DynamicArray *symbols_table);
 
 /*
  * Returns a pointer to a string, that contains the converted version
@@ -267,19 +369,10 @@ char *convert_to_base_64(unsigned int num);
  * Parameters:
  * -----------
  * int row_index                    the index of the row of the command.
- * DynamicArray *program_lines      a DynamicArray that stores the lines of the program.
+ * DynamicArray *program_lines      a DynamicArray that stores the ProgramLine of each line of the program.
  */
 int get_command_address(int row_index, DynamicArray *program_lines);
 
-/*
- * Returns 1 if the given string is an existing register, and 0 otherwise.
- *
- * Parameters:
- * -----------
- * char *register_name  the name of the register.
- */
-int is_existing_register(char *register_name);
-
 /*
  * Returns 1 if the given addressing method is in the array of addressing methods
  * that was given. Otherwise, returns 0.
@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include <string.h>
 #include "helpers.h"
 #include "command_analysis.h"
@@ -13,79 +14,85 @@
  * the program, after it had changed the type of each entry definition label.
  *
  * Parameters:
- * char *file_path      the path to the file that stores the program.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
  */
-DynamicArray *second_iteration(char *file_path) {
-    DynamicArray *program_lines = get_program_lines(file_path);
-    DynamicArray *symbols_table = get_symbols_table(file_path);
+DynamicArray *second_iteration(DynamicArray *program_lines) {
+    DynamicArray *symbols_table = get_symbols_table(program_lines);
     DynamicArray *temp_positions_array;
+    CommandsTable *commands_table = calloc(1, sizeof(CommandsTable));
 
     int row_index;
-    char *temp_command_content;
+    ProgramLine *temp_line;
     int temp_command_type;
+    int command_index;
 
     IC = 0;
+    reset_segment(&code_segment);
 
     for (row_index = 0; row_index < (program_lines->length); row_index++) {
-        temp_command_content = GET_STRING(program_lines, row_index);
-        temp_positions_array = get_positions_array(temp_command_content);
+        temp_line = GET_POINTER(program_lines, ProgramLine*, row_index);
+        temp_positions_array = temp_line->positions_array;
 
-        if (is_empty_command(temp_command_content)) {
-            free_dynamic_array(temp_positions_array);
+        if (is_empty_command(temp_line->content)) {
             continue;
         }
-        temp_command_type = get_definition_type(temp_command_content);
+        temp_command_type = get_definition_type(temp_line);
         if (temp_command_type == DATA_DEFINITION_CODE ||
                 temp_command_type == STRING_DEFINITION_CODE ||
                 temp_command_type == EXTERN_DEFINITION_CODE) {
-            free_dynamic_array(temp_positions_array);
             continue;
         } else if (temp_command_type == ENTRY_DEFINITION_CODE) {
-            int label_index = get_declaration_index(temp_command_content) + 1;
+            int label_index = get_declaration_index(temp_line) + 1;
             Field label_field = GET_ELEMENT(temp_positions_array, Field*, label_index);
-            Label *temp_label;
 
-            int found_entry_label_definition_flag = 0;
-            int found_entry_and_extern_definition_flag = 0;
-            int index;
-            /* search the entry label in the symbols table */
-            for (index = 0; index < (symbols_table->length); index++) {
-                temp_label = (symbols_table->array)[index];
-                /* the two labels have the same name, and one is defined as entry and the other is a command label */
-                if (!strcmp(label_field.content, temp_label->name) && (temp_label->type) != EXTERN_DEFINITION_CODE) {
-                    found_entry_label_definition_flag = 1;
-                    /* mark the label in the table that belongs to the .entry definition */
-                    temp_label->type = ENTRY_DEFINITION_CODE;
-                }
-                    /* the two labels have the same name, and one is defined as entry and the other as external */
-                else if (!strcmp(label_field.content, temp_label->name) && (temp_label->type) &&
-                        (temp_label->type) == EXTERN_DEFINITION_CODE) {
-                    ERROR_FLAG = 1;
-                    print_error(EXTERN_AND_ENTRY_LABEL, row_index + 1);
-                    found_entry_and_extern_definition_flag = 1;
-                }
-            }
-            if (found_entry_and_extern_definition_flag) {
-                found_entry_and_extern_definition_flag = 0;
-                free_dynamic_array(temp_positions_array);
-                continue;
-            }
-            if (!found_entry_label_definition_flag) {
-                ERROR_FLAG = 1;
-                print_error(ENTRY_LABEL_WASNT_DEFINED, row_index + 1);
-            }
-            found_entry_label_definition_flag = 0;
-            free_dynamic_array(temp_positions_array);
+            mark_entry_label(symbols_table, label_field.id, row_index);
         } else if (temp_command_type == COMMAND_DEFINITION_CODE) {
-            Encode encoding = encode_command(temp_command_content, row_index, symbols_table);
-            int index;
-
-            for (index = 0; index < encoding.memory_words; index++) {
-                code_segment[IC][0] = encoding.encodings_array[index];
-                IC += 1;
-            }
+            add_command(commands_table, temp_line, row_index, symbols_table);
         }
     }
-    free_dynamic_array(program_lines);
+    /* encode the commands, one after the other */
+    for (command_index = 0; command_index < (commands_table->length); command_index++) {
+        IC += encode_command(&(commands_table->commands)[command_index], symbols_table);
+    }
+    free_commands_table(commands_table);
     return symbols_table;
+}
+
+/*
+ * Changes the type of the label with the given name id in the given symbols table,
+ * to the type of an entry definition. If the label is external, or it wasn't defined
+ * in the program, the function prints the error and sets the error flag.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ * int label_id                     the id of the name of the label in the string pool.
+ * int row_index                    the index of the row of the .entry declaration.
+ */
+void mark_entry_label(DynamicArray *symbols_table, int label_id, int row_index) {
+    Label *temp_label;
+
+    int found_entry_label_definition_flag = 0;
+    int found_entry_and_extern_definition_flag = 0;
+    int index;
+    /* search the entry label in the symbols table */
+    for (index = 0; index < (symbols_table->length); index++) {
+        temp_label = (symbols_table->array)[index];
+        /* the two labels have the same name, and one is defined as entry and the other is a command label */
+        if (label_id == (temp_label->id) && (temp_label->type) != EXTERN_DEFINITION_CODE) {
+            found_entry_label_definition_flag = 1;
+            /* mark the label in the table that belongs to the .entry definition */
+            temp_label->type = ENTRY_DEFINITION_CODE;
+        }
+            /* the two labels have the same name, and one is defined as entry and the other as external */
+        else if (label_id == (temp_label->id) && (temp_label->type) == EXTERN_DEFINITION_CODE) {
+            ERROR_FLAG = 1;
+            print_error(EXTERN_AND_ENTRY_LABEL, row_index + 1);
+            found_entry_and_extern_definition_flag = 1;
+        }
+    }
+    if (!found_entry_label_definition_flag && !found_entry_and_extern_definition_flag) {
+        ERROR_FLAG = 1;
+        print_error(ENTRY_LABEL_WASNT_DEFINED, row_index + 1);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include <string.h>
+#include <stdlib.h>
+#include "lexer.h"
+#include "../segments.h"
+
+#define INITIAL_TOKENS_LIST_CAPACITY 8 /* the number of tokens that a tokens list can store after its first growth */
+#define NO_OF_CHARACTERS 256 /* the number of different values a character can have */
+#define NO_OF_DIRECTIVES 4 /* the number of directives in the assembly language */
+
+/* the class of every character */
+unsigned char character_classes[NO_OF_CHARACTERS];
+/* the next state of the lexer for every state and every character class */
+signed char transitions[NO_OF_LEXER_STATES][NO_OF_CHARACTER_CLASSES];
+/* the code of the token that ends in every state, and 0 if a token can't end in the state */
+unsigned char accepted_tokens[NO_OF_LEXER_STATES];
+/* indicates if the tables of the lexer have already been built */
+int lexer_tables_built = 0;
+
+/*
+ * Sets the next state of the given state to be the given next state, for
+ * every character class between the given classes (including both of them).
+ *
+ * Parameters:
+ * -----------
+ * int state            the current state.
+ * int first_class      the first character class.
+ * int last_class       the last character class.
+ * int next_state       the next state.
+ */
+void set_transitions(int state, int first_class, int last_class, int next_state) {
+    int character_class;
+    for (character_class = first_class; character_class <= last_class; character_class++) {
+        transitions[state][character_class] = (signed char) next_state;
+    }
+}
+
+/*
+ * Fills the character classes table with the class of each of the 256 possible
+ * characters, and fills the transitions table of the lexer with the next state of
+ * each state and each character class, and the token code that each state accepts.
+ */
+void build_lexer_tables() {
+    int character;
+    int state;
+
+    /* classify the characters */
+    for (character = 0; character < NO_OF_CHARACTERS; character++) {
+        if ((character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z')) {
+            character_classes[character] = LETTER_CHARACTER_CLASS;
+        } else if (character >= '0' && character <= '9') {
+            character_classes[character] = DIGIT_CHARACTER_CLASS;
+        } else {
+            character_classes[character] = OTHER_CHARACTER_CLASS;
+        }
+    }
+    character_classes[' '] = SPACE_CHARACTER_CLASS;
+    character_classes['\t'] = SPACE_CHARACTER_CLASS;
+    character_classes['\r'] = SPACE_CHARACTER_CLASS;
+    character_classes['\n'] = SPACE_CHARACTER_CLASS;
+    character_classes[','] = COMMA_CHARACTER_CLASS;
+    character_classes[REGISTER_LETTER_CHARACTER] = REGISTER_LETTER_CHARACTER_CLASS;
+    character_classes['+'] = SIGN_CHARACTER_CLASS;
+    character_classes['-'] = SIGN_CHARACTER_CLASS;
+    character_classes[DIRECTIVE_STARTING_CHARACTER] = DOT_CHARACTER_CLASS;
+    character_classes[REGISTER_PREFIX_CHARACTER] = AT_CHARACTER_CLASS;
+    character_classes[LABEL_ENDING_CHARACTER] = COLON_CHARACTER_CLASS;
+    character_classes[STRING_BOUNDARY_CHARACTER] = QUOTE_CHARACTER_CLASS;
+    character_classes[COMMENT_STARTING_CHARACTER] = SEMICOLON_CHARACTER_CLASS;
+    character_classes[0] = END_CHARACTER_CLASS;
+
+    /* by default, a delimiter ends a token, a label ending character makes it an invalid label,
+     * and any other character makes it an unknown token */
+    for (state = 0; state < NO_OF_LEXER_STATES; state++) {
+        set_transitions(state, 0, NO_OF_CHARACTER_CLASSES - 1, UNKNOWN_STATE);
+        transitions[state][SPACE_CHARACTER_CLASS] = TOKEN_END_STATE;
+        transitions[state][COMMA_CHARACTER_CLASS] = TOKEN_END_STATE;
+        transitions[state][END_CHARACTER_CLASS] = TOKEN_END_STATE;
+        transitions[state][COLON_CHARACTER_CLASS] = INVALID_LABEL_STATE;
+        accepted_tokens[state] = UNKNOWN_TOKEN_CODE;
+    }
+
+    /* the first character of a token */
+    for (state = LINE_START_STATE; state <= TOKEN_START_STATE; state++) {
+        transitions[state][SPACE_CHARACTER_CLASS] = (signed char) state;
+        transitions[state][END_CHARACTER_CLASS] = (signed char) state;
+        transitions[state][COMMA_CHARACTER_CLASS] = COMMA_STATE;
+        transitions[state][LETTER_CHARACTER_CLASS] = IDENTIFIER_STATE;
+        transitions[state][REGISTER_LETTER_CHARACTER_CLASS] = IDENTIFIER_STATE;
+        transitions[state][DIGIT_CHARACTER_CLASS] = NUMBER_STATE;
+        transitions[state][SIGN_CHARACTER_CLASS] = SIGN_STATE;
+        transitions[state][DOT_CHARACTER_CLASS] = DOT_STATE;
+        transitions[state][AT_CHARACTER_CLASS] = AT_STATE;
+        transitions[state][QUOTE_CHARACTER_CLASS] = STRING_STATE;
+        accepted_tokens[state] = 0;
+    }
+    /* a comment can only start in the beginning of a line */
+    transitions[LINE_START_STATE][SEMICOLON_CHARACTER_CLASS] = COMMENT_STATE;
+
+    /* identifiers and label definitions */
+    set_transitions(IDENTIFIER_STATE, LETTER_CHARACTER_CLASS, DIGIT_CHARACTER_CLASS, IDENTIFIER_STATE);
+    transitions[IDENTIFIER_STATE][COLON_CHARACTER_CLASS] = LABEL_STATE;
+    accepted_tokens[IDENTIFIER_STATE] = IDENTIFIER_TOKEN_CODE;
+    set_transitions(LABEL_STATE, OTHER_CHARACTER_CLASS, OTHER_CHARACTER_CLASS, INVALID_LABEL_STATE);
+    set_transitions(LABEL_STATE, LETTER_CHARACTER_CLASS, SEMICOLON_CHARACTER_CLASS, INVALID_LABEL_STATE);
+    accepted_tokens[LABEL_STATE] = LABEL_DEFINITION_TOKEN_CODE;
+    set_transitions(INVALID_LABEL_STATE, OTHER_CHARACTER_CLASS, OTHER_CHARACTER_CLASS, INVALID_LABEL_STATE);
+    set_transitions(INVALID_LABEL_STATE, LETTER_CHARACTER_CLASS, SEMICOLON_CHARACTER_CLASS, INVALID_LABEL_STATE);
+    accepted_tokens[INVALID_LABEL_STATE] = INVALID_LABEL_TOKEN_CODE;
+
+    /* directives */
+    set_transitions(DOT_STATE, LETTER_CHARACTER_CLASS, REGISTER_LETTER_CHARACTER_CLASS, DIRECTIVE_STATE);
+    set_transitions(DIRECTIVE_STATE, LETTER_CHARACTER_CLASS, REGISTER_LETTER_CHARACTER_CLASS, DIRECTIVE_STATE);
+    accepted_tokens[DIRECTIVE_STATE] = DIRECTIVE_TOKEN_CODE;
+
+    /* registers */
+    transitions[AT_STATE][REGISTER_LETTER_CHARACTER_CLASS] = AT_LETTER_STATE;
+    transitions[AT_LETTER_STATE][DIGIT_CHARACTER_CLASS] = REGISTER_STATE;
+    transitions[REGISTER_STATE][DIGIT_CHARACTER_CLASS] = REGISTER_STATE;
+    accepted_tokens[REGISTER_STATE] = REGISTER_TOKEN_CODE;
+
+    /* immediates */
+    transitions[SIGN_STATE][DIGIT_CHARACTER_CLASS] = NUMBER_STATE;
+    transitions[NUMBER_STATE][DIGIT_CHARACTER_CLASS] = NUMBER_STATE;
+    accepted_tokens[NUMBER_STATE] = IMMEDIATE_TOKEN_CODE;
+
+    /* strings may contain delimiters, and end in the last boundary character before a delimiter */
+    set_transitions(STRING_STATE, 0, NO_OF_CHARACTER_CLASSES - 1, STRING_STATE);
+    transitions[STRING_STATE][QUOTE_CHARACTER_CLASS] = STRING_END_STATE;
+    transitions[STRING_STATE][END_CHARACTER_CLASS] = TOKEN_END_STATE;
+    accepted_tokens[STRING_STATE] = 0;
+    set_transitions(STRING_END_STATE, 0, NO_OF_CHARACTER_CLASSES - 1, STRING_STATE);
+    transitions[STRING_END_STATE][QUOTE_CHARACTER_CLASS] = STRING_END_STATE;
+    transitions[STRING_END_STATE][END_CHARACTER_CLASS] = TOKEN_END_STATE;
+    accepted_tokens[STRING_END_STATE] = STRING_TOKEN_CODE;
+
+    /* a comment continues until the end of the line */
+    set_transitions(COMMENT_STATE, 0, NO_OF_CHARACTER_CLASSES - 1, COMMENT_STATE);
+    transitions[COMMENT_STATE][END_CHARACTER_CLASS] = TOKEN_END_STATE;
+    accepted_tokens[COMMENT_STATE] = COMMENT_TOKEN_CODE;
+
+    /* a comma is a token of a single character */
+    set_transitions(COMMA_STATE, 0, NO_OF_CHARACTER_CLASSES - 1, TOKEN_END_STATE);
+    accepted_tokens[COMMA_STATE] = COMMA_TOKEN_CODE;
+
+    lexer_tables_built = 1;
+}
+
+/*
+ * Returns the index of the operation with the given name in the operations array.
+ * The name is given by its first character and its length, and doesn't have to end
+ * with a null terminator. If there is no such operation, the function returns -1.
+ *
+ * Parameters:
+ * -----------
+ * const char *name     the first character of the name.
+ * int length           the number of characters in the name.
+ */
+int get_mnemonic_index(const char *name, int length) {
+    int index;
+    for (index = 0; index < NO_OF_OPERATIONS; index++) {
+        if ((int) strlen(operations[index].name) == length && !strncmp(name, operations[index].name, length)) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Returns the definition code of the directive with the given name (.data, .string,
+ * .extern or .entry). The name is given by its first character and its length, and
+ * doesn't have to end with a null terminator. If there is no such directive, the
+ * function returns 0.
+ *
+ * Parameters:
+ * -----------
+ * const char *name     the first character of the name, including the dot.
+ * int length           the number of characters in the name.
+ */
+int get_directive_code(const char *name, int length) {
+    const char *directives_names[NO_OF_DIRECTIVES] = {DATA_DEFINITION_NAME, STRING_DEFINITION_NAME,
+                                                      EXTERN_DEFINITION_NAME, ENTRY_DEFINITION_NAME};
+    const int directives_codes[NO_OF_DIRECTIVES] = {DATA_DEFINITION_CODE, STRING_DEFINITION_CODE,
+                                                    EXTERN_DEFINITION_CODE, ENTRY_DEFINITION_CODE};
+    int index;
+    for (index = 0; index < NO_OF_DIRECTIVES; index++) {
+        if ((int) strlen(directives_names[index]) == length && !strncmp(name, directives_names[index], length)) {
+            return directives_codes[index];
+        }
+    }
+    return 0;
+}
+
+/*
+ * Adds a token with the given type and boundaries to the end of the given tokens
+ * list. Identifiers that are names of operations become mnemonics, and the value of
+ * a mnemonic is the index of its operation, and the value of a directive is its
+ * definition code. The tokens list grows automatically if it's full.
+ *
+ * Parameters:
+ * -----------
+ * TokensList *tokens_list  a pointer to the tokens list.
+ * const char *line         the string of the line.
+ * int type                 the code of the token.
+ * int start                the index in which the token starts in the line.
+ * int end                  the index in which the token ends in the line.
+ * int value                the number that was scanned in the beginning of the token.
+ */
+void add_token(TokensList *tokens_list, const char *line, int type, int start, int end, int value) {
+    Token *token;
+    int mnemonic_index;
+
+    if ((tokens_list->length) == (tokens_list->capacity)) {
+        tokens_list->capacity = (tokens_list->capacity) ? 2 * (tokens_list->capacity) : INITIAL_TOKENS_LIST_CAPACITY;
+        tokens_list->tokens = realloc(tokens_list->tokens, (tokens_list->capacity) * sizeof(Token));
+    }
+    token = &(tokens_list->tokens)[tokens_list->length];
+    token->type = type;
+    token->start = start;
+    token->end = end;
+    token->value = value;
+
+    if (type == IDENTIFIER_TOKEN_CODE) {
+        mnemonic_index = get_mnemonic_index(line + start, end - start + 1);
+        if (mnemonic_index >= 0) {
+            token->type = MNEMONIC_TOKEN_CODE;
+            token->value = mnemonic_index;
+        }
+    } else if (type == DIRECTIVE_TOKEN_CODE) {
+        token->value = get_directive_code(line + start, end - start + 1);
+    }
+    tokens_list->length += 1;
+}
+
+/*
+ * Returns a pointer to a TokensList that contains the tokens of the given line, in
+ * the order they appear in the line. The line is scanned in a single forward pass:
+ * each character is classified by the character classes table, and the next state of
+ * the lexer is taken from the transitions table. A token ends when the transitions
+ * table has no next state for the current character, and then its type is the token
+ * code that the last state accepts. A string that is not closed before the end of the
+ * line ends at the last boundary character, and the characters after it are scanned
+ * again as new tokens. The user should free the list with 'free_tokens_list'.
+ *
+ * Parameters:
+ * -----------
+ * const char *line     the string of the line.
+ */
+TokensList *tokenize_line(const char *line) {
+    TokensList *tokens_list = calloc(1, sizeof(TokensList));
+
+    int state = LINE_START_STATE; /* the current state of the lexer */
+    int next_state;
+    int character_class; /* the class of the current character */
+
+    int token_start = 0; /* the index in which the current token starts */
+    int token_end; /* the index in which the current token ends */
+    int token_type; /* the code of the current token */
+    int last_accepted_end = -1; /* the last index in which the current token could have ended */
+    int last_accepted_type = 0; /* the code of the current token if it ends in the last accepted index */
+
+    int number = 0; /* the absolute value of the number in the beginning of the current token, up to MAX_NUMBER_VALUE + 1 */
+    int negative = 0; /* indicates if the number in the beginning of the current token is negative */
+    int index;
+
+    if (!lexer_tables_built) {
+        build_lexer_tables();
+    }
+    for (index = 0;; index++) {
+        character_class = character_classes[(unsigned char) line[index]];
+        next_state = transitions[state][character_class];
+
+        /* the current character ends the current token */
+        if (next_state == TOKEN_END_STATE) {
+            if (accepted_tokens[state]) {
+                token_end = index - 1;
+                token_type = accepted_tokens[state];
+            } else if (last_accepted_end >= token_start) {
+                token_end = last_accepted_end;
+                token_type = last_accepted_type;
+            } else {
+                token_end = index - 1;
+                token_type = UNKNOWN_TOKEN_CODE;
+            }
+            add_token(tokens_list, line, token_type, token_start, token_end, negative ? -number : number);
+
+            state = TOKEN_START_STATE;
+            token_start = token_end + 1;
+            number = 0;
+            negative = 0;
+            /* the token ended before the current character, so the characters after it are scanned again */
+            if (token_end < index - 1) {
+                index = token_end;
+                continue;
+            }
+            next_state = transitions[state][character_class];
+        }
+
+        if (next_state == LINE_START_STATE || next_state == TOKEN_START_STATE) {
+            if (character_class == END_CHARACTER_CLASS) {
+                break;
+            }
+            token_start = index + 1;
+        } else if (next_state == NUMBER_STATE || next_state == REGISTER_STATE) {
+            /* a number that doesn't fit in a memory word stays above the largest value, instead of overflowing */
+            if (number <= MAX_NUMBER_VALUE) {
+                number = 10 * number + (line[index] - '0');
+            }
+            if (number > MAX_NUMBER_VALUE) {
+                number = MAX_NUMBER_VALUE + 1;
+            }
+        } else if (next_state == SIGN_STATE) {
+            negative = (line[index] == '-');
+        }
+        if (accepted_tokens[next_state]) {
+            last_accepted_end = index;
+            last_accepted_type = accepted_tokens[next_state];
+        }
+        state = next_state;
+    }
+    return tokens_list;
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the tokens
+ * of the given tokens list, and in the end frees the list itself.
+ *
+ * Parameters:
+ * -----------
+ * TokensList *tokens_list  a pointer to the tokens list.
+ */
+void free_tokens_list(TokensList *tokens_list) {
+    free(tokens_list->tokens);
+    free(tokens_list);
+}
@@ -0,0 +1,101 @@
+#ifndef ASSEMBLER_SIMULATOR_LEXER_H
+#define ASSEMBLER_SIMULATOR_LEXER_H
+
+#include "../types.h"
+
+/* the classes of the characters that the lexer distinguishes */
+#define OTHER_CHARACTER_CLASS 0 /* any character that doesn't belong to another class */
+#define SPACE_CHARACTER_CLASS 1 /* spaces, tabs and carriage returns */
+#define COMMA_CHARACTER_CLASS 2 /* a comma */
+#define LETTER_CHARACTER_CLASS 3 /* the english letters, except of the register letter */
+#define REGISTER_LETTER_CHARACTER_CLASS 4 /* the letter that follows the register prefix */
+#define DIGIT_CHARACTER_CLASS 5 /* the digits */
+#define SIGN_CHARACTER_CLASS 6 /* a plus or a minus sign */
+#define DOT_CHARACTER_CLASS 7 /* the starting character of a directive */
+#define AT_CHARACTER_CLASS 8 /* the prefix of a register */
+#define COLON_CHARACTER_CLASS 9 /* the label ending character */
+#define QUOTE_CHARACTER_CLASS 10 /* the boundary character of a string */
+#define SEMICOLON_CHARACTER_CLASS 11 /* the starting character of a comment */
+#define END_CHARACTER_CLASS 12 /* the null terminator of the line */
+#define NO_OF_CHARACTER_CLASSES 13 /* the number of character classes */
+
+/* the states of the lexer */
+#define TOKEN_END_STATE (-1) /* the current character ends the current token, and it is not consumed */
+#define LINE_START_STATE 0 /* no token was found yet in the line */
+#define TOKEN_START_STATE 1 /* between two tokens */
+#define IDENTIFIER_STATE 2 /* letters and digits that start with a letter */
+#define LABEL_STATE 3 /* an identifier that is followed by a label ending character */
+#define DOT_STATE 4 /* a directive starting character */
+#define DIRECTIVE_STATE 5 /* a directive starting character that is followed by letters */
+#define AT_STATE 6 /* a register prefix */
+#define AT_LETTER_STATE 7 /* a register prefix that is followed by the register letter */
+#define REGISTER_STATE 8 /* a register prefix and letter that are followed by digits */
+#define SIGN_STATE 9 /* a plus or a minus sign */
+#define NUMBER_STATE 10 /* digits, that may follow a sign */
+#define STRING_STATE 11 /* inside a string */
+#define STRING_END_STATE 12 /* the closing boundary character of a string */
+#define COMMENT_STATE 13 /* inside a comment */
+#define COMMA_STATE 14 /* a comma */
+#define INVALID_LABEL_STATE 15 /* a token that contains a label ending character, and is not a label definition */
+#define UNKNOWN_STATE 16 /* any other token */
+#define NO_OF_LEXER_STATES 17 /* the number of states of the lexer */
+
+/*
+ * Fills the character classes table with the class of each of the 256 possible
+ * characters, and fills the transitions table of the lexer with the next state of
+ * each state and each character class, and the token code that each state accepts.
+ */
+void build_lexer_tables();
+
+/*
+ * Returns the index of the operation with the given name in the operations array.
+ * The name is given by its first character and its length, and doesn't have to end
+ * with a null terminator. If there is no such operation, the function returns -1.
+ *
+ * Parameters:
+ * -----------
+ * const char *name     the first character of the name.
+ * int length           the number of characters in the name.
+ */
+int get_mnemonic_index(const char *name, int length);
+
+/*
+ * Returns the definition code of the directive with the given name (.data, .string,
+ * .extern or .entry). The name is given by its first character and its length, and
+ * doesn't have to end with a null terminator. If there is no such directive, the
+ * function returns 0.
+ *
+ * Parameters:
+ * -----------
+ * const char *name     the first character of the name, including the dot.
+ * int length           the number of characters in the name.
+ */
+int get_directive_code(const char *name, int length);
+
+/*
+ * Returns a pointer to a TokensList that contains the tokens of the given line, in
+ * the order they appear in the line. The line is scanned in a single forward pass:
+ * each character is classified by the character classes table, and the next state of
+ * the lexer is taken from the transitions table. A token ends when the transitions
+ * table has no next state for the current character, and then its type is the token
+ * code that the last state accepts. A string that is not closed before the end of the
+ * line ends at the last boundary character, and the characters after it are scanned
+ * again as new tokens. The user should free the list with 'free_tokens_list'.
+ *
+ * Parameters:
+ * -----------
+ * const char *line     the string of the line.
+ */
+TokensList *tokenize_line(const char *line);
+
+/*
+ * Frees the dynamic memory that was allocated to contain the tokens
+ * of the given tokens list, and in the end frees the list itself.
+ *
+ * Parameters:
+ * -----------
+ * TokensList *tokens_list  a pointer to the tokens list.
+ */
+void free_tokens_list(TokensList *tokens_list);
+
+#endif
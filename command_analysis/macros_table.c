@@ -7,67 +7,70 @@
 #include "../absolutes.h"
 
 /*
- * Creates a Macro structure for each definition of a macro in the program,
+ * Creates a Macro structure for each definition of a macro in the given lines,
  * and adds it to a DynamicArray that is created during the program. In the
  * end, the function returns a pointer to the DynamicArray. In addition, the
- * function re-writes the content or creates a new file, expand the macros
- * calls to it, and remove the definitions and the calls of the macros.
+ * function adds each line of the program to the given expanded lines, with the
+ * calls of the macros expanded, and without the definitions of the macros. The
+ * expanded lines point to the ProgramLine structures of the given lines, so they
+ * are not lexed again, and the user should free them with 'free_array'.
  *
  * Parameters:
  * -----------
- * char *source_file    the source file that contains the program.
- * char *dest_file      the destination file to write the new program to.
+ * DynamicArray *program_lines      the ProgramLine of each line of the program.
+ * DynamicArray *expanded_lines     the DynamicArray to add the lines of the new program to.
  */
-DynamicArray *expand_macros(char *source_file, char *dest_file) {
-    FILE *file = fopen(dest_file, "w");
-    DynamicArray *program_lines = get_program_lines(source_file);
+DynamicArray *expand_macro_lines(DynamicArray *program_lines, DynamicArray *expanded_lines) {
     DynamicArray *macros_table = create_dynamic_array();
     DynamicArray *temp_positions_array; /* the positions array of the current command */
     Field field_0, field_1; /* the first two fields of the current command */
-    Macro *temp_macro; /* the Macro struct to store the macro */
+    Macro *temp_macro = NULL; /* the Macro struct to store the macro */
+    Macro *called_macro = NULL; /* the macro that the current command calls */
     Macro current_macro;
+    ProgramLine *line; /* the current line of the program */
 
     int row_index = 0;
     int length = program_lines->length; /* the number of commands in the program */
     int starting_index, ending_index; /* the row_index where the current field starts and ends */
-    char *command_content; /* a content to store the content of the current command */
     int no_of_fields; /* the number of fields in the current command */
-    int call_index = 0; /* in which index the macro was called */
     int macro_found_flag = 0; /* indicates if a macro has been started its definition */
     int found_macro_in_table = 0; /* indicates if the macro that was called, was found in the macros table */
 
     int i, j;
 
-    file = fopen(dest_file, "a");
     while (row_index < length) {
-        command_content = GET_STRING(program_lines, row_index);
-        /* create the positions array for the current command, and store it */
-        temp_positions_array = get_positions_array(command_content);
+        line = GET_POINTER(program_lines, ProgramLine*, row_index);
+        /* the positions array of the current command was created when the command was read */
+        temp_positions_array = line->positions_array;
         no_of_fields = (temp_positions_array->length);
 
         /* command is only semicolons (;), spaces and tabs */
-        if (is_empty_command(command_content) && !macro_found_flag) {
-            fprintf(file, "%s\n", command_content); /* add the command to the new file */
+        if (is_empty_command(line->content) && !macro_found_flag) {
+            add_element(expanded_lines, line);
 
             row_index++;
             continue;
         }
-        /* if the command is not empty there is at least one field in it */
+        /* a command with no fields is kept, and inside a macro definition it is a part of its content */
+        if (no_of_fields == 0) {
+            if (!macro_found_flag) {
+                add_element(expanded_lines, line);
+            }
+            row_index++;
+            continue;
+        }
         field_0 = GET_ELEMENT(temp_positions_array, Field*, 0);
 
         /* it may be the end of a macro definition, or a call to a macro */
         if (no_of_fields == NO_OF_FIELDS_IN_MACRO_CALL_OR_END) {
-            /* it is the end of a macro definition */
-            if (strcmp(field_0.content, MACRO_DEFINITION_END_NAME) == 0) {
+            /* it is the end of a macro definition, without a definition it is an undefined command */
+            if (strcmp(field_0.content, MACRO_DEFINITION_END_NAME) == 0 && macro_found_flag) {
                 ending_index = row_index;
                 (temp_macro->start_index) = starting_index;
                 (temp_macro->finish_index) = ending_index;
                 add_element(macros_table, (void *) temp_macro);
                 /* reset flags and indexes */
-                call_index = 0;
                 macro_found_flag = 0;
-                /* free the dynamic memory that the positions array took */
-                free_all_elements(temp_positions_array);
                 row_index++;
                 continue;
             }
@@ -78,28 +81,27 @@ DynamicArray *expand_macros(char *source_file, char *dest_file) {
                     for (i = 0; ((macros_table->array)[i]) != NULL; i++) {
                         current_macro = GET_ELEMENT(macros_table, Macro*, i);
                         /* if we found the macro in the macros table */
-                        if (strcmp(current_macro.name, field_0.content) == 0) {
+                        if (current_macro.id == field_0.id) {
                             found_macro_in_table = 1;
+                            called_macro = GET_POINTER(macros_table, Macro*, i);
                             for (j = current_macro.start_index + 1; j < current_macro.finish_index; j++) {
-                                fprintf(file, "%s\n", GET_STRING(program_lines, j));
+                                add_element(expanded_lines, GET_POINTER(program_lines, ProgramLine*, j));
                             }
                             break;
                         }
                     }
                 }
                 if (found_macro_in_table) {
-                    (temp_macro->calls)[call_index] = row_index;
-                    call_index++;
+                    add_element(called_macro->calls, line);
+                } else if (!macro_found_flag) {
+                    /* it is a command with a single field, such as 'rts' or 'stop' */
+                    add_element(expanded_lines, line);
                 }
                 found_macro_in_table = 0;
-                /* free the dynamic memory that the positions array took */
-                free_all_elements(temp_positions_array);
                 row_index++;
                 continue;
             }
         } else if (macro_found_flag) {
-            /* free the dynamic memory that the positions array took */
-            free_all_elements(temp_positions_array);
             row_index++;
             continue; /* do not write the content of the macro to the new file */
         }
@@ -110,28 +112,123 @@ DynamicArray *expand_macros(char *source_file, char *dest_file) {
             if (strcmp(field_0.content, MACRO_DEFINITION_START_NAME) == 0) {
                 starting_index = row_index;
                 temp_macro = malloc(sizeof(Macro)); /* allocate memory for a new macro */
-                memset(temp_macro->name, 0, sizeof(temp_macro->name));
-                memset(temp_macro->calls, 0, sizeof(temp_macro->calls));
-                strcpy(temp_macro->name, field_1.content); /* store the name of the macro */
+                if (temp_macro == NULL) {
+                    printf("Could not allocate memory for the macro!\n");
+                    exit(0);
+                }
+                temp_macro->calls = create_dynamic_array();
+                /* store the name of the macro */
+                temp_macro->id = intern_string(&string_pool, field_1.content, (int) strlen(field_1.content));
+                temp_macro->name = get_pool_string(&string_pool, temp_macro->id);
                 /* reset flags and indexes */
-                call_index = 0;
                 macro_found_flag = 1;
 
-                /* free the dynamic memory that the positions array took */
-                free_all_elements(temp_positions_array);
                 row_index++;
                 continue;
             }
         }
         /* the command is not the beginning/end of a macro definition and not a call to it,
          * it is just a regular command */
-        fprintf(file, "%s\n", command_content); /* add the command to the new file */
-        /* free the dynamic memory that the positions array took */
-        free_all_elements(temp_positions_array);
+        add_element(expanded_lines, line);
         row_index++;
     }
-    free_dynamic_array(program_lines);
+    /* a macro that was not ended is not added to the table */
+    if (macro_found_flag) {
+        free_array(temp_macro->calls);
+        free(temp_macro);
+    }
+    return macros_table;
+}
+
+/*
+ * Returns 1 if the given line starts or ends the definition of a macro, and 0 otherwise.
+ * A program without such lines has no macros, and its expanded lines are its lines.
+ *
+ * Parameters:
+ * -----------
+ * ProgramLine *line    a pointer to the line.
+ */
+int is_macro_line(ProgramLine *line) {
+    Field *field_0;
+
+    if ((line->positions_array->length) == 0) {
+        return 0;
+    }
+    field_0 = GET_POINTER(line->positions_array, Field*, 0);
+    return strcmp(field_0->content, MACRO_DEFINITION_START_NAME) == 0 ||
+           strcmp(field_0->content, MACRO_DEFINITION_END_NAME) == 0;
+}
+
+/*
+ * Creates a Macro structure for each definition of a macro in the program,
+ * and adds it to a DynamicArray that is created during the program. In the
+ * end, the function returns a pointer to the DynamicArray. In addition, the
+ * function adds the lines of the program to the given expanded lines like
+ * 'expand_macro_lines', and re-writes the content or creates a new file with
+ * the expanded lines.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *program_lines      the ProgramLine of each line of the program.
+ * DynamicArray *expanded_lines     the DynamicArray to add the lines of the new program to.
+ * char *dest_file                  the destination file to write the new program to.
+ */
+DynamicArray *expand_macros(DynamicArray *program_lines, DynamicArray *expanded_lines, char *dest_file) {
+    DynamicArray *macros_table = expand_macro_lines(program_lines, expanded_lines);
+
+    update_expanded_lines(expanded_lines, 0, 0, dest_file);
+    return macros_table;
+}
+
+/*
+ * Frees the given macros table, that was returned by 'expand_macro_lines' or
+ * 'expand_macros': the list of the calls of each macro, the macros and the table.
+ * The lines in the lists of the calls belong to the program, and are not freed.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *macros_table   the Macro of each definition of a macro in the program.
+ */
+void free_macros_table(DynamicArray *macros_table) {
+    int index;
+
+    for (index = 0; index < (macros_table->length); index++) {
+        free_array(GET_POINTER(macros_table, Macro*, index)->calls);
+    }
+    free_dynamic_array(macros_table);
+}
+
+/*
+ * Writes the given expanded lines to the given file, from the line in the given index,
+ * that starts in the given offset in the file. The lines before it are not written
+ * again, so they must be in the file from a previous assembly. If the offset is 0, or
+ * the file doesn't exist, the whole file is written. Returns the length of the file,
+ * which may be shorter than its previous length.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *expanded_lines     the lines of the program after its macros were expanded.
+ * int first_line                   the index of the first line to write.
+ * long offset                      the offset of the first line in the file.
+ * char *dest_file                  the file to write the lines to.
+ */
+long update_expanded_lines(DynamicArray *expanded_lines, int first_line, long offset, char *dest_file) {
+    FILE *file = (offset > 0) ? fopen(dest_file, "r+") : NULL;
+    long length;
+    int index;
+
+    if (file == NULL) {
+        /* re-write the file */
+        file = fopen(dest_file, "w");
+        first_line = 0;
+        offset = 0;
+    }
+    fseek(file, offset, SEEK_SET);
+    for (index = first_line; index < (expanded_lines->length); index++) {
+        fprintf(file, "%s\n", GET_POINTER(expanded_lines, ProgramLine*, index)->content); /* add the command to the new file */
+    }
+    length = ftell(file);
     /* make sure the file we opened will be closed */
     fclose(file);
-    return macros_table;
+    return length;
 }
\ No newline at end of file
@@ -1,60 +1,171 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "helpers.h"
 #include "command_analysis.h"
+#include "lexer.h"
+#include "../function_macros.h"
 
 /*
- * Returns a pointer to a DynamicArray that is created during the
- * execution of the function, and contains strings in the 'array'
- * field, that each represent a line in the program.
+ * Returns a pointer to a new null-terminated string that contains the given
+ * characters. The user should free the string in the end of the usage.
  *
  * Parameters:
  * -----------
- * char *file_path  the path to file that contains the program.
+ * const char *characters   the characters of the line, not necessarily null-terminated.
+ * size_t length            the number of characters.
  */
-DynamicArray *get_program_lines(char *file_path) {
-    FILE *file = fopen(file_path, "r");
-    DynamicArray *commands = create_dynamic_array();
-    char *single_command = malloc(sizeof(char));
-    char temp_char; /* a temporary variable to store the character that was scanned */
-    int length = 0; /* the current number of characters in the command */
-    int last_byte;
+char *copy_line(const char *characters, size_t length) {
+    char *line = malloc(length + 1);
 
-    if (file == NULL) {
-        printf("Could not open the given file!\n");
+    if (line == NULL) {
+        printf("Could not allocate memory for the program lines!\n");
         exit(0);
     }
-    while (fscanf(file, "%c", &temp_char) != EOF) {
+    memcpy(line, characters, length);
+    line[length] = '\0';
+    return line;
+}
+
+/*
+ * Returns a pointer to a new ProgramLine structure that stores the given line, and
+ * its tokens and fields. The line is lexed only here, and the ProgramLine takes the
+ * ownership of the given string, which is freed with the line by 'free_program_lines'.
+ *
+ * Parameters:
+ * -----------
+ * char *content    a string that contains the line, that was allocated dynamically.
+ */
+ProgramLine *create_program_line(char *content) {
+    ProgramLine *line = malloc(sizeof(ProgramLine));
+
+    if (line == NULL) {
+        printf("Could not allocate memory for the program lines!\n");
+        exit(0);
+    }
+    line->content = content;
+    line->tokens_list = tokenize_line(content);
+    line->positions_array = get_positions_array(content, line->tokens_list);
+    return line;
+}
+
+/*
+ * Returns a pointer to a DynamicArray that is created during the execution of
+ * the function, and contains a ProgramLine structure in the 'array' field for
+ * each line of the given source. If the source ends with a new line, its last
+ * line is a single space.
+ *
+ * Parameters:
+ * -----------
+ * const char *source   the characters of the program.
+ * size_t length        the number of characters in the program.
+ */
+DynamicArray *split_program_lines(const char *source, size_t length) {
+    DynamicArray *commands = create_dynamic_array();
+    size_t line_start = 0; /* the index of the first character of the current command */
+    size_t index;
+
+    for (index = 0; index < length; index++) {
         /* the end of the current command arrived */
-        if (temp_char == '\n') {
-            /* store null terminator for empty commands */
-            single_command[length] = 0;
-            /* store the command */
-            add_element(commands, single_command);
-            /* create a new command */
-            single_command = malloc(sizeof(char));
-            length = 0;
-        } else {
-            length++;
-            /* increase the memory block */
-            single_command = realloc(single_command, (1 + length) * sizeof(char));
-            /* store the character */
-            single_command[length - 1] = temp_char;
-            /* store null terminator */
-            single_command[length] = 0;
+        if (source[index] == '\n') {
+            add_element(commands, create_program_line(copy_line(source + line_start, index - line_start)));
+            line_start = index + 1;
         }
     }
-    fseek(file, -1, SEEK_END);
-    last_byte = fgetc(file);
+    /* store the last command */
+    if (length > 0 && source[length - 1] == '\n') {
+        add_element(commands, create_program_line(copy_line(" ", 1)));
+    } else {
+        add_element(commands, create_program_line(copy_line(source + line_start, length - line_start)));
+    }
+    return commands;
+}
 
-    if (last_byte == '\n') {
-        single_command = calloc(2, sizeof(char));
-        single_command[0] = ' ';
-        single_command[1] = '\0';
+/*
+ * Returns a pointer to a new string that contains all the characters of the given
+ * file, and stores their number in the given pointer. The string is not null-terminated.
+ * The user should free the string in the end of the usage.
+ *
+ * Parameters:
+ * -----------
+ * char *file_path  the path to file that contains the program.
+ * long *length     a pointer to store the number of characters in.
+ */
+char *read_source_file(char *file_path, long *length) {
+    FILE *file = fopen(file_path, "r");
+    char *contents;
+
+    if (file == NULL) {
+        printf("Could not open the given file!\n");
+        exit(0);
     }
-    /* store the last command */
-    add_element(commands, single_command);
+    /* read the whole file at once, and split it to lines in the memory */
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    contents = malloc((*length > 0 ? (size_t) *length : 1) * sizeof(char));
+    if (contents == NULL) {
+        printf("Could not allocate memory for the program lines!\n");
+        exit(0);
+    }
+    *length = (long) fread(contents, sizeof(char), (size_t) (*length > 0 ? *length : 0), file);
     /* make sure the file we opened will be closed */
     fclose(file);
+    return contents;
+}
+
+/*
+ * Returns a pointer to a DynamicArray that is created during the
+ * execution of the function, and contains a ProgramLine structure
+ * in the 'array' field for each line in the program.
+ *
+ * Parameters:
+ * -----------
+ * char *file_path  the path to file that contains the program.
+ */
+DynamicArray *get_program_lines(char *file_path) {
+    DynamicArray *commands;
+    long length;
+    char *contents = read_source_file(file_path, &length);
+
+    commands = split_program_lines(contents, (size_t) length);
+    free(contents);
     return commands;
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the given line, its
+ * tokens and its fields, and in the end frees the line itself.
+ *
+ * Parameters:
+ * -----------
+ * ProgramLine *line    a pointer to the line.
+ */
+void free_program_line(ProgramLine *line) {
+    int field_index;
+
+    for (field_index = 0; field_index < (line->positions_array->length); field_index++) {
+        free(GET_POINTER(line->positions_array, Field*, field_index));
+    }
+    free_array(line->positions_array);
+    free_tokens_list(line->tokens_list);
+    free(line->content);
+    free(line);
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the given lines, their
+ * tokens and their fields, and in the end frees the array itself.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *program_lines  a DynamicArray of ProgramLine structures.
+ */
+void free_program_lines(DynamicArray *program_lines) {
+    int index;
+
+    for (index = 0; index < (program_lines->length); index++) {
+        free_program_line(GET_POINTER(program_lines, ProgramLine*, index));
+    }
+    free_array(program_lines);
 }
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "scanner.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define FULL_BLOCK_MASK ((SCAN_BLOCK_SIZE == 32) ? 0xFFFFFFFFUL : 0xFFFFUL) /* a mask with a bit for each character of a block */
+
+/*
+ * Returns 1 if the given character belongs to the given class, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char temp_char       the character to classify.
+ * int class            the class to check (DELIMITER_CLASS or LETTER_CLASS).
+ */
+int is_in_class(char temp_char, int class) {
+    if (class == DELIMITER_CLASS) {
+        return temp_char == ' ' || temp_char == ',';
+    }
+    return (temp_char >= 'a' && temp_char <= 'z') || (temp_char >= 'A' && temp_char <= 'Z');
+}
+
+/*
+ * Returns a bit mask of the characters of the given block that belong to the given
+ * class. The i-th bit of the mask is set if the i-th character of the block belongs
+ * to the class. The block must contain at least SCAN_BLOCK_SIZE characters.
+ *
+ * Parameters:
+ * -----------
+ * const char *block    the characters to classify.
+ * int class            the class of the characters to search (DELIMITER_CLASS or LETTER_CLASS).
+ */
+unsigned long get_class_mask(const char *block, int class) {
+#if defined(__AVX2__)
+    __m256i chars = _mm256_loadu_si256((const __m256i *) block);
+    __m256i matches;
+    __m256i lower_case;
+
+    if (class == DELIMITER_CLASS) {
+        matches = _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')),
+                                  _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(',')));
+    } else {
+        /* setting the 0x20 bit turns every upper case letter to a lower case letter */
+        lower_case = _mm256_or_si256(chars, _mm256_set1_epi8(0x20));
+        matches = _mm256_and_si256(_mm256_cmpgt_epi8(lower_case, _mm256_set1_epi8('a' - 1)),
+                                   _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower_case));
+    }
+    return (unsigned long) (unsigned int) _mm256_movemask_epi8(matches);
+#elif defined(__SSE2__)
+    __m128i chars = _mm_loadu_si128((const __m128i *) block);
+    __m128i matches;
+    __m128i lower_case;
+
+    if (class == DELIMITER_CLASS) {
+        matches = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')),
+                               _mm_cmpeq_epi8(chars, _mm_set1_epi8(',')));
+    } else {
+        /* setting the 0x20 bit turns every upper case letter to a lower case letter */
+        lower_case = _mm_or_si128(chars, _mm_set1_epi8(0x20));
+        matches = _mm_and_si128(_mm_cmpgt_epi8(lower_case, _mm_set1_epi8('a' - 1)),
+                                _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), lower_case));
+    }
+    return (unsigned long) _mm_movemask_epi8(matches);
+#else
+    unsigned long mask = 0;
+    int index;
+
+    for (index = 0; index < SCAN_BLOCK_SIZE; index++) {
+        if (is_in_class(block[index], class)) {
+            mask |= 1UL << index;
+        }
+    }
+    return mask;
+#endif
+}
+
+/*
+ * Returns the index of the lowest bit that is set in the given mask.
+ * The mask must not be zero.
+ *
+ * Parameters:
+ * -----------
+ * unsigned long mask   a non-zero bit mask.
+ */
+int get_lowest_bit_index(unsigned long mask) {
+#if defined(__GNUC__)
+    return __builtin_ctzl(mask);
+#else
+    int index = 0;
+    while (!(mask & 1UL)) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+/*
+ * Returns the index of the first character of the given string, starting from the
+ * given index, that belongs to the given class (or doesn't belong to it, if 'negate'
+ * is 1). If there is no such character, the function returns the length of the string.
+ *
+ * Parameters:
+ * -----------
+ * const char *string   the string to scan.
+ * int length           the number of characters in the string.
+ * int index            the index to start the scan from.
+ * int class            the class of the characters to search.
+ * int negate           1 to search a character that doesn't belong to the class, and 0 otherwise.
+ */
+int find_first_in_class(const char *string, int length, int index, int class, int negate) {
+    unsigned long mask;
+
+    /* classify whole blocks */
+    while (index + SCAN_BLOCK_SIZE <= length) {
+        mask = get_class_mask(string + index, class);
+        if (negate) {
+            mask = ~mask & FULL_BLOCK_MASK;
+        }
+        if (mask) {
+            return index + get_lowest_bit_index(mask);
+        }
+        index += SCAN_BLOCK_SIZE;
+    }
+    /* classify the characters after the last whole block */
+    while (index < length) {
+        if (is_in_class(string[index], class) != negate) {
+            return index;
+        }
+        index++;
+    }
+    return length;
+}
+
+/*
+ * Returns the index of the first character of the given string, starting from
+ * the given index, that is not a delimiter. If there is no such character, the
+ * function returns the length of the string.
+ *
+ * Parameters:
+ * -----------
+ * const char *string   the string to scan.
+ * int length           the number of characters in the string.
+ * int index            the index to start the scan from.
+ */
+int skip_delimiters(const char *string, int length, int index) {
+    return find_first_in_class(string, length, index, DELIMITER_CLASS, 1);
+}
+
+/*
+ * Returns 1 if the given string contains at least one letter, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * const char *string   the string to scan.
+ * int length           the number of characters in the string.
+ */
+int contains_letter(const char *string, int length) {
+    return find_first_in_class(string, length, 0, LETTER_CLASS, 0) < length;
+}
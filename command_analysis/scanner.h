@@ -0,0 +1,89 @@
+#ifndef ASSEMBLER_SIMULATOR_SCANNER_H
+#define ASSEMBLER_SIMULATOR_SCANNER_H
+
+#define DELIMITER_CLASS 1 /* the class of the characters that separate fields (spaces and commas) */
+#define LETTER_CLASS 2 /* the class of the english letters */
+
+/*
+ * The number of characters that are classified in each step of the scan.
+ * With AVX2 the scanner classifies 32 characters at once, with SSE2 it
+ * classifies 16 characters at once, and without them it uses a scalar loop
+ * over blocks of 16 characters.
+ */
+#if defined(__AVX2__)
+#define SCAN_BLOCK_SIZE 32
+#else
+#define SCAN_BLOCK_SIZE 16
+#endif
+
+/*
+ * Returns 1 if the given character belongs to the given class, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char temp_char       the character to classify.
+ * int class            the class to check (DELIMITER_CLASS or LETTER_CLASS).
+ */
+int is_in_class(char temp_char, int class);
+
+/*
+ * Returns a bit mask of the characters of the given block that belong to the given
+ * class. The i-th bit of the mask is set if the i-th character of the block belongs
+ * to the class. The block must contain at least SCAN_BLOCK_SIZE characters.
+ *
+ * Parameters:
+ * -----------
+ * const char *block    the characters to classify.
+ * int class            the class of the characters to search (DELIMITER_CLASS or LETTER_CLASS).
+ */
+unsigned long get_class_mask(const char *block, int class);
+
+/*
+ * Returns the index of the lowest bit that is set in the given mask.
+ * The mask must not be zero.
+ *
+ * Parameters:
+ * -----------
+ * unsigned long mask   a non-zero bit mask.
+ */
+int get_lowest_bit_index(unsigned long mask);
+
+/*
+ * Returns the index of the first character of the given string, starting from the
+ * given index, that belongs to the given class (or doesn't belong to it, if 'negate'
+ * is 1). If there is no such character, the function returns the length of the string.
+ *
+ * Parameters:
+ * -----------
+ * const char *string   the string to scan.
+ * int length           the number of characters in the string.
+ * int index            the index to start the scan from.
+ * int class            the class of the characters to search.
+ * int negate           1 to search a character that doesn't belong to the class, and 0 otherwise.
+ */
+int find_first_in_class(const char *string, int length, int index, int class, int negate);
+
+/*
+ * Returns the index of the first character of the given string, starting from
+ * the given index, that is not a delimiter. If there is no such character, the
+ * function returns the length of the string.
+ *
+ * Parameters:
+ * -----------
+ * const char *string   the string to scan.
+ * int length           the number of characters in the string.
+ * int index            the index to start the scan from.
+ */
+int skip_delimiters(const char *string, int length, int index);
+
+/*
+ * Returns 1 if the given string contains at least one letter, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * const char *string   the string to scan.
+ * int length           the number of characters in the string.
+ */
+int contains_letter(const char *string, int length);
+
+#endif
@@ -7,6 +7,51 @@
 #include "../error_detection/detector.h"
 #include "../segments.h"
 
+/*
+ * Returns a pointer to a new Label structure with the name that has the given
+ * id in the string pool. The name is owned by the string pool, and therefore it
+ * is stored only once. The other fields of the label are not set.
+ *
+ * Parameters:
+ * -----------
+ * int label_id     the id of the name of the label in the string pool.
+ */
+Label *create_label(int label_id) {
+    Label *label = malloc(sizeof(Label));
+    label->id = label_id;
+    label->name = get_pool_string(&string_pool, label_id);
+    return label;
+}
+
+/*
+ * Adds a label with the given name id, address and type to the given symbols table,
+ * and returns 1. If a similar label is already in the table, the function prints the
+ * error, sets the error flag, and returns 0 without adding the label.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ * int label_id                     the id of the name of the label in the string pool.
+ * int address                      the address of the label (IC/DC, or 0 if it's external).
+ * int type                         the type of the label.
+ * int row_index                    the index of the row that the label is found in.
+ */
+int add_symbol(DynamicArray *symbols_table, int label_id, int address, int type, int row_index) {
+    Label *label = create_label(label_id);
+    label->address = address;
+    label->type = type;
+    label->index = row_index;
+
+    /* search for similar labels in the symbols table */
+    if (found_similar_label(symbols_table, label, row_index)) {
+        ERROR_FLAG = 1;
+        free(label);
+        return 0;
+    }
+    add_element(symbols_table, label);
+    return 1;
+}
+
 /*
  * Returns a pointer to a DynamicArray that contains Label structures.
  * Each label represent a symbol in the program, and contains information
@@ -16,103 +61,68 @@
  *
  * Parameters:
  * -----------
- * char *file_path  the path to the file that contains the program.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
  */
-DynamicArray *get_symbols_table(char *file_path) {
+DynamicArray *get_symbols_table(DynamicArray *program_lines) {
     DynamicArray *symbols_table = create_dynamic_array(); /* the array that stores the labels */
-    DynamicArray *program_lines = get_program_lines(file_path); /* the array that stores the lines of the program */
     DynamicArray *temp_positions_array; /* the positions array of the current command */
 
-    char *temp_command_content; /* a temporary variable to contain the content of the current command */
+    ProgramLine *temp_line; /* the current line of the program */
 
     int row_index; /* the index of the current row in the program_lines array */
     int definition_code; /* the type of the definition (data, string, extern, entry, ...) */
 
     int found_label; /* indicates if a label has been found in the command */
 
-    Label *temp_label; /* temporary Label pointer to store the label to add to the symbols table */
-    char *label_name;
-
     /* reset the instructions & data counters */
     IC = 0;
     DC = 0;
+    reset_segment(&data_segment);
 
     for (row_index = 0; row_index < (program_lines->length); row_index++) {
-        temp_command_content = GET_STRING(program_lines, row_index);
-        temp_positions_array = get_positions_array(temp_command_content);
+        temp_line = GET_POINTER(program_lines, ProgramLine*, row_index);
+        temp_positions_array = temp_line->positions_array;
 
-        if (is_empty_command(temp_command_content)) {
-            free_dynamic_array(temp_positions_array);
+        if (is_empty_command(temp_line->content)) {
             continue;
         }
-        definition_code = get_definition_type(temp_command_content);
-        found_label = has_valid_label(temp_command_content);
+        definition_code = get_definition_type(temp_line);
+        found_label = has_valid_label(temp_line);
 
         if (definition_code == DATA_DEFINITION_CODE ||
             definition_code == STRING_DEFINITION_CODE ||
             definition_code == COMMAND_DEFINITION_CODE) {
             if (found_label) {
-                /* create the label struct to add to the symbols table */
-                temp_label = malloc(sizeof(Label));
-                temp_label->index = row_index;
-                label_name = get_label_name(temp_command_content);
-                strcpy(temp_label->name, label_name);
-                free(label_name); /* we don't need to use this dynamic memory area after we stored its data in the struct */
-
-                if (definition_code == COMMAND_DEFINITION_CODE) {
-                    temp_label->address = IC;
-                    temp_label->type = definition_code;
-                } else {
-                    temp_label->address = DC;
-                    temp_label->type = DATA_DEFINITION_CODE;
-                }
-                /* search for similar labels in the symbols table */
-                if (found_similar_label(symbols_table, temp_label, row_index)) {
-                    ERROR_FLAG = 1;
-                }
-                    /* add the label to the symbols table if it's not in it */
-                else {
-                    add_element(symbols_table, temp_label);
-
+                /* add the label to the symbols table if it's not in it, the label is the first field */
+                if (add_symbol(symbols_table, GET_ELEMENT(temp_positions_array, Field*, 0).id,
+                               (definition_code == COMMAND_DEFINITION_CODE) ? IC : DC,
+                               (definition_code == COMMAND_DEFINITION_CODE) ? definition_code : DATA_DEFINITION_CODE,
+                               row_index)) {
                     if (definition_code == COMMAND_DEFINITION_CODE) {
-                        IC += get_no_of_memory_words(temp_command_content);
+                        IC += get_no_of_memory_words(temp_line);
                     } else {
                         /* encode the data to the data segment based on its type (string/data) */
-                        encode_data(temp_command_content);
+                        encode_data(temp_line);
                     }
                 }
             } else {
                 /* increase the IC even if the command don't have label */
                 if (definition_code == COMMAND_DEFINITION_CODE) {
-                    IC += get_no_of_memory_words(temp_command_content);
+                    IC += get_no_of_memory_words(temp_line);
                 } else {
                     /* encode the data to the data segment based on its type (string/data) */
-                    encode_data(temp_command_content);
+                    encode_data(temp_line);
                 }
             }
         } else if (definition_code == EXTERN_DEFINITION_CODE) {
             /* add the label of the declaration to the symbols table */
-            int label_index = get_declaration_index(temp_command_content) + 1;
+            int label_index = get_declaration_index(temp_line) + 1;
             Field label_field = GET_ELEMENT(temp_positions_array, Field*, label_index);
 
-            /* create the label struct to add to the symbols table */
-            temp_label = malloc(sizeof(Label));
-            temp_label->address = 0;
-            temp_label->type = definition_code;
-            temp_label->index = row_index;
-            strcpy(temp_label->name, label_field.content);
-
-            if (found_similar_label(symbols_table, temp_label, row_index)) {
-                ERROR_FLAG = 1;
-                free_dynamic_array(temp_positions_array);
-                continue;
-            }
-            add_element(symbols_table, temp_label);
+            add_symbol(symbols_table, label_field.id, 0, definition_code, row_index);
         }
-        free_dynamic_array(temp_positions_array);
     }
     address_transformation(symbols_table);
-    free_dynamic_array(program_lines);
 
     final_IC = IC;
     final_DC = DC;
@@ -1,68 +1,81 @@
 #include <math.h>
+#include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
 #include "helpers.h"
 #include "command_analysis.h"
+#include "lexer.h"
 #include "../error_detection/helpers.h"
 #include "../function_macros.h"
 
 /*
- * Gets a content that represent a command_content in the program, then breaks
- * it into parts using 'strtok' and other functions, and in the end
- * returns a pointer to the DynamicArray that was created during the
- * function execution, and stores in it Field structures, with order
- * that correspond to the order of the fields of the command_content.
+ * Returns a pointer to a new Field structure that stores the characters of the
+ * given command between the given indexes (including both of them). The content
+ * of the field is stored in the same memory block as the structure, and therefore
+ * freeing the field frees its content as well. If the field starts with a letter,
+ * it is an identifier, and it is interned into the string pool without its label
+ * ending character.
  *
  * Parameters:
  * -----------
- * char *command_content    a content that contains the command_content to tokenize.
+ * char *command_content    the string of the command.
+ * int start_index          the index in which the field starts in the command.
+ * int end_index            the index in which the field ends in the command.
  */
-DynamicArray *get_positions_array(char *command_content) {
+Field *create_field(char *command_content, int start_index, int end_index) {
+    int length = end_index - start_index + 1; /* the number of characters in the field */
+    Field *field = malloc(sizeof(Field) + (length + 1) * sizeof(char));
+
+    field->start = start_index;
+    field->end = end_index;
+    field->content = (char *) (field + 1);
+    memcpy(field->content, command_content + start_index, length);
+    (field->content)[length] = 0; /* add a null-terminator */
+
+    field->id = NO_STRING_ID;
+    if (isalpha((field->content)[0])) {
+        /* a label definition is interned without its ending character */
+        if ((field->content)[length - 1] == LABEL_ENDING_CHARACTER) {
+            length -= 1;
+        }
+        field->id = intern_string(&string_pool, field->content, length);
+    }
+    return field;
+}
+
+/*
+ * Returns a pointer to a DynamicArray that stores a Field structure for each token
+ * of the given command, except of the commas, in the order of the tokens in the command.
+ * Each field stores the type and the value of its token, and the number of commas
+ * between the previous field and itself. The tokens are the tokens that the lexer
+ * found in the command, when the command was read.
+ *
+ * Parameters:
+ * -----------
+ * char *command_content        the string of the command.
+ * TokensList *tokens_list      the tokens of the command.
+ */
+DynamicArray *get_positions_array(char *command_content, TokensList *tokens_list) {
     DynamicArray *positions_array = create_dynamic_array(); /* the head of the dynamic array that will store the fields of the command_content */
+    Token *temp_token;
     Field *temp_field; /* a temporary field that will store the current fields data */
 
-    char delimiters[] = " ,"; /* separating characters */
-    char *start; /* a pointer to the beginning of the current token */
-    char *end; /* a pointer to the end of the current token */
-    size_t token_length; /* the length of the current token */
-
-    int start_index; /* the index in which the current token starts */
-    int end_index; /* the index in which the current token ends */
-
-    int i; /* the index of where to add the character of the name in the 'name' array */
-    int j; /* the index of where to take the character of the name from the command_content string */
-
-    /* move to the first place from the beginning where there are no spaces */
-    start = command_content + strspn(command_content, delimiters);
-    end = command_content + strlen(command_content) - 1;
-
-    while (start <= end) {
-        /* find the length of the token */
-        token_length = strcspn(start, delimiters);
-
-        /* calculate the starting & ending index of the token */
-        start_index = (int) (start - command_content);
-        end_index = (int) (start_index + token_length - 1);
-
-        /* store the field in the positions array */
-        temp_field = malloc(sizeof(Field));
-        temp_field->start = start_index;
-        temp_field->end = end_index;
-
-        /* add a null-terminator */
-        memset(temp_field->content, 0, sizeof(temp_field->content));
+    int no_of_commas = 0; /* the number of commas since the last field */
+    int index;
 
-        /* add the content of the field */
-        j = start_index;
-        for (i = 0; i < end_index - start_index + 1; i++) {
-            (temp_field->content)[i] = command_content[j];
-            j++;
+    for (index = 0; index < (tokens_list->length); index++) {
+        temp_token = &(tokens_list->tokens)[index];
+        if (temp_token->type == COMMA_TOKEN_CODE) {
+            no_of_commas++;
+            continue;
         }
+        /* store the field in the positions array */
+        temp_field = create_field(command_content, temp_token->start, temp_token->end);
+        temp_field->type = temp_token->type;
+        temp_field->value = temp_token->value;
+        temp_field->preceding_commas = no_of_commas;
         add_element(positions_array, temp_field);
-
-        /* skip the delimiters characters and continue to the next token */
-        start += token_length;
-        start += strspn(start, delimiters);
+        no_of_commas = 0;
     }
     return positions_array;
 }
@@ -74,46 +87,39 @@ DynamicArray *get_positions_array(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *command_content            the string of the command.
+ * ProgramLine *line                the line of the command.
  * DynamicArray *symbols_table      a DynamicArray pointer.
  */
-DynamicArray *get_operands_array(char *command_content, DynamicArray *symbols_table) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    DynamicArray *parameters_positions_array;
+DynamicArray *get_operands_array(ProgramLine *line, DynamicArray *symbols_table) {
+    DynamicArray *positions_array = line->positions_array;
     DynamicArray *operands_array;
 
     Operand *temp_operand;
     Field temp_field;
 
-    int name_index = get_name_field_index(command_content);
+    int name_index = find_name_field_index(positions_array);
     int index;
-    char delimiters[] = " ,"; /* separating characters */
-    char *parameters_part;
-
-    /* get the part of the command that contains the parameters only */
-    parameters_part = command_content + GET_ELEMENT(positions_array, Field*, name_index).end + 1;
-    parameters_part = parameters_part + strspn(parameters_part, delimiters);
 
-    parameters_positions_array = get_positions_array(parameters_part);
     operands_array = create_dynamic_array();
 
-    /* create and add the Operand structures to the operands array */
-    for (index = 0; index < (parameters_positions_array->length); index++) {
-        temp_field = GET_ELEMENT(parameters_positions_array, Field*, index);
-        temp_operand = malloc(sizeof(Operand));
+    /* create and add the Operand structures to the operands array, the operands are the fields after the name */
+    for (index = name_index + 1; index < (positions_array->length); index++) {
+        temp_field = GET_ELEMENT(positions_array, Field*, index);
+        /* the data of the operand is stored right after the structure */
+        temp_operand = malloc(sizeof(Operand) + (strlen(temp_field.content) + 1) * sizeof(char));
+        temp_operand->data = (char *) (temp_operand + 1);
 
         strcpy(temp_operand->data, temp_field.content);
-        temp_operand->addressing = get_operand_addressing_code(temp_operand->data);
+        temp_operand->id = temp_field.id;
+        temp_operand->value = temp_field.value;
+        temp_operand->addressing = get_field_addressing_code(&temp_field);
         temp_operand->start = temp_field.start;
         temp_operand->end = temp_field.end;
 
-        if (symbols_table != NULL) {
-            temp_operand->ARE = get_operand_ARE_code(temp_operand->data, symbols_table);
-        }
+        /* the A.R.E code of a label is known only after the symbols table was built */
+        temp_operand->ARE = (symbols_table != NULL) ? get_operand_ARE_code(temp_operand->id, symbols_table) :
+                            ARE_ABSOLUTE_CODE;
         add_element(operands_array, temp_operand);
     }
-
-    free_dynamic_array(positions_array);
-    free_dynamic_array(parameters_positions_array);
     return operands_array;
 }
\ No newline at end of file
@@ -1,54 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "quantities.h"
 #include "absolutes.h"
 #include "command_analysis/command_analysis.h"
 #include "error_detection/detector.h"
+#include "data_structures/string_pool.h"
+#include "segments.h"
+#include "build_cache.h"
+
+/*
+ * Returns a pointer to a new string that contains the given file path, followed
+ * by the given extension. The user should free the dynamic memory that was
+ * allocated to store the string in the end of the usage.
+ *
+ * Parameters:
+ * -----------
+ * char *file_path  a path to a file, without an extension.
+ * char *extension  the extension to add to the path.
+ */
+char *create_file_path(char *file_path, char *extension) {
+    size_t path_length = strlen(file_path);
+    size_t extension_length = strlen(extension);
+    char *path = malloc((path_length + extension_length + 1) * sizeof(char));
+
+    if (path == NULL) {
+        printf("Could not allocate memory for the path of the file!\n");
+        exit(0);
+    }
+    memcpy(path, file_path, path_length);
+    memcpy(path + path_length, extension, extension_length + 1);
+    return path;
+}
 
 /*
  * Given a path to a file that contains an Assembly program, the following function
  * checks for errors in the program and prints them. If there are no errors in the program,
- * the function creates the object, externals, entries and no macros files.
+ * the function creates the object, externals, entries and no macros files. If the program
+ * has not changed since it was assembled, its output files and errors are restored from
+ * the build cache instead, and otherwise they are stored in the cache.
  *
  * Parameters:
  * -----------
  * char *file_path  a path to a file that contains the program.
  */
 void compile(char *file_path) {
-    char input_file[MAX_FILE_NAME_LENGTH];
-    char output_file[MAX_FILE_NAME_LENGTH];
+    /* create the path of each file */
+    char *input_file = create_file_path(file_path, INPUT_CODE_FILE_EXTENSION);
+    char *no_macros_file_path = create_file_path(file_path, OUTPUT_NO_MACROS_FILE_EXTENSION);
+    char *object_file_path = create_file_path(file_path, OUTPUT_OBJECT_FILE_EXTENSION);
+    char *entries_file_path = create_file_path(file_path, OUTPUT_ENTRIES_FILE_EXTENSION);
+    char *externals_file_path = create_file_path(file_path, OUTPUT_EXTERNALS_FILE_EXTENSION);
+    char *binary_object_file_path = create_file_path(file_path, OUTPUT_BINARY_OBJECT_FILE_EXTENSION);
+    char *cache_entry_path = get_cache_entry_path(input_file);
 
-    char no_macros_file_path[MAX_FILE_NAME_LENGTH];
-    char object_file_path[MAX_FILE_NAME_LENGTH];
-    char entries_file_path[MAX_FILE_NAME_LENGTH];
-    char externals_file_path[MAX_FILE_NAME_LENGTH];
+    DynamicArray *program_lines; /* the lines of the program, that are lexed once when they are read */
+    DynamicArray *expanded_lines; /* the lines of the program after its macros were expanded */
 
     int error_exists;
+    int caching_flag = 0; /* indicates if the outputs of the program are stored in the build cache */
 
-    /* create the path of each output file */
-    strcpy(no_macros_file_path, file_path);
-    strcpy(object_file_path, file_path);
-    strcpy(entries_file_path, file_path);
-    strcpy(externals_file_path, file_path);
-
-    strcat(no_macros_file_path, OUTPUT_NO_MACROS_FILE_EXTENSION);
-    strcat(object_file_path, OUTPUT_OBJECT_FILE_EXTENSION);
-    strcat(entries_file_path, OUTPUT_ENTRIES_FILE_EXTENSION);
-    strcat(externals_file_path, OUTPUT_EXTERNALS_FILE_EXTENSION);
-
-    strcpy(input_file, file_path);
-    strcat(input_file, INPUT_CODE_FILE_EXTENSION);
-
-    strcpy(output_file, file_path);
-    strcat(output_file, OUTPUT_CODE_FILE_EXTENSION);
+    /* the errors of the previous program don't belong to this program */
+    ERROR_FLAG = 0;
+    /* the output files of a previous run are replaced by the output files of this run */
+    remove(no_macros_file_path);
+    remove(object_file_path);
+    remove(entries_file_path);
+    remove(externals_file_path);
+    remove(binary_object_file_path);
 
-    expand_macros(input_file, no_macros_file_path);
-    /* don't create the output files if there's an error in the program */
-    error_exists = detect(output_file);
-    if (error_exists) {
-        return;
+    if (cache_entry_path == NULL || !restore_cache_entry(cache_entry_path, file_path)) {
+        caching_flag = (cache_entry_path != NULL) && open_cache_entry(cache_entry_path);
+        /* the identifiers of the previous program are not used anymore */
+        reset_string_pool(&string_pool);
+        program_lines = get_program_lines(input_file);
+        expanded_lines = create_dynamic_array();
+        free_macros_table(expand_macros(program_lines, expanded_lines, no_macros_file_path));
+        /* don't create the output files if there's an error in the program */
+        error_exists = detect(expanded_lines);
+        if (!error_exists) {
+            /* create the output files */
+            create_object_file(expanded_lines, object_file_path);
+            create_entries_file(expanded_lines, entries_file_path);
+            create_externals_file(expanded_lines, externals_file_path);
+            if (BINARY_OBJECT_FLAG) {
+                create_binary_object_file(expanded_lines, binary_object_file_path);
+            }
+        }
+        free_array(expanded_lines);
+        free_program_lines(program_lines);
+        if (caching_flag) {
+            close_cache_entry(cache_entry_path, file_path);
+        }
     }
-    /* create the output files */
-    create_object_file(output_file, object_file_path);
-    create_entries_file(output_file, entries_file_path);
-    create_externals_file(output_file, externals_file_path);
+    free(input_file);
+    free(no_macros_file_path);
+    free(object_file_path);
+    free(entries_file_path);
+    free(externals_file_path);
+    free(binary_object_file_path);
+    free(cache_entry_path);
 }
@@ -1,10 +1,24 @@
 #ifndef ASSEMBLER_SIMULATOR_COMPILER_H
 #define ASSEMBLER_SIMULATOR_COMPILER_H
 
+/*
+ * Returns a pointer to a new string that contains the given file path, followed
+ * by the given extension. The user should free the dynamic memory that was
+ * allocated to store the string in the end of the usage.
+ *
+ * Parameters:
+ * -----------
+ * char *file_path  a path to a file, without an extension.
+ * char *extension  the extension to add to the path.
+ */
+char *create_file_path(char *file_path, char *extension);
+
 /*
  * Given a path to a file that contains an Assembly program, the following function
  * checks for errors in the program and prints them. If there are no errors in the program,
- * the function creates the object, externals, entries and no macros files.
+ * the function creates the object, externals, entries and no macros files. If the program
+ * has not changed since it was assembled, its output files and errors are restored from
+ * the build cache instead, and otherwise they are stored in the cache.
  *
  * Parameters:
  * -----------
@@ -113,4 +113,17 @@ void free_dynamic_array(DynamicArray *array) {
         free_all_elements(array); /* free the elements of the array before the array itself */
         free(array); /* free the array itself */
     }
+}
+
+/* Frees the dynamic memory that was allocated to contain the given
+ * array, without its elements. It is used for arrays that store
+ * pointers to elements that belong to another array.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *array  a pointer to a DynamicArray.
+ */
+void free_array(DynamicArray *array) {
+    free(array->array);
+    free(array);
 }
\ No newline at end of file
@@ -74,4 +74,12 @@ void free_all_elements(DynamicArray *array);
  */
 void free_dynamic_array(DynamicArray *array);
 
+/* Frees the dynamic memory that was allocated to contain the given
+ * array, without its elements. It is used for arrays that store
+ * pointers to elements that belong to another array.
+ * Parameters:
+ * DynamicArray *array  a pointer to a DynamicArray.
+ */
+void free_array(DynamicArray *array);
+
 #endif
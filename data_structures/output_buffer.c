@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <string.h>
+#include "output_buffer.h"
+
+/*
+ * Makes the given output buffer empty, without changing its buffer.
+ *
+ * Parameters:
+ * -----------
+ * OutputBuffer *output     a pointer to the output buffer.
+ */
+void reset_output(OutputBuffer *output) {
+    output->length = 0;
+    if ((output->capacity) > 0) {
+        (output->buffer)[0] = '\0';
+    }
+}
+
+/*
+ * Appends the given string to the text of the given output buffer. The characters
+ * that don't fit in the buffer are not stored, but they are counted in its length.
+ *
+ * Parameters:
+ * -----------
+ * OutputBuffer *output     a pointer to the output buffer.
+ * const char *text         the string to append.
+ */
+void append_output(OutputBuffer *output, const char *text) {
+    size_t text_length = strlen(text);
+    size_t stored_length; /* the number of characters that fit in the buffer */
+
+    if ((output->length) + 1 < (output->capacity)) {
+        stored_length = (output->capacity) - (output->length) - 1;
+        if (stored_length > text_length) {
+            stored_length = text_length;
+        }
+        memcpy((output->buffer) + (output->length), text, stored_length);
+        (output->buffer)[(output->length) + stored_length] = '\0';
+    }
+    output->length += text_length;
+}
+
+/*
+ * Appends the decimal text of the given number to the text of the given output buffer.
+ *
+ * Parameters:
+ * -----------
+ * OutputBuffer *output     a pointer to the output buffer.
+ * int number               the number to append.
+ */
+void append_output_number(OutputBuffer *output, int number) {
+    char text[MAX_NUMBER_TEXT_LENGTH + 1];
+
+    sprintf(text, "%d", number);
+    append_output(output, text);
+}
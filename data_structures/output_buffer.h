@@ -0,0 +1,51 @@
+#ifndef ASSEMBLER_SIMULATOR_OUTPUT_BUFFER_H
+#define ASSEMBLER_SIMULATOR_OUTPUT_BUFFER_H
+
+#include <stddef.h>
+
+#define MAX_NUMBER_TEXT_LENGTH 12 /* the maximum number of characters in the decimal text of an int */
+
+/*
+ * The structure OutputBuffer stores text in a buffer that is owned by the user,
+ * and never grows. Text that doesn't fit in the buffer is truncated, but the
+ * 'length' field stores the total length of the text that was appended, so the
+ * user can tell that the text was truncated and how large the buffer should be.
+ * The text in the buffer is always null-terminated (if its capacity is not 0).
+ */
+typedef struct {
+    char *buffer; /* the characters of the text, owned by the user */
+    size_t capacity; /* the number of characters in the buffer, including the null terminator */
+    size_t length; /* the length of the text that was appended, even if it was truncated */
+} OutputBuffer;
+
+/*
+ * Makes the given output buffer empty, without changing its buffer.
+ *
+ * Parameters:
+ * -----------
+ * OutputBuffer *output     a pointer to the output buffer.
+ */
+void reset_output(OutputBuffer *output);
+
+/*
+ * Appends the given string to the text of the given output buffer. The characters
+ * that don't fit in the buffer are not stored, but they are counted in its length.
+ *
+ * Parameters:
+ * -----------
+ * OutputBuffer *output     a pointer to the output buffer.
+ * const char *text         the string to append.
+ */
+void append_output(OutputBuffer *output, const char *text);
+
+/*
+ * Appends the decimal text of the given number to the text of the given output buffer.
+ *
+ * Parameters:
+ * -----------
+ * OutputBuffer *output     a pointer to the output buffer.
+ * int number               the number to append.
+ */
+void append_output_number(OutputBuffer *output, int number);
+
+#endif
@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "segment.h"
+
+#define INITIAL_SEGMENT_CAPACITY 64 /* the number of words that a segment can store after its first growth */
+
+/*
+ * Stores the given word in the given index of the segment. If the index is
+ * beyond the capacity of the segment, the segment grows to contain it, and if
+ * the index is negative, the function prints an error and exits.
+ *
+ * Parameters:
+ * -----------
+ * Segment *segment     a pointer to the segment to write the word to.
+ * int index            the index of the word in the segment.
+ * unsigned int word    the word to store.
+ */
+void write_word(Segment *segment, int index, unsigned int word) {
+    int new_capacity;
+
+    if (index < 0) {
+        printf("The given index (index = %d) is not in the boundaries of the segment!\n", index);
+        exit(0);
+    }
+    if (index >= (segment->capacity)) {
+        new_capacity = (segment->capacity) ? (segment->capacity) : INITIAL_SEGMENT_CAPACITY;
+        while (new_capacity <= index) {
+            new_capacity *= 2;
+        }
+        segment->words = realloc(segment->words, new_capacity * sizeof(unsigned short));
+        if (segment->words == NULL) {
+            printf("Could not allocate memory for the segment!\n");
+            exit(0);
+        }
+        /* the words between the old end and the new end are empty */
+        memset(segment->words + segment->capacity, 0, (new_capacity - segment->capacity) * sizeof(unsigned short));
+        segment->capacity = new_capacity;
+    }
+    (segment->words)[index] = (unsigned short) word;
+    if (index >= (segment->length)) {
+        segment->length = index + 1;
+    }
+}
+
+/*
+ * Returns the word in the given index of the segment. If the index is not
+ * in the boundaries of the segment, the function prints an error and exits.
+ *
+ * Parameters:
+ * -----------
+ * Segment *segment     a pointer to the segment to read the word from.
+ * int index            the index of the word in the segment.
+ */
+unsigned int read_word(Segment *segment, int index) {
+    if (index < 0 || index >= (segment->length)) {
+        printf("The given index (index = %d) is not in the boundaries of the segment!\n", index);
+        exit(0);
+    }
+    return (segment->words)[index];
+}
+
+/*
+ * Removes all the words from the segment. The memory of the segment
+ * is kept, so that it could be used again without growing.
+ *
+ * Parameters:
+ * -----------
+ * Segment *segment     a pointer to a Segment.
+ */
+void reset_segment(Segment *segment) {
+    if (segment->words != NULL) {
+        memset(segment->words, 0, (segment->length) * sizeof(unsigned short));
+    }
+    segment->length = 0;
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the words
+ * of the segment, and makes it an empty segment.
+ *
+ * Parameters:
+ * -----------
+ * Segment *segment     a pointer to a Segment.
+ */
+void free_segment(Segment *segment) {
+    free(segment->words);
+    segment->words = NULL;
+    segment->length = 0;
+    segment->capacity = 0;
+}
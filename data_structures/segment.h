@@ -0,0 +1,62 @@
+#ifndef ASSEMBLER_SIMULATOR_SEGMENT_H
+#define ASSEMBLER_SIMULATOR_SEGMENT_H
+
+/*
+ * The structure Segment stores the memory words of a segment of the program
+ * (the code segment or the data segment). Each memory word is 12 bits long,
+ * and therefore the words are packed in 16 bits. The 'words' array grows
+ * automatically when a word is written beyond its capacity, and the 'length'
+ * field stores the number of words that were written to the segment. A
+ * Segment with all its fields set to zero is an empty segment.
+ */
+typedef struct {
+    unsigned short *words; /* the memory words of the segment */
+    int length; /* the number of words in the segment */
+    int capacity; /* the number of words that can be stored before the array has to grow */
+} Segment;
+
+/*
+ * Stores the given word in the given index of the segment. If the index is
+ * beyond the capacity of the segment, the segment grows to contain it, and if
+ * the index is negative, the function prints an error and exits.
+ *
+ * Parameters:
+ * -----------
+ * Segment *segment     a pointer to the segment to write the word to.
+ * int index            the index of the word in the segment.
+ * unsigned int word    the word to store.
+ */
+void write_word(Segment *segment, int index, unsigned int word);
+
+/*
+ * Returns the word in the given index of the segment. If the index is not
+ * in the boundaries of the segment, the function prints an error and exits.
+ *
+ * Parameters:
+ * -----------
+ * Segment *segment     a pointer to the segment to read the word from.
+ * int index            the index of the word in the segment.
+ */
+unsigned int read_word(Segment *segment, int index);
+
+/*
+ * Removes all the words from the segment. The memory of the segment
+ * is kept, so that it could be used again without growing.
+ *
+ * Parameters:
+ * -----------
+ * Segment *segment     a pointer to a Segment.
+ */
+void reset_segment(Segment *segment);
+
+/*
+ * Frees the dynamic memory that was allocated to contain the words
+ * of the segment, and makes it an empty segment.
+ *
+ * Parameters:
+ * -----------
+ * Segment *segment     a pointer to a Segment.
+ */
+void free_segment(Segment *segment);
+
+#endif
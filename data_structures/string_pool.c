@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "string_pool.h"
+
+#define INITIAL_NO_OF_BUCKETS 64 /* the number of buckets of the hash table after its first growth */
+#define FNV_OFFSET_BASIS 2166136261u /* the initial value of the FNV-1a hash */
+#define FNV_PRIME 16777619u /* the multiplier of the FNV-1a hash */
+
+/*
+ * Returns the FNV-1a hash of the given characters.
+ *
+ * Parameters:
+ * -----------
+ * char *string     the characters to hash.
+ * int length       the number of characters to hash.
+ */
+unsigned int hash_string(char *string, int length) {
+    unsigned int hash = FNV_OFFSET_BASIS;
+    int index;
+
+    for (index = 0; index < length; index++) {
+        hash ^= (unsigned char) string[index];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/*
+ * Returns the index of the bucket of the given string in the hash table of the pool.
+ * If the string is in the pool, the bucket stores its id, and otherwise, the bucket
+ * is the empty bucket where the string should be stored.
+ *
+ * Parameters:
+ * -----------
+ * StringPool *pool     a pointer to the pool.
+ * char *string         the characters of the string.
+ * int length           the number of characters in the string.
+ * unsigned int hash    the hash of the string.
+ */
+int find_bucket(StringPool *pool, char *string, int length, unsigned int hash) {
+    unsigned int mask = (pool->no_of_buckets) - 1;
+    unsigned int index = hash & mask;
+    int id;
+
+    while ((id = (pool->buckets)[index]) != NO_STRING_ID) {
+        if ((pool->hashes)[id] == hash && strncmp((pool->strings)[id], string, length) == 0 &&
+            (pool->strings)[id][length] == 0) {
+            break;
+        }
+        /* linear probing */
+        index = (index + 1) & mask;
+    }
+    return (int) index;
+}
+
+/*
+ * Doubles the number of buckets in the hash table of the pool, and
+ * stores the id of each string of the pool in its new bucket.
+ *
+ * Parameters:
+ * -----------
+ * StringPool *pool     a pointer to the pool.
+ */
+void grow_buckets(StringPool *pool) {
+    int index;
+    unsigned int mask;
+    unsigned int bucket;
+
+    pool->no_of_buckets = (pool->no_of_buckets) ? 2 * (pool->no_of_buckets) : INITIAL_NO_OF_BUCKETS;
+    free(pool->buckets);
+    pool->buckets = malloc((pool->no_of_buckets) * sizeof(int));
+    if (pool->buckets == NULL) {
+        printf("Could not allocate memory for the string pool!\n");
+        exit(0);
+    }
+    for (index = 0; index < (pool->no_of_buckets); index++) {
+        (pool->buckets)[index] = NO_STRING_ID;
+    }
+    mask = (pool->no_of_buckets) - 1;
+    for (index = 0; index < (pool->length); index++) {
+        bucket = (pool->hashes)[index] & mask;
+        while ((pool->buckets)[bucket] != NO_STRING_ID) {
+            bucket = (bucket + 1) & mask;
+        }
+        (pool->buckets)[bucket] = index;
+    }
+}
+
+/*
+ * Returns the id of the given string in the pool. If the string is not
+ * in the pool, a copy of it is added to the pool and gets a new id.
+ *
+ * Parameters:
+ * -----------
+ * StringPool *pool     a pointer to the pool.
+ * char *string         the characters of the string, not necessarily null-terminated.
+ * int length           the number of characters in the string.
+ */
+int intern_string(StringPool *pool, char *string, int length) {
+    unsigned int hash = hash_string(string, length);
+    int bucket;
+    int id;
+
+    /* keep the hash table at most half full */
+    if (2 * ((pool->length) + 1) > (pool->no_of_buckets)) {
+        grow_buckets(pool);
+    }
+    bucket = find_bucket(pool, string, length, hash);
+    if ((pool->buckets)[bucket] != NO_STRING_ID) {
+        return (pool->buckets)[bucket];
+    }
+    /* the string is not in the pool */
+    if ((pool->length) == (pool->capacity)) {
+        pool->capacity = (pool->capacity) ? 2 * (pool->capacity) : INITIAL_NO_OF_BUCKETS;
+        pool->strings = realloc(pool->strings, (pool->capacity) * sizeof(char *));
+        pool->hashes = realloc(pool->hashes, (pool->capacity) * sizeof(unsigned int));
+        if (pool->strings == NULL || pool->hashes == NULL) {
+            printf("Could not allocate memory for the string pool!\n");
+            exit(0);
+        }
+    }
+    id = (pool->length);
+    (pool->strings)[id] = malloc((length + 1) * sizeof(char));
+    memcpy((pool->strings)[id], string, length);
+    (pool->strings)[id][length] = 0;
+    (pool->hashes)[id] = hash;
+    (pool->buckets)[bucket] = id;
+    pool->length += 1;
+    return id;
+}
+
+/*
+ * Returns the id of the given string in the pool, and NO_STRING_ID
+ * if the string is not in the pool. The string is not added to the pool.
+ *
+ * Parameters:
+ * -----------
+ * StringPool *pool     a pointer to the pool.
+ * char *string         a null-terminated string.
+ */
+int find_string_id(StringPool *pool, char *string) {
+    int length = (int) strlen(string);
+
+    if ((pool->no_of_buckets) == 0) {
+        return NO_STRING_ID;
+    }
+    return (pool->buckets)[find_bucket(pool, string, length, hash_string(string, length))];
+}
+
+/*
+ * Returns the string with the given id in the pool. The string is owned
+ * by the pool, and it is valid until the pool is reset.
+ *
+ * Parameters:
+ * -----------
+ * StringPool *pool     a pointer to the pool.
+ * int id               the id of the string.
+ */
+char *get_pool_string(StringPool *pool, int id) {
+    if (id < 0 || id >= (pool->length)) {
+        printf("The given id (id = %d) is not in the string pool!\n", id);
+        exit(0);
+    }
+    return (pool->strings)[id];
+}
+
+/*
+ * Removes all the strings from the pool and frees their memory. The ids
+ * that were given before the reset must not be used after it.
+ *
+ * Parameters:
+ * -----------
+ * StringPool *pool     a pointer to the pool.
+ */
+void reset_string_pool(StringPool *pool) {
+    int index;
+
+    for (index = 0; index < (pool->length); index++) {
+        free((pool->strings)[index]);
+    }
+    for (index = 0; index < (pool->no_of_buckets); index++) {
+        (pool->buckets)[index] = NO_STRING_ID;
+    }
+    pool->length = 0;
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the strings and
+ * the hash table of the pool, and makes it an empty pool.
+ *
+ * Parameters:
+ * -----------
+ * StringPool *pool     a pointer to the pool.
+ */
+void free_string_pool(StringPool *pool) {
+    reset_string_pool(pool);
+    free(pool->strings);
+    free(pool->hashes);
+    free(pool->buckets);
+    memset(pool, 0, sizeof(StringPool));
+}
@@ -0,0 +1,80 @@
+#ifndef ASSEMBLER_SIMULATOR_STRING_POOL_H
+#define ASSEMBLER_SIMULATOR_STRING_POOL_H
+
+#define NO_STRING_ID (-1) /* the id of a string that is not stored in the pool */
+
+/*
+ * The structure StringPool stores a single copy of each distinct string that
+ * was interned into it, and gives each string a small integer id, which is its
+ * index in the 'strings' array. The 'buckets' array is an open addressing hash
+ * table of ids, so that interning a string and finding its id takes constant
+ * time on average. Two strings in the pool are equal only if their ids are equal.
+ * A StringPool with all its fields set to zero is an empty pool.
+ */
+typedef struct {
+    char **strings; /* the strings of the pool, in the order of their ids */
+    unsigned int *hashes; /* the hash of each string of the pool */
+    int length; /* the number of strings in the pool */
+    int capacity; /* the number of strings that can be stored before the arrays have to grow */
+    int *buckets; /* the hash table of the pool, each bucket stores an id or NO_STRING_ID */
+    int no_of_buckets; /* the number of buckets in the hash table, always a power of 2 */
+} StringPool;
+
+/* the pool of the identifiers (labels, macros and operations names) of the program */
+extern StringPool string_pool;
+
+/*
+ * Returns the id of the given string in the pool. If the string is not
+ * in the pool, a copy of it is added to the pool and gets a new id.
+ *
+ * Parameters:
+ * -----------
+ * StringPool *pool     a pointer to the pool.
+ * char *string         the characters of the string, not necessarily null-terminated.
+ * int length           the number of characters in the string.
+ */
+int intern_string(StringPool *pool, char *string, int length);
+
+/*
+ * Returns the id of the given string in the pool, and NO_STRING_ID
+ * if the string is not in the pool. The string is not added to the pool.
+ *
+ * Parameters:
+ * -----------
+ * StringPool *pool     a pointer to the pool.
+ * char *string         a null-terminated string.
+ */
+int find_string_id(StringPool *pool, char *string);
+
+/*
+ * Returns the string with the given id in the pool. The string is owned
+ * by the pool, and it is valid until the pool is reset.
+ *
+ * Parameters:
+ * -----------
+ * StringPool *pool     a pointer to the pool.
+ * int id               the id of the string.
+ */
+char *get_pool_string(StringPool *pool, int id);
+
+/*
+ * Removes all the strings from the pool and frees their memory. The ids
+ * that were given before the reset must not be used after it.
+ *
+ * Parameters:
+ * -----------
+ * StringPool *pool     a pointer to the pool.
+ */
+void reset_string_pool(StringPool *pool);
+
+/*
+ * Frees the dynamic memory that was allocated to contain the strings and
+ * the hash table of the pool, and makes it an empty pool.
+ *
+ * Parameters:
+ * -----------
+ * StringPool *pool     a pointer to the pool.
+ */
+void free_string_pool(StringPool *pool);
+
+#endif
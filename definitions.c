@@ -1,7 +1,11 @@
+#include <stdio.h>
 #include "types.h"
 #include "absolutes.h"
 #include "quantities.h"
 #include "function_macros.h"
+#include "data_structures/segment.h"
+#include "data_structures/output_buffer.h"
+#include "data_structures/string_pool.h"
 #include "error_detection/errors.h"
 
 /* the instruction counter of the program */
@@ -14,11 +18,20 @@ int final_DC;
 int LOAD_ADDRESS = 100;
 /* indicates if an error has occurred in the program */
 int ERROR_FLAG = 0;
+/* indicates if the binary object file of the program is created */
+int BINARY_OBJECT_FLAG = 0;
+/* the stream that the errors of the program are copied to, or NULL if they are only printed */
+FILE *diagnostics_file = NULL;
+/* the buffer that the errors of the program are appended to instead of being printed, or NULL */
+OutputBuffer *diagnostics_buffer = NULL;
 
 /* the encoding of the program's code */
-unsigned int code_segment[MAX_NO_OF_COMMANDS][1];
+Segment code_segment;
 /* the encoding of the program's data */
-unsigned int data_segment[MAX_NO_OF_COMMANDS][1];
+Segment data_segment;
+
+/* the pool of the identifiers (labels, macros and operations names) of the program */
+StringPool string_pool;
 
 /* the names of all the possible registers */
 const char registers_names[NO_OF_REGISTERS][MAX_REGISTER_NAME_LENGTH + 1] = {
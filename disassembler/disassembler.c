@@ -0,0 +1,352 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "disassembler.h"
+#include "../absolutes.h"
+#include "../segments.h"
+#include "../command_analysis/command_analysis.h"
+#include "../command_analysis/helpers.h"
+
+/* the decoding template of every value of a first word of a command */
+DecodingTemplate decoding_table[DECODING_TABLE_SIZE];
+/* indicates if the decoding table has already been built */
+int decoding_table_built = 0;
+
+/*
+ * Fills the decoding table with the decoding template of every value of a first
+ * word. The templates are built from the operations table and the encoding table
+ * of the assembler, so only the combinations of an operation and addressing methods
+ * that the assembler accepts are decoded as commands.
+ */
+void build_decoding_table() {
+    const int addressing_codes[NO_OF_ADDRESSING_INDEXES] = {0, IMMEDIATE_ADDRESSING_CODE, LABEL_ADDRESSING_CODE,
+                                                            REGISTER_ADDRESSING_CODE};
+    const EncodingTemplate *template;
+    DecodingTemplate *decoding;
+    Operation operation;
+    int no_of_src_operands;
+    int no_of_dest_operands;
+    int index;
+    int src_index;
+    int dest_index;
+
+    for (index = 0; index < DECODING_TABLE_SIZE; index++) {
+        decoding_table[index].opcode = NO_OPCODE;
+    }
+    for (index = 0; index < NO_OF_OPERATIONS; index++) {
+        operation = operations[index];
+        /* a command with a single operand has only a destination operand */
+        no_of_src_operands = (operation.type == COMMAND_WITH_2_PARAMETERS_CODE);
+        no_of_dest_operands = (operation.type != COMMAND_WITH_0_PARAMETERS_CODE);
+        for (src_index = 0; src_index < NO_OF_ADDRESSING_INDEXES; src_index++) {
+            for (dest_index = 0; dest_index < NO_OF_ADDRESSING_INDEXES; dest_index++) {
+                if ((src_index != NO_OPERAND_ADDRESSING_INDEX) != no_of_src_operands ||
+                    (dest_index != NO_OPERAND_ADDRESSING_INDEX) != no_of_dest_operands ||
+                    (no_of_src_operands && !is_addressing_method(addressing_codes[src_index],
+                                                                 operation.source_operand_addressing,
+                                                                 NO_OF_ADDRESSING_METHODS)) ||
+                    (no_of_dest_operands && !is_addressing_method(addressing_codes[dest_index],
+                                                                  operation.destination_operand_addressing,
+                                                                  NO_OF_ADDRESSING_METHODS))) {
+                    continue;
+                }
+                template = get_encoding_template(operation.opcode, addressing_codes[src_index],
+                                                 addressing_codes[dest_index]);
+                decoding = &decoding_table[template->first_word & MEMORY_WORD_MASK];
+                decoding->opcode = operation.opcode;
+                decoding->src_addressing = addressing_codes[src_index];
+                decoding->dest_addressing = addressing_codes[dest_index];
+                decoding->memory_words = template->memory_words;
+            }
+        }
+    }
+    decoding_table_built = 1;
+}
+
+/*
+ * Returns a pointer to the decoding template of the given first word of a command.
+ *
+ * Parameters:
+ * -----------
+ * unsigned int word    the first word of the command.
+ */
+const DecodingTemplate *get_decoding_template(unsigned int word) {
+    if (!decoding_table_built) {
+        build_decoding_table();
+    }
+    return &decoding_table[word & MEMORY_WORD_MASK];
+}
+
+/*
+ * Returns a pointer to a new Disassembly of the given image, with the names of its
+ * entry labels and the names of the external labels in their use addresses. The user
+ * should free it with 'free_disassembly'.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the loaded program.
+ */
+Disassembly *create_disassembly(MachineImage *image) {
+    Disassembly *disassembly = calloc(1, sizeof(Disassembly));
+    LoadedSymbols *symbols;
+    char *name;
+    int index;
+
+    if (disassembly == NULL || (disassembly->label_ids = malloc(MACHINE_MEMORY_SIZE * sizeof(int))) == NULL ||
+        (disassembly->external_ids = malloc(MACHINE_MEMORY_SIZE * sizeof(int))) == NULL ||
+        (disassembly->command_starts = calloc(MACHINE_MEMORY_SIZE, sizeof(unsigned char))) == NULL) {
+        printf("Could not allocate memory for the disassembly!\n");
+        exit(0);
+    }
+    disassembly->image = image;
+    for (index = 0; index < MACHINE_MEMORY_SIZE; index++) {
+        (disassembly->label_ids)[index] = NO_STRING_ID;
+        (disassembly->external_ids)[index] = NO_STRING_ID;
+    }
+    symbols = &(image->entries);
+    for (index = 0; index < (symbols->length); index++) {
+        name = get_pool_string(&(symbols->names), (symbols->ids)[index]);
+        if ((symbols->addresses)[index] < MACHINE_MEMORY_SIZE) {
+            (disassembly->label_ids)[(symbols->addresses)[index]] =
+                    intern_string(&(disassembly->names), name, (int) strlen(name));
+        }
+    }
+    symbols = &(image->externals);
+    for (index = 0; index < (symbols->length); index++) {
+        name = get_pool_string(&(symbols->names), (symbols->ids)[index]);
+        if ((symbols->addresses)[index] < MACHINE_MEMORY_SIZE) {
+            (disassembly->external_ids)[(symbols->addresses)[index]] =
+                    intern_string(&(disassembly->names), name, (int) strlen(name));
+        }
+    }
+    return disassembly;
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the given disassembly
+ * (but not its image), and in the end frees the disassembly itself.
+ *
+ * Parameters:
+ * -----------
+ * Disassembly *disassembly     a pointer to the disassembly.
+ */
+void free_disassembly(Disassembly *disassembly) {
+    free_string_pool(&(disassembly->names));
+    free(disassembly->label_ids);
+    free(disassembly->external_ids);
+    free(disassembly->command_starts);
+    free(disassembly);
+}
+
+/*
+ * Returns the id of the name of the label that is defined in the given address. If
+ * the address has no label, a label with a generated name ('L' and the address) is
+ * added to it.
+ *
+ * Parameters:
+ * -----------
+ * Disassembly *disassembly     a pointer to the disassembly.
+ * int address                  the address of the label.
+ */
+int get_address_label(Disassembly *disassembly, int address) {
+    char name[MAX_GENERATED_LABEL_LENGTH + 1];
+
+    if ((disassembly->label_ids)[address] == NO_STRING_ID) {
+        sprintf(name, "%c%d", GENERATED_LABEL_PREFIX, address);
+        (disassembly->label_ids)[address] = intern_string(&(disassembly->names), name, (int) strlen(name));
+    }
+    return (disassembly->label_ids)[address];
+}
+
+/*
+ * Decodes the code words of the program in a single sweep: the first word of each
+ * command is decoded with the decoding table, the address of the command is marked,
+ * and the address of each relocatable label operand gets a label.
+ *
+ * Parameters:
+ * -----------
+ * Disassembly *disassembly     a pointer to the disassembly.
+ */
+void scan_commands(Disassembly *disassembly) {
+    unsigned short *memory = disassembly->image->memory;
+    int code_end = (disassembly->image->load_address) + (disassembly->image->code_words);
+    const DecodingTemplate *template;
+    int address = disassembly->image->load_address;
+    int index;
+
+    while (address < code_end) {
+        template = get_decoding_template(memory[address]);
+        if ((template->opcode) == NO_OPCODE || address + (template->memory_words) > code_end) {
+            /* an unknown word is skipped alone */
+            address++;
+            continue;
+        }
+        (disassembly->command_starts)[address] = 1;
+        for (index = 1; index < (template->memory_words); index++) {
+            if (decode_bit_field(memory[address + index], ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT) ==
+                ARE_RELOCATABLE_CODE) {
+                get_address_label(disassembly, decode_bit_field(memory[address + index], ENCODING_OPERAND_LENGTH,
+                                                                ENCODING_OPERAND_SHIFT));
+            }
+        }
+        address += template->memory_words;
+    }
+}
+
+/*
+ * Prints the operand that is encoded in the given memory word, with the given
+ * addressing method.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly.
+ * int addressing               the addressing code of the operand.
+ * int address                  the address of the memory word of the operand.
+ * int register_shift           the index of the first bit of a register in the memory word.
+ */
+void print_operand(FILE *output, Disassembly *disassembly, int addressing, int address, int register_shift) {
+    unsigned int word = (disassembly->image->memory)[address];
+    int value = decode_bit_field(word, ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT);
+    int ARE = decode_bit_field(word, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT);
+
+    if (addressing == REGISTER_ADDRESSING_CODE) {
+        fprintf(output, "%s", registers_names[decode_bit_field(word, ENCODING_REGISTER_LENGTH, register_shift) %
+                                              NO_OF_REGISTERS]);
+    } else if (addressing == IMMEDIATE_ADDRESSING_CODE) {
+        /* an immediate value is a signed number in the bits of the operand */
+        if (value >= (1 << (ENCODING_OPERAND_LENGTH - 1))) {
+            value -= (1 << ENCODING_OPERAND_LENGTH);
+        }
+        fprintf(output, "%d", value);
+    } else if (ARE == ARE_EXTERNAL_CODE && (disassembly->external_ids)[address] != NO_STRING_ID) {
+        fprintf(output, "%s", get_pool_string(&(disassembly->names), (disassembly->external_ids)[address]));
+    } else if (ARE == ARE_EXTERNAL_CODE) {
+        /* an external label without an externals file is named after its use */
+        fprintf(output, "%c%d", GENERATED_LABEL_PREFIX, address);
+    } else {
+        fprintf(output, "%s", get_pool_string(&(disassembly->names), get_address_label(disassembly, value)));
+    }
+}
+
+/*
+ * Prints the command that starts in the given address, with its label.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly.
+ * int address                  the address of the first word of the command.
+ */
+void print_command(FILE *output, Disassembly *disassembly, int address) {
+    const DecodingTemplate *template = get_decoding_template((disassembly->image->memory)[address]);
+    int operand_address = address + 1;
+
+    if ((disassembly->label_ids)[address] != NO_STRING_ID) {
+        fprintf(output, "%s%c ", get_pool_string(&(disassembly->names), (disassembly->label_ids)[address]),
+                LABEL_ENDING_CHARACTER);
+    }
+    fprintf(output, "%s", operations[template->opcode].name);
+    if ((template->src_addressing) != 0) {
+        fprintf(output, " ");
+        print_operand(output, disassembly, template->src_addressing, operand_address, ENCODING_SRC_REGISTER_SHIFT);
+        fprintf(output, ", ");
+        /* two registers are stored in the same memory word */
+        if ((template->src_addressing) != REGISTER_ADDRESSING_CODE ||
+            (template->dest_addressing) != REGISTER_ADDRESSING_CODE) {
+            operand_address++;
+        }
+    } else if ((template->dest_addressing) != 0) {
+        fprintf(output, " ");
+    }
+    if ((template->dest_addressing) != 0) {
+        print_operand(output, disassembly, template->dest_addressing, operand_address, ENCODING_DEST_REGISTER_SHIFT);
+    }
+    fprintf(output, "\n");
+}
+
+/*
+ * Prints the data words of the program as .data declarations. A new declaration
+ * starts in every address that has a label.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly.
+ */
+void print_data(FILE *output, Disassembly *disassembly) {
+    int data_start = (disassembly->image->load_address) + (disassembly->image->code_words);
+    int data_end = data_start + (disassembly->image->data_words);
+    int values_in_line = 0;
+    int address;
+    int value;
+
+    for (address = data_start; address < data_end; address++) {
+        if ((disassembly->label_ids)[address] != NO_STRING_ID || values_in_line == DATA_VALUES_PER_LINE) {
+            if (values_in_line > 0) {
+                fprintf(output, "\n");
+            }
+            values_in_line = 0;
+        }
+        if (values_in_line == 0) {
+            if ((disassembly->label_ids)[address] != NO_STRING_ID) {
+                fprintf(output, "%s%c ", get_pool_string(&(disassembly->names), (disassembly->label_ids)[address]),
+                        LABEL_ENDING_CHARACTER);
+            }
+            fprintf(output, "%s ", DATA_DEFINITION_NAME);
+        } else {
+            fprintf(output, ", ");
+        }
+        /* a data word is a signed number in all its bits */
+        value = (disassembly->image->memory)[address] & MEMORY_WORD_MASK;
+        if (value > (MEMORY_WORD_MASK >> 1)) {
+            value -= MEMORY_WORD_MASK + 1;
+        }
+        fprintf(output, "%d", value);
+        values_in_line++;
+    }
+    if (values_in_line > 0) {
+        fprintf(output, "\n");
+    }
+}
+
+/*
+ * Prints the given loaded program as assembly code: its entry and external
+ * declarations, its commands and its data. Labels get their names from the entries
+ * file and the externals file, and any other address that is used by a label operand
+ * gets a generated label, so the printed program is assembled to the same words.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output         the file to print to.
+ * MachineImage *image  a pointer to the loaded program.
+ */
+void disassemble(FILE *output, MachineImage *image) {
+    Disassembly *disassembly = create_disassembly(image);
+    int code_end = (image->load_address) + (image->code_words);
+    int address;
+    int index;
+
+    scan_commands(disassembly);
+    for (index = 0; index < (image->entries.length); index++) {
+        fprintf(output, "%s %s\n", ENTRY_DEFINITION_NAME,
+                get_pool_string(&(image->entries.names), (image->entries.ids)[index]));
+    }
+    for (index = 0; index < (image->externals.names.length); index++) {
+        fprintf(output, "%s %s\n", EXTERN_DEFINITION_NAME, get_pool_string(&(image->externals.names), index));
+    }
+    address = image->load_address;
+    while (address < code_end) {
+        if ((disassembly->command_starts)[address]) {
+            print_command(output, disassembly, address);
+            address += get_decoding_template((image->memory)[address])->memory_words;
+        } else {
+            /* a word that is not a part of a valid command */
+            fprintf(output, "%c word %d: %d\n", COMMENT_STARTING_CHARACTER, address,
+                    (image->memory)[address] & MEMORY_WORD_MASK);
+            address++;
+        }
+    }
+    print_data(output, disassembly);
+    free_disassembly(disassembly);
+}
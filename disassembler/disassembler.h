@@ -0,0 +1,123 @@
+#ifndef ASSEMBLER_SIMULATOR_DISASSEMBLER_H
+#define ASSEMBLER_SIMULATOR_DISASSEMBLER_H
+
+#include <stdio.h>
+#include "../types.h"
+
+#define NO_OPCODE (-1) /* the opcode of a word that is not a first word of a valid command */
+#define DECODING_TABLE_SIZE (MEMORY_WORD_MASK + 1) /* the number of values of a memory word */
+#define DATA_VALUES_PER_LINE 8 /* the maximum number of values in a line of a .data declaration */
+#define GENERATED_LABEL_PREFIX 'L' /* the first character of the name of a label that has no name in the files */
+#define MAX_GENERATED_LABEL_LENGTH 12 /* the maximum number of characters in the name of a generated label */
+
+/*
+ * Fills the decoding table with the decoding template of every value of a first
+ * word. The templates are built from the operations table and the encoding table
+ * of the assembler, so only the combinations of an operation and addressing methods
+ * that the assembler accepts are decoded as commands.
+ */
+void build_decoding_table();
+
+/*
+ * Returns a pointer to the decoding template of the given first word of a command.
+ *
+ * Parameters:
+ * -----------
+ * unsigned int word    the first word of the command.
+ */
+const DecodingTemplate *get_decoding_template(unsigned int word);
+
+/*
+ * Returns a pointer to a new Disassembly of the given image, with the names of its
+ * entry labels and the names of the external labels in their use addresses. The user
+ * should free it with 'free_disassembly'.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the loaded program.
+ */
+Disassembly *create_disassembly(MachineImage *image);
+
+/*
+ * Frees the dynamic memory that was allocated to contain the given disassembly
+ * (but not its image), and in the end frees the disassembly itself.
+ *
+ * Parameters:
+ * -----------
+ * Disassembly *disassembly     a pointer to the disassembly.
+ */
+void free_disassembly(Disassembly *disassembly);
+
+/*
+ * Returns the id of the name of the label that is defined in the given address. If
+ * the address has no label, a label with a generated name ('L' and the address) is
+ * added to it.
+ *
+ * Parameters:
+ * -----------
+ * Disassembly *disassembly     a pointer to the disassembly.
+ * int address                  the address of the label.
+ */
+int get_address_label(Disassembly *disassembly, int address);
+
+/*
+ * Decodes the code words of the program in a single sweep: the first word of each
+ * command is decoded with the decoding table, the address of the command is marked,
+ * and the address of each relocatable label operand gets a label.
+ *
+ * Parameters:
+ * -----------
+ * Disassembly *disassembly     a pointer to the disassembly.
+ */
+void scan_commands(Disassembly *disassembly);
+
+/*
+ * Prints the operand that is encoded in the given memory word, with the given
+ * addressing method.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly.
+ * int addressing               the addressing code of the operand.
+ * int address                  the address of the memory word of the operand.
+ * int register_shift           the index of the first bit of a register in the memory word.
+ */
+void print_operand(FILE *output, Disassembly *disassembly, int addressing, int address, int register_shift);
+
+/*
+ * Prints the command that starts in the given address, with its label.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly.
+ * int address                  the address of the first word of the command.
+ */
+void print_command(FILE *output, Disassembly *disassembly, int address);
+
+/*
+ * Prints the data words of the program as .data declarations. A new declaration
+ * starts in every address that has a label.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly.
+ */
+void print_data(FILE *output, Disassembly *disassembly);
+
+/*
+ * Prints the given loaded program as assembly code: its entry and external
+ * declarations, its commands and its data. Labels get their names from the entries
+ * file and the externals file, and any other address that is used by a label operand
+ * gets a generated label, so the printed program is assembled to the same words.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output         the file to print to.
+ * MachineImage *image  a pointer to the loaded program.
+ */
+void disassemble(FILE *output, MachineImage *image);
+
+#endif
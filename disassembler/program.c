@@ -0,0 +1,21 @@
+#include <stdio.h>
+#include "disassembler.h"
+#include "../absolutes.h"
+#include "../loader/loader.h"
+
+int main(int argc, char *argv[]) {
+    MachineImage *image;
+    int index;
+
+    /* each argument is a path to the output files of a program, without an extension */
+    for (index = 1; index < argc; index++) {
+        image = load_machine_image(argv[index]);
+        if (image == NULL) {
+            printf("%c %s: the program has no valid object file\n", COMMENT_STARTING_CHARACTER, argv[index]);
+            continue;
+        }
+        disassemble(stdout, image);
+        free_machine_image(image);
+    }
+    return 0;
+}
@@ -1,4 +1,3 @@
-#include <ctype.h>
 #include <string.h>
 #include <stdio.h>
 #include "errors.h"
@@ -7,6 +6,7 @@
 #include "../function_macros.h"
 #include "../command_analysis/helpers.h"
 #include "../command_analysis/command_analysis.h"
+#include "../command_analysis/lexer.h"
 
 /*
  * Activates all the error detection functions, that check if the
@@ -16,95 +16,111 @@
  *
  * Parameters:
  * -----------
- * char *file_path  the path to the file that contains the program.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int detect(char *file_path) {
-    DynamicArray *program_lines = get_program_lines(file_path);
-    DynamicArray *symbols_table = NULL;
-
-    char *temp_command_content;
+int detect(DynamicArray *program_lines) {
     char *error_msg = NULL;
 
     int row_index;
-    int definition_type;
 
     for (row_index = 0; row_index < (program_lines->length); row_index++) {
-        temp_command_content = GET_STRING(program_lines, row_index);
-        if (is_empty_command(temp_command_content)) {
-            continue;
-        }
-        definition_type = get_definition_type(temp_command_content);
         /* check for errors in the command */
-        if (definition_type == COMMAND_DEFINITION_CODE) {
-            if (invalid_label_characters(temp_command_content)) {
-                error_msg = INVALID_LABEL_CHARACTERS;
-            } else if (undefined_command(temp_command_content)) {
-                error_msg = UNDEFINED_COMMAND;
-            } else if (illegal_comma(temp_command_content) == 1) {
-                error_msg = MISSING_COMMA;
-            } else if (illegal_comma(temp_command_content) == 2) {
-                error_msg = ILLEGAL_COMMA;
-            } else if (illegal_comma(temp_command_content) == 3) {
-                error_msg = MULTIPLE_CONSECUTIVE_COMMAS;
-            } else if (extraneous_text(temp_command_content)) {
-                error_msg = EXTRANEOUS_TEXT;
-            } else if (missing_arguments(temp_command_content) == 1) {
-                error_msg = MISSING_ARGUMENTS;
-            } else if (missing_arguments(temp_command_content) == 2) {
-                error_msg = INVALID_NO_OF_ARGUMENTS;
-            } else if (invalid_operand_type(temp_command_content)) {
-                error_msg = INVALID_OPERAND_TYPE;
-            } else if (undefined_register_name(temp_command_content)) {
-                error_msg = UNDEFINED_REGISTER_NAME;
-            }
-        }
-        else if (definition_type == EXTERN_DEFINITION_CODE || definition_type == ENTRY_DEFINITION_CODE) {
-            if (invalid_label_characters(temp_command_content)) {
-                error_msg = INVALID_LABEL_CHARACTERS;
-            }
-            else if (declaration_with_no_label(temp_command_content) == 1) {
-                error_msg = INVALID_LABEL_CHARACTERS;
-            }
-            else if (declaration_with_no_label(temp_command_content) == 2) {
-                error_msg = DECLARATION_WITH_NO_LABEL;
-            }
-            else if (declaration_with_no_label(temp_command_content) == 3) {
-                error_msg = EXTRANEOUS_TEXT;
-            }
-        }
-        else if (definition_type == UNKNOWN_ADDRESSING_CODE) {
-            error_msg = UNRECOGNIZED_DECLARATION;
-        }
-
+        error_msg = get_command_error(GET_POINTER(program_lines, ProgramLine*, row_index));
         if (error_msg) {
             ERROR_FLAG = 1;
             print_error(error_msg, row_index + 1);
         }
-        error_msg = NULL;
     }
     /* general tests */
     if (!ERROR_FLAG) {
-        if (memory_overflow(file_path)) {
+        if (memory_overflow(program_lines)) {
             ERROR_FLAG = 1;
             error_msg = MEMORY_OVERFLOW;
             print_error(error_msg, -1);
         }
     }
-    if (symbols_table) {
-        free_dynamic_array(symbols_table);
-    }
-    free_dynamic_array(program_lines);
     return (ERROR_FLAG) ? 1 : 0;
 }
 
+/*
+ * Activates the error detection functions that check a single command, and returns
+ * the message of the first error that was found in the given command. If the command
+ * is valid (or empty), the function returns NULL. The result depends only on the
+ * characters of the command, and not on the other commands of the program.
+ *
+ * Parameters:
+ * -----------
+ * ProgramLine *line        the line of the command.
+ */
+char *get_command_error(ProgramLine *line) {
+    int definition_type;
+
+    if (is_empty_command(line->content)) {
+        return NULL;
+    }
+    definition_type = get_definition_type(line);
+    if (definition_type == COMMAND_DEFINITION_CODE) {
+        if (invalid_label_characters(line)) {
+            return INVALID_LABEL_CHARACTERS;
+        } else if (undefined_command(line)) {
+            return UNDEFINED_COMMAND;
+        } else if (illegal_comma(line) == 1) {
+            return MISSING_COMMA;
+        } else if (illegal_comma(line) == 2) {
+            return ILLEGAL_COMMA;
+        } else if (illegal_comma(line) == 3) {
+            return MULTIPLE_CONSECUTIVE_COMMAS;
+        } else if (extraneous_text(line)) {
+            return EXTRANEOUS_TEXT;
+        } else if (missing_arguments(line) == 1) {
+            return MISSING_ARGUMENTS;
+        } else if (missing_arguments(line) == 2) {
+            return INVALID_NO_OF_ARGUMENTS;
+        } else if (invalid_operand_type(line)) {
+            return INVALID_OPERAND_TYPE;
+        } else if (undefined_register_name(line)) {
+            return UNDEFINED_REGISTER_NAME;
+        } else if (number_out_of_range(line)) {
+            return NUMBER_OUT_OF_RANGE;
+        }
+    }
+    else if (definition_type == DATA_DEFINITION_CODE || definition_type == STRING_DEFINITION_CODE) {
+        if (empty_declaration(line)) {
+            return MISSING_ARGUMENTS;
+        } else if (number_out_of_range(line)) {
+            return NUMBER_OUT_OF_RANGE;
+        }
+    }
+    else if (definition_type == EXTERN_DEFINITION_CODE || definition_type == ENTRY_DEFINITION_CODE) {
+        if (invalid_label_characters(line)) {
+            return INVALID_LABEL_CHARACTERS;
+        }
+        else if (declaration_with_no_label(line) == 1) {
+            return INVALID_LABEL_CHARACTERS;
+        }
+        else if (declaration_with_no_label(line) == 2) {
+            return DECLARATION_WITH_NO_LABEL;
+        }
+        else if (declaration_with_no_label(line) == 3) {
+            return EXTRANEOUS_TEXT;
+        }
+    }
+    else if (definition_type == UNKNOWN_ADDRESSING_CODE) {
+        return UNRECOGNIZED_DECLARATION;
+    }
+    return NULL;
+}
+
 /*
  * Prints the error message and the row that it occurred
- * in the program.
+ * in the program, and copies them to the diagnostics file
+ * if it is open. If the diagnostics buffer is set, the error
+ * is appended to it instead of being printed.
  *
  * Parameters:
  * -----------
@@ -112,7 +128,18 @@ int detect(char *file_path) {
  * int error_row    the row of the error in the program.
  */
 void print_error(char *error_msg, int error_row) {
+    if (diagnostics_buffer != NULL) {
+        append_output(diagnostics_buffer, "Row: ");
+        append_output_number(diagnostics_buffer, error_row);
+        append_output(diagnostics_buffer, "\t|  Error: ");
+        append_output(diagnostics_buffer, error_msg);
+        append_output(diagnostics_buffer, "\n");
+        return;
+    }
     printf("Row: %d\t|  Error: %s\n", error_row, error_msg);
+    if (diagnostics_file != NULL) {
+        fprintf(diagnostics_file, "Row: %d\t|  Error: %s\n", error_row, error_msg);
+    }
 }
 
 /*
@@ -122,29 +149,19 @@ void print_error(char *error_msg, int error_row) {
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line        the line of the command.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int undefined_command(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    Field temp_field;
-    int max_name_index = (MAX_NAME_FIELD_INDEX < (positions_array->length) - 1) ? MAX_NAME_FIELD_INDEX :
-                         (positions_array->length) - 1;
-    int index;
+int undefined_command(ProgramLine *line) {
+    DynamicArray *positions_array = line->positions_array;
+    /* check if the name of the command is in the operations table */
+    int name_index = find_name_field_index(positions_array);
 
-    for (index = 0; index <= max_name_index; index++) {
-        temp_field = GET_ELEMENT(positions_array, Field*, index);
-        /* check if the name of the command is in the operations table */
-        if (get_operation_index(temp_field.content) >= 0) {
-            return 0;
-        }
-    }
-    free_dynamic_array(positions_array);
-    return 1; /* print */
+    return name_index < 0;
 }
 
 /*
@@ -156,7 +173,7 @@ int undefined_command(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line        the line of the command.
  *
  * Return Values:
  * --------------
@@ -164,14 +181,13 @@ int undefined_command(char *command_content) {
  * 1    test failed - missing arguments.
  * 2    test failed - too many arguments.
  */
-int missing_arguments(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    Operation operation = get_operation(command_content);
+int missing_arguments(ProgramLine *line) {
+    DynamicArray *positions_array = line->positions_array;
+    Operation operation = get_operation(line);
 
     int no_of_arguments_should_have = operation.type;
-    int no_of_arguments_have = (positions_array->length) - (get_name_field_index(command_content) + 1);
+    int no_of_arguments_have = (positions_array->length) - (get_name_field_index(line) + 1);
 
-    free_dynamic_array(positions_array);
     if (no_of_arguments_have < no_of_arguments_should_have) {
         return 1;
     } else if (no_of_arguments_have > no_of_arguments_should_have) {
@@ -187,7 +203,7 @@ int missing_arguments(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *command_content        the string of the command.
+ * ProgramLine *line            the line of the command.
  * DynamicArray *symbols_table  a DynamicArray pointer to a symbols table.
  *
  * Return Values:
@@ -195,29 +211,16 @@ int missing_arguments(char *command_content) {
  * 0    test passed.
  * 1    test failed.
  */
-int invalid_label_characters(char *command_content) {
-    char delimiters[] = " "; /* separating characters */
-    int label_end_index = -1;
+int invalid_label_characters(ProgramLine *line) {
+    DynamicArray *positions_array = line->positions_array;
+    Field *temp_field;
     int index;
 
-    command_content = command_content + strspn(command_content, delimiters);
-    /* search for the ending character of the label */
-    for (index = 0; index < (signed int)strlen(command_content); index++) {
-        if (command_content[index] == LABEL_ENDING_CHARACTER) {
-            label_end_index = index;
-            break;
-        }
-    }
-    /* there is no label in the command, and therefore the test passed */
-    if (label_end_index < 0) {
-        return 0;
-    }
-    /* check that all the characters of the label are letters and digits, and the first character is a letter */
-    if (!isalpha(command_content[0])) {
-        return 1;
-    }
-    for (index = 0; index < label_end_index; index++) {
-        if (!isalpha(command_content[index]) && !isdigit(command_content[index])) {
+    /* a label ending character is valid only in a label definition, which is the first field */
+    for (index = 0; index < (positions_array->length); index++) {
+        temp_field = GET_POINTER(positions_array, Field*, index);
+        if (temp_field->type == INVALID_LABEL_TOKEN_CODE ||
+            (temp_field->type == LABEL_DEFINITION_TOKEN_CODE && index > 0)) {
             return 1;
         }
     }
@@ -226,51 +229,43 @@ int invalid_label_characters(char *command_content) {
 
 /*
  * Checks if the given command has a text after the end of it. If the command
- * have a character which is not a space or a tab after the last argument, then
- * the function returns 1. Otherwise, returns 0.
+ * have a token after the last argument, or if the last argument is a token that
+ * can't be an argument, such as a string or a label definition, then the function
+ * returns 1. Otherwise, returns 0.
  *
  * Parameters:
  * -----------
- * char *command_content        the string of the command.
+ * ProgramLine *line            the line of the command.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int extraneous_text(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    Operation operation = get_operation(command_content);
-    Field last_argument;
-
-    int last_argument_index = 1 + operation.type; /* the index of the last argument in the positions array */
-    int last_character_index; /* the index of the last character of the command */
+int extraneous_text(ProgramLine *line) {
+    TokensList *tokens_list = line->tokens_list;
+    Operation operation = get_operation(line);
+    Token *temp_token;
+
+    int last_argument_index = get_name_field_index(line) + operation.type; /* the index of the last argument in the positions array */
+    int field_index = -1; /* the index of the current token in the positions array */
+    int found_extraneous_text = 1;
     int index;
 
-    if (!has_valid_label(command_content)) {
-        last_argument_index -= 1;
-    }
-    if (last_argument_index >= (positions_array->length)) {
-        return 1;
-    }
-    last_argument = GET_ELEMENT(positions_array, Field*, last_argument_index);
-    last_character_index = last_argument.end;
-    index = last_character_index;
-    while (index >= last_argument.start + 1) {
-        if (!isalpha(command_content[index]) && !isdigit(command_content[index])) {
-            return 1;
-        }
-        --index;
-    }
-    ++last_character_index;
-    while (last_character_index < (signed int)strlen(command_content)) {
-        if (command_content[last_character_index] != ' ' && command_content[last_character_index] != '\t') {
-            free_dynamic_array(positions_array);
-            return 1;
+    for (index = 0; index < (tokens_list->length); index++) {
+        temp_token = &(tokens_list->tokens)[index];
+        if (temp_token->type == COMMA_TOKEN_CODE || ++field_index < last_argument_index) {
+            continue;
         }
-        ++last_character_index;
+        /* the last argument should be the last token of the command */
+        found_extraneous_text = index < (tokens_list->length) - 1 ||
+                                temp_token->type == LABEL_DEFINITION_TOKEN_CODE ||
+                                temp_token->type == INVALID_LABEL_TOKEN_CODE ||
+                                temp_token->type == STRING_TOKEN_CODE ||
+                                temp_token->type == COMMENT_TOKEN_CODE;
+        break;
     }
-    return 0;
+    return found_extraneous_text;
 }
 
 /*
@@ -282,7 +277,7 @@ int extraneous_text(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *command_content        the string of the command.
+ * ProgramLine *line            the line of the command.
  *
  * Return Values:
  * --------------
@@ -291,68 +286,26 @@ int extraneous_text(char *command_content) {
  * 2    test failed - illegal comma.
  * 3    test failed - Multiple consecutive commas.
  */
-int illegal_comma(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    Field current_label;
-    Field next_label;
-
-    int command_name_index = get_name_field_index(command_content);
-    int first_argument_index = command_name_index + 1; /* the index of the first argument in the positions array */
-    int no_of_commas = 0; /* the number of commas between two arguments of the command */
-    int start, end;
-    int index;
+int illegal_comma(ProgramLine *line) {
+    DynamicArray *positions_array = line->positions_array;
+    Field *temp_field;
 
-    /* check if there are commas between the label and the name of the command */
-    if (has_valid_label(command_content)) {
-        start = GET_ELEMENT(positions_array, Field*, 0).end + 1;
-        end = GET_ELEMENT(positions_array, Field*, 1).start;
+    int first_argument_index = get_name_field_index(line) + 1; /* the index of the first argument in the positions array */
+    int index;
 
-        for (index = start; index < end; index++) {
-            if (command_content[index] == ',') {
-                free_dynamic_array(positions_array);
-                return 2;
-            }
-        }
-    }
-    /* check if there are commas between the name of the command and the first argument */
-    start = command_name_index;
-    end = first_argument_index;
-
-    if (end < (positions_array->length)) {
-        current_label = GET_ELEMENT(positions_array, Field*, start);
-        next_label = GET_ELEMENT(positions_array, Field*, end);
-
-        for (index = current_label.end + 1; index < next_label.start; index++) {
-            if (command_content[index] == ',') {
-                free_dynamic_array(positions_array);
-                return 2;
-            }
+    for (index = 0; index < (positions_array->length); index++) {
+        temp_field = GET_POINTER(positions_array, Field*, index);
+        /* there should be no commas before the first argument of the command */
+        if (index <= first_argument_index && (temp_field->preceding_commas) > 0) {
+            return 2;
         }
-    }
-    /* check that there is exactly 1 comma between any two arguments of the command */
-    start = first_argument_index;
-    end = start + 1;
-    while (end < (positions_array->length)) {
-        current_label = GET_ELEMENT(positions_array, Field*, start);
-        next_label = GET_ELEMENT(positions_array, Field*, end);
-
-        for (index = current_label.end + 1; index < next_label.start; index++) {
-            if (command_content[index] == ',') {
-                ++no_of_commas;
-            }
-        }
-        if (no_of_commas == 0) {
-            free_dynamic_array(positions_array);
+        /* there should be exactly 1 comma between any two arguments of the command */
+        if (index > first_argument_index && (temp_field->preceding_commas) == 0) {
             return 1;
-        } else if (no_of_commas == 2) {
-            free_dynamic_array(positions_array);
+        } else if (index > first_argument_index && (temp_field->preceding_commas) > 1) {
             return 3;
         }
-        no_of_commas = 0;
-        ++start;
-        ++end;
     }
-    free_dynamic_array(positions_array);
     return 0;
 }
 
@@ -362,15 +315,15 @@ int illegal_comma(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *file_path  the path to the file that contains the program.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int memory_overflow(char *file_path) {
-    DynamicArray *symbols_table = get_symbols_table(file_path);
+int memory_overflow(DynamicArray *program_lines) {
+    DynamicArray *symbols_table = get_symbols_table(program_lines);
     if (IC + DC > NO_OF_MEMORY_WORDS_IN_PROGRAM) {
         free_dynamic_array(symbols_table);
         return 1;
@@ -386,18 +339,18 @@ int memory_overflow(char *file_path) {
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line        the line of the command.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int invalid_operand_type(char *command_content) {
-    DynamicArray *operands_array = get_operands_array(command_content, NULL);
-    Operation operation = get_operation(command_content);
-    Operand source_operand;
-    Operand destination_operand;
+int invalid_operand_type(ProgramLine *line) {
+    DynamicArray *operands_array = get_operands_array(line, NULL);
+    Operation operation = get_operation(line);
+    Operand *source_operand;
+    Operand *destination_operand;
 
     /* the number of addressing codes that the destination operand can get */
     const int dest_operand_addressing_length =
@@ -414,21 +367,21 @@ int invalid_operand_type(char *command_content) {
         free_dynamic_array(operands_array);
         return 0;
     } else if ((operands_array->length) == 1) {
-        destination_operand = GET_ELEMENT(operands_array, Operand*, 0);
+        destination_operand = GET_POINTER(operands_array, Operand*, 0);
         /* check if the addressing code of the destination operand is one of the
          * addressing codes that the destination operand can get */
         for (index = 0; index < dest_operand_addressing_length; index++) {
-            if (destination_operand.addressing == operation.destination_operand_addressing[index]) {
+            if (destination_operand->addressing == operation.destination_operand_addressing[index]) {
                 free_dynamic_array(operands_array);
                 return 0;
             }
         }
     } else {
-        source_operand = GET_ELEMENT(operands_array, Operand*, 0);
-        destination_operand = GET_ELEMENT(operands_array, Operand*, 1);
+        source_operand = GET_POINTER(operands_array, Operand*, 0);
+        destination_operand = GET_POINTER(operands_array, Operand*, 1);
 
         for (index = 0; index < src_operand_addressing_length; index++) {
-            if (source_operand.addressing == operation.source_operand_addressing[index]) {
+            if (source_operand->addressing == operation.source_operand_addressing[index]) {
                 found_src_addressing_code_flag = 1;
                 break;
             }
@@ -436,7 +389,7 @@ int invalid_operand_type(char *command_content) {
         /* check if the addressing code of the destination operand is one of the
          * addressing codes that the destination operand can get */
         for (index = 0; index < dest_operand_addressing_length; index++) {
-            if (destination_operand.addressing == operation.destination_operand_addressing[index]) {
+            if (destination_operand->addressing == operation.destination_operand_addressing[index]) {
                 found_dest_addressing_code_flag = 1;
                 break;
             }
@@ -457,18 +410,18 @@ int invalid_operand_type(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *command_content        the string of the command.
+ * ProgramLine *line            the line of the command.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int undefined_register_name(char *command_content) {
-    DynamicArray *operands_array = get_operands_array(command_content, NULL);
-    Operation operation = get_operation(command_content);
-    Operand first_operand;
-    Operand second_operand;
+int undefined_register_name(ProgramLine *line) {
+    DynamicArray *operands_array = get_operands_array(line, NULL);
+    Operation operation = get_operation(line);
+    Operand *first_operand;
+    Operand *second_operand;
 
     int no_of_addressing_1; /* the number of addressing methods that the first operand can take */
     int no_of_addressing_2; /* the number of addressing methods that the second operand can take */
@@ -477,19 +430,19 @@ int undefined_register_name(char *command_content) {
         free_dynamic_array(operands_array);
         return 0;
     } else if (operation.type == 1) {
-        first_operand = GET_ELEMENT(operands_array, Operand*, 0);
+        first_operand = GET_POINTER(operands_array, Operand*, 0);
         no_of_addressing_1 = (signed int)(sizeof(operation.destination_operand_addressing) / sizeof(operation.destination_operand_addressing[0]));
 
         if (is_addressing_method(REGISTER_ADDRESSING_CODE, operation.destination_operand_addressing, no_of_addressing_1)) {
-            if (first_operand.data[0] == '@' && !is_existing_register(first_operand.data)) {
+            if (first_operand->data[0] == REGISTER_PREFIX_CHARACTER && first_operand->addressing != REGISTER_ADDRESSING_CODE) {
                 free_dynamic_array(operands_array);
                 return 1;
             }
         }
 
     } else if (operation.type == 2) {
-        first_operand = GET_ELEMENT(operands_array, Operand*, 0);
-        second_operand = GET_ELEMENT(operands_array, Operand*, 1);
+        first_operand = GET_POINTER(operands_array, Operand*, 0);
+        second_operand = GET_POINTER(operands_array, Operand*, 1);
 
         no_of_addressing_1 = (signed int)(sizeof(operation.source_operand_addressing) / sizeof(operation.source_operand_addressing[0]));
         no_of_addressing_2 = (signed int)(sizeof(operation.destination_operand_addressing) / sizeof(operation.destination_operand_addressing[0]));
@@ -497,12 +450,12 @@ int undefined_register_name(char *command_content) {
         /* if the addressing method of the operand is a register addressing, and
          * the operand is not an existing register, then the test was failed. */
         if (is_addressing_method(REGISTER_ADDRESSING_CODE, operation.source_operand_addressing, no_of_addressing_1)) {
-            if (first_operand.data[0] == '@' && !is_existing_register(first_operand.data)) {
+            if (first_operand->data[0] == REGISTER_PREFIX_CHARACTER && first_operand->addressing != REGISTER_ADDRESSING_CODE) {
                 return 1;
             }
         }
         if (is_addressing_method(REGISTER_ADDRESSING_CODE, operation.destination_operand_addressing, no_of_addressing_2)) {
-            if (second_operand.data[0] == '@' && !is_existing_register(second_operand.data)) {
+            if (second_operand->data[0] == REGISTER_PREFIX_CHARACTER && second_operand->addressing != REGISTER_ADDRESSING_CODE) {
                 return 1;
             }
         }
@@ -519,7 +472,7 @@ int undefined_register_name(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *command_content        the string of the command.
+ * ProgramLine *line            the line of the command.
  *
  * Return Values:
  * --------------
@@ -528,19 +481,18 @@ int undefined_register_name(char *command_content) {
  * 2    test failed - declaration with no label definition.
  * 3    test failed - extraneous text.
  */
-int declaration_with_no_label(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    Field label_field;
+int declaration_with_no_label(ProgramLine *line) {
+    DynamicArray *positions_array = line->positions_array;
+    Field *label_field;
 
     const int declaration_no_of_fields_with_no_label = 2; /* the number of fields in a .extern/.entry declaration, that don't have an opening label */
     const int declaration_no_of_fields_with_label = 3; /* the number of fields in a .extern/.entry declaration, that have an opening label */
 
     int no_of_fields_should_have; /* the number of fields the command should have */
     int no_of_fields_have = (positions_array->length); /* the actual number of fields in the command */
-    int index;
 
     /* check if an opening label exists */
-    if (has_valid_label(command_content)) {
+    if (has_valid_label(line)) {
         no_of_fields_should_have = declaration_no_of_fields_with_label;
     }
     else {
@@ -548,25 +500,69 @@ int declaration_with_no_label(char *command_content) {
     }
 
     if (no_of_fields_have > no_of_fields_should_have) {
-        free_dynamic_array(positions_array);
         return 3;
     }
     else if (no_of_fields_have < no_of_fields_should_have) {
-        free_dynamic_array(positions_array);
         return 2;
     }
-    /* check if the label characters are valid */
-    label_field = GET_ELEMENT(positions_array, Field*, no_of_fields_have-1);
-    free_dynamic_array(positions_array);
-    /* the first character of a .extern/.entry declaration label should be a letter */
-    if (isalpha(command_content[label_field.start])) {
-        for (index = label_field.start + 1; index <= label_field.end; index++) {
-            if (!isalpha(command_content[index]) && !isdigit(command_content[index])) {
-                return 1;
-            }
-        }
-    } else {
+    /* check if the label characters are valid, a .extern/.entry declaration label should be an identifier */
+    label_field = GET_POINTER(positions_array, Field*, no_of_fields_have - 1);
+    if (label_field->type != IDENTIFIER_TOKEN_CODE && label_field->type != MNEMONIC_TOKEN_CODE) {
         return 1;
     }
     return 0;
 }
+
+/*
+ * Checks if the numbers of the given command fit in their memory words. The values of
+ * a .data declaration fill a whole memory word, and their absolute value can be up to
+ * the largest value of a memory word. The immediate operands of a command are encoded
+ * in ENCODING_OPERAND_LENGTH bits, so they must fit in that signed range. If one of
+ * the numbers doesn't fit, the function returns 1. Otherwise, returns 0.
+ *
+ * Parameters:
+ * -----------
+ * ProgramLine *line            the line of the command.
+ *
+ * Return Values:
+ * --------------
+ * 0    test passed.
+ * 1    test failed.
+ */
+int number_out_of_range(ProgramLine *line) {
+    DynamicArray *positions_array = line->positions_array;
+    Field *temp_field;
+    int max_value = MAX_IMMEDIATE_VALUE;
+    int min_value = MIN_IMMEDIATE_VALUE;
+    int index;
+
+    if (get_definition_type(line) == DATA_DEFINITION_CODE) {
+        max_value = MAX_NUMBER_VALUE;
+        min_value = -MAX_NUMBER_VALUE;
+    }
+    for (index = 0; index < (positions_array->length); index++) {
+        temp_field = GET_POINTER(positions_array, Field*, index);
+        if (temp_field->type == IMMEDIATE_TOKEN_CODE && (temp_field->value > max_value || temp_field->value < min_value)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Checks if the given .data/.string declaration has a value after it. If there is
+ * no field after the declaration, such as in 'X: .data', the function returns 1.
+ * Otherwise, returns 0.
+ *
+ * Parameters:
+ * -----------
+ * ProgramLine *line            the line of the command.
+ *
+ * Return Values:
+ * --------------
+ * 0    test passed.
+ * 1    test failed.
+ */
+int empty_declaration(ProgramLine *line) {
+    return get_declaration_index(line) + 1 >= (line->positions_array->length);
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef ASSEMBLER_SIMULATOR_DETECTOR_H
 #define ASSEMBLER_SIMULATOR_DETECTOR_H
 
+#include "../types.h"
+
 /*
  * Activates all the error detection functions, that check if the
  * given program is valid and prints the errors to the screen with
@@ -9,18 +11,32 @@
  *
  * Parameters:
  * -----------
- * char *file_path  the path to the file that contains the program.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int detect(char *file_path);
+int detect(DynamicArray *program_lines);
+
+/*
+ * Activates the error detection functions that check a single command, and returns
+ * the message of the first error that was found in the given command. If the command
+ * is valid (or empty), the function returns NULL. The result depends only on the
+ * characters of the command, and not on the other commands of the program.
+ *
+ * Parameters:
+ * -----------
+ * ProgramLine *line        the line of the command.
+ */
+char *get_command_error(ProgramLine *line);
 
 /*
  * Prints the error message and the row that it occurred
- * in the program.
+ * in the program, and copies them to the diagnostics file
+ * if it is open. If the diagnostics buffer is set, the error
+ * is appended to it instead of being printed.
  *
  * Parameters:
  * -----------
@@ -36,14 +52,14 @@ void print_error(char *error_msg, int error_row);
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line        the line of the command.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int undefined_command(char *command_content);
+int undefined_command(ProgramLine *line);
 
 /*
  * Returns 0 if the number of arguments that was given to the command, is equal to the
@@ -54,7 +70,7 @@ int undefined_command(char *command_content);
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line        the line of the command.
  *
  * Return Values:
  * --------------
@@ -62,7 +78,7 @@ int undefined_command(char *command_content);
  * 1    test failed - missing arguments.
  * 2    test failed - too many arguments.
  */
-int missing_arguments(char *command_content);
+int missing_arguments(ProgramLine *line);
 
 /*
  * Checks if the given command has a label, and if it does, the function checks
@@ -71,7 +87,7 @@ int missing_arguments(char *command_content);
  *
  * Parameters:
  * -----------
- * char *command_content        the string of the command.
+ * ProgramLine *line            the line of the command.
  * DynamicArray *symbols_table  a DynamicArray pointer to a symbols table.
  *
  * Return Values:
@@ -79,7 +95,7 @@ int missing_arguments(char *command_content);
  * 0    test passed.
  * 1    test failed.
  */
-int invalid_label_characters(char *command_content);
+int invalid_label_characters(ProgramLine *line);
 
 /*
  * Checks if the given command has a text after the end of it. If the command
@@ -88,14 +104,14 @@ int invalid_label_characters(char *command_content);
  *
  * Parameters:
  * -----------
- * char *command_content        the string of the command.
+ * ProgramLine *line            the line of the command.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int extraneous_text(char *command_content);
+int extraneous_text(ProgramLine *line);
 
 /*
  * Checks if there is no comma between the label and the name of the command
@@ -106,7 +122,7 @@ int extraneous_text(char *command_content);
  *
  * Parameters:
  * -----------
- * char *command_content        the string of the command.
+ * ProgramLine *line            the line of the command.
  *
  * Return Values:
  * --------------
@@ -115,7 +131,7 @@ int extraneous_text(char *command_content);
  * 2    test failed - illegal comma.
  * 3    test failed - Multiple consecutive commas.
  */
-int illegal_comma(char *command_content);
+int illegal_comma(ProgramLine *line);
 
 /*
  * Returns 0 if the given .extern/.entry declaration has a valid
@@ -125,7 +141,7 @@ int illegal_comma(char *command_content);
  *
  * Parameters:
  * -----------
- * char *command_content        the string of the command.
+ * ProgramLine *line            the line of the command.
  *
  * Return Values:
  * --------------
@@ -134,7 +150,7 @@ int illegal_comma(char *command_content);
  * 2    test failed - declaration with no label definition.
  * 3    test failed - extraneous text.
  */
-int declaration_with_no_label(char *command_content);
+int declaration_with_no_label(ProgramLine *line);
 
 /*
  * Returns 1 if the number of memory words that the given program takes,
@@ -142,14 +158,14 @@ int declaration_with_no_label(char *command_content);
  *
  * Parameters:
  * -----------
- * char *file_path  the path to the file that contains the program.
+ * DynamicArray *program_lines  the ProgramLine of each line of the program.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int memory_overflow(char *file_path);
+int memory_overflow(DynamicArray *program_lines);
 
 /*
  * Checks if the addressing code of each argument of the given command, correspond to
@@ -158,14 +174,14 @@ int memory_overflow(char *file_path);
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line        the line of the command.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int invalid_operand_type(char *command_content);
+int invalid_operand_type(ProgramLine *line);
 
 /*
  * Checks if the given command have valid register definitions, and if one
@@ -174,13 +190,47 @@ int invalid_operand_type(char *command_content);
  *
  * Parameters:
  * -----------
- * char *command_content        the string of the command.
+ * ProgramLine *line            the line of the command.
+ *
+ * Return Values:
+ * --------------
+ * 0    test passed.
+ * 1    test failed.
+ */
+int undefined_register_name(ProgramLine *line);
+
+/*
+ * Checks if the numbers of the given command fit in their memory words. The values of
+ * a .data declaration fill a whole memory word, and their absolute value can be up to
+ * the largest value of a memory word. The immediate operands of a command are encoded
+ * in ENCODING_OPERAND_LENGTH bits, so they must fit in that signed range. If one of
+ * the numbers doesn't fit, the function returns 1. Otherwise, returns 0.
+ *
+ * Parameters:
+ * -----------
+ * ProgramLine *line            the line of the command.
+ *
+ * Return Values:
+ * --------------
+ * 0    test passed.
+ * 1    test failed.
+ */
+int number_out_of_range(ProgramLine *line);
+
+/*
+ * Checks if the given .data/.string declaration has a value after it. If there is
+ * no field after the declaration, such as in 'X: .data', the function returns 1.
+ * Otherwise, returns 0.
+ *
+ * Parameters:
+ * -----------
+ * ProgramLine *line            the line of the command.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int undefined_register_name(char *command_content);
+int empty_declaration(ProgramLine *line);
 
 #endif
@@ -12,6 +12,7 @@
 #define MULTIPLE_LABEL_DEFINITIONS "Multiple definitions of the same label!"
 
 #define UNDEFINED_REGISTER_NAME "Undefined register name!"
+#define NUMBER_OUT_OF_RANGE "The number does not fit in a memory word!"
 #define EXTERN_AND_ENTRY_LABEL "Label was defined as external and as entry label!"
 #define ENTRY_LABEL_WASNT_DEFINED "Entry label was not defined in this file!"
 #define ILLEGAL_COMMA "Illegal comma!"
@@ -22,6 +23,20 @@
 #define UNRECOGNIZED_DECLARATION "The following declaration do not exists!"
 #define DECLARATION_WITH_NO_LABEL "The following .extern/.entry declaration do not contain a label!"
 
+#define UNLOADED_MODULE "The module has no valid object file!"
+#define MULTIPLE_ENTRY_DEFINITIONS "Entry label was defined in more than one module!"
+#define INVALID_EXTERNAL_REFERENCE "A use of an external label is not in the code of the module!"
+#define UNRESOLVED_EXTERNAL_LABEL "External label was not defined as entry in any module!"
+#define LINKED_MEMORY_OVERFLOW "The linked program consumes more memory than exists!"
+#define LINKED_ADDRESS_OVERFLOW "A relocated address does not fit in its memory word!"
+
+#define ILLEGAL_INSTRUCTION "The memory word is not a first word of a valid command!"
+#define UNRESOLVED_EXTERNAL_OPERAND "The command uses an external label that was not linked!"
+#define RETURN_STACK_OVERFLOW "Too many nested subroutine calls!"
+#define RETURN_STACK_UNDERFLOW "Return from a subroutine that was not called!"
+#define PROGRAM_COUNTER_OVERFLOW "The command is beyond the memory of the machine!"
+#define UNTRANSLATED_ADDRESS "The address is not a command in the code of the translated program!"
+
 extern int variable_2; /* a variable to solve the empty translation unit problem */
 
 #endif
@@ -1,10 +1,10 @@
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
 #include "helpers.h"
 #include "../types.h"
 #include "../segments.h"
 #include "../command_analysis/command_analysis.h"
+#include "../command_analysis/lexer.h"
 #include "../function_macros.h"
 
 /*
@@ -17,16 +17,7 @@
  * char *operation_name     a name of an operation.
  */
 int get_operation_index(char *operation_name) {
-    Operation temp_operation;
-    int index;
-    /* check if the name of the command is in the operations table */
-    for (index = 0; index < (int)(sizeof(operations) / sizeof(operations[0])); index++) {
-        temp_operation = operations[index];
-        if (!strcmp(operation_name, temp_operation.name)) {
-            return index;
-        }
-    }
-    return -1;
+    return get_mnemonic_index(operation_name, (int) strlen(operation_name));
 }
 
 /*
@@ -34,63 +25,58 @@ int get_operation_index(char *operation_name) {
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-Operation get_operation(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    Field name_field = GET_ELEMENT(positions_array, Field*, get_name_field_index(command_content));
-    free_dynamic_array(positions_array);
-    return operations[get_operation_index(name_field.content)];
+Operation get_operation(ProgramLine *line) {
+    DynamicArray *positions_array = line->positions_array;
+    int operation_index = GET_POINTER(positions_array, Field*, find_name_field_index(positions_array))->value;
+
+    return operations[operation_index];
 }
 
 /*
- * Returns the index of the name of the given command, in its positions array.
- * If the name is not found in the operations table, or it's not in the first
- * fields that the name of the command should be in, then the function returns -1.
+ * Returns the index of the name of a command, in the given positions array of the
+ * command. If there is no mnemonic in the first fields that the name of the command
+ * should be in, then the function returns -1.
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * DynamicArray *positions_array    the positions array of the command.
  */
-int get_name_field_index(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    Field temp_field;
-
+int find_name_field_index(DynamicArray *positions_array) {
     int index;
-    int max_name_index = (MAX_NAME_FIELD_INDEX < (positions_array->length) - 1) ? MAX_NAME_FIELD_INDEX :
-                         (positions_array->length) - 1;
-
-    for (index = 0; index <= max_name_index; index++) {
-        temp_field = GET_ELEMENT(positions_array, Field *, index);
-        /* check if the name of the command is in the operations table */
-        if (get_operation_index(temp_field.content) >= 0) {
-            free_dynamic_array(positions_array);
+    for (index = 0; index <= MAX_NAME_FIELD_INDEX && index < (positions_array->length); index++) {
+        if (GET_POINTER(positions_array, Field*, index)->type == MNEMONIC_TOKEN_CODE) {
             return index;
         }
     }
-    free_dynamic_array(positions_array);
     return -1;
 }
 
 /*
- * Returns the number of arguments that was given to the command.
+ * Returns the index of the name of the given command, in its positions array.
+ * If the name is not found in the operations table, or it's not in the first
+ * fields that the name of the command should be in, then the function returns -1.
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int get_no_of_arguments(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    int name_index = get_name_field_index(command_content);
-
-    /* get the part of the command that contains the parameters only */
-    char *parameters_part = command_content + GET_ELEMENT(positions_array, Field*, name_index).end + 1;
-    DynamicArray *parameters_positions_array = get_positions_array(parameters_part);
-    int no_of_given_parameters = (parameters_positions_array->length);
+int get_name_field_index(ProgramLine *line) {
+    return find_name_field_index(line->positions_array);
+}
 
-    free_dynamic_array(positions_array);
-    free_dynamic_array(parameters_positions_array);
-    return no_of_given_parameters;
+/*
+ * Returns the number of arguments that was given to the command.
+ *
+ * Parameters:
+ * -----------
+ * ProgramLine *line    the line of the command.
+ */
+int get_no_of_arguments(ProgramLine *line) {
+    DynamicArray *positions_array = line->positions_array;
+    /* the arguments are the fields after the name of the command */
+    return (positions_array->length) - (find_name_field_index(positions_array) + 1);
 }
 
 /*
@@ -98,20 +84,8 @@ int get_no_of_arguments(char *command_content) {
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int get_no_of_parameters(char *command_content) {
-    DynamicArray *positions_array = get_positions_array(command_content);
-    Field name_field = GET_ELEMENT(positions_array, Field*, get_name_field_index(command_content));
-
-    int no_of_parameters_operation_takes = operations[get_operation_index(name_field.content)].type;
-    int name_index = get_name_field_index(command_content);
-
-    /* get the part of the command that contains the parameters only */
-    char *parameters_part = command_content + GET_ELEMENT(positions_array, Field*, name_index).end + 1;
-    DynamicArray *parameters_positions_array = get_positions_array(parameters_part);
-
-    free_dynamic_array(positions_array);
-    free_dynamic_array(parameters_positions_array);
-    return no_of_parameters_operation_takes;
+int get_no_of_parameters(ProgramLine *line) {
+    return get_operation(line).type;
 }
\ No newline at end of file
@@ -20,9 +20,20 @@ int get_operation_index(char *operation_name);
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-Operation get_operation(char *command_content);
+Operation get_operation(ProgramLine *line);
+
+/*
+ * Returns the index of the name of a command, in the given positions array of the
+ * command. If there is no mnemonic in the first fields that the name of the command
+ * should be in, then the function returns -1.
+ *
+ * Parameters:
+ * -----------
+ * DynamicArray *positions_array    the positions array of the command.
+ */
+int find_name_field_index(DynamicArray *positions_array);
 
 /*
  * Returns the index of the name of the given command, in its positions array.
@@ -31,27 +42,27 @@ Operation get_operation(char *command_content);
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int get_name_field_index(char *command_content);
+int get_name_field_index(ProgramLine *line);
 
 /*
  * Returns the number of arguments that was given to the command.
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int get_no_of_arguments(char *command_content);
+int get_no_of_arguments(ProgramLine *line);
 
 /*
  * Returns the number of parameters the operation of the command have.
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line    the line of the command.
  */
-int get_no_of_parameters(char *command_content);
+int get_no_of_parameters(ProgramLine *line);
 
 /*
  * Checks if the addressing code of each argument of the given command, correspond to
@@ -60,13 +71,13 @@ int get_no_of_parameters(char *command_content);
  *
  * Parameters:
  * -----------
- * char *command_content    the string of the command.
+ * ProgramLine *line        the line of the command.
  *
  * Return Values:
  * --------------
  * 0    test passed.
  * 1    test failed.
  */
-int invalid_operand_type(char *command_content);
+int invalid_operand_type(ProgramLine *line);
 
 #endif
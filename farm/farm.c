@@ -0,0 +1,562 @@
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "farm.h"
+#include "../simulator/simulator.h"
+#include "../simulator/threaded.h"
+#include "../simulator/snapshot.h"
+#include "../disassembler/disassembler.h"
+#include "../loader/loader.h"
+
+/*
+ * Returns the number of worker threads that a farm starts when the number is not
+ * given: the number of processors that are online, and at most MAX_FARM_THREADS.
+ */
+int get_default_threads() {
+    long no_of_processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (no_of_processors < 1) {
+        return 1;
+    }
+    return (no_of_processors > MAX_FARM_THREADS) ? MAX_FARM_THREADS : (int) no_of_processors;
+}
+
+/*
+ * Returns a pointer to a new Farm without jobs, that executes its jobs with the given
+ * number of worker threads. The user should free it with 'free_farm'.
+ *
+ * Parameters:
+ * -----------
+ * int no_of_threads                the number of worker threads.
+ * unsigned long max_instructions   the maximum number of commands of each job, or 0 for no limit.
+ */
+Farm *create_farm(int no_of_threads, unsigned long max_instructions) {
+    Farm *farm = calloc(1, sizeof(Farm));
+
+    if (farm == NULL) {
+        printf("Could not allocate memory for the farm!\n");
+        exit(0);
+    }
+    farm->no_of_threads = no_of_threads;
+    farm->max_instructions = max_instructions;
+    return farm;
+}
+
+/*
+ * Frees the loaded programs, the jobs, the results and the deques of the given farm,
+ * and in the end frees the farm itself.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm   a pointer to the farm.
+ */
+void free_farm(Farm *farm) {
+    int index;
+
+    for (index = 0; index < (farm->program_paths).length; index++) {
+        if ((farm->images)[index] != NULL) {
+            free_machine_image((farm->images)[index]);
+        }
+    }
+    if (farm->deques != NULL) {
+        for (index = 0; index < (farm->no_of_threads); index++) {
+            pthread_mutex_destroy(&((farm->deques)[index].lock));
+            free((farm->deques)[index].jobs);
+        }
+    }
+    free_string_pool(&(farm->program_paths));
+    free_string_pool(&(farm->file_paths));
+    free(farm->images);
+    free(farm->jobs);
+    free(farm->results);
+    free(farm->deques);
+    free(farm);
+}
+
+/*
+ * Returns the id of the given program in the farm. The program is loaded only the
+ * first time it's added, and all the jobs of the program share its image, which they
+ * never change. If the program can't be loaded, its image is NULL.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm           a pointer to the farm.
+ * char *program_path   the path to the output files of the program, without an extension.
+ */
+int add_farm_program(Farm *farm, char *program_path) {
+    int no_of_programs = (farm->program_paths).length;
+    int id = intern_string(&(farm->program_paths), program_path, strlen(program_path));
+
+    if (id < no_of_programs) {
+        return id;
+    }
+    /* the program was not added before */
+    farm->images = realloc(farm->images, (id + 1) * sizeof(MachineImage *));
+    if (farm->images == NULL) {
+        printf("Could not allocate memory for the programs of the farm!\n");
+        exit(0);
+    }
+    (farm->images)[id] = load_machine_image(program_path);
+    if ((farm->images)[id] == NULL) {
+        printf("%s: the program has no valid object file\n", program_path);
+    }
+    return id;
+}
+
+/*
+ * Adds a job to the given farm, that executes the given program with the given input
+ * file, and compares its output with the given file.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm           a pointer to the farm.
+ * char *program_path   the path to the output files of the program, without an extension.
+ * char *input_path     the path to the input file.
+ * char *expected_path  the path to the file with the expected output.
+ */
+void add_farm_job(Farm *farm, char *program_path, char *input_path, char *expected_path) {
+    FarmJob *job;
+
+    if ((farm->no_of_jobs) == (farm->jobs_capacity)) {
+        farm->jobs_capacity = (farm->jobs_capacity) ? 2 * (farm->jobs_capacity) : INITIAL_NO_OF_JOBS;
+        farm->jobs = realloc(farm->jobs, (farm->jobs_capacity) * sizeof(FarmJob));
+        if (farm->jobs == NULL) {
+            printf("Could not allocate memory for the jobs of the farm!\n");
+            exit(0);
+        }
+    }
+    job = &((farm->jobs)[farm->no_of_jobs++]);
+    job->program_id = add_farm_program(farm, program_path);
+    job->input_id = intern_string(&(farm->file_paths), input_path, strlen(input_path));
+    job->expected_id = intern_string(&(farm->file_paths), expected_path, strlen(expected_path));
+}
+
+/*
+ * Adds a job to the given farm for each line of the given manifest. Each line contains
+ * the path to the output files of a program (without an extension), the path to its
+ * input file and the path to the file with its expected output, separated by white
+ * spaces. Empty lines are skipped, and an invalid line is printed and skipped. Returns
+ * 1 if the manifest was read, and 0 if it can't be read.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm           a pointer to the farm.
+ * char *manifest_path  the path to the manifest.
+ */
+int read_manifest(Farm *farm, char *manifest_path) {
+    FILE *manifest;
+    char line[MAX_MANIFEST_LINE_LENGTH];
+    char program_path[MAX_MANIFEST_LINE_LENGTH];
+    char input_path[MAX_MANIFEST_LINE_LENGTH];
+    char expected_path[MAX_MANIFEST_LINE_LENGTH];
+    char extra[MAX_MANIFEST_LINE_LENGTH];
+    int line_number = 0;
+    int no_of_paths;
+
+    if ((manifest = fopen(manifest_path, "r")) == NULL) {
+        printf("%s: the manifest can't be read\n", manifest_path);
+        return 0;
+    }
+    while (fgets(line, MAX_MANIFEST_LINE_LENGTH, manifest) != NULL) {
+        line_number++;
+        no_of_paths = sscanf(line, "%s %s %s %s", program_path, input_path, expected_path, extra);
+        if (no_of_paths == EOF) {
+            continue;
+        }
+        if (no_of_paths != MANIFEST_PATHS_PER_LINE) {
+            printf("%s: line %d: a job needs a program, an input file and an expected output file\n",
+                   manifest_path, line_number);
+            continue;
+        }
+        add_farm_job(farm, program_path, input_path, expected_path);
+    }
+    fclose(manifest);
+    return 1;
+}
+
+/*
+ * Fills the deque of each worker of the given farm with a block of adjacent jobs, so
+ * each worker starts with the jobs of the same programs, and creates their locks.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm   a pointer to the farm, with all its jobs.
+ */
+void distribute_jobs(Farm *farm) {
+    JobDeque *deque;
+    int worker;
+    int first;
+    int last;
+
+    farm->deques = calloc(farm->no_of_threads, sizeof(JobDeque));
+    farm->results = calloc(farm->no_of_jobs, sizeof(FarmResult));
+    if (farm->deques == NULL || farm->results == NULL) {
+        printf("Could not allocate memory for the jobs of the farm!\n");
+        exit(0);
+    }
+    for (worker = 0; worker < (farm->no_of_threads); worker++) {
+        deque = &((farm->deques)[worker]);
+        first = (int) ((long) worker * (farm->no_of_jobs) / (farm->no_of_threads));
+        last = (int) ((long) (worker + 1) * (farm->no_of_jobs) / (farm->no_of_threads));
+        deque->jobs = malloc((last - first + 1) * sizeof(int));
+        if (deque->jobs == NULL) {
+            printf("Could not allocate memory for the jobs of the farm!\n");
+            exit(0);
+        }
+        for (deque->bottom = 0; first + (deque->bottom) < last; deque->bottom++) {
+            (deque->jobs)[deque->bottom] = first + (deque->bottom);
+        }
+        deque->top = 0;
+        pthread_mutex_init(&(deque->lock), NULL);
+    }
+}
+
+/*
+ * Removes the job in the bottom of the given deque and returns it, or returns NO_JOB
+ * if the deque is empty. Only the worker that owns the deque takes jobs from its bottom.
+ *
+ * Parameters:
+ * -----------
+ * JobDeque *deque  a pointer to the deque.
+ */
+int pop_job(JobDeque *deque) {
+    int job = NO_JOB;
+
+    pthread_mutex_lock(&(deque->lock));
+    if ((deque->bottom) > (deque->top)) {
+        job = (deque->jobs)[--(deque->bottom)];
+    }
+    pthread_mutex_unlock(&(deque->lock));
+    return job;
+}
+
+/*
+ * Removes the job in the top of the given deque and returns it, or returns NO_JOB if
+ * the deque is empty. The other workers steal jobs from the top, away from the end
+ * that the owner works on.
+ *
+ * Parameters:
+ * -----------
+ * JobDeque *deque  a pointer to the deque.
+ */
+int steal_job(JobDeque *deque) {
+    int job = NO_JOB;
+
+    pthread_mutex_lock(&(deque->lock));
+    if ((deque->bottom) > (deque->top)) {
+        job = (deque->jobs)[(deque->top)++];
+    }
+    pthread_mutex_unlock(&(deque->lock));
+    return job;
+}
+
+/*
+ * Returns the next job of the given worker: a job from its own deque, or if its deque
+ * is empty, a job that it steals from the deques of the other workers, starting with
+ * the next worker. Jobs never add jobs, so if all the deques are empty the function
+ * returns NO_JOB, and the worker is done.
+ *
+ * Parameters:
+ * -----------
+ * FarmWorker *worker   a pointer to the worker.
+ */
+int take_job(FarmWorker *worker) {
+    Farm *farm = worker->farm;
+    int job = pop_job(&((farm->deques)[worker->index]));
+    int offset;
+
+    for (offset = 1; job == NO_JOB && offset < (farm->no_of_threads); offset++) {
+        job = steal_job(&((farm->deques)[((worker->index) + offset) % (farm->no_of_threads)]));
+        if (job != NO_JOB) {
+            worker->stolen_jobs++;
+        }
+    }
+    return job;
+}
+
+/*
+ * Returns 1 if the first given number of characters of the given output are exactly
+ * the characters of the given file, and 0 otherwise. If the file can't be read, the
+ * function returns NO_EXPECTED_OUTPUT.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output         the stream that the program printed to.
+ * long length          the number of characters that the program printed.
+ * char *expected_path  the path to the file with the expected output.
+ */
+int compare_output(FILE *output, long length, char *expected_path) {
+    FILE *expected = fopen(expected_path, "rb");
+    int equal = 1;
+
+    if (expected == NULL) {
+        return NO_EXPECTED_OUTPUT;
+    }
+    rewind(output);
+    for (; equal && length > 0; length--) {
+        equal = (getc(output) == getc(expected));
+    }
+    if (equal && getc(expected) != EOF) {
+        equal = 0;
+    }
+    fclose(expected);
+    return equal;
+}
+
+/*
+ * Frees the machine, the threaded program and the snapshot of the program that the
+ * given worker executed last, if it has one.
+ *
+ * Parameters:
+ * -----------
+ * FarmWorker *worker   a pointer to the worker.
+ */
+void free_worker_program(FarmWorker *worker) {
+    if (worker->machine != NULL) {
+        free_snapshot(worker->snapshot);
+        free_threaded_program(worker->program);
+        free_machine(worker->machine);
+        worker->machine = NULL;
+    }
+    worker->program_id = NO_STRING_ID;
+}
+
+/*
+ * Prepares the given worker to execute the given program: copies the memory of its
+ * image to the memory of the worker, predecodes it, and takes a snapshot of the
+ * machine before it executes any command. The next jobs of the same program only
+ * restore the snapshot, so they copy back only the words that the last job wrote.
+ *
+ * Parameters:
+ * -----------
+ * FarmWorker *worker   a pointer to the worker.
+ * int program_id       the id of the program.
+ */
+void load_worker_program(FarmWorker *worker, int program_id) {
+    MachineImage *image = (worker->farm->images)[program_id];
+
+    free_worker_program(worker);
+    memcpy(worker->memory, image->memory, MACHINE_MEMORY_SIZE * sizeof(unsigned short));
+    worker->machine = create_machine(image, NULL, worker->output);
+    worker->machine->memory = worker->memory;
+    worker->program = predecode_program(worker->machine, image, ALL_FUSION_PATTERNS);
+    worker->snapshot = take_snapshot(worker->machine);
+    worker->program_id = program_id;
+}
+
+/*
+ * Executes the job with the given index in the given worker, with the threaded
+ * interpreter, and stores its result. The program is executed in a copy of the memory
+ * of its image that the worker owns, so the image is shared by all the workers, and
+ * the output is printed to a temporary file of the worker, and compared with the
+ * expected output. If the worker executed the same program in its last job, the
+ * machine is reset to its snapshot instead of loading the program again.
+ *
+ * Parameters:
+ * -----------
+ * FarmWorker *worker   a pointer to the worker.
+ * int job_index        the index of the job.
+ */
+void run_farm_job(FarmWorker *worker, int job_index) {
+    Farm *farm = worker->farm;
+    FarmJob *job = &((farm->jobs)[job_index]);
+    FarmResult *result = &((farm->results)[job_index]);
+    Machine *machine;
+    FILE *input;
+    int equal;
+
+    result->status = JOB_NOT_RUN;
+    if ((farm->images)[job->program_id] == NULL ||
+        (input = fopen(get_pool_string(&(farm->file_paths), job->input_id), "r")) == NULL) {
+        return;
+    }
+    if ((worker->program_id) == (job->program_id)) {
+        restore_snapshot(worker->machine, worker->snapshot, worker->program);
+    } else {
+        load_worker_program(worker, job->program_id);
+    }
+    machine = worker->machine;
+    machine->input = input;
+    rewind(worker->output);
+    run_threaded(machine, worker->program, farm->max_instructions);
+    fflush(worker->output);
+    result->executed_instructions = machine->executed_instructions;
+    if ((machine->state) == MACHINE_FAULT) {
+        result->status = JOB_FAULT;
+        result->error_msg = machine->error_msg;
+        result->error_address = machine->error_address;
+    } else if ((machine->state) == MACHINE_RUNNING) {
+        result->status = JOB_UNFINISHED;
+    } else {
+        equal = compare_output(worker->output, ftell(worker->output),
+                               get_pool_string(&(farm->file_paths), job->expected_id));
+        result->status = (equal == NO_EXPECTED_OUTPUT) ? JOB_NOT_RUN : (equal ? JOB_PASSED : JOB_FAILED);
+    }
+    fclose(input);
+}
+
+/*
+ * The function of a worker thread: executes jobs until there are no jobs left in any
+ * of the deques. Returns NULL.
+ *
+ * Parameters:
+ * -----------
+ * void *worker     a pointer to the FarmWorker of the thread.
+ */
+void *run_farm_worker(void *worker) {
+    int job;
+
+    while ((job = take_job((FarmWorker *) worker)) != NO_JOB) {
+        run_farm_job((FarmWorker *) worker, job);
+    }
+    return NULL;
+}
+
+/*
+ * Executes all the jobs of the given farm with its worker threads, and returns the
+ * number of jobs that were stolen. Each worker has its own memory and its own output
+ * file, and the jobs are shared between the workers with their deques. The decoding
+ * table is built before the threads start, so they only read it.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm   a pointer to the farm, with all its jobs.
+ */
+unsigned long run_farm(Farm *farm) {
+    FarmWorker *workers;
+    unsigned long stolen_jobs = 0;
+    int index;
+
+    build_decoding_table();
+    distribute_jobs(farm);
+    if ((workers = calloc(farm->no_of_threads, sizeof(FarmWorker))) == NULL) {
+        printf("Could not allocate memory for the workers of the farm!\n");
+        exit(0);
+    }
+    for (index = 0; index < (farm->no_of_threads); index++) {
+        workers[index].farm = farm;
+        workers[index].index = index;
+        workers[index].program_id = NO_STRING_ID;
+        workers[index].memory = malloc(MACHINE_MEMORY_SIZE * sizeof(unsigned short));
+        workers[index].output = tmpfile();
+        if (workers[index].memory == NULL || workers[index].output == NULL) {
+            printf("Could not allocate memory or a temporary file for the workers of the farm!\n");
+            exit(0);
+        }
+    }
+    for (index = 0; index < (farm->no_of_threads); index++) {
+        if (pthread_create(&(workers[index].thread), NULL, run_farm_worker, &(workers[index])) != 0) {
+            printf("Could not start the threads of the farm!\n");
+            exit(0);
+        }
+    }
+    for (index = 0; index < (farm->no_of_threads); index++) {
+        pthread_join(workers[index].thread, NULL);
+        stolen_jobs += workers[index].stolen_jobs;
+        free_worker_program(&(workers[index]));
+        free(workers[index].memory);
+        fclose(workers[index].output);
+    }
+    free(workers);
+    return stolen_jobs;
+}
+
+/*
+ * Prints the result of each job of the given farm, in the order of the jobs in the
+ * manifest, so the results don't depend on the threads that executed the jobs, and
+ * returns the number of jobs that passed.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm   a pointer to the farm, after its jobs were executed.
+ */
+int print_farm_results(Farm *farm) {
+    FarmJob *job;
+    FarmResult *result;
+    int passed_jobs = 0;
+    int index;
+
+    for (index = 0; index < (farm->no_of_jobs); index++) {
+        job = &((farm->jobs)[index]);
+        result = &((farm->results)[index]);
+        printf("%s %s: ", get_pool_string(&(farm->program_paths), job->program_id),
+               get_pool_string(&(farm->file_paths), job->input_id));
+        switch (result->status) {
+            case JOB_PASSED:
+                printf("passed (%lu instructions)\n", result->executed_instructions);
+                passed_jobs++;
+                break;
+            case JOB_FAILED:
+                printf("the output is not the output in %s\n",
+                       get_pool_string(&(farm->file_paths), job->expected_id));
+                break;
+            case JOB_FAULT:
+                printf("Address: %d\t|  Error: %s\n", result->error_address, result->error_msg);
+                break;
+            case JOB_UNFINISHED:
+                printf("the program didn't stop after %lu instructions\n", result->executed_instructions);
+                break;
+            default:
+                printf("the program, the input file or the file %s can't be read\n",
+                       get_pool_string(&(farm->file_paths), job->expected_id));
+        }
+    }
+    return passed_jobs;
+}
+
+/*
+ * Executes the jobs of the given manifest with the given number of worker threads,
+ * prints the result of each job in the order of the manifest and the number of jobs
+ * that passed, and prints the statistics of the farm. Returns the number of jobs
+ * that passed.
+ *
+ * Parameters:
+ * -----------
+ * char *manifest_path              the path to the manifest.
+ * int no_of_threads                the number of worker threads, or 0 for a thread for each processor.
+ * unsigned long max_instructions   the maximum number of commands of each job, or 0 for no limit.
+ */
+int run_manifest(char *manifest_path, int no_of_threads, unsigned long max_instructions) {
+    Farm *farm;
+    struct timespec start;
+    struct timespec end;
+    unsigned long executed = 0;
+    unsigned long stolen_jobs;
+    double seconds;
+    int passed_jobs;
+    int index;
+
+    farm = create_farm((no_of_threads > 0) ? no_of_threads : get_default_threads(), max_instructions);
+    if (!read_manifest(farm, manifest_path)) {
+        free_farm(farm);
+        return 0;
+    }
+    /* a worker without a job would only look for jobs to steal */
+    if ((farm->no_of_threads) > (farm->no_of_jobs)) {
+        farm->no_of_threads = (farm->no_of_jobs > 0) ? farm->no_of_jobs : 1;
+    }
+    /* the threads run in parallel, so the time is the elapsed time and not the time of the processor */
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    stolen_jobs = (farm->no_of_jobs > 0) ? run_farm(farm) : 0;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (double) (end.tv_sec - start.tv_sec) + (double) (end.tv_nsec - start.tv_nsec) / 1e9;
+    passed_jobs = print_farm_results(farm);
+    printf("%s: %d of %d jobs passed\n", manifest_path, passed_jobs, farm->no_of_jobs);
+    for (index = 0; index < (farm->no_of_jobs); index++) {
+        executed += (farm->results)[index].executed_instructions;
+    }
+    fprintf(stderr, "Executed %s: %lu instructions in %d jobs with %d threads in %.3f seconds", manifest_path,
+            executed, farm->no_of_jobs, farm->no_of_threads, seconds);
+    if (seconds > 0) {
+        fprintf(stderr, " (%.0f instructions per second)", (double) executed / seconds);
+    }
+    fprintf(stderr, ", %lu jobs were stolen\n", stolen_jobs);
+    fflush(stdout);
+    free_farm(farm);
+    return passed_jobs;
+}
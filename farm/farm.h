@@ -0,0 +1,278 @@
+#ifndef ASSEMBLER_SIMULATOR_FARM_H
+#define ASSEMBLER_SIMULATOR_FARM_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "../types.h"
+
+#define THREADS_OPTION "-t" /* the command line option that sets the number of worker threads */
+#define MAX_FARM_THREADS 256 /* the maximum number of worker threads */
+#define MAX_MANIFEST_LINE_LENGTH 4096 /* the maximum number of characters in a line of the manifest */
+#define MANIFEST_PATHS_PER_LINE 3 /* the number of paths in a line of the manifest */
+#define INITIAL_NO_OF_JOBS 64 /* the number of jobs that a farm can store before its array grows */
+#define NO_JOB (-1) /* the index that is returned instead of a job when there are no jobs */
+#define NO_EXPECTED_OUTPUT (-1) /* the file with the expected output can't be read */
+
+#define JOB_NOT_RUN 0 /* the program, the input file or the expected output can't be read */
+#define JOB_PASSED 1 /* the program printed the expected output */
+#define JOB_FAILED 2 /* the program printed another output */
+#define JOB_FAULT 3 /* the program stopped because of an error */
+#define JOB_UNFINISHED 4 /* the program didn't stop before the limit of the number of commands */
+
+/*
+ * A JobDeque structure stores the jobs that a worker of a farm didn't take yet, by
+ * their indexes. The worker takes jobs from the bottom, and the other workers steal
+ * jobs from the top when their own deques are empty. The farm structures are defined
+ * here and not in types.h, since only the farm includes the header of the threads.
+ */
+typedef struct {
+    int *jobs; /* the indexes of the jobs */
+    int top; /* the index of the first job in the array that was not taken */
+    int bottom; /* the index after the last job in the array that was not taken */
+    pthread_mutex_t lock; /* the lock of the owner and the thieves of the deque */
+} JobDeque;
+
+/*
+ * A Farm structure stores the jobs of a manifest and their results. Each program is
+ * loaded once, and its image is shared by all the threads that execute its jobs.
+ */
+typedef struct {
+    StringPool program_paths; /* the distinct programs, the id of each is the index of its image */
+    StringPool file_paths; /* the distinct input files and expected output files */
+    MachineImage **images; /* the loaded image of each program, or NULL if it can't be loaded */
+    FarmJob *jobs; /* the jobs, in the order of the manifest */
+    int no_of_jobs; /* the number of jobs */
+    int jobs_capacity; /* the number of jobs that can be stored before the array has to grow */
+    FarmResult *results; /* the result of each job */
+    JobDeque *deques; /* the deque of each worker thread */
+    int no_of_threads; /* the number of worker threads */
+    unsigned long max_instructions; /* the maximum number of commands of each job, or 0 for no limit */
+} Farm;
+
+/*
+ * A FarmWorker structure stores a worker thread of a farm, with the memory that it
+ * executes programs in, and the temporary file that the programs print to. The worker
+ * keeps the machine of the program it executed last, with a snapshot of the machine
+ * before the program started.
+ */
+typedef struct {
+    Farm *farm; /* the farm of the worker */
+    int index; /* the index of the worker, and of its deque */
+    pthread_t thread; /* the thread of the worker */
+    unsigned short *memory; /* the MACHINE_MEMORY_SIZE words of the memory of the worker */
+    FILE *output; /* the file that the programs of the worker print to */
+    int program_id; /* the id of the program that the worker executed last, or NO_STRING_ID */
+    Machine *machine; /* the machine of the program, or NULL */
+    ThreadedProgram *program; /* the predecoded commands of the program */
+    MachineSnapshot *snapshot; /* the state of the machine before the program started */
+    unsigned long stolen_jobs; /* the number of jobs that the worker stole from other workers */
+} FarmWorker;
+
+/*
+ * Returns the number of worker threads that a farm starts when the number is not
+ * given: the number of processors that are online, and at most MAX_FARM_THREADS.
+ */
+int get_default_threads();
+
+/*
+ * Returns a pointer to a new Farm without jobs, that executes its jobs with the given
+ * number of worker threads. The user should free it with 'free_farm'.
+ *
+ * Parameters:
+ * -----------
+ * int no_of_threads                the number of worker threads.
+ * unsigned long max_instructions   the maximum number of commands of each job, or 0 for no limit.
+ */
+Farm *create_farm(int no_of_threads, unsigned long max_instructions);
+
+/*
+ * Frees the loaded programs, the jobs, the results and the deques of the given farm,
+ * and in the end frees the farm itself.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm   a pointer to the farm.
+ */
+void free_farm(Farm *farm);
+
+/*
+ * Returns the id of the given program in the farm. The program is loaded only the
+ * first time it's added, and all the jobs of the program share its image, which they
+ * never change. If the program can't be loaded, its image is NULL.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm           a pointer to the farm.
+ * char *program_path   the path to the output files of the program, without an extension.
+ */
+int add_farm_program(Farm *farm, char *program_path);
+
+/*
+ * Adds a job to the given farm, that executes the given program with the given input
+ * file, and compares its output with the given file.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm           a pointer to the farm.
+ * char *program_path   the path to the output files of the program, without an extension.
+ * char *input_path     the path to the input file.
+ * char *expected_path  the path to the file with the expected output.
+ */
+void add_farm_job(Farm *farm, char *program_path, char *input_path, char *expected_path);
+
+/*
+ * Adds a job to the given farm for each line of the given manifest. Each line contains
+ * the path to the output files of a program (without an extension), the path to its
+ * input file and the path to the file with its expected output, separated by white
+ * spaces. Empty lines are skipped, and an invalid line is printed and skipped. Returns
+ * 1 if the manifest was read, and 0 if it can't be read.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm           a pointer to the farm.
+ * char *manifest_path  the path to the manifest.
+ */
+int read_manifest(Farm *farm, char *manifest_path);
+
+/*
+ * Fills the deque of each worker of the given farm with a block of adjacent jobs, so
+ * each worker starts with the jobs of the same programs, and creates their locks.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm   a pointer to the farm, with all its jobs.
+ */
+void distribute_jobs(Farm *farm);
+
+/*
+ * Removes the job in the bottom of the given deque and returns it, or returns NO_JOB
+ * if the deque is empty. Only the worker that owns the deque takes jobs from its bottom.
+ *
+ * Parameters:
+ * -----------
+ * JobDeque *deque  a pointer to the deque.
+ */
+int pop_job(JobDeque *deque);
+
+/*
+ * Removes the job in the top of the given deque and returns it, or returns NO_JOB if
+ * the deque is empty. The other workers steal jobs from the top, away from the end
+ * that the owner works on.
+ *
+ * Parameters:
+ * -----------
+ * JobDeque *deque  a pointer to the deque.
+ */
+int steal_job(JobDeque *deque);
+
+/*
+ * Returns the next job of the given worker: a job from its own deque, or if its deque
+ * is empty, a job that it steals from the deques of the other workers, starting with
+ * the next worker. Jobs never add jobs, so if all the deques are empty the function
+ * returns NO_JOB, and the worker is done.
+ *
+ * Parameters:
+ * -----------
+ * FarmWorker *worker   a pointer to the worker.
+ */
+int take_job(FarmWorker *worker);
+
+/*
+ * Returns 1 if the first given number of characters of the given output are exactly
+ * the characters of the given file, and 0 otherwise. If the file can't be read, the
+ * function returns NO_EXPECTED_OUTPUT.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output         the stream that the program printed to.
+ * long length          the number of characters that the program printed.
+ * char *expected_path  the path to the file with the expected output.
+ */
+int compare_output(FILE *output, long length, char *expected_path);
+
+/*
+ * Frees the machine, the threaded program and the snapshot of the program that the
+ * given worker executed last, if it has one.
+ *
+ * Parameters:
+ * -----------
+ * FarmWorker *worker   a pointer to the worker.
+ */
+void free_worker_program(FarmWorker *worker);
+
+/*
+ * Prepares the given worker to execute the given program: copies the memory of its
+ * image to the memory of the worker, predecodes it, and takes a snapshot of the
+ * machine before it executes any command. The next jobs of the same program only
+ * restore the snapshot, so they copy back only the words that the last job wrote.
+ *
+ * Parameters:
+ * -----------
+ * FarmWorker *worker   a pointer to the worker.
+ * int program_id       the id of the program.
+ */
+void load_worker_program(FarmWorker *worker, int program_id);
+
+/*
+ * Executes the job with the given index in the given worker, with the threaded
+ * interpreter, and stores its result. The program is executed in a copy of the memory
+ * of its image that the worker owns, so the image is shared by all the workers, and
+ * the output is printed to a temporary file of the worker, and compared with the
+ * expected output. If the worker executed the same program in its last job, the
+ * machine is reset to its snapshot instead of loading the program again.
+ *
+ * Parameters:
+ * -----------
+ * FarmWorker *worker   a pointer to the worker.
+ * int job_index        the index of the job.
+ */
+void run_farm_job(FarmWorker *worker, int job_index);
+
+/*
+ * The function of a worker thread: executes jobs until there are no jobs left in any
+ * of the deques. Returns NULL.
+ *
+ * Parameters:
+ * -----------
+ * void *worker     a pointer to the FarmWorker of the thread.
+ */
+void *run_farm_worker(void *worker);
+
+/*
+ * Executes all the jobs of the given farm with its worker threads, and returns the
+ * number of jobs that were stolen. Each worker has its own memory and its own output
+ * file, and the jobs are shared between the workers with their deques. The decoding
+ * table is built before the threads start, so they only read it.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm   a pointer to the farm, with all its jobs.
+ */
+unsigned long run_farm(Farm *farm);
+
+/*
+ * Prints the result of each job of the given farm, in the order of the jobs in the
+ * manifest, so the results don't depend on the threads that executed the jobs, and
+ * returns the number of jobs that passed.
+ *
+ * Parameters:
+ * -----------
+ * Farm *farm   a pointer to the farm, after its jobs were executed.
+ */
+int print_farm_results(Farm *farm);
+
+/*
+ * Executes the jobs of the given manifest with the given number of worker threads,
+ * prints the result of each job in the order of the manifest and the number of jobs
+ * that passed, and prints the statistics of the farm. Returns the number of jobs
+ * that passed.
+ *
+ * Parameters:
+ * -----------
+ * char *manifest_path              the path to the manifest.
+ * int no_of_threads                the number of worker threads, or 0 for a thread for each processor.
+ * unsigned long max_instructions   the maximum number of commands of each job, or 0 for no limit.
+ */
+int run_manifest(char *manifest_path, int no_of_threads, unsigned long max_instructions);
+
+#endif
@@ -0,0 +1,28 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "farm.h"
+#include "../simulator/simulator.h"
+
+int main(int argc, char *argv[]) {
+    unsigned long max_instructions = 0; /* the maximum number of commands of each job, or 0 for no limit */
+    int no_of_threads = 0; /* the number of worker threads, or 0 for a thread for each processor */
+    int index;
+
+    /* each argument is a path to a manifest, with a job in each line */
+    for (index = 1; index < argc; index++) {
+        if (strcmp(argv[index], INSTRUCTIONS_LIMIT_OPTION) == 0 && index + 1 < argc) {
+            max_instructions = strtoul(argv[++index], NULL, 10);
+            continue;
+        }
+        if (strcmp(argv[index], THREADS_OPTION) == 0 && index + 1 < argc) {
+            no_of_threads = atoi(argv[++index]);
+            if (no_of_threads > MAX_FARM_THREADS) {
+                no_of_threads = MAX_FARM_THREADS;
+            }
+            continue;
+        }
+        run_manifest(argv[index], no_of_threads, max_instructions);
+    }
+    return 0;
+}
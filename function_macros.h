@@ -13,6 +13,19 @@
  */
 #define GET_ELEMENT(dynamic_array, type, index) (*((type)(((dynamic_array)->array)[index])))
 
+/*
+ * Returns a pointer to an element in a specific index in the given
+ * dynamic array, based on the type of the elements in the array. Unlike
+ * GET_ELEMENT, the element itself is not copied.
+ *
+ * Parameters:
+ * -----------
+ * dynamic_array    a DynamicArray.
+ * type             the type of the pointers in the dynamic array.
+ * index            the index of the element to return from the array.
+ */
+#define GET_POINTER(dynamic_array, type, index) ((type)(((dynamic_array)->array)[index]))
+
 /*
  * Returns a content element in a specific index in the given
  * dynamic array. The dynamic array must store strings only.
@@ -0,0 +1,1005 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "incremental.h"
+#include "compiler.h"
+#include "absolutes.h"
+#include "function_macros.h"
+#include "segments.h"
+#include "command_analysis/command_analysis.h"
+#include "command_analysis/helpers.h"
+#include "error_detection/detector.h"
+#include "error_detection/errors.h"
+#include "data_structures/dynamic_array.h"
+
+#define INITIAL_NO_OF_RECORDS 64 /* the number of records that a state can store after its first growth */
+
+/*
+ * Returns a pointer to a new IncrementalState, that has no analyzed lines.
+ * The user should free it with 'free_incremental_state'.
+ */
+IncrementalState *create_incremental_state() {
+    IncrementalState *state = calloc(1, sizeof(IncrementalState));
+
+    if (state == NULL) {
+        printf("Could not allocate memory for the incremental state!\n");
+        exit(0);
+    }
+    state->symbols_table = create_dynamic_array();
+    return state;
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the records, the lines,
+ * the rows and the tables of the given state, and in the end frees the state itself.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ */
+void free_incremental_state(IncrementalState *state) {
+    int index;
+
+    for (index = 0; index < (state->lines_pool.length); index++) {
+        free_segment(&(state->records)[index].words);
+    }
+    for (index = 0; index < (state->symbols_table->length); index++) {
+        free(GET_POINTER(state->symbols_table, Label*, index));
+    }
+    if (state->program_lines != NULL) {
+        free_program_lines(state->program_lines);
+    }
+    free_array(state->symbols_table);
+    free(state->commands_table.commands);
+    free(state->records);
+    free(state->rows);
+    free(state->labels);
+    free(state->source);
+    free_string_pool(&(state->lines_pool));
+    free(state);
+}
+
+/*
+ * Analyzes the given line, and stores the results in the given record: the type of
+ * the line, its error, the label it defines or declares, and its command or its data.
+ * The words of a command are encoded only after the symbols table is built.
+ *
+ * Parameters:
+ * -----------
+ * LineRecord *record       a pointer to the record to fill.
+ * ProgramLine *line        the line to analyze.
+ */
+void analyze_line(LineRecord *record, ProgramLine *line) {
+    DynamicArray *positions_array = line->positions_array;
+
+    memset(record, 0, sizeof(LineRecord));
+    record->label_id = NO_STRING_ID;
+
+    if (is_empty_command(line->content)) {
+        return;
+    }
+    record->type = get_definition_type(line);
+    record->error_msg = get_command_error(line);
+    if (record->error_msg) {
+        return;
+    }
+    if (record->type == COMMAND_DEFINITION_CODE) {
+        get_command_object(line, 0, NULL, &(record->command));
+        record->no_of_words = get_command_memory_words(&(record->command));
+    } else if (record->type == DATA_DEFINITION_CODE || record->type == STRING_DEFINITION_CODE) {
+        record->no_of_words = encode_data_words(line, &(record->words), 0);
+    } else if (record->type == EXTERN_DEFINITION_CODE || record->type == ENTRY_DEFINITION_CODE) {
+        /* the label of a declaration is the field after the declaration */
+        record->label_id = GET_ELEMENT(positions_array, Field*, get_declaration_index(line) + 1).id;
+    }
+    if ((record->type == COMMAND_DEFINITION_CODE || record->type == DATA_DEFINITION_CODE ||
+         record->type == STRING_DEFINITION_CODE) && has_valid_label(line)) {
+        /* the label is the first field */
+        record->label_id = GET_ELEMENT(positions_array, Field*, 0).id;
+    }
+}
+
+/*
+ * Returns the id of the given line in the lines pool of the given state. If the line
+ * was not analyzed before, the function adds it to the pool, analyzes it, and increases
+ * the given counter of analyzed lines.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state      a pointer to the state.
+ * ProgramLine *line            the line.
+ * int *no_of_analyzed_lines    a pointer to the number of lines that were analyzed.
+ */
+int get_line_id(IncrementalState *state, ProgramLine *line, int *no_of_analyzed_lines) {
+    int no_of_lines = (state->lines_pool.length);
+    int line_id = intern_string(&(state->lines_pool), line->content, (int) strlen(line->content));
+
+    /* the line has already been analyzed */
+    if (line_id < no_of_lines) {
+        return line_id;
+    }
+    if (line_id == (state->capacity)) {
+        state->capacity = (state->capacity) ? 2 * (state->capacity) : INITIAL_NO_OF_RECORDS;
+        state->records = realloc(state->records, (state->capacity) * sizeof(LineRecord));
+        if (state->records == NULL) {
+            printf("Could not allocate memory for the incremental state!\n");
+            exit(0);
+        }
+    }
+    analyze_line(&(state->records)[line_id], line);
+    *no_of_analyzed_lines += 1;
+    return line_id;
+}
+
+/*
+ * Makes sure that the rows array of the given state can store the given number of rows
+ * and the counters after them, and that the labels array can store a state for each
+ * identifier in the string pool. The new label states have no labels.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ * int no_of_rows           the number of rows to store.
+ */
+void reserve_incremental_state(IncrementalState *state, int no_of_rows) {
+    int capacity;
+
+    if (no_of_rows + 1 > (state->rows_capacity)) {
+        capacity = (state->rows_capacity) ? (state->rows_capacity) : INITIAL_NO_OF_RECORDS;
+        while (capacity < no_of_rows + 1) {
+            capacity *= 2;
+        }
+        state->rows = realloc(state->rows, capacity * sizeof(RowState));
+        if (state->rows == NULL) {
+            printf("Could not allocate memory for the incremental state!\n");
+            exit(0);
+        }
+        /* the counters after the rows of the first assembly are the counters of an empty program */
+        if ((state->rows_capacity) == 0) {
+            memset(state->rows, 0, sizeof(RowState));
+        }
+        state->rows_capacity = capacity;
+    }
+    if ((string_pool.length) > (state->labels_capacity)) {
+        capacity = (state->labels_capacity) ? (state->labels_capacity) : INITIAL_NO_OF_RECORDS;
+        while (capacity < (string_pool.length)) {
+            capacity *= 2;
+        }
+        state->labels = realloc(state->labels, capacity * sizeof(LabelState));
+        if (state->labels == NULL) {
+            printf("Could not allocate memory for the incremental state!\n");
+            exit(0);
+        }
+        memset(state->labels + (state->labels_capacity), 0, (capacity - (state->labels_capacity)) * sizeof(LabelState));
+        state->labels_capacity = capacity;
+    }
+}
+
+/*
+ * Removes all the rows, the labels and the commands of the given state, and empties
+ * the code segment and the data segment, so that the next assembly starts from the
+ * first row. The version of each identifier that had a label changes.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ */
+void reset_incremental_tables(IncrementalState *state) {
+    Label *label;
+    int index;
+
+    while ((state->symbols_table->length) > 0) {
+        label = GET_POINTER(state->symbols_table, Label*, (state->symbols_table->length) - 1);
+        (state->labels)[label->id].version += 1;
+        remove_element(state->symbols_table, (state->symbols_table->length) - 1);
+        free(label);
+    }
+    for (index = 0; index < (state->labels_capacity); index++) {
+        (state->labels)[index].label = NULL;
+        (state->labels)[index].previous_label = NULL;
+        (state->labels)[index].no_of_entries = 0;
+    }
+    state->commands_table.length = 0;
+    reset_segment(&code_segment);
+    reset_segment(&data_segment);
+    /* the ids of the lines of the rows are kept, so the lines that didn't change are not searched in the pool */
+    (state->rows)[0].IC = 0;
+    (state->rows)[0].DC = 0;
+    (state->rows)[0].command_index = 0;
+    state->no_of_rows = 0;
+}
+
+/*
+ * Returns the type that the given label was defined with, before it was marked as an
+ * entry label: the type of a command label, of a data label or of an external label.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ * Label *label             a pointer to a label of the symbols table of the state.
+ */
+int get_label_definition_type(IncrementalState *state, Label *label) {
+    int type = (state->records)[(state->rows)[label->index].line_id].type;
+    return (type == STRING_DEFINITION_CODE) ? DATA_DEFINITION_CODE : type;
+}
+
+/*
+ * Adds a label with the given id to the end of the symbols table of the given state.
+ * Returns 1 if the label was added, and 0 if it can't be defined with another label
+ * with the same id. Only the first label with an id is stored in the state of the id,
+ * so the label is found without a search in the symbols table.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ * int label_id             the id of the name of the label in the string pool.
+ * int address              the IC or the DC of the label.
+ * int type                 the type of the label.
+ * int row_index            the index of the row that the label is defined in.
+ */
+int add_row_label(IncrementalState *state, int label_id, int address, int type, int row_index) {
+    LabelState *label_state = &(state->labels)[label_id];
+    Label *label;
+
+    /* only external labels can be declared more than once */
+    if ((label_state->label) != NULL &&
+        (type != EXTERN_DEFINITION_CODE || (label_state->label->type) != EXTERN_DEFINITION_CODE)) {
+        return 0;
+    }
+    label = create_label(label_id);
+    label->address = address;
+    label->type = type;
+    label->index = row_index;
+    add_element(state->symbols_table, label);
+    if ((label_state->label) == NULL) {
+        label_state->label = label;
+    }
+    return 1;
+}
+
+/*
+ * Marks the label with the given id as an entry label if it has an entry declaration,
+ * and restores the type it was defined with otherwise. Returns 1 if the entry
+ * declarations of the id are valid, and 0 if the label is external or it wasn't defined.
+ * The version of the id changes if the type of a label from the rows before the given
+ * row has changed, because its commands are not encoded again otherwise.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ * int label_id             the id of the name of the label in the string pool.
+ * int first_row            the index of the first row that has changed.
+ */
+int update_entry_label(IncrementalState *state, int label_id, int first_row) {
+    LabelState *label_state = &(state->labels)[label_id];
+    Label *label = label_state->label;
+    int type;
+
+    if (label == NULL || (label->type) == EXTERN_DEFINITION_CODE) {
+        return (label_state->no_of_entries) == 0;
+    }
+    type = (label_state->no_of_entries) ? ENTRY_DEFINITION_CODE : get_label_definition_type(state, label);
+    if ((label->type) != type) {
+        label->type = type;
+        if ((label->index) < first_row) {
+            label_state->version += 1;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Updates the symbols table of the given state from the given row: the labels of the
+ * previous rows from this row are removed, and the labels of the given rows from this
+ * row are added, while the labels of the rows before it are kept. Only the ids of the
+ * labels and the entry declarations that were removed or added are checked for errors,
+ * and the version of an id changes only if the address or the type of its label has
+ * changed. The function stores the counters before each row from the given row, and
+ * sets the final IC and DC. Returns 1 if the labels are valid, and 0 if a label is
+ * defined twice or an entry declaration is invalid, without printing the error.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state, with the rows of the previous assembly.
+ * int *line_ids            the id of the line of each row of the program.
+ * int no_of_rows           the number of rows in the program.
+ * int first_row            the index of the first row that has changed.
+ */
+int update_symbols_table(IncrementalState *state, int *line_ids, int no_of_rows, int first_row) {
+    DynamicArray *symbols_table = state->symbols_table;
+    DynamicArray *removed_labels = create_dynamic_array(); /* the labels of the previous rows, that were removed */
+    LineRecord *record;
+    Label *label;
+    Label *current_label;
+
+    int *entry_ids; /* the ids of the entry declarations that were removed or added */
+    int no_of_entry_ids = 0;
+    int first_label; /* the index of the first label that was added to the symbols table */
+    int previous_IC = (state->rows)[state->no_of_rows].IC;
+    int command_index;
+    int valid_flag = 1;
+    int row_index;
+    int index;
+
+    entry_ids = malloc(((state->no_of_rows) + no_of_rows - 2 * first_row + 1) * sizeof(int));
+    if (entry_ids == NULL) {
+        printf("Could not allocate memory for the incremental state!\n");
+        exit(0);
+    }
+    /* remove the entry declarations of the previous rows */
+    for (row_index = first_row; row_index < (state->no_of_rows); row_index++) {
+        record = &(state->records)[(state->rows)[row_index].line_id];
+        if (record->type == ENTRY_DEFINITION_CODE) {
+            (state->labels)[record->label_id].no_of_entries -= 1;
+            entry_ids[no_of_entry_ids++] = record->label_id;
+        }
+    }
+    /* remove the labels of the previous rows, which are in the end of the symbols table */
+    while ((symbols_table->length) > 0 &&
+           (label = GET_POINTER(symbols_table, Label*, (symbols_table->length) - 1))->index >= first_row) {
+        remove_element(symbols_table, (symbols_table->length) - 1);
+        if ((state->labels)[label->id].label == label) {
+            (state->labels)[label->id].label = NULL;
+            (state->labels)[label->id].previous_label = label;
+            add_element(removed_labels, label);
+        } else {
+            free(label);
+        }
+    }
+    first_label = (symbols_table->length);
+
+    /* add the labels of the rows, and count their words */
+    IC = (state->rows)[first_row].IC;
+    DC = (state->rows)[first_row].DC;
+    command_index = (state->rows)[first_row].command_index;
+    for (row_index = first_row; row_index < no_of_rows && valid_flag; row_index++) {
+        record = &(state->records)[line_ids[row_index]];
+        (state->rows)[row_index].line_id = line_ids[row_index];
+        (state->rows)[row_index].IC = IC;
+        (state->rows)[row_index].DC = DC;
+        (state->rows)[row_index].command_index = command_index;
+
+        if (record->type == COMMAND_DEFINITION_CODE) {
+            if (record->label_id != NO_STRING_ID) {
+                valid_flag = add_row_label(state, record->label_id, IC, COMMAND_DEFINITION_CODE, row_index);
+            }
+            IC += (record->no_of_words);
+            command_index++;
+        } else if (record->type == DATA_DEFINITION_CODE || record->type == STRING_DEFINITION_CODE) {
+            if (record->label_id != NO_STRING_ID) {
+                valid_flag = add_row_label(state, record->label_id, DC, DATA_DEFINITION_CODE, row_index);
+            }
+            DC += (record->no_of_words);
+        } else if (record->type == EXTERN_DEFINITION_CODE) {
+            valid_flag = add_row_label(state, record->label_id, 0, EXTERN_DEFINITION_CODE, row_index);
+        } else if (record->type == ENTRY_DEFINITION_CODE) {
+            (state->labels)[record->label_id].no_of_entries += 1;
+            entry_ids[no_of_entry_ids++] = record->label_id;
+        }
+    }
+    if (valid_flag) {
+        (state->rows)[no_of_rows].IC = IC;
+        (state->rows)[no_of_rows].DC = DC;
+        (state->rows)[no_of_rows].command_index = command_index;
+        final_IC = IC;
+        final_DC = DC;
+
+        /* the data labels of the rows before the first row move with the end of the code */
+        for (index = 0; index < first_label && IC != previous_IC; index++) {
+            label = GET_POINTER(symbols_table, Label*, index);
+            if (get_label_definition_type(state, label) == DATA_DEFINITION_CODE) {
+                label->address += IC - previous_IC;
+                (state->labels)[label->id].version += 1;
+            }
+        }
+        /* transform the addresses of the new labels, like 'address_transformation' */
+        for (index = first_label; index < (symbols_table->length); index++) {
+            label = GET_POINTER(symbols_table, Label*, index);
+            if ((label->type) != EXTERN_DEFINITION_CODE) {
+                label->address += LOAD_ADDRESS;
+            }
+            if ((label->type) == DATA_DEFINITION_CODE) {
+                label->address += IC;
+            }
+        }
+        /* mark the entry labels of the ids whose labels or entry declarations have changed */
+        for (index = 0; index < no_of_entry_ids; index++) {
+            valid_flag = update_entry_label(state, entry_ids[index], first_row) && valid_flag;
+        }
+        for (index = 0; index < (removed_labels->length); index++) {
+            label = GET_POINTER(removed_labels, Label*, index);
+            valid_flag = update_entry_label(state, label->id, first_row) && valid_flag;
+        }
+        for (index = first_label; index < (symbols_table->length); index++) {
+            label = GET_POINTER(symbols_table, Label*, index);
+            valid_flag = update_entry_label(state, label->id, first_row) && valid_flag;
+        }
+    }
+    /* the version of an id changes only if its label has changed */
+    for (index = first_label; index < (symbols_table->length); index++) {
+        label = GET_POINTER(symbols_table, Label*, index);
+        if ((state->labels)[label->id].label == label && (state->labels)[label->id].previous_label == NULL) {
+            (state->labels)[label->id].version += 1;
+        }
+    }
+    for (index = 0; index < (removed_labels->length); index++) {
+        label = GET_POINTER(removed_labels, Label*, index);
+        current_label = (state->labels)[label->id].label;
+        if (current_label == NULL || (current_label->address) != (label->address) ||
+            (current_label->type) != (label->type)) {
+            (state->labels)[label->id].version += 1;
+        }
+        (state->labels)[label->id].previous_label = NULL;
+        free(label);
+    }
+    free_array(removed_labels);
+    free(entry_ids);
+    return valid_flag;
+}
+
+/*
+ * Encodes the command of the given record to its 'words' segment, if it wasn't
+ * encoded yet, or if the version of one of the labels it uses has changed since
+ * it was encoded. Returns 1 if the command was encoded, and 0 if its words were
+ * reused. The labels of a command are searched in the symbols table only when
+ * the command is encoded.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ * LineRecord *record       a pointer to the record of a regular command.
+ */
+int update_command_words(IncrementalState *state, LineRecord *record) {
+    ResolvedOperand *operands[2];
+    int version;
+
+    int changed_flag = !(record->encoded);
+    int operand_index;
+
+    operands[0] = &(record->command.source_operand);
+    operands[1] = &(record->command.destination_operand);
+
+    for (operand_index = 0; operand_index < 2; operand_index++) {
+        if (operands[operand_index]->addressing != LABEL_ADDRESSING_CODE) {
+            continue;
+        }
+        version = (state->labels)[operands[operand_index]->value].version;
+        if (version != (record->label_versions)[operand_index]) {
+            (record->label_versions)[operand_index] = version;
+            changed_flag = 1;
+        }
+    }
+    if (!changed_flag) {
+        return 0;
+    }
+    for (operand_index = 0; operand_index < 2; operand_index++) {
+        if (operands[operand_index]->addressing == LABEL_ADDRESSING_CODE) {
+            operands[operand_index]->ARE = (unsigned char) get_operand_ARE_code(operands[operand_index]->value,
+                                                                                state->symbols_table);
+        }
+    }
+    reset_segment(&(record->words));
+    encode_command_words(&(record->command), state->symbols_table, &(record->words), 0);
+    record->encoded = (state->no_of_assemblies);
+    return 1;
+}
+
+/*
+ * Writes the given word to the given index of the given segment, if the segment
+ * has a different word in that index, and lowers the given index of the first word
+ * that was changed accordingly.
+ *
+ * Parameters:
+ * -----------
+ * Segment *segment     a pointer to the segment.
+ * int index            the index of the word.
+ * unsigned int word    the word.
+ * int *first_word      a pointer to the index of the first word of the segment that was changed.
+ */
+void update_segment_word(Segment *segment, int index, unsigned int word, int *first_word) {
+    if (index < (segment->length) && read_word(segment, index) == (unsigned short) word) {
+        return;
+    }
+    write_word(segment, index, word);
+    if (index < *first_word) {
+        *first_word = index;
+    }
+}
+
+/*
+ * Copies the words of the rows from the given row to the code segment and the data
+ * segment, and replaces the commands of the commands table from this row. The rows
+ * before it keep their words and their commands, except of the commands that were
+ * encoded again because one of their labels has changed. The indexes of the first
+ * words that were changed are stored in the state.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state, with the rows of the current assembly.
+ * int first_row            the index of the first row that has changed.
+ */
+void encode_rows(IncrementalState *state, int first_row) {
+    CommandsTable *commands_table = &(state->commands_table);
+    RowState *row;
+    LineRecord *record;
+    int row_index;
+    int word_index;
+
+    state->first_code_word = final_IC;
+    state->first_data_word = final_DC;
+    commands_table->length = (state->rows)[first_row].command_index;
+
+    for (row_index = 0; row_index < (state->no_of_rows); row_index++) {
+        row = &(state->rows)[row_index];
+        record = &(state->records)[row->line_id];
+
+        if (record->type == COMMAND_DEFINITION_CODE) {
+            update_command_words(state, record);
+            if (row_index >= first_row) {
+                append_command(commands_table, &(record->command));
+            } else if ((record->encoded) == (state->no_of_assemblies)) {
+                (commands_table->commands)[row->command_index] = record->command;
+            } else {
+                continue;
+            }
+            (commands_table->commands)[row->command_index].index = row_index;
+            for (word_index = 0; word_index < (record->no_of_words); word_index++) {
+                update_segment_word(&code_segment, (row->IC) + word_index, read_word(&(record->words), word_index),
+                                    &(state->first_code_word));
+            }
+        } else if ((record->type == DATA_DEFINITION_CODE || record->type == STRING_DEFINITION_CODE) &&
+                   row_index >= first_row) {
+            for (word_index = 0; word_index < (record->no_of_words); word_index++) {
+                update_segment_word(&data_segment, (row->DC) + word_index, read_word(&(record->words), word_index),
+                                    &(state->first_data_word));
+            }
+        }
+    }
+}
+
+/*
+ * Adds the labels of the given rows to the given symbols table, in the order of the
+ * rows, and sets the IC and the DC to the number of code words and data words in the
+ * program. The addresses of the labels are transformed to their final addresses. The
+ * labels are searched in the symbols table like in 'get_symbols_table', so that the
+ * errors of the labels are printed in the same order.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state          a pointer to the state.
+ * int *line_ids                    the id of the line of each row of the program.
+ * int no_of_rows                   the number of rows in the program.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ */
+void build_symbols_table(IncrementalState *state, int *line_ids, int no_of_rows, DynamicArray *symbols_table) {
+    LineRecord *record;
+    int row_index;
+
+    IC = 0;
+    DC = 0;
+    for (row_index = 0; row_index < no_of_rows; row_index++) {
+        record = &(state->records)[line_ids[row_index]];
+
+        if (record->type == COMMAND_DEFINITION_CODE) {
+            if (record->label_id == NO_STRING_ID ||
+                add_symbol(symbols_table, record->label_id, IC, COMMAND_DEFINITION_CODE, row_index)) {
+                IC += (record->no_of_words);
+            }
+        } else if (record->type == DATA_DEFINITION_CODE || record->type == STRING_DEFINITION_CODE) {
+            if (record->label_id == NO_STRING_ID ||
+                add_symbol(symbols_table, record->label_id, DC, DATA_DEFINITION_CODE, row_index)) {
+                DC += (record->no_of_words);
+            }
+        } else if (record->type == EXTERN_DEFINITION_CODE) {
+            add_symbol(symbols_table, record->label_id, 0, EXTERN_DEFINITION_CODE, row_index);
+        }
+    }
+    address_transformation(symbols_table);
+    final_IC = IC;
+    final_DC = DC;
+}
+
+/*
+ * Prints the errors of the labels of the given rows, and of the size of the program,
+ * like 'compile'. The function is used only after an error was found in the labels
+ * of the rows, and it builds the symbols table of the state from the first row.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ * int *line_ids            the id of the line of each row of the program.
+ * int no_of_rows           the number of rows in the program.
+ */
+void report_label_errors(IncrementalState *state, int *line_ids, int no_of_rows) {
+    LineRecord *record;
+    int row_index;
+
+    reset_incremental_tables(state);
+    build_symbols_table(state, line_ids, no_of_rows, state->symbols_table);
+    if (final_IC + final_DC > NO_OF_MEMORY_WORDS_IN_PROGRAM) {
+        ERROR_FLAG = 1;
+        print_error(MEMORY_OVERFLOW, -1);
+    }
+    /* mark the entry labels */
+    for (row_index = 0; row_index < no_of_rows && !ERROR_FLAG; row_index++) {
+        record = &(state->records)[line_ids[row_index]];
+        if (record->type == ENTRY_DEFINITION_CODE) {
+            mark_entry_label(state->symbols_table, record->label_id, row_index);
+        }
+    }
+}
+
+/*
+ * Assembles the given rows of a program to the code segment, the data segment, and the
+ * symbols table and the commands table of the given state. The rows before the first
+ * row that is different from the rows of the previous assembly keep their counters,
+ * their labels and their words, and only the rows from that row are counted and added
+ * again. The errors of the program are printed and set the ERROR_FLAG, and in that
+ * case the next assembly starts from the first row.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state of the previous assemblies.
+ * int *line_ids            the id of the line of each row of the program.
+ * int no_of_rows           the number of rows in the program.
+ */
+void assemble_rows(IncrementalState *state, int *line_ids, int no_of_rows) {
+    LineRecord *record;
+    int first_row = 0; /* the index of the first row that is different from the previous assembly */
+    int row_index;
+
+    state->no_of_assemblies += 1;
+    reserve_incremental_state(state, (no_of_rows > (state->no_of_rows)) ? no_of_rows : (state->no_of_rows));
+
+    /* print the errors of the lines */
+    for (row_index = 0; row_index < no_of_rows; row_index++) {
+        record = &(state->records)[line_ids[row_index]];
+        if (record->error_msg) {
+            ERROR_FLAG = 1;
+            print_error(record->error_msg, row_index + 1);
+        }
+    }
+    if (state->valid) {
+        while (first_row < no_of_rows && first_row < (state->no_of_rows) &&
+               (state->rows)[first_row].line_id == line_ids[first_row]) {
+            first_row++;
+        }
+    } else {
+        reset_incremental_tables(state);
+    }
+    state->valid = 0;
+    if (!ERROR_FLAG) {
+        state->valid = update_symbols_table(state, line_ids, no_of_rows, first_row);
+    }
+    for (row_index = first_row; row_index < no_of_rows; row_index++) {
+        (state->rows)[row_index].line_id = line_ids[row_index];
+    }
+    state->no_of_rows = no_of_rows;
+
+    if (!ERROR_FLAG && !(state->valid)) {
+        report_label_errors(state, line_ids, no_of_rows);
+    } else if (!ERROR_FLAG && final_IC + final_DC > NO_OF_MEMORY_WORDS_IN_PROGRAM) {
+        ERROR_FLAG = 1;
+        state->valid = 0;
+        print_error(MEMORY_OVERFLOW, -1);
+    }
+    if (!ERROR_FLAG) {
+        encode_rows(state, first_row);
+    }
+    IC = 0;
+    DC = 0;
+}
+
+/*
+ * Assembles the given lines of a program, after its macros were expanded, to the code
+ * segment, the data segment, and the symbols table and the commands table of the given
+ * state. Only the lines that were not analyzed in a previous assembly with the same
+ * state are analyzed, and the errors of the program are printed and set the ERROR_FLAG.
+ * The segments and the tables are filled only if there's no error in the program.
+ * Returns the number of lines that were analyzed.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state          a pointer to the state of the previous assemblies.
+ * DynamicArray *program_lines      the lines of the program.
+ */
+int assemble_lines(IncrementalState *state, DynamicArray *program_lines) {
+    int *line_ids = malloc(((program_lines->length) + 1) * sizeof(int)); /* the id of the line of each row */
+    int no_of_analyzed_lines = 0;
+    int row_index;
+
+    if (line_ids == NULL) {
+        printf("Could not allocate memory for the incremental state!\n");
+        exit(0);
+    }
+    for (row_index = 0; row_index < (program_lines->length); row_index++) {
+        line_ids[row_index] = get_line_id(state, GET_POINTER(program_lines, ProgramLine*, row_index),
+                                          &no_of_analyzed_lines);
+    }
+    assemble_rows(state, line_ids, program_lines->length);
+    free(line_ids);
+    return no_of_analyzed_lines;
+}
+
+/*
+ * Replaces the program lines of the given state with the lines of the given source.
+ * The lines that the source has in common with the previous source, in its beginning
+ * and in its end, are moved from the previous lines, and only the lines between them
+ * are lexed. Returns the index of the first line that has changed, and stores the
+ * number of common lines in the end of the source, and the offset of the first line
+ * that has changed in the source, in the given pointers. The state takes the
+ * ownership of the given source.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state      a pointer to the state.
+ * char *source                 the characters of the program, that were allocated dynamically.
+ * long length                  the number of characters in the program.
+ * int *no_of_last_lines        a pointer to store the number of common lines in the end of the source in.
+ * long *offset                 a pointer to store the offset of the first line that has changed in.
+ */
+int update_program_lines(IncrementalState *state, char *source, long length, int *no_of_last_lines, long *offset) {
+    DynamicArray *previous_lines = state->program_lines;
+    DynamicArray *program_lines = create_dynamic_array();
+    ProgramLine *line;
+
+    long prefix_length = 0; /* the number of equal characters in the beginning of the sources */
+    long suffix_length = 0; /* the number of equal characters in the end of the sources, after the beginning */
+    long lines_end = length; /* the index after the last character of the lines that are lexed */
+    long line_start = 0;
+    long index;
+    int first_line = 0;
+    int no_of_previous_lines = (previous_lines != NULL) ? (previous_lines->length) : 0;
+    int line_index;
+
+    *no_of_last_lines = 0;
+    if (previous_lines != NULL) {
+        while (prefix_length < length && prefix_length < (state->source_length) &&
+               source[prefix_length] == (state->source)[prefix_length]) {
+            prefix_length++;
+        }
+        while (suffix_length < length - prefix_length && suffix_length < (state->source_length) - prefix_length &&
+               source[length - 1 - suffix_length] == (state->source)[(state->source_length) - 1 - suffix_length]) {
+            suffix_length++;
+        }
+        /* a line is common if its new line is in the common beginning */
+        for (index = 0; index < prefix_length; index++) {
+            if (source[index] == '\n') {
+                first_line++;
+                line_start = index + 1;
+            }
+        }
+        /* a line is common if the new line before it is in the common end */
+        for (index = length - 1; index >= length - suffix_length; index--) {
+            if (source[index] == '\n') {
+                *no_of_last_lines += 1;
+                lines_end = index + 1;
+            }
+        }
+    }
+    *offset = line_start;
+
+    for (line_index = 0; line_index < first_line; line_index++) {
+        add_element(program_lines, GET_POINTER(previous_lines, ProgramLine*, line_index));
+    }
+    /* lex the lines between the common lines, like 'split_program_lines' */
+    for (index = line_start; index < lines_end; index++) {
+        if (source[index] == '\n') {
+            add_element(program_lines, create_program_line(copy_line(source + line_start, index - line_start)));
+            line_start = index + 1;
+        }
+    }
+    if (*no_of_last_lines == 0) {
+        if (length > 0 && source[length - 1] == '\n') {
+            add_element(program_lines, create_program_line(copy_line(" ", 1)));
+        } else {
+            add_element(program_lines, create_program_line(copy_line(source + line_start, length - line_start)));
+        }
+    }
+    for (line_index = first_line; line_index < (program_lines->length); line_index++) {
+        if (is_macro_line(GET_POINTER(program_lines, ProgramLine*, line_index))) {
+            state->no_of_macro_lines += 1;
+        }
+    }
+    for (line_index = no_of_previous_lines - *no_of_last_lines; line_index < no_of_previous_lines; line_index++) {
+        add_element(program_lines, GET_POINTER(previous_lines, ProgramLine*, line_index));
+    }
+    /* free the previous lines that were replaced */
+    for (line_index = first_line; line_index < no_of_previous_lines - *no_of_last_lines; line_index++) {
+        line = GET_POINTER(previous_lines, ProgramLine*, line_index);
+        if (is_macro_line(line)) {
+            state->no_of_macro_lines -= 1;
+        }
+        free_program_line(line);
+    }
+    if (previous_lines != NULL) {
+        free_array(previous_lines);
+    }
+    free(state->source);
+    state->source = source;
+    state->source_length = length;
+    state->program_lines = program_lines;
+    return first_line;
+}
+
+/*
+ * Cuts the given file to the given length.
+ *
+ * Parameters:
+ * -----------
+ * char *path   the path of the file.
+ * long length  the new length of the file.
+ */
+void truncate_file(char *path, long length) {
+    if (truncate(path, (off_t) length) != 0) {
+        remove(path);
+    }
+}
+
+/*
+ * Assembles the program in the given file like 'compile', but analyzes only the lines
+ * that were not analyzed in a previous assembly with the same state, and lexes only the
+ * lines that have changed. The counters, the labels and the words of the rows before the
+ * first row that has changed are kept, and only the commands that use a label whose
+ * address or type has changed are encoded again. The no macros file and the object files
+ * are written from the first line and the first word that have changed. Returns the
+ * number of lines that were analyzed.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state of the previous assemblies.
+ * char *file_path          a path to a file that contains the program, without an extension.
+ */
+int assemble_incrementally(IncrementalState *state, char *file_path) {
+    /* create the path of each file */
+    char *input_file = create_file_path(file_path, INPUT_CODE_FILE_EXTENSION);
+    char *no_macros_file_path = create_file_path(file_path, OUTPUT_NO_MACROS_FILE_EXTENSION);
+    char *object_file_path = create_file_path(file_path, OUTPUT_OBJECT_FILE_EXTENSION);
+    char *entries_file_path = create_file_path(file_path, OUTPUT_ENTRIES_FILE_EXTENSION);
+    char *externals_file_path = create_file_path(file_path, OUTPUT_EXTERNALS_FILE_EXTENSION);
+    char *binary_object_file_path = create_file_path(file_path, OUTPUT_BINARY_OBJECT_FILE_EXTENSION);
+
+    DynamicArray *expanded_lines;
+    RowState *rows;
+    char *source;
+    long length;
+    long offset; /* the offset of the first line that has changed in the source */
+
+    int *line_ids; /* the id of the line of each row of the program */
+    int no_of_previous_lines = (state->program_lines != NULL) ? (state->program_lines->length) : 0;
+    int previous_IC = (state->outputs_flag) ? (state->rows)[state->no_of_rows].IC : 0;
+    int previous_DC = (state->outputs_flag) ? (state->rows)[state->no_of_rows].DC : 0;
+    int no_of_analyzed_lines = 0;
+    int no_of_rows;
+    int no_of_last_lines;
+    int first_line;
+    int first_code_word;
+    int first_data_word;
+    int first_word = 0; /* the first word of the object files that has changed */
+    int row_index;
+
+    /* the errors of the previous assembly don't belong to this assembly */
+    ERROR_FLAG = 0;
+    source = read_source_file(input_file, &length);
+    first_line = update_program_lines(state, source, length, &no_of_last_lines, &offset);
+
+    if (state->no_of_macro_lines == 0) {
+        /* a program without macros is its own expansion, so only the lines between the common lines are analyzed */
+        expanded_lines = state->program_lines;
+        no_of_rows = (expanded_lines->length);
+        rows = state->rows;
+        line_ids = malloc((no_of_rows + 1) * sizeof(int));
+        if (line_ids == NULL) {
+            printf("Could not allocate memory for the incremental state!\n");
+            exit(0);
+        }
+        for (row_index = 0; row_index < no_of_rows; row_index++) {
+            if (!(state->expanded_flag) && row_index < first_line) {
+                line_ids[row_index] = rows[row_index].line_id;
+            } else if (!(state->expanded_flag) && row_index >= no_of_rows - no_of_last_lines) {
+                line_ids[row_index] = rows[row_index - no_of_rows + no_of_previous_lines].line_id;
+            } else {
+                line_ids[row_index] = get_line_id(state, GET_POINTER(expanded_lines, ProgramLine*, row_index),
+                                                  &no_of_analyzed_lines);
+            }
+        }
+        /* the no macros file of a program without macros is written again only from the first line that has changed */
+        if (state->expanded_flag) {
+            first_line = 0;
+            offset = 0;
+        }
+        truncate_file(no_macros_file_path, update_expanded_lines(expanded_lines, first_line, offset,
+                                                                 no_macros_file_path));
+        assemble_rows(state, line_ids, no_of_rows);
+        free(line_ids);
+    } else {
+        expanded_lines = create_dynamic_array();
+        free_macros_table(expand_macros(state->program_lines, expanded_lines, no_macros_file_path));
+        no_of_rows = (expanded_lines->length);
+        no_of_analyzed_lines = assemble_lines(state, expanded_lines);
+        free_array(expanded_lines);
+    }
+    state->expanded_flag = (state->no_of_macro_lines > 0);
+
+    /* the object files of the previous assembly are written again only from the first word that has changed */
+    if (!ERROR_FLAG && state->outputs_flag) {
+        first_code_word = state->first_code_word;
+        first_data_word = state->first_data_word;
+        if (final_IC != previous_IC) {
+            /* the data words moved */
+            first_code_word = (previous_IC < first_code_word) ? previous_IC : first_code_word;
+            first_data_word = 0;
+        }
+        first_word = (final_IC + first_data_word < first_code_word) ? final_IC + first_data_word : first_code_word;
+        first_word = (previous_IC + previous_DC < first_word) ? previous_IC + previous_DC : first_word;
+    }
+    /* don't create the output files if there's an error in the program */
+    if (!ERROR_FLAG) {
+        truncate_file(object_file_path, update_object_file(object_file_path, first_word));
+        remove(entries_file_path);
+        write_entries_file(state->symbols_table, entries_file_path);
+        remove(externals_file_path);
+        write_externals_file(&(state->commands_table), state->symbols_table, externals_file_path);
+        if (BINARY_OBJECT_FLAG) {
+            truncate_file(binary_object_file_path, update_binary_object_file(&(state->commands_table),
+                                                                             state->symbols_table,
+                                                                             binary_object_file_path, first_word));
+        } else {
+            remove(binary_object_file_path);
+        }
+    } else {
+        remove(object_file_path);
+        remove(entries_file_path);
+        remove(externals_file_path);
+        remove(binary_object_file_path);
+    }
+    state->outputs_flag = !ERROR_FLAG;
+    printf("Assembled %s: %d of %d lines were analyzed\n", input_file, no_of_analyzed_lines, no_of_rows);
+
+    free(input_file);
+    free(no_macros_file_path);
+    free(object_file_path);
+    free(entries_file_path);
+    free(externals_file_path);
+    free(binary_object_file_path);
+    return no_of_analyzed_lines;
+}
+
+/*
+ * Assembles the program in the given file, and then checks its modification time
+ * periodically, and assembles it again incrementally whenever it changes. The
+ * function returns when the file is removed.
+ *
+ * Parameters:
+ * -----------
+ * char *file_path  a path to a file that contains the program, without an extension.
+ */
+void watch_program(char *file_path) {
+    IncrementalState *state = create_incremental_state();
+    char *input_file = create_file_path(file_path, INPUT_CODE_FILE_EXTENSION);
+    struct stat file_status;
+    struct timespec last_modification;
+    struct timespec interval;
+
+    interval.tv_sec = 0;
+    interval.tv_nsec = WATCH_INTERVAL_NANOSECONDS;
+    last_modification.tv_sec = 0;
+    last_modification.tv_nsec = 0;
+
+    while (stat(input_file, &file_status) == 0) {
+        if (file_status.st_mtim.tv_sec != last_modification.tv_sec ||
+            file_status.st_mtim.tv_nsec != last_modification.tv_nsec) {
+            last_modification = file_status.st_mtim;
+            assemble_incrementally(state, file_path);
+            fflush(stdout);
+        }
+        nanosleep(&interval, NULL);
+    }
+    free(input_file);
+    free_incremental_state(state);
+}
@@ -0,0 +1,293 @@
+#ifndef ASSEMBLER_SIMULATOR_INCREMENTAL_H
+#define ASSEMBLER_SIMULATOR_INCREMENTAL_H
+
+#include "types.h"
+#include "data_structures/dynamic_array.h"
+
+#define WATCH_OPTION "-w" /* the command line option that watches a program and assembles it whenever it changes */
+#define WATCH_INTERVAL_NANOSECONDS 200000000L /* the time between two checks of the watched program */
+
+/*
+ * Returns a pointer to a new IncrementalState, that has no analyzed lines.
+ * The user should free it with 'free_incremental_state'.
+ */
+IncrementalState *create_incremental_state();
+
+/*
+ * Frees the dynamic memory that was allocated to contain the records, the lines,
+ * the rows and the tables of the given state, and in the end frees the state itself.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ */
+void free_incremental_state(IncrementalState *state);
+
+/*
+ * Analyzes the given line, and stores the results in the given record: the type of
+ * the line, its error, the label it defines or declares, and its command or its data.
+ * The words of a command are encoded only after the symbols table is built.
+ *
+ * Parameters:
+ * -----------
+ * LineRecord *record       a pointer to the record to fill.
+ * ProgramLine *line        the line to analyze.
+ */
+void analyze_line(LineRecord *record, ProgramLine *line);
+
+/*
+ * Returns the id of the given line in the lines pool of the given state. If the line
+ * was not analyzed before, the function adds it to the pool, analyzes it, and increases
+ * the given counter of analyzed lines.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state      a pointer to the state.
+ * ProgramLine *line            the line.
+ * int *no_of_analyzed_lines    a pointer to the number of lines that were analyzed.
+ */
+int get_line_id(IncrementalState *state, ProgramLine *line, int *no_of_analyzed_lines);
+
+/*
+ * Makes sure that the rows array of the given state can store the given number of rows
+ * and the counters after them, and that the labels array can store a state for each
+ * identifier in the string pool. The new label states have no labels.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ * int no_of_rows           the number of rows to store.
+ */
+void reserve_incremental_state(IncrementalState *state, int no_of_rows);
+
+/*
+ * Removes all the rows, the labels and the commands of the given state, and empties
+ * the code segment and the data segment, so that the next assembly starts from the
+ * first row. The version of each identifier that had a label changes.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ */
+void reset_incremental_tables(IncrementalState *state);
+
+/*
+ * Returns the type that the given label was defined with, before it was marked as an
+ * entry label: the type of a command label, of a data label or of an external label.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ * Label *label             a pointer to a label of the symbols table of the state.
+ */
+int get_label_definition_type(IncrementalState *state, Label *label);
+
+/*
+ * Adds a label with the given id to the end of the symbols table of the given state.
+ * Returns 1 if the label was added, and 0 if it can't be defined with another label
+ * with the same id. Only the first label with an id is stored in the state of the id,
+ * so the label is found without a search in the symbols table.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ * int label_id             the id of the name of the label in the string pool.
+ * int address              the IC or the DC of the label.
+ * int type                 the type of the label.
+ * int row_index            the index of the row that the label is defined in.
+ */
+int add_row_label(IncrementalState *state, int label_id, int address, int type, int row_index);
+
+/*
+ * Marks the label with the given id as an entry label if it has an entry declaration,
+ * and restores the type it was defined with otherwise. Returns 1 if the entry
+ * declarations of the id are valid, and 0 if the label is external or it wasn't defined.
+ * The version of the id changes if the type of a label from the rows before the given
+ * row has changed, because its commands are not encoded again otherwise.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ * int label_id             the id of the name of the label in the string pool.
+ * int first_row            the index of the first row that has changed.
+ */
+int update_entry_label(IncrementalState *state, int label_id, int first_row);
+
+/*
+ * Updates the symbols table of the given state from the given row: the labels of the
+ * previous rows from this row are removed, and the labels of the given rows from this
+ * row are added, while the labels of the rows before it are kept. Only the ids of the
+ * labels and the entry declarations that were removed or added are checked for errors,
+ * and the version of an id changes only if the address or the type of its label has
+ * changed. The function stores the counters before each row from the given row, and
+ * sets the final IC and DC. Returns 1 if the labels are valid, and 0 if a label is
+ * defined twice or an entry declaration is invalid, without printing the error.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state, with the rows of the previous assembly.
+ * int *line_ids            the id of the line of each row of the program.
+ * int no_of_rows           the number of rows in the program.
+ * int first_row            the index of the first row that has changed.
+ */
+int update_symbols_table(IncrementalState *state, int *line_ids, int no_of_rows, int first_row);
+
+/*
+ * Encodes the command of the given record to its 'words' segment, if it wasn't
+ * encoded yet, or if the version of one of the labels it uses has changed since
+ * it was encoded. Returns 1 if the command was encoded, and 0 if its words were
+ * reused. The labels of a command are searched in the symbols table only when
+ * the command is encoded.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ * LineRecord *record       a pointer to the record of a regular command.
+ */
+int update_command_words(IncrementalState *state, LineRecord *record);
+
+/*
+ * Writes the given word to the given index of the given segment, if the segment
+ * has a different word in that index, and lowers the given index of the first word
+ * that was changed accordingly.
+ *
+ * Parameters:
+ * -----------
+ * Segment *segment     a pointer to the segment.
+ * int index            the index of the word.
+ * unsigned int word    the word.
+ * int *first_word      a pointer to the index of the first word of the segment that was changed.
+ */
+void update_segment_word(Segment *segment, int index, unsigned int word, int *first_word);
+
+/*
+ * Copies the words of the rows from the given row to the code segment and the data
+ * segment, and replaces the commands of the commands table from this row. The rows
+ * before it keep their words and their commands, except of the commands that were
+ * encoded again because one of their labels has changed. The indexes of the first
+ * words that were changed are stored in the state.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state, with the rows of the current assembly.
+ * int first_row            the index of the first row that has changed.
+ */
+void encode_rows(IncrementalState *state, int first_row);
+
+/*
+ * Adds the labels of the given rows to the given symbols table, in the order of the
+ * rows, and sets the IC and the DC to the number of code words and data words in the
+ * program. The addresses of the labels are transformed to their final addresses. The
+ * labels are searched in the symbols table like in 'get_symbols_table', so that the
+ * errors of the labels are printed in the same order.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state          a pointer to the state.
+ * int *line_ids                    the id of the line of each row of the program.
+ * int no_of_rows                   the number of rows in the program.
+ * DynamicArray *symbols_table      a DynamicArray pointer.
+ */
+void build_symbols_table(IncrementalState *state, int *line_ids, int no_of_rows, DynamicArray *symbols_table);
+
+/*
+ * Prints the errors of the labels of the given rows, and of the size of the program,
+ * like 'compile'. The function is used only after an error was found in the labels
+ * of the rows, and it builds the symbols table of the state from the first row.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state.
+ * int *line_ids            the id of the line of each row of the program.
+ * int no_of_rows           the number of rows in the program.
+ */
+void report_label_errors(IncrementalState *state, int *line_ids, int no_of_rows);
+
+/*
+ * Assembles the given rows of a program to the code segment, the data segment, and the
+ * symbols table and the commands table of the given state. The rows before the first
+ * row that is different from the rows of the previous assembly keep their counters,
+ * their labels and their words, and only the rows from that row are counted and added
+ * again. The errors of the program are printed and set the ERROR_FLAG, and in that
+ * case the next assembly starts from the first row.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state of the previous assemblies.
+ * int *line_ids            the id of the line of each row of the program.
+ * int no_of_rows           the number of rows in the program.
+ */
+void assemble_rows(IncrementalState *state, int *line_ids, int no_of_rows);
+
+/*
+ * Assembles the given lines of a program, after its macros were expanded, to the code
+ * segment, the data segment, and the symbols table and the commands table of the given
+ * state. Only the lines that were not analyzed in a previous assembly with the same
+ * state are analyzed, and the errors of the program are printed and set the ERROR_FLAG.
+ * The segments and the tables are filled only if there's no error in the program.
+ * Returns the number of lines that were analyzed.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state          a pointer to the state of the previous assemblies.
+ * DynamicArray *program_lines      the lines of the program.
+ */
+int assemble_lines(IncrementalState *state, DynamicArray *program_lines);
+
+/*
+ * Replaces the program lines of the given state with the lines of the given source.
+ * The lines that the source has in common with the previous source, in its beginning
+ * and in its end, are moved from the previous lines, and only the lines between them
+ * are lexed. Returns the index of the first line that has changed, and stores the
+ * number of common lines in the end of the source, and the offset of the first line
+ * that has changed in the source, in the given pointers. The state takes the
+ * ownership of the given source.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state      a pointer to the state.
+ * char *source                 the characters of the program, that were allocated dynamically.
+ * long length                  the number of characters in the program.
+ * int *no_of_last_lines        a pointer to store the number of common lines in the end of the source in.
+ * long *offset                 a pointer to store the offset of the first line that has changed in.
+ */
+int update_program_lines(IncrementalState *state, char *source, long length, int *no_of_last_lines, long *offset);
+
+/*
+ * Cuts the given file to the given length.
+ *
+ * Parameters:
+ * -----------
+ * char *path   the path of the file.
+ * long length  the new length of the file.
+ */
+void truncate_file(char *path, long length);
+
+/*
+ * Assembles the program in the given file like 'compile', but analyzes only the lines
+ * that were not analyzed in a previous assembly with the same state, and lexes only the
+ * lines that have changed. The counters, the labels and the words of the rows before the
+ * first row that has changed are kept, and only the commands that use a label whose
+ * address or type has changed are encoded again. The no macros file and the object files
+ * are written from the first line and the first word that have changed. Returns the
+ * number of lines that were analyzed.
+ *
+ * Parameters:
+ * -----------
+ * IncrementalState *state  a pointer to the state of the previous assemblies.
+ * char *file_path          a path to a file that contains the program, without an extension.
+ */
+int assemble_incrementally(IncrementalState *state, char *file_path);
+
+/*
+ * Assembles the program in the given file, and then checks its modification time
+ * periodically, and assembles it again incrementally whenever it changes. The
+ * function returns when the file is removed.
+ *
+ * Parameters:
+ * -----------
+ * char *file_path  a path to a file that contains the program, without an extension.
+ */
+void watch_program(char *file_path);
+
+#endif
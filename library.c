@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "library.h"
+#include "incremental.h"
+#include "absolutes.h"
+#include "function_macros.h"
+#include "segments.h"
+#include "command_analysis/command_analysis.h"
+#include "data_structures/dynamic_array.h"
+#include "data_structures/output_buffer.h"
+
+/*
+ * Appends a line with the name and the address of each of the given labels to
+ * the given output buffer, in the format of the entries and externals files.
+ *
+ * Parameters:
+ * -----------
+ * OutputBuffer *output     a pointer to the output buffer.
+ * DynamicArray *labels     a DynamicArray of Label pointers.
+ * int type                 the type of the labels to append, or -1 to append all of them.
+ */
+void append_labels(OutputBuffer *output, DynamicArray *labels, int type) {
+    Label *temp_label;
+
+    int index;
+
+    for (index = 0; index < (labels->length); index++) {
+        temp_label = GET_POINTER(labels, Label*, index);
+        if (type < 0 || (temp_label->type) == type) {
+            append_output(output, temp_label->name);
+            append_output(output, " ");
+            append_output_number(output, temp_label->address);
+            append_output(output, "\n");
+        }
+    }
+}
+
+/*
+ * Copies the code words and then the data words of the assembled program to the words
+ * array of the given result, as much as it can store, and sets the sizes of the program.
+ *
+ * Parameters:
+ * -----------
+ * AssemblyResult *result   a pointer to the result.
+ */
+void copy_program_words(AssemblyResult *result) {
+    int index;
+
+    result->code_words = final_IC;
+    result->data_words = final_DC;
+    for (index = 0; index < final_IC && index < (result->capacity); index++) {
+        (result->words)[index] = (unsigned short) read_word(&code_segment, index);
+    }
+    for (index = 0; index < final_DC && final_IC + index < (result->capacity); index++) {
+        (result->words)[final_IC + index] = (unsigned short) read_word(&data_segment, index);
+    }
+}
+
+/*
+ * Returns 1 if the given output buffer stores all the text that was appended to it
+ * (with its null terminator), and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * OutputBuffer *output     a pointer to the output buffer.
+ */
+int is_output_complete(OutputBuffer *output) {
+    return (output->length) == 0 || (output->length) < (output->capacity);
+}
+
+/*
+ * Assembles the program in the given buffer without reading or writing any file, and
+ * stores its outputs in the buffers of the given result: its memory words, the lines
+ * of its entries file and externals file, and its errors (which are not printed). The
+ * sizes of the outputs are always set, even if they don't fit in their buffers, so the
+ * user can assemble the program again with larger buffers. Returns ASSEMBLY_SUCCEEDED,
+ * ASSEMBLY_FAILED or ASSEMBLY_TRUNCATED. The assembler uses global tables, so programs
+ * can't be assembled in parallel.
+ *
+ * Parameters:
+ * -----------
+ * const char *source       the characters of the program, not necessarily null-terminated.
+ * size_t length            the number of characters in the program.
+ * AssemblyResult *result   a pointer to the result, with the buffers of the user.
+ */
+int assemble_buffer(const char *source, size_t length, AssemblyResult *result) {
+    IncrementalState *state = create_incremental_state();
+    DynamicArray *program_lines;
+    DynamicArray *expanded_lines = create_dynamic_array();
+    DynamicArray *references;
+    OutputBuffer *previous_diagnostics = diagnostics_buffer;
+
+    int status = ASSEMBLY_FAILED;
+
+    result->code_words = 0;
+    result->data_words = 0;
+    reset_output(&(result->entries));
+    reset_output(&(result->externals));
+    reset_output(&(result->diagnostics));
+
+    /* the errors and the identifiers of the previous program don't belong to this program */
+    ERROR_FLAG = 0;
+    reset_string_pool(&string_pool);
+    diagnostics_buffer = &(result->diagnostics);
+
+    /* the identifiers of the lines are interned when the lines are lexed */
+    program_lines = split_program_lines(source, length);
+    free_macros_table(expand_macro_lines(program_lines, expanded_lines));
+    assemble_lines(state, expanded_lines);
+
+    if (!ERROR_FLAG) {
+        copy_program_words(result);
+        append_labels(&(result->entries), state->symbols_table, ENTRY_DEFINITION_CODE);
+        references = get_external_references(&(state->commands_table), state->symbols_table);
+        append_labels(&(result->externals), references, -1);
+        free_dynamic_array(references);
+
+        status = ASSEMBLY_SUCCEEDED;
+        if (final_IC + final_DC > (result->capacity) || !is_output_complete(&(result->entries)) ||
+            !is_output_complete(&(result->externals))) {
+            status = ASSEMBLY_TRUNCATED;
+        }
+    }
+    diagnostics_buffer = previous_diagnostics;
+
+    free_array(expanded_lines);
+    free_program_lines(program_lines);
+    free_incremental_state(state);
+    return status;
+}
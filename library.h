@@ -0,0 +1,28 @@
+#ifndef ASSEMBLER_SIMULATOR_LIBRARY_H
+#define ASSEMBLER_SIMULATOR_LIBRARY_H
+
+#include <stddef.h>
+#include "types.h"
+
+#define ASSEMBLY_SUCCEEDED 0 /* the program was assembled, and all its outputs were stored */
+#define ASSEMBLY_FAILED 1 /* an error was found in the program, and it's described in the diagnostics */
+#define ASSEMBLY_TRUNCATED 2 /* the program was assembled, but an output didn't fit in its buffer */
+
+/*
+ * Assembles the program in the given buffer without reading or writing any file, and
+ * stores its outputs in the buffers of the given result: its memory words, the lines
+ * of its entries file and externals file, and its errors (which are not printed). The
+ * sizes of the outputs are always set, even if they don't fit in their buffers, so the
+ * user can assemble the program again with larger buffers. Returns ASSEMBLY_SUCCEEDED,
+ * ASSEMBLY_FAILED or ASSEMBLY_TRUNCATED. The assembler uses global tables, so programs
+ * can't be assembled in parallel.
+ *
+ * Parameters:
+ * -----------
+ * const char *source       the characters of the program, not necessarily null-terminated.
+ * size_t length            the number of characters in the program.
+ * AssemblyResult *result   a pointer to the result, with the buffers of the user.
+ */
+int assemble_buffer(const char *source, size_t length, AssemblyResult *result);
+
+#endif
@@ -0,0 +1,864 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "link_state.h"
+#include "linker.h"
+#include "../absolutes.h"
+#include "../segments.h"
+#include "../compiler.h"
+#include "../build_cache.h"
+#include "../loader/loader.h"
+#include "../loader/base_64.h"
+#include "../command_analysis/helpers.h"
+#include "../error_detection/errors.h"
+
+/* the extensions of the output files of a module, that the loader may read */
+char *module_extensions[NO_OF_MODULE_FILES] = {OUTPUT_BINARY_OBJECT_FILE_EXTENSION, OUTPUT_OBJECT_FILE_EXTENSION,
+                                               OUTPUT_ENTRIES_FILE_EXTENSION, OUTPUT_EXTERNALS_FILE_EXTENSION};
+
+/*
+ * Returns a hash of the sizes and the modification times of the output files of the
+ * given module. The contents of a module are hashed only if its signature has changed.
+ *
+ * Parameters:
+ * -----------
+ * char *module_path    the path to the output files of the module, without an extension.
+ */
+unsigned long get_module_signature(char *module_path) {
+    unsigned long first_hash = FNV_OFFSET_BASIS;
+    unsigned long second_hash = SECOND_HASH_BASIS;
+    struct stat file_status;
+    long fields[3]; /* the size and the modification time of a file */
+    char *file_path;
+    int index;
+
+    for (index = 0; index < NO_OF_MODULE_FILES; index++) {
+        file_path = create_file_path(module_path, module_extensions[index]);
+        memset(fields, 0, sizeof(fields));
+        if (stat(file_path, &file_status) == 0) {
+            fields[0] = (long) file_status.st_size;
+            fields[1] = (long) file_status.st_mtim.tv_sec;
+            fields[2] = (long) file_status.st_mtim.tv_nsec;
+        } else {
+            fields[0] = -1;
+        }
+        hash_bytes((const unsigned char *) fields, sizeof(fields), &first_hash, &second_hash);
+        free(file_path);
+    }
+    return first_hash;
+}
+
+/*
+ * Stores a 64-bit hash of the contents of the output files of the given module in
+ * the given array (as two 32-bit hashes).
+ *
+ * Parameters:
+ * -----------
+ * char *module_path    the path to the output files of the module, without an extension.
+ * unsigned long *hash  an array of two hashes.
+ */
+void hash_module(char *module_path, unsigned long *hash) {
+    unsigned char exists; /* separates a missing file from an empty one */
+    char *file_path;
+    char *contents;
+    size_t length;
+    int index;
+
+    hash[0] = FNV_OFFSET_BASIS;
+    hash[1] = SECOND_HASH_BASIS;
+    for (index = 0; index < NO_OF_MODULE_FILES; index++) {
+        file_path = create_file_path(module_path, module_extensions[index]);
+        contents = map_file(file_path, &length);
+        exists = (unsigned char) (contents != NULL);
+        hash_bytes(&exists, 1, &hash[0], &hash[1]);
+        if (contents != NULL) {
+            hash_bytes((const unsigned char *) contents, length, &hash[0], &hash[1]);
+            unmap_file(contents, length);
+        }
+        free(file_path);
+    }
+}
+
+
+/*
+ * Writes a line for each of the given symbols to the given link state file,
+ * with the name of the symbol and its address.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file               the link state file.
+ * LoadedSymbols *symbols   a pointer to the symbols.
+ */
+void write_state_symbols(FILE *file, LoadedSymbols *symbols) {
+    int index;
+
+    for (index = 0; index < (symbols->length); index++) {
+        fprintf(file, "%s %d\n", get_pool_string(&(symbols->names), (symbols->ids)[index]),
+                (symbols->addresses)[index]);
+    }
+}
+
+/*
+ * Writes the fields of the line of the given module to the given link state file: its
+ * placement, its sizes, its signature, the hash of its contents and the number of its
+ * symbols. The hashes have a fixed width, so the fields of a module whose contents
+ * have not changed can be overwritten in their place.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file               the link state file.
+ * LinkedModule *module     a pointer to the module.
+ */
+void write_state_fields(FILE *file, LinkedModule *module) {
+    MachineImage *image = module->image;
+
+    fprintf(file, "%d %d %d %d %d %0*lx %0*lx %0*lx %d %d", module->code_address, module->data_address,
+            image->load_address, image->code_words, image->data_words, STATE_HASH_WIDTH, module->signature,
+            STATE_HASH_WIDTH, module->hash[0], STATE_HASH_WIDTH, module->hash[1], image->entries.length,
+            image->externals.length);
+}
+
+/*
+ * Writes the line of the given module to the given link state file, followed by a
+ * line for each of its entry labels and each use of an external label.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file               the link state file.
+ * LinkedModule *module     a pointer to the module.
+ */
+void write_state_module(FILE *file, LinkedModule *module) {
+    fprintf(file, "%s ", module->path);
+    write_state_fields(file, module);
+    fputc('\n', file);
+    write_state_symbols(file, &(module->image->entries));
+    write_state_symbols(file, &(module->image->externals));
+}
+
+/*
+ * Writes the link state file of a program that was linked from the given modules.
+ * Each module has a line with its path, its placement, its sizes, its signature and
+ * the hash of its contents, followed by a line for each of its entry labels and each
+ * use of an external label, with the address in the module (as in its own files).
+ *
+ * Parameters:
+ * -----------
+ * char *output_path        a path to the output files of the program, without an extension.
+ * LinkedModule *modules    the modules of the program, after they were placed.
+ * int no_of_modules        the number of modules.
+ */
+void write_link_state(char *output_path, LinkedModule *modules, int no_of_modules) {
+    char *state_file_path = create_file_path(output_path, OUTPUT_LINK_STATE_FILE_EXTENSION);
+    FILE *file = fopen(state_file_path, "w");
+    int index;
+
+    free(state_file_path);
+    if (file == NULL) {
+        return;
+    }
+    fprintf(file, "%s %d\n", LINK_STATE_MAGIC, no_of_modules);
+    for (index = 0; index < no_of_modules; index++) {
+        write_state_module(file, &modules[index]);
+    }
+    fclose(file);
+}
+
+/*
+ * Reads the next token of the given file, that ends with a white character or with
+ * the end of the file. Returns a pointer to a new string that contains the token,
+ * or NULL if there are no more tokens in the file. The user should free the string
+ * in the end of the usage.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file   the file to read from.
+ */
+char *read_token(FILE *file) {
+    int capacity = INITIAL_TOKEN_LENGTH;
+    int length = 0;
+    int character;
+    char *token;
+
+    while ((character = fgetc(file)) != EOF && isspace(character)) {
+        continue;
+    }
+    if (character == EOF) {
+        return NULL;
+    }
+    if ((token = malloc(capacity)) == NULL) {
+        printf("Could not allocate memory for the link state!\n");
+        exit(0);
+    }
+    do {
+        if (length + 1 == capacity) {
+            capacity *= 2;
+            if ((token = realloc(token, capacity)) == NULL) {
+                printf("Could not allocate memory for the link state!\n");
+                exit(0);
+            }
+        }
+        token[length++] = (char) character;
+    } while ((character = fgetc(file)) != EOF && !isspace(character));
+    token[length] = '\0';
+    return token;
+}
+
+/*
+ * Adds the given number of symbols from the lines of the given link state file to
+ * the given symbols. Returns 1 if all the symbols were read, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file               the link state file.
+ * LoadedSymbols *symbols   a pointer to the symbols.
+ * int no_of_symbols        the number of symbols to read.
+ */
+int read_state_symbols(FILE *file, LoadedSymbols *symbols, int no_of_symbols) {
+    char *name;
+    int address;
+    int index;
+
+    for (index = 0; index < no_of_symbols; index++) {
+        if ((name = read_token(file)) == NULL) {
+            return 0;
+        }
+        if (fscanf(file, "%d", &address) != 1) {
+            free(name);
+            return 0;
+        }
+        add_loaded_symbol(symbols, name, (int) strlen(name), address);
+        free(name);
+    }
+    return 1;
+}
+
+/*
+ * Reads the line of a module from the given link state file to the given module, and
+ * then its symbols. Returns 1 if the module was read and it has the given path, and
+ * 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file           the link state file.
+ * LinkedModule *module a pointer to the module.
+ * char *module_path    the path that the module should have.
+ */
+int read_state_module(FILE *file, LinkedModule *module, char *module_path) {
+    MachineImage *image;
+    char *path = read_token(file);
+    int no_of_entries;
+    int no_of_externals;
+    int same_path = (path != NULL && strcmp(path, module_path) == 0);
+
+    free(path);
+    if (!same_path) {
+        return 0;
+    }
+    if ((image = calloc(1, sizeof(MachineImage))) == NULL) {
+        printf("Could not allocate memory for the link state!\n");
+        exit(0);
+    }
+    module->path = module_path;
+    module->image = image;
+    /* the space after the path was read with the path */
+    module->state_offset = ftell(file);
+    if (fscanf(file, "%d %d %d %d %d %lx %lx %lx %d %d", &(module->code_address), &(module->data_address),
+               &(image->load_address), &(image->code_words), &(image->data_words), &(module->signature),
+               &(module->hash[0]), &(module->hash[1]), &no_of_entries, &no_of_externals) != 10) {
+        return 0;
+    }
+    return (image->code_words) >= 0 && (image->data_words) >= 0 &&
+           read_state_symbols(file, &(image->entries), no_of_entries) &&
+           read_state_symbols(file, &(image->externals), no_of_externals);
+}
+
+/*
+ * Returns the id of the given label name in the link state. If the name is not in
+ * the state yet, the function adds it without an entry label and without sites.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state     a pointer to the link state.
+ * char *name           the name of the label.
+ */
+int get_state_name_id(LinkState *state, char *name) {
+    int id = find_string_id(&(state->entries.names), name);
+
+    if (id != NO_STRING_ID) {
+        return id;
+    }
+    add_loaded_symbol(&(state->entries), name, (int) strlen(name), -1);
+    id = (state->entries.names.length) - 1;
+    if (id == (state->names_capacity)) {
+        state->names_capacity = (state->names_capacity) ? 2 * (state->names_capacity) : INITIAL_NO_OF_STATE_NAMES;
+        state->entry_modules = realloc(state->entry_modules, (state->names_capacity) * sizeof(int));
+        state->first_sites = realloc(state->first_sites, (state->names_capacity) * sizeof(int));
+        if (state->entry_modules == NULL || state->first_sites == NULL) {
+            printf("Could not allocate memory for the link state!\n");
+            exit(0);
+        }
+    }
+    (state->entry_modules)[id] = -1;
+    (state->first_sites)[id] = -1;
+    return id;
+}
+
+/*
+ * Adds the entry labels of the given module to the global entries of the given link
+ * state, with their addresses in the linked image. Returns the number of entry labels
+ * that were already defined by a module, and were not added.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state     a pointer to the link state.
+ * int module_index     the index of the module, after it was placed.
+ */
+int add_state_entries(LinkState *state, int module_index) {
+    LinkedModule *module = &(state->modules)[module_index];
+    LoadedSymbols *module_entries = &(module->image->entries);
+    int no_of_conflicts = 0;
+    int index;
+    int id;
+
+    for (index = 0; index < (module_entries->length); index++) {
+        id = get_state_name_id(state, get_pool_string(&(module_entries->names), (module_entries->ids)[index]));
+        if ((state->entry_modules)[id] != -1) {
+            no_of_conflicts++;
+            continue;
+        }
+        (state->entries.addresses)[(state->entries.first_indexes)[id]] = relocate_address(
+                module, (module_entries->addresses)[index]);
+        (state->entry_modules)[id] = module_index;
+    }
+    return no_of_conflicts;
+}
+
+/*
+ * Adds a site to the given link state for each use of an external label in the
+ * given module, in the reverse index of the name of the label.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state     a pointer to the link state.
+ * int module_index     the index of the module, after it was placed.
+ */
+void add_state_sites(LinkState *state, int module_index) {
+    LinkedModule *module = &(state->modules)[module_index];
+    LoadedSymbols *externals = &(module->image->externals);
+    int site_index;
+    int index;
+    int id;
+
+    for (index = 0; index < (externals->length); index++) {
+        id = get_state_name_id(state, get_pool_string(&(externals->names), (externals->ids)[index]));
+        /* reuse a removed site, or add a site to the end of the array */
+        if ((state->free_sites) != -1) {
+            site_index = state->free_sites;
+            state->free_sites = (state->sites)[site_index].next_site;
+        } else {
+            if ((state->no_of_sites) == (state->sites_capacity)) {
+                state->sites_capacity = (state->sites_capacity) ? 2 * (state->sites_capacity) :
+                                        INITIAL_NO_OF_PATCH_SITES;
+                state->sites = realloc(state->sites, (state->sites_capacity) * sizeof(PatchSite));
+                if (state->sites == NULL) {
+                    printf("Could not allocate memory for the link state!\n");
+                    exit(0);
+                }
+            }
+            site_index = (state->no_of_sites)++;
+        }
+        (state->sites)[site_index].module_index = module_index;
+        (state->sites)[site_index].address = relocate_address(module, (externals->addresses)[index]);
+        (state->sites)[site_index].next_site = (state->first_sites)[id];
+        (state->first_sites)[id] = site_index;
+    }
+}
+
+/*
+ * Removes the entry labels and the sites of the given module from the given link
+ * state. Only the names that the module defines or uses are touched.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state         a pointer to the link state.
+ * LinkedModule *module     a pointer to the module, as it was added to the state.
+ * int module_index         the index of the module.
+ */
+void remove_state_symbols(LinkState *state, LinkedModule *module, int module_index) {
+    LoadedSymbols *module_entries = &(module->image->entries);
+    LoadedSymbols *externals = &(module->image->externals);
+    int previous_site;
+    int site_index;
+    int next_site;
+    int index;
+    int id;
+
+    for (index = 0; index < (module_entries->length); index++) {
+        id = find_string_id(&(state->entries.names),
+                            get_pool_string(&(module_entries->names), (module_entries->ids)[index]));
+        if (id != NO_STRING_ID && (state->entry_modules)[id] == module_index) {
+            (state->entries.addresses)[(state->entries.first_indexes)[id]] = -1;
+            (state->entry_modules)[id] = -1;
+        }
+    }
+    /* the sites of each name that the module uses are unlinked once */
+    for (index = 0; index < (externals->names.length); index++) {
+        id = find_string_id(&(state->entries.names), get_pool_string(&(externals->names), index));
+        previous_site = -1;
+        site_index = (id != NO_STRING_ID) ? (state->first_sites)[id] : -1;
+        while (site_index != -1) {
+            next_site = (state->sites)[site_index].next_site;
+            if ((state->sites)[site_index].module_index != module_index) {
+                previous_site = site_index;
+            } else {
+                if (previous_site == -1) {
+                    (state->first_sites)[id] = next_site;
+                } else {
+                    (state->sites)[previous_site].next_site = next_site;
+                }
+                (state->sites)[site_index].next_site = state->free_sites;
+                state->free_sites = site_index;
+            }
+            site_index = next_site;
+        }
+    }
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the modules, the entries
+ * and the sites of the given link state, and in the end frees the state itself.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state     a pointer to the link state.
+ */
+void free_link_state(LinkState *state) {
+    free_linked_modules(state->modules, state->no_of_modules);
+    free_loaded_symbols(&(state->entries));
+    free(state->entry_modules);
+    free(state->first_sites);
+    free(state->sites);
+    free(state);
+}
+
+/*
+ * Reads the link state file of the given program, and returns the link state that it
+ * describes. The image of each module contains only its sizes and its symbols, and
+ * not its words. The global entries and the sites of the external labels are indexed
+ * while the modules are read. If the file doesn't exist, it's not valid, or the program
+ * was linked from other modules, the function returns NULL. The user should free the
+ * state with 'free_link_state'.
+ *
+ * Parameters:
+ * -----------
+ * char *output_path        a path to the output files of the program, without an extension.
+ * char *module_paths[]     the paths to the output files of the modules, without an extension.
+ * int no_of_modules        the number of modules.
+ */
+LinkState *read_link_state(char *output_path, char *module_paths[], int no_of_modules) {
+    char *state_file_path = create_file_path(output_path, OUTPUT_LINK_STATE_FILE_EXTENSION);
+    FILE *file = fopen(state_file_path, "r");
+    LinkState *state;
+    char *magic;
+    int state_modules;
+    int valid_flag;
+    int index;
+
+    free(state_file_path);
+    if (file == NULL) {
+        return NULL;
+    }
+    if ((state = calloc(1, sizeof(LinkState))) == NULL ||
+        (state->modules = calloc((size_t) no_of_modules + 1, sizeof(LinkedModule))) == NULL) {
+        printf("Could not allocate memory for the link state!\n");
+        exit(0);
+    }
+    state->no_of_modules = no_of_modules;
+    state->free_sites = -1;
+    magic = read_token(file);
+    valid_flag = (magic != NULL && strcmp(magic, LINK_STATE_MAGIC) == 0 &&
+                  fscanf(file, "%d", &state_modules) == 1 && state_modules == no_of_modules);
+    free(magic);
+    for (index = 0; index < no_of_modules && valid_flag; index++) {
+        valid_flag = read_state_module(file, &(state->modules)[index], module_paths[index]);
+    }
+    fclose(file);
+    for (index = 0; index < no_of_modules && valid_flag; index++) {
+        state->code_words += (state->modules)[index].image->code_words;
+        state->data_words += (state->modules)[index].image->data_words;
+        valid_flag = (add_state_entries(state, index) == 0);
+        add_state_sites(state, index);
+    }
+    if (!valid_flag) {
+        free_link_state(state);
+        return NULL;
+    }
+    return state;
+}
+
+/*
+ * Overwrites the words in the given addresses of the object file of a linked program
+ * with their values in the given memory, without rewriting the rest of the file.
+ * Returns 1 if the object file has the given sizes and the words were written, and
+ * 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *output_path        a path to the output files of the program, without an extension.
+ * unsigned short *memory   the memory of the machine, with the new words.
+ * int *addresses           the addresses of the words to overwrite.
+ * int no_of_addresses      the number of addresses.
+ * int code_words           the number of code words of the linked program.
+ * int data_words           the number of data words of the linked program.
+ */
+int patch_object_file(char *output_path, unsigned short *memory, int *addresses, int no_of_addresses,
+                      int code_words, int data_words) {
+    char *object_file_path = create_file_path(output_path, OUTPUT_OBJECT_FILE_EXTENSION);
+    FILE *file = fopen(object_file_path, "r+b");
+    char *base_64_code;
+    int file_code_words;
+    int file_data_words;
+    long header_length;
+    int index;
+
+    free(object_file_path);
+    if (file == NULL) {
+        return 0;
+    }
+    /* the linker writes each word in a line of the same length, so the line of a word is found by its address */
+    if (fscanf(file, "%d %d", &file_code_words, &file_data_words) != 2 || fgetc(file) != '\n' ||
+        file_code_words != code_words || file_data_words != data_words) {
+        fclose(file);
+        return 0;
+    }
+    header_length = ftell(file);
+    if (fseek(file, 0, SEEK_END) != 0 ||
+        ftell(file) != header_length + BASE_64_LINE_LENGTH * (long) (code_words + data_words)) {
+        fclose(file);
+        return 0;
+    }
+    for (index = 0; index < no_of_addresses; index++) {
+        base_64_code = convert_to_base_64(memory[addresses[index]]);
+        fseek(file, header_length + BASE_64_LINE_LENGTH * (long) (addresses[index] - LOAD_ADDRESS), SEEK_SET);
+        fputs(base_64_code, file);
+        free(base_64_code);
+    }
+    fclose(file);
+    return 1;
+}
+
+/*
+ * Patches the sites of the entry label with the given name id in the given memory,
+ * except of the sites of the given module, and adds their addresses to the given
+ * addresses. Returns the number of errors that were found: a site of a label that
+ * has no entry label anymore, or whose address doesn't fit in an operand.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state         a pointer to the link state.
+ * int id                   the id of the name of the entry label in the state.
+ * int module_index         the index of the module that was patched.
+ * unsigned short *memory   the memory of the linked image.
+ * int *addresses           the addresses of the words to patch.
+ * int *no_of_addresses     a pointer to the number of addresses.
+ */
+int patch_entry_sites(LinkState *state, int id, int module_index, unsigned short *memory, int *addresses,
+                      int *no_of_addresses) {
+    PatchSite *site;
+    int address = (state->entries.addresses)[(state->entries.first_indexes)[id]];
+    int errors = 0;
+    int site_index;
+
+    for (site_index = (state->first_sites)[id]; site_index != -1; site_index = site->next_site) {
+        site = &(state->sites)[site_index];
+        /* the uses of the module itself were resolved with its words */
+        if ((site->module_index) == module_index) {
+            continue;
+        }
+        if (address < 0) {
+            print_link_error(UNRESOLVED_EXTERNAL_LABEL, (state->modules)[site->module_index].path);
+            errors++;
+        } else if (address >= (1 << ENCODING_OPERAND_LENGTH)) {
+            print_link_error(LINKED_ADDRESS_OVERFLOW, (state->modules)[site->module_index].path);
+            errors++;
+        } else {
+            addresses[(*no_of_addresses)++] = site->address;
+            memory[site->address] = (unsigned short) (
+                    encode_bit_field(address, ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT) |
+                    encode_bit_field(ARE_RELOCATABLE_CODE, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT));
+        }
+    }
+    return errors;
+}
+
+/*
+ * Patches a module that has changed since the program was linked in its place in the
+ * object file of the linked program. The entries and the sites of the module are
+ * replaced in the link state, the words of the module are relocated and its external
+ * labels are resolved again, and the sites of its entry labels in the other modules
+ * are patched if the address of the label has changed. Returns RELINK_PATCHED if the
+ * module was patched, RELINK_LAYOUT_CHANGED if its sizes have changed (or it can't be
+ * loaded), and RELINK_FAILED if an error was found.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state     a pointer to the link state, as it was read from the link state file.
+ * int module_index     the index of the module that has changed.
+ * char *output_path    a path to the output files of the program, without an extension.
+ */
+int patch_module(LinkState *state, int module_index, char *output_path) {
+    LinkedModule *module = &(state->modules)[module_index];
+    LinkedModule old_module = *module; /* the module as it was linked */
+    LoadedSymbols *old_entries = &(old_module.image->entries);
+    LoadedSymbols *new_entries;
+    MachineImage *new_image = load_machine_image(module->path);
+    MachineImage *linked_image;
+    char *name;
+    int *addresses; /* the addresses of the words to patch */
+    int no_of_addresses = 0;
+    int errors = 0;
+    int conflicts;
+    int id;
+    int index;
+    int result;
+
+    if (new_image == NULL || (new_image->load_address) != (old_module.image->load_address) ||
+        (new_image->code_words) != (old_module.image->code_words) ||
+        (new_image->data_words) != (old_module.image->data_words)) {
+        if (new_image != NULL) {
+            free_machine_image(new_image);
+        }
+        return RELINK_LAYOUT_CHANGED;
+    }
+    linked_image = calloc(1, sizeof(MachineImage));
+    if (linked_image == NULL || (linked_image->memory = calloc(MACHINE_MEMORY_SIZE, sizeof(unsigned short))) == NULL) {
+        printf("Could not allocate memory for the linked program!\n");
+        exit(0);
+    }
+    if ((addresses = malloc((size_t) (new_image->code_words + new_image->data_words + state->no_of_sites + 1) *
+                            sizeof(int))) == NULL) {
+        printf("Could not allocate memory for the linked program!\n");
+        exit(0);
+    }
+    /* replace the entries and the sites of the module in the state */
+    module->image = new_image;
+    new_entries = &(new_image->entries);
+    remove_state_symbols(state, &old_module, module_index);
+    for (conflicts = add_state_entries(state, module_index); conflicts > 0; conflicts--) {
+        print_link_error(MULTIPLE_ENTRY_DEFINITIONS, module->path);
+        errors++;
+    }
+    errors += relocate_module(linked_image, module);
+    errors += resolve_externals(linked_image, module, &(state->entries));
+    add_state_sites(state, module_index);
+    for (index = 0; index < (new_image->code_words); index++) {
+        addresses[no_of_addresses++] = (module->code_address) + index;
+    }
+    for (index = 0; index < (new_image->data_words); index++) {
+        addresses[no_of_addresses++] = (module->data_address) + index;
+    }
+
+    /* patch the sites of the entry labels of the module in the other modules, if their address has changed */
+    for (index = 0; index < (old_entries->names.length); index++) {
+        name = get_pool_string(&(old_entries->names), index);
+        id = find_string_id(&(state->entries.names), name);
+        if ((state->entries.addresses)[(state->entries.first_indexes)[id]] !=
+            relocate_address(&old_module, get_loaded_symbol_address(old_entries, name))) {
+            errors += patch_entry_sites(state, id, module_index, linked_image->memory, addresses, &no_of_addresses);
+        }
+    }
+    /* the entries file is written again only if the entry labels of the module have changed */
+    for (index = 0; index < (new_entries->length) && !(state->entries_flag); index++) {
+        name = get_pool_string(&(new_entries->names), (new_entries->ids)[index]);
+        state->entries_flag = (index >= (old_entries->length) ||
+                               strcmp(name, get_pool_string(&(old_entries->names), (old_entries->ids)[index])) != 0 ||
+                               relocate_address(module, (new_entries->addresses)[index]) !=
+                               relocate_address(&old_module, (old_entries->addresses)[index]));
+    }
+    if ((new_entries->length) != (old_entries->length)) {
+        state->entries_flag = 1;
+    }
+    if (errors > 0) {
+        result = RELINK_FAILED;
+    } else if (!patch_object_file(output_path, linked_image->memory, addresses, no_of_addresses,
+                                  state->code_words, state->data_words)) {
+        result = RELINK_LAYOUT_CHANGED;
+    } else {
+        result = RELINK_PATCHED;
+    }
+    free_machine_image(old_module.image);
+    free_machine_image(linked_image);
+    free(addresses);
+    return result;
+}
+
+/*
+ * Writes the entries file of a linked program from the entry labels of the modules in
+ * the given link state, in the same order as 'link_program'.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state     a pointer to the link state.
+ * char *output_path    a path to the output files of the program, without an extension.
+ */
+void write_state_entries(LinkState *state, char *output_path) {
+    char *entries_file_path = create_file_path(output_path, OUTPUT_ENTRIES_FILE_EXTENSION);
+    LinkedModule *module;
+    LoadedSymbols *module_entries;
+    FILE *file = NULL;
+    int index;
+    int symbol_index;
+
+    remove(entries_file_path);
+    for (index = 0; index < (state->no_of_modules); index++) {
+        module = &(state->modules)[index];
+        module_entries = &(module->image->entries);
+        /* create the entries file only if there's at least one entry label */
+        if ((module_entries->length) > 0 && file == NULL && (file = fopen(entries_file_path, "w")) == NULL) {
+            break;
+        }
+        for (symbol_index = 0; symbol_index < (module_entries->length); symbol_index++) {
+            fprintf(file, "%s %d\n", get_pool_string(&(module_entries->names), (module_entries->ids)[symbol_index]),
+                    relocate_address(module, (module_entries->addresses)[symbol_index]));
+        }
+    }
+    if (file != NULL) {
+        fclose(file);
+    }
+    free(entries_file_path);
+}
+
+/*
+ * Updates the link state file of a linked program after some of its modules have
+ * changed. The fields of a module whose files were written again without a change
+ * in their contents are overwritten in their place, and the file is written again
+ * only from the line of the first module that was patched. If the file can't be
+ * opened, it's written from the beginning.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state         a pointer to the link state.
+ * char *output_path        a path to the output files of the program, without an extension.
+ * int first_patched        the index of the first module that was patched, or -1.
+ * int *changed_modules     indicates for each module if its signature has changed.
+ */
+void update_link_state(LinkState *state, char *output_path, int first_patched, int *changed_modules) {
+    char *state_file_path = create_file_path(output_path, OUTPUT_LINK_STATE_FILE_EXTENSION);
+    FILE *file = fopen(state_file_path, "r+");
+    LinkedModule *module;
+    int last_module = (first_patched >= 0) ? first_patched : (state->no_of_modules);
+    long length;
+    int index;
+
+    if (file == NULL) {
+        free(state_file_path);
+        write_link_state(output_path, state->modules, state->no_of_modules);
+        return;
+    }
+    /* the fields of a module that was not patched keep their length */
+    for (index = 0; index < last_module; index++) {
+        if (changed_modules[index]) {
+            fseek(file, (state->modules)[index].state_offset, SEEK_SET);
+            write_state_fields(file, &(state->modules)[index]);
+        }
+    }
+    /* the symbols of a patched module may have changed, so the rest of the file is written again */
+    if (first_patched >= 0) {
+        module = &(state->modules)[first_patched];
+        fseek(file, (module->state_offset) - (long) strlen(module->path) - 1, SEEK_SET);
+        for (index = first_patched; index < (state->no_of_modules); index++) {
+            write_state_module(file, &(state->modules)[index]);
+        }
+        length = ftell(file);
+        fclose(file);
+        if (truncate(state_file_path, (off_t) length) != 0) {
+            remove(state_file_path);
+        }
+    } else {
+        fclose(file);
+    }
+    free(state_file_path);
+}
+
+/*
+ * Links the given modules like 'link_program', but if the program was already linked
+ * from the same modules, only the modules that have changed since then are patched
+ * in the linked program. The program is linked again only if a module doesn't fit
+ * in its place. Returns 1 if the program was linked, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *output_path        a path to the output files of the program, without an extension.
+ * char *module_paths[]     the paths to the output files of the modules, without an extension.
+ * int no_of_modules        the number of modules.
+ */
+int relink_program(char *output_path, char *module_paths[], int no_of_modules) {
+    LinkState *state = read_link_state(output_path, module_paths, no_of_modules);
+    LinkedModule *module;
+    unsigned long signature;
+    unsigned long hash[2];
+    int *changed_modules; /* indicates for each module if its signature has changed */
+    int no_of_changed = 0;
+    int no_of_patched = 0;
+    int first_patched = -1;
+    int result = RELINK_PATCHED;
+    int index;
+
+    if (state == NULL) {
+        return link_program(output_path, module_paths, no_of_modules);
+    }
+    if ((changed_modules = calloc((size_t) no_of_modules + 1, sizeof(int))) == NULL) {
+        printf("Could not allocate memory for the link state!\n");
+        exit(0);
+    }
+    for (index = 0; index < no_of_modules && result == RELINK_PATCHED; index++) {
+        module = &(state->modules)[index];
+        signature = get_module_signature(module_paths[index]);
+        if (signature == (module->signature)) {
+            continue;
+        }
+        changed_modules[index] = 1;
+        no_of_changed++;
+        /* the files of the module were written again, but they may have the same contents */
+        hash_module(module_paths[index], hash);
+        if (hash[0] != (module->hash[0]) || hash[1] != (module->hash[1])) {
+            result = patch_module(state, index, output_path);
+            first_patched = (first_patched == -1) ? index : first_patched;
+            no_of_patched++;
+        }
+        module->signature = signature;
+        module->hash[0] = hash[0];
+        module->hash[1] = hash[1];
+    }
+    /* even if no module has changed, the linked program must still be in its place */
+    if (result == RELINK_PATCHED && no_of_patched == 0 &&
+        !patch_object_file(output_path, NULL, NULL, 0, state->code_words, state->data_words)) {
+        result = RELINK_LAYOUT_CHANGED;
+    }
+    if (result == RELINK_LAYOUT_CHANGED) {
+        free(changed_modules);
+        free_link_state(state);
+        return link_program(output_path, module_paths, no_of_modules);
+    }
+    if (result == RELINK_FAILED) {
+        remove_linked_image(output_path);
+        free(changed_modules);
+        free_link_state(state);
+        return 0;
+    }
+    if (state->entries_flag) {
+        write_state_entries(state, output_path);
+    }
+    if (no_of_changed > 0) {
+        update_link_state(state, output_path, first_patched, changed_modules);
+    }
+    printf("Relinked %s: %d of %d modules were patched\n", output_path, no_of_patched, no_of_modules);
+    free(changed_modules);
+    free_link_state(state);
+    return 1;
+}
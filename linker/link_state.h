@@ -0,0 +1,291 @@
+#ifndef ASSEMBLER_SIMULATOR_LINK_STATE_H
+#define ASSEMBLER_SIMULATOR_LINK_STATE_H
+
+#include <stdio.h>
+#include "../types.h"
+
+#define NO_OF_MODULE_FILES 4 /* the number of output files of a module that the loader may read */
+#define INITIAL_TOKEN_LENGTH 32 /* the number of characters that a token of the link state file can store before it grows */
+#define INITIAL_NO_OF_STATE_NAMES 32 /* the number of label names that a link state can store after its first growth */
+#define INITIAL_NO_OF_PATCH_SITES 32 /* the number of sites that a link state can store after its first growth */
+#define LINK_STATE_MAGIC "LNK2" /* the first token of a link state file, which changes with its format */
+#define STATE_HASH_WIDTH 16 /* the number of hexadecimal digits of each hash in the link state file */
+
+#define RELINK_PATCHED 1 /* the module was patched in the linked image */
+#define RELINK_LAYOUT_CHANGED 0 /* the module doesn't fit in its place, and the program has to be linked again */
+#define RELINK_FAILED (-1) /* an error was found in the linked program */
+
+/*
+ * Returns a hash of the sizes and the modification times of the output files of the
+ * given module. The contents of a module are hashed only if its signature has changed.
+ *
+ * Parameters:
+ * -----------
+ * char *module_path    the path to the output files of the module, without an extension.
+ */
+unsigned long get_module_signature(char *module_path);
+
+/*
+ * Stores a 64-bit hash of the contents of the output files of the given module in
+ * the given array (as two 32-bit hashes).
+ *
+ * Parameters:
+ * -----------
+ * char *module_path    the path to the output files of the module, without an extension.
+ * unsigned long *hash  an array of two hashes.
+ */
+void hash_module(char *module_path, unsigned long *hash);
+
+/*
+ * Writes a line for each of the given symbols to the given link state file,
+ * with the name of the symbol and its address.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file               the link state file.
+ * LoadedSymbols *symbols   a pointer to the symbols.
+ */
+void write_state_symbols(FILE *file, LoadedSymbols *symbols);
+
+/*
+ * Writes the fields of the line of the given module to the given link state file: its
+ * placement, its sizes, its signature, the hash of its contents and the number of its
+ * symbols. The hashes have a fixed width, so the fields of a module whose contents
+ * have not changed can be overwritten in their place.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file               the link state file.
+ * LinkedModule *module     a pointer to the module.
+ */
+void write_state_fields(FILE *file, LinkedModule *module);
+
+/*
+ * Writes the line of the given module to the given link state file, followed by a
+ * line for each of its entry labels and each use of an external label.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file               the link state file.
+ * LinkedModule *module     a pointer to the module.
+ */
+void write_state_module(FILE *file, LinkedModule *module);
+
+/*
+ * Writes the link state file of a program that was linked from the given modules.
+ * Each module has a line with its path, its placement, its sizes, its signature and
+ * the hash of its contents, followed by a line for each of its entry labels and each
+ * use of an external label, with the address in the module (as in its own files).
+ *
+ * Parameters:
+ * -----------
+ * char *output_path        a path to the output files of the program, without an extension.
+ * LinkedModule *modules    the modules of the program, after they were placed.
+ * int no_of_modules        the number of modules.
+ */
+void write_link_state(char *output_path, LinkedModule *modules, int no_of_modules);
+
+/*
+ * Reads the next token of the given file, that ends with a white character or with
+ * the end of the file. Returns a pointer to a new string that contains the token,
+ * or NULL if there are no more tokens in the file. The user should free the string
+ * in the end of the usage.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file   the file to read from.
+ */
+char *read_token(FILE *file);
+
+/*
+ * Adds the given number of symbols from the lines of the given link state file to
+ * the given symbols. Returns 1 if all the symbols were read, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file               the link state file.
+ * LoadedSymbols *symbols   a pointer to the symbols.
+ * int no_of_symbols        the number of symbols to read.
+ */
+int read_state_symbols(FILE *file, LoadedSymbols *symbols, int no_of_symbols);
+
+/*
+ * Reads the line of a module from the given link state file to the given module, and
+ * then its symbols. Returns 1 if the module was read and it has the given path, and
+ * 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * FILE *file           the link state file.
+ * LinkedModule *module a pointer to the module.
+ * char *module_path    the path that the module should have.
+ */
+int read_state_module(FILE *file, LinkedModule *module, char *module_path);
+
+/*
+ * Returns the id of the given label name in the link state. If the name is not in
+ * the state yet, the function adds it without an entry label and without sites.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state     a pointer to the link state.
+ * char *name           the name of the label.
+ */
+int get_state_name_id(LinkState *state, char *name);
+
+/*
+ * Adds the entry labels of the given module to the global entries of the given link
+ * state, with their addresses in the linked image. Returns the number of entry labels
+ * that were already defined by a module, and were not added.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state     a pointer to the link state.
+ * int module_index     the index of the module, after it was placed.
+ */
+int add_state_entries(LinkState *state, int module_index);
+
+/*
+ * Adds a site to the given link state for each use of an external label in the
+ * given module, in the reverse index of the name of the label.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state     a pointer to the link state.
+ * int module_index     the index of the module, after it was placed.
+ */
+void add_state_sites(LinkState *state, int module_index);
+
+/*
+ * Removes the entry labels and the sites of the given module from the given link
+ * state. Only the names that the module defines or uses are touched.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state         a pointer to the link state.
+ * LinkedModule *module     a pointer to the module, as it was added to the state.
+ * int module_index         the index of the module.
+ */
+void remove_state_symbols(LinkState *state, LinkedModule *module, int module_index);
+
+/*
+ * Frees the dynamic memory that was allocated to contain the modules, the entries
+ * and the sites of the given link state, and in the end frees the state itself.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state     a pointer to the link state.
+ */
+void free_link_state(LinkState *state);
+
+/*
+ * Reads the link state file of the given program, and returns the link state that it
+ * describes. The image of each module contains only its sizes and its symbols, and
+ * not its words. The global entries and the sites of the external labels are indexed
+ * while the modules are read. If the file doesn't exist, it's not valid, or the program
+ * was linked from other modules, the function returns NULL. The user should free the
+ * state with 'free_link_state'.
+ *
+ * Parameters:
+ * -----------
+ * char *output_path        a path to the output files of the program, without an extension.
+ * char *module_paths[]     the paths to the output files of the modules, without an extension.
+ * int no_of_modules        the number of modules.
+ */
+LinkState *read_link_state(char *output_path, char *module_paths[], int no_of_modules);
+
+/*
+ * Overwrites the words in the given addresses of the object file of a linked program
+ * with their values in the given memory, without rewriting the rest of the file.
+ * Returns 1 if the object file has the given sizes and the words were written, and
+ * 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *output_path        a path to the output files of the program, without an extension.
+ * unsigned short *memory   the memory of the machine, with the new words.
+ * int *addresses           the addresses of the words to overwrite.
+ * int no_of_addresses      the number of addresses.
+ * int code_words           the number of code words of the linked program.
+ * int data_words           the number of data words of the linked program.
+ */
+int patch_object_file(char *output_path, unsigned short *memory, int *addresses, int no_of_addresses,
+                      int code_words, int data_words);
+
+/*
+ * Patches the sites of the entry label with the given name id in the given memory,
+ * except of the sites of the given module, and adds their addresses to the given
+ * addresses. Returns the number of errors that were found: a site of a label that
+ * has no entry label anymore, or whose address doesn't fit in an operand.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state         a pointer to the link state.
+ * int id                   the id of the name of the entry label in the state.
+ * int module_index         the index of the module that was patched.
+ * unsigned short *memory   the memory of the linked image.
+ * int *addresses           the addresses of the words to patch.
+ * int *no_of_addresses     a pointer to the number of addresses.
+ */
+int patch_entry_sites(LinkState *state, int id, int module_index, unsigned short *memory, int *addresses,
+                      int *no_of_addresses);
+
+/*
+ * Patches a module that has changed since the program was linked in its place in the
+ * object file of the linked program. The entries and the sites of the module are
+ * replaced in the link state, the words of the module are relocated and its external
+ * labels are resolved again, and the sites of its entry labels in the other modules
+ * are patched if the address of the label has changed. Returns RELINK_PATCHED if the
+ * module was patched, RELINK_LAYOUT_CHANGED if its sizes have changed (or it can't be
+ * loaded), and RELINK_FAILED if an error was found.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state     a pointer to the link state, as it was read from the link state file.
+ * int module_index     the index of the module that has changed.
+ * char *output_path    a path to the output files of the program, without an extension.
+ */
+int patch_module(LinkState *state, int module_index, char *output_path);
+
+/*
+ * Writes the entries file of a linked program from the entry labels of the modules in
+ * the given link state, in the same order as 'link_program'.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state     a pointer to the link state.
+ * char *output_path    a path to the output files of the program, without an extension.
+ */
+void write_state_entries(LinkState *state, char *output_path);
+
+/*
+ * Updates the link state file of a linked program after some of its modules have
+ * changed. The fields of a module whose files were written again without a change
+ * in their contents are overwritten in their place, and the file is written again
+ * only from the line of the first module that was patched. If the file can't be
+ * opened, it's written from the beginning.
+ *
+ * Parameters:
+ * -----------
+ * LinkState *state         a pointer to the link state.
+ * char *output_path        a path to the output files of the program, without an extension.
+ * int first_patched        the index of the first module that was patched, or -1.
+ * int *changed_modules     indicates for each module if its signature has changed.
+ */
+void update_link_state(LinkState *state, char *output_path, int first_patched, int *changed_modules);
+
+/*
+ * Links the given modules like 'link_program', but if the program was already linked
+ * from the same modules, only the modules that have changed since then are patched
+ * in the linked program. The program is linked again only if a module doesn't fit
+ * in its place. Returns 1 if the program was linked, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *output_path        a path to the output files of the program, without an extension.
+ * char *module_paths[]     the paths to the output files of the modules, without an extension.
+ * int no_of_modules        the number of modules.
+ */
+int relink_program(char *output_path, char *module_paths[], int no_of_modules);
+
+#endif
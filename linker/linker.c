@@ -0,0 +1,363 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "linker.h"
+#include "link_state.h"
+#include "../absolutes.h"
+#include "../segments.h"
+#include "../compiler.h"
+#include "../loader/loader.h"
+#include "../command_analysis/helpers.h"
+#include "../error_detection/errors.h"
+
+/*
+ * Prints the given error of the linker, and the module it was found in.
+ *
+ * Parameters:
+ * -----------
+ * char *error_msg      the error message.
+ * char *module_path    the path to the output files of the module, without an extension.
+ */
+void print_link_error(char *error_msg, char *module_path) {
+    printf("Module: %s\t|  Error: %s\n", module_path, error_msg);
+}
+
+/*
+ * Returns the address in the linked image of the given address of the module. An
+ * address of a code word is moved with the code words of the module, and an address
+ * of a data word is moved with its data words.
+ *
+ * Parameters:
+ * -----------
+ * LinkedModule *module     a pointer to the module.
+ * int address              an address in the image of the module, as it was loaded.
+ */
+int relocate_address(LinkedModule *module, int address) {
+    int code_end = (module->image->load_address) + (module->image->code_words);
+
+    if (address < code_end) {
+        return address - (module->image->load_address) + (module->code_address);
+    }
+    return address - code_end + (module->data_address);
+}
+
+/*
+ * Places the code words and the data words of the given modules in the linked image,
+ * and returns the number of words of the linked image. The code words of the modules
+ * are placed from the load address in the order of the modules, and their data words
+ * are placed after all the code words in the same order.
+ *
+ * Parameters:
+ * -----------
+ * LinkedModule *modules    the modules of the program, after they were loaded.
+ * int no_of_modules        the number of modules.
+ */
+int place_modules(LinkedModule *modules, int no_of_modules) {
+    int address = LOAD_ADDRESS;
+    int index;
+
+    for (index = 0; index < no_of_modules; index++) {
+        modules[index].code_address = address;
+        address += modules[index].image->code_words;
+    }
+    for (index = 0; index < no_of_modules; index++) {
+        modules[index].data_address = address;
+        address += modules[index].image->data_words;
+    }
+    return address - LOAD_ADDRESS;
+}
+
+/*
+ * Adds the entry labels of all the given modules to the given global entries, with
+ * their addresses in the linked image, and returns the number of errors that were
+ * found. Each entry label is stored once in the global entries, so it's resolved
+ * with a single hash lookup, and an entry label of more than one module is an error.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *entries   a pointer to the global entries.
+ * LinkedModule *modules    the modules of the program, after they were placed.
+ * int no_of_modules        the number of modules.
+ */
+int add_global_entries(LoadedSymbols *entries, LinkedModule *modules, int no_of_modules) {
+    LoadedSymbols *module_entries;
+    char *name;
+    int errors = 0;
+    int index;
+    int symbol_index;
+
+    for (index = 0; index < no_of_modules; index++) {
+        module_entries = &(modules[index].image->entries);
+        for (symbol_index = 0; symbol_index < (module_entries->length); symbol_index++) {
+            name = get_pool_string(&(module_entries->names), (module_entries->ids)[symbol_index]);
+            if (find_string_id(&(entries->names), name) != NO_STRING_ID) {
+                print_link_error(MULTIPLE_ENTRY_DEFINITIONS, modules[index].path);
+                errors++;
+                continue;
+            }
+            add_loaded_symbol(entries, name, (int) strlen(name),
+                              relocate_address(&modules[index], (module_entries->addresses)[symbol_index]));
+        }
+    }
+    return errors;
+}
+
+/*
+ * Copies the words of the given module to their places in the memory of the linked
+ * image, and relocates the addresses of its relocatable code words. Returns the
+ * number of errors that were found.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *linked_image   a pointer to the linked image.
+ * LinkedModule *module         a pointer to the module, after it was placed.
+ */
+int relocate_module(MachineImage *linked_image, LinkedModule *module) {
+    unsigned short *code = (module->image->memory) + (module->image->load_address);
+    unsigned short *linked_code = (linked_image->memory) + (module->code_address);
+    unsigned int word;
+    int address;
+    int errors = 0;
+    int index;
+
+    memcpy(linked_code, code, (module->image->code_words) * sizeof(unsigned short));
+    memcpy((linked_image->memory) + (module->data_address), code + (module->image->code_words),
+           (module->image->data_words) * sizeof(unsigned short));
+
+    /* only the words of label operands are relocatable, so the data words are never changed */
+    for (index = 0; index < (module->image->code_words); index++) {
+        word = code[index];
+        if (decode_bit_field(word, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT) != ARE_RELOCATABLE_CODE) {
+            continue;
+        }
+        address = relocate_address(module, decode_bit_field(word, ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT));
+        if (address >= (1 << ENCODING_OPERAND_LENGTH)) {
+            print_link_error(LINKED_ADDRESS_OVERFLOW, module->path);
+            errors++;
+        }
+        linked_code[index] = (unsigned short) (
+                encode_bit_field(address, ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT) |
+                encode_bit_field(ARE_RELOCATABLE_CODE, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT));
+    }
+    return errors;
+}
+
+/*
+ * Patches each use of an external label in the given module, in the memory of the
+ * linked image, with the address of the entry label of the same name. Each distinct
+ * external label of the module is looked up in the global entries only once. Returns
+ * the number of errors that were found.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *linked_image   a pointer to the linked image.
+ * LinkedModule *module         a pointer to the module, after it was relocated.
+ * LoadedSymbols *entries       a pointer to the global entries.
+ */
+int resolve_externals(MachineImage *linked_image, LinkedModule *module, LoadedSymbols *entries) {
+    LoadedSymbols *externals = &(module->image->externals);
+    int no_of_names = externals->names.length;
+    int *addresses = malloc((no_of_names + 1) * sizeof(int)); /* the address of each external label of the module */
+    int errors = 0;
+    int address;
+    int index;
+    int id;
+
+    if (addresses == NULL) {
+        printf("Could not allocate memory for the external labels!\n");
+        exit(0);
+    }
+    for (id = 0; id < no_of_names; id++) {
+        addresses[id] = get_loaded_symbol_address(entries, get_pool_string(&(externals->names), id));
+        if (addresses[id] < 0) {
+            print_link_error(UNRESOLVED_EXTERNAL_LABEL, module->path);
+            errors++;
+        } else if (addresses[id] >= (1 << ENCODING_OPERAND_LENGTH)) {
+            print_link_error(LINKED_ADDRESS_OVERFLOW, module->path);
+            errors++;
+        }
+    }
+    for (index = 0; index < (externals->length); index++) {
+        id = (externals->ids)[index];
+        address = (externals->addresses)[index];
+        if (address < (module->image->load_address) ||
+            address >= (module->image->load_address) + (module->image->code_words)) {
+            print_link_error(INVALID_EXTERNAL_REFERENCE, module->path);
+            errors++;
+            continue;
+        }
+        if (addresses[id] < 0) {
+            continue;
+        }
+        /* the use of the label is now a relocatable address in the linked image */
+        (linked_image->memory)[relocate_address(module, address)] = (unsigned short) (
+                encode_bit_field(addresses[id], ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT) |
+                encode_bit_field(ARE_RELOCATABLE_CODE, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT));
+    }
+    free(addresses);
+    return errors;
+}
+
+/*
+ * Removes the output files of a previous linkage of the program: the object file,
+ * the entries file and the link state file, and also the externals file and the
+ * binary object file, that the linker doesn't create, so they are never mistaken
+ * for the linked program.
+ *
+ * Parameters:
+ * -----------
+ * char *output_path    a path to the output files, without an extension.
+ */
+void remove_linked_image(char *output_path) {
+    char *extensions[] = {OUTPUT_OBJECT_FILE_EXTENSION, OUTPUT_ENTRIES_FILE_EXTENSION,
+                          OUTPUT_EXTERNALS_FILE_EXTENSION, OUTPUT_BINARY_OBJECT_FILE_EXTENSION,
+                          OUTPUT_LINK_STATE_FILE_EXTENSION};
+    char *file_path;
+    int index;
+
+    for (index = 0; index < (int) (sizeof(extensions) / sizeof(extensions[0])); index++) {
+        file_path = create_file_path(output_path, extensions[index]);
+        remove(file_path);
+        free(file_path);
+    }
+}
+
+/*
+ * Writes the entries file of a linked program with the given global entries. Each
+ * line contains the name of an entry label and its address in the linked image. If
+ * the program has no entry labels, the file is not created.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *entries   a pointer to the global entries.
+ * char *output_path        a path to the output files, without an extension.
+ */
+void write_linked_entries(LoadedSymbols *entries, char *output_path) {
+    char *entries_file_path = create_file_path(output_path, OUTPUT_ENTRIES_FILE_EXTENSION);
+    FILE *file;
+    int index;
+
+    remove(entries_file_path);
+    /* create the entries file only if there's at least one entry label */
+    if ((entries->length) > 0) {
+        file = fopen(entries_file_path, "w");
+        for (index = 0; index < (entries->length); index++) {
+            fprintf(file, "%s %d\n", get_pool_string(&(entries->names), (entries->ids)[index]),
+                    (entries->addresses)[index]);
+        }
+        fclose(file);
+    }
+    free(entries_file_path);
+}
+
+/*
+ * Writes the output files of the given linked image: the object file, with all its
+ * code words and then all its data words, and the entries file, if it has entry labels.
+ * All the external labels of the linked image are resolved, so it has no externals file.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *linked_image   a pointer to the linked image.
+ * char *output_path            a path to the output files, without an extension.
+ */
+void write_linked_image(MachineImage *linked_image, char *output_path) {
+    char *object_file_path = create_file_path(output_path, OUTPUT_OBJECT_FILE_EXTENSION);
+    int no_of_words = (linked_image->code_words) + (linked_image->data_words);
+    char *base_64_code;
+    FILE *file;
+    int index;
+
+    file = fopen(object_file_path, "w");
+    fprintf(file, "%d %d\n", linked_image->code_words, linked_image->data_words);
+    for (index = 0; index < no_of_words; index++) {
+        base_64_code = convert_to_base_64((linked_image->memory)[(linked_image->load_address) + index]);
+        fprintf(file, "%s\n", base_64_code);
+        free(base_64_code);
+    }
+    fclose(file);
+    write_linked_entries(&(linked_image->entries), output_path);
+    free(object_file_path);
+}
+
+/*
+ * Frees the images of the given modules, and in the end frees the array of the modules.
+ *
+ * Parameters:
+ * -----------
+ * LinkedModule *modules    the modules of the program.
+ * int no_of_modules        the number of modules.
+ */
+void free_linked_modules(LinkedModule *modules, int no_of_modules) {
+    int index;
+
+    for (index = 0; index < no_of_modules; index++) {
+        if (modules[index].image != NULL) {
+            free_machine_image(modules[index].image);
+        }
+    }
+    free(modules);
+}
+
+/*
+ * Links the given modules, that were assembled separately, to a single program and
+ * writes its output files and its link state file. The time of the linkage is linear
+ * in the total number of words, entry labels and uses of external labels of the modules.
+ * If an error is found, it's printed, and the output files are not created. Returns 1
+ * if the program was linked, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *output_path        a path to the output files of the program, without an extension.
+ * char *module_paths[]     the paths to the output files of the modules, without an extension.
+ * int no_of_modules        the number of modules.
+ */
+int link_program(char *output_path, char *module_paths[], int no_of_modules) {
+    LinkedModule *modules = calloc((size_t) no_of_modules + 1, sizeof(LinkedModule));
+    MachineImage *linked_image = calloc(1, sizeof(MachineImage));
+    int errors = 0;
+    int index;
+
+    if (modules == NULL || linked_image == NULL ||
+        (linked_image->memory = calloc(MACHINE_MEMORY_SIZE, sizeof(unsigned short))) == NULL) {
+        printf("Could not allocate memory for the linked program!\n");
+        exit(0);
+    }
+    remove_linked_image(output_path);
+    for (index = 0; index < no_of_modules; index++) {
+        modules[index].path = module_paths[index];
+        /* the module is fingerprinted before it's loaded, so a later change is always noticed */
+        modules[index].signature = get_module_signature(module_paths[index]);
+        hash_module(module_paths[index], modules[index].hash);
+        modules[index].image = load_machine_image(module_paths[index]);
+        if (modules[index].image == NULL) {
+            print_link_error(UNLOADED_MODULE, module_paths[index]);
+            errors++;
+        }
+    }
+    if (errors == 0) {
+        linked_image->load_address = LOAD_ADDRESS;
+        if (LOAD_ADDRESS + place_modules(modules, no_of_modules) > MACHINE_MEMORY_SIZE) {
+            print_link_error(LINKED_MEMORY_OVERFLOW, output_path);
+            errors++;
+        } else {
+            linked_image->code_words = modules[no_of_modules - 1].code_address +
+                                       modules[no_of_modules - 1].image->code_words - LOAD_ADDRESS;
+            linked_image->data_words = modules[no_of_modules - 1].data_address +
+                                       modules[no_of_modules - 1].image->data_words -
+                                       LOAD_ADDRESS - (linked_image->code_words);
+            /* all the entries are resolved before any use of an external label is patched */
+            errors += add_global_entries(&(linked_image->entries), modules, no_of_modules);
+            for (index = 0; index < no_of_modules; index++) {
+                errors += relocate_module(linked_image, &modules[index]);
+                errors += resolve_externals(linked_image, &modules[index], &(linked_image->entries));
+            }
+        }
+    }
+    if (errors == 0) {
+        write_linked_image(linked_image, output_path);
+        write_link_state(output_path, modules, no_of_modules);
+    }
+    free_linked_modules(modules, no_of_modules);
+    free_machine_image(linked_image);
+    return errors == 0;
+}
@@ -0,0 +1,142 @@
+#ifndef ASSEMBLER_SIMULATOR_LINKER_H
+#define ASSEMBLER_SIMULATOR_LINKER_H
+
+#include "../types.h"
+
+/*
+ * Prints the given error of the linker, and the module it was found in.
+ *
+ * Parameters:
+ * -----------
+ * char *error_msg      the error message.
+ * char *module_path    the path to the output files of the module, without an extension.
+ */
+void print_link_error(char *error_msg, char *module_path);
+
+/*
+ * Returns the address in the linked image of the given address of the module. An
+ * address of a code word is moved with the code words of the module, and an address
+ * of a data word is moved with its data words.
+ *
+ * Parameters:
+ * -----------
+ * LinkedModule *module     a pointer to the module.
+ * int address              an address in the image of the module, as it was loaded.
+ */
+int relocate_address(LinkedModule *module, int address);
+
+/*
+ * Places the code words and the data words of the given modules in the linked image,
+ * and returns the number of words of the linked image. The code words of the modules
+ * are placed from the load address in the order of the modules, and their data words
+ * are placed after all the code words in the same order.
+ *
+ * Parameters:
+ * -----------
+ * LinkedModule *modules    the modules of the program, after they were loaded.
+ * int no_of_modules        the number of modules.
+ */
+int place_modules(LinkedModule *modules, int no_of_modules);
+
+/*
+ * Adds the entry labels of all the given modules to the given global entries, with
+ * their addresses in the linked image, and returns the number of errors that were
+ * found. Each entry label is stored once in the global entries, so it's resolved
+ * with a single hash lookup, and an entry label of more than one module is an error.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *entries   a pointer to the global entries.
+ * LinkedModule *modules    the modules of the program, after they were placed.
+ * int no_of_modules        the number of modules.
+ */
+int add_global_entries(LoadedSymbols *entries, LinkedModule *modules, int no_of_modules);
+
+/*
+ * Copies the words of the given module to their places in the memory of the linked
+ * image, and relocates the addresses of its relocatable code words. Returns the
+ * number of errors that were found.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *linked_image   a pointer to the linked image.
+ * LinkedModule *module         a pointer to the module, after it was placed.
+ */
+int relocate_module(MachineImage *linked_image, LinkedModule *module);
+
+/*
+ * Patches each use of an external label in the given module, in the memory of the
+ * linked image, with the address of the entry label of the same name. Each distinct
+ * external label of the module is looked up in the global entries only once. Returns
+ * the number of errors that were found.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *linked_image   a pointer to the linked image.
+ * LinkedModule *module         a pointer to the module, after it was relocated.
+ * LoadedSymbols *entries       a pointer to the global entries.
+ */
+int resolve_externals(MachineImage *linked_image, LinkedModule *module, LoadedSymbols *entries);
+
+/*
+ * Removes the output files of a previous linkage of the program: the object file,
+ * the entries file and the link state file, and also the externals file and the
+ * binary object file, that the linker doesn't create, so they are never mistaken
+ * for the linked program.
+ *
+ * Parameters:
+ * -----------
+ * char *output_path    a path to the output files, without an extension.
+ */
+void remove_linked_image(char *output_path);
+
+/*
+ * Writes the entries file of a linked program with the given global entries. Each
+ * line contains the name of an entry label and its address in the linked image. If
+ * the program has no entry labels, the file is not created.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *entries   a pointer to the global entries.
+ * char *output_path        a path to the output files, without an extension.
+ */
+void write_linked_entries(LoadedSymbols *entries, char *output_path);
+
+/*
+ * Writes the output files of the given linked image: the object file, with all its
+ * code words and then all its data words, and the entries file, if it has entry labels.
+ * All the external labels of the linked image are resolved, so it has no externals file.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *linked_image   a pointer to the linked image.
+ * char *output_path            a path to the output files, without an extension.
+ */
+void write_linked_image(MachineImage *linked_image, char *output_path);
+
+/*
+ * Frees the images of the given modules, and in the end frees the array of the modules.
+ *
+ * Parameters:
+ * -----------
+ * LinkedModule *modules    the modules of the program.
+ * int no_of_modules        the number of modules.
+ */
+void free_linked_modules(LinkedModule *modules, int no_of_modules);
+
+/*
+ * Links the given modules, that were assembled separately, to a single program and
+ * writes its output files and its link state file. The time of the linkage is linear
+ * in the total number of words, entry labels and uses of external labels of the modules.
+ * If an error is found, it's printed, and the output files are not created. Returns 1
+ * if the program was linked, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *output_path        a path to the output files of the program, without an extension.
+ * char *module_paths[]     the paths to the output files of the modules, without an extension.
+ * int no_of_modules        the number of modules.
+ */
+int link_program(char *output_path, char *module_paths[], int no_of_modules);
+
+#endif
@@ -0,0 +1,10 @@
+#include "link_state.h"
+
+int main(int argc, char *argv[]) {
+    /* the first argument is the linked program, and the following arguments are its modules */
+    if (argc < 3) {
+        return 0;
+    }
+    relink_program(argv[1], argv + 2, argc - 2);
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "base_64.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define NEW_LINE_VALUE 0x40 /* the value of a new line character, that no base 64 digit has */
+#define NOT_A_DIGIT_BITS 0xC0 /* the bits that are set only in the values of characters that are not digits */
+
+/*
+ * Returns the value (0-63) of the given base 64 digit, or INVALID_BASE_64_DIGIT
+ * if the character is not a base 64 digit.
+ *
+ * Parameters:
+ * -----------
+ * char digit   the character to decode.
+ */
+unsigned int decode_base_64_digit(char digit) {
+    if (digit >= 'A' && digit <= 'Z') {
+        return (unsigned int) (digit - 'A');
+    } else if (digit >= 'a' && digit <= 'z') {
+        return (unsigned int) (digit - 'a') + 26;
+    } else if (digit >= '0' && digit <= '9') {
+        return (unsigned int) (digit - '0') + 52;
+    } else if (digit == '+') {
+        return 62;
+    } else if (digit == '/') {
+        return 63;
+    }
+    return INVALID_BASE_64_DIGIT;
+}
+
+/*
+ * Returns the value of the given character of a line of a word: the value of
+ * a base 64 digit, NEW_LINE_VALUE for a new line, and INVALID_BASE_64_DIGIT
+ * for any other character.
+ *
+ * Parameters:
+ * -----------
+ * char character   the character to translate.
+ */
+unsigned int translate_character(char character) {
+    return (character == '\n') ? NEW_LINE_VALUE : decode_base_64_digit(character);
+}
+
+/*
+ * Stores the value of each of the BASE_64_BLOCK_SIZE characters of the given block
+ * in the given array, as 'translate_character' does. With SSE2 the characters are
+ * classified by ranges, and the offset of each range is added to all the characters
+ * of the block at once.
+ *
+ * Parameters:
+ * -----------
+ * const char *block        the characters to translate.
+ * unsigned char *values    the array to store the values in.
+ */
+void translate_block(const char *block, unsigned char *values) {
+#if defined(__SSE2__)
+    __m128i chars = _mm_loadu_si128((const __m128i *) block);
+    __m128i upper_case = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)),
+                                       _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), chars));
+    __m128i lower_case = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('a' - 1)),
+                                       _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), chars));
+    __m128i digits = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)),
+                                   _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), chars));
+    __m128i plus = _mm_cmpeq_epi8(chars, _mm_set1_epi8('+'));
+    __m128i slash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+    __m128i new_line = _mm_cmpeq_epi8(chars, _mm_set1_epi8('\n'));
+    __m128i ranges = _mm_or_si128(_mm_or_si128(upper_case, lower_case), digits);
+    __m128i valid = _mm_or_si128(_mm_or_si128(ranges, new_line), _mm_or_si128(plus, slash));
+    /* the offset that turns each character of a range to its value */
+    __m128i offsets = _mm_or_si128(_mm_or_si128(_mm_and_si128(upper_case, _mm_set1_epi8((char) -'A')),
+                                                _mm_and_si128(lower_case, _mm_set1_epi8((char) (26 - 'a')))),
+                                   _mm_and_si128(digits, _mm_set1_epi8((char) (52 - '0'))));
+    __m128i result = _mm_and_si128(_mm_add_epi8(chars, offsets), ranges);
+
+    result = _mm_or_si128(result, _mm_and_si128(plus, _mm_set1_epi8(62)));
+    result = _mm_or_si128(result, _mm_and_si128(slash, _mm_set1_epi8(63)));
+    result = _mm_or_si128(result, _mm_and_si128(new_line, _mm_set1_epi8(NEW_LINE_VALUE)));
+    result = _mm_or_si128(result, _mm_andnot_si128(valid, _mm_set1_epi8((char) INVALID_BASE_64_DIGIT)));
+    _mm_storeu_si128((__m128i *) values, result);
+#else
+    int index;
+
+    for (index = 0; index < BASE_64_BLOCK_SIZE; index++) {
+        values[index] = (unsigned char) translate_character(block[index]);
+    }
+#endif
+}
+
+/*
+ * Decodes the base 64 words of an object file, and returns the number of decoded
+ * words. Each word is stored in a line of exactly BASE_64_LINE_LENGTH characters:
+ * two base 64 digits, starting from the upper 6 bits, and a new line. Whole blocks
+ * of lines are translated at once with SSE2 (when it's available), and their digits
+ * are combined to words. If the text is not in this format, the function returns -1,
+ * and the caller should decode it line by line.
+ *
+ * Parameters:
+ * -----------
+ * const char *text         the lines of the words, without the header line.
+ * size_t length            the number of characters in the text.
+ * unsigned short *words    the array to store the decoded words in.
+ */
+int decode_base_64_words(const char *text, size_t length, unsigned short *words) {
+    /* a block of BASE_64_BLOCK_SIZE lines is translated as BASE_64_LINE_LENGTH blocks of characters */
+    unsigned char values[BASE_64_LINE_LENGTH * BASE_64_BLOCK_SIZE];
+    unsigned int errors = 0; /* the bits that show that a digit or a new line is not valid */
+    size_t no_of_words = length / BASE_64_LINE_LENGTH;
+    size_t word_index = 0;
+    const char *line;
+    int index;
+
+    if (length % BASE_64_LINE_LENGTH != 0) {
+        return -1;
+    }
+    /* decode whole blocks of lines */
+    while (word_index + BASE_64_BLOCK_SIZE <= no_of_words) {
+        for (index = 0; index < BASE_64_LINE_LENGTH; index++) {
+            translate_block(text + BASE_64_LINE_LENGTH * word_index + index * BASE_64_BLOCK_SIZE,
+                            values + index * BASE_64_BLOCK_SIZE);
+        }
+        for (index = 0; index < BASE_64_BLOCK_SIZE; index++) {
+            errors |= (values[BASE_64_LINE_LENGTH * index] | values[BASE_64_LINE_LENGTH * index + 1]) &
+                      NOT_A_DIGIT_BITS;
+            errors |= values[BASE_64_LINE_LENGTH * index + 2] ^ NEW_LINE_VALUE;
+            words[word_index + index] = (unsigned short) ((values[BASE_64_LINE_LENGTH * index] << 6) |
+                                                          values[BASE_64_LINE_LENGTH * index + 1]);
+        }
+        word_index += BASE_64_BLOCK_SIZE;
+    }
+    /* decode the lines after the last whole block */
+    for (; word_index < no_of_words; word_index++) {
+        line = text + BASE_64_LINE_LENGTH * word_index;
+        errors |= (translate_character(line[0]) | translate_character(line[1])) & NOT_A_DIGIT_BITS;
+        errors |= translate_character(line[2]) ^ NEW_LINE_VALUE;
+        words[word_index] = (unsigned short) ((translate_character(line[0]) << 6) | translate_character(line[1]));
+    }
+    return errors ? -1 : (int) no_of_words;
+}
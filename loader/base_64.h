@@ -0,0 +1,36 @@
+#ifndef ASSEMBLER_SIMULATOR_BASE_64_H
+#define ASSEMBLER_SIMULATOR_BASE_64_H
+
+#include <stddef.h>
+
+#define BASE_64_LINE_LENGTH 3 /* the number of characters in a line of a word in the object file (2 digits and a new line) */
+#define BASE_64_BLOCK_SIZE 16 /* the number of characters that are decoded at once */
+#define INVALID_BASE_64_DIGIT 0xFF /* the value of a character that is not a base 64 digit */
+
+/*
+ * Returns the value (0-63) of the given base 64 digit, or INVALID_BASE_64_DIGIT
+ * if the character is not a base 64 digit.
+ *
+ * Parameters:
+ * -----------
+ * char digit   the character to decode.
+ */
+unsigned int decode_base_64_digit(char digit);
+
+/*
+ * Decodes the base 64 words of an object file, and returns the number of decoded
+ * words. Each word is stored in a line of exactly BASE_64_LINE_LENGTH characters:
+ * two base 64 digits, starting from the upper 6 bits, and a new line. Whole blocks
+ * of lines are translated at once with SSE2 (when it's available), and their digits
+ * are combined to words. If the text is not in this format, the function returns -1,
+ * and the caller should decode it line by line.
+ *
+ * Parameters:
+ * -----------
+ * const char *text         the lines of the words, without the header line.
+ * size_t length            the number of characters in the text.
+ * unsigned short *words    the array to store the decoded words in.
+ */
+int decode_base_64_words(const char *text, size_t length, unsigned short *words);
+
+#endif
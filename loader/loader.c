@@ -0,0 +1,467 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "loader.h"
+#include "base_64.h"
+#include "../absolutes.h"
+#include "../segments.h"
+#include "../compiler.h"
+
+#define INITIAL_NO_OF_SYMBOLS 16 /* the number of symbols that can be stored after the first growth */
+
+/*
+ * Returns a pointer to the contents of the given file, mapped to the memory, and
+ * stores the number of bytes of the file in the given length. If the file can't be
+ * opened or it's empty, the function returns NULL. The user should unmap the file
+ * with 'unmap_file'.
+ *
+ * Parameters:
+ * -----------
+ * char *file_path      the path to the file.
+ * size_t *length       a pointer to store the length of the file in.
+ */
+char *map_file(char *file_path, size_t *length) {
+    struct stat file_status;
+    void *contents;
+    int file_descriptor = open(file_path, O_RDONLY);
+
+    *length = 0;
+    if (file_descriptor < 0) {
+        return NULL;
+    }
+    if (fstat(file_descriptor, &file_status) != 0 || file_status.st_size <= 0) {
+        close(file_descriptor);
+        return NULL;
+    }
+    contents = mmap(NULL, (size_t) file_status.st_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    /* the mapping stays valid after the file is closed */
+    close(file_descriptor);
+    if (contents == MAP_FAILED) {
+        return NULL;
+    }
+    *length = (size_t) file_status.st_size;
+    return (char *) contents;
+}
+
+/*
+ * Unmaps the contents of a file that was mapped with 'map_file'.
+ *
+ * Parameters:
+ * -----------
+ * char *contents       the contents of the file.
+ * size_t length        the number of bytes of the file.
+ */
+void unmap_file(char *contents, size_t length) {
+    if (contents != NULL) {
+        munmap(contents, length);
+    }
+}
+
+/*
+ * Adds a symbol with the given name and address to the end of the given symbols.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *symbols   a pointer to the symbols.
+ * char *name               the characters of the name, not necessarily null-terminated.
+ * int length               the number of characters in the name.
+ * int address              the address of the symbol.
+ */
+void add_loaded_symbol(LoadedSymbols *symbols, char *name, int length, int address) {
+    int no_of_names = (symbols->names.length);
+    int id;
+
+    if ((symbols->length) == (symbols->capacity)) {
+        symbols->capacity = (symbols->capacity) ? 2 * (symbols->capacity) : INITIAL_NO_OF_SYMBOLS;
+        symbols->ids = realloc(symbols->ids, (symbols->capacity) * sizeof(int));
+        symbols->addresses = realloc(symbols->addresses, (symbols->capacity) * sizeof(int));
+        /* there are never more names than symbols */
+        symbols->first_indexes = realloc(symbols->first_indexes, (symbols->capacity) * sizeof(int));
+        if (symbols->ids == NULL || symbols->addresses == NULL || symbols->first_indexes == NULL) {
+            printf("Could not allocate memory for the loaded symbols!\n");
+            exit(0);
+        }
+    }
+    id = intern_string(&(symbols->names), name, length);
+    if (id == no_of_names) {
+        (symbols->first_indexes)[id] = (symbols->length);
+    }
+    (symbols->ids)[symbols->length] = id;
+    (symbols->addresses)[symbols->length] = address;
+    symbols->length += 1;
+}
+
+/*
+ * Returns the address of the first symbol with the given name, or -1
+ * if there is no symbol with the given name.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *symbols   a pointer to the symbols.
+ * char *name               the name of the symbol.
+ */
+int get_loaded_symbol_address(LoadedSymbols *symbols, char *name) {
+    int id = find_string_id(&(symbols->names), name);
+
+    if (id == NO_STRING_ID) {
+        return -1;
+    }
+    return (symbols->addresses)[(symbols->first_indexes)[id]];
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the given
+ * symbols, and makes them empty.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *symbols   a pointer to the symbols.
+ */
+void free_loaded_symbols(LoadedSymbols *symbols) {
+    free_string_pool(&(symbols->names));
+    free(symbols->ids);
+    free(symbols->addresses);
+    free(symbols->first_indexes);
+    memset(symbols, 0, sizeof(LoadedSymbols));
+}
+
+/*
+ * Reads the decimal number that starts in the given index of the given text, after
+ * any spaces, and moves the index to the character after the number. Returns the
+ * number, or -1 if there is no number in the index.
+ *
+ * Parameters:
+ * -----------
+ * const char *text     the text to read from.
+ * size_t length        the number of characters in the text.
+ * size_t *index        a pointer to the index to start reading from.
+ */
+long read_number(const char *text, size_t length, size_t *index) {
+    long number = 0;
+    size_t start;
+
+    while (*index < length && (text[*index] == ' ' || text[*index] == '\t')) {
+        *index += 1;
+    }
+    start = *index;
+    while (*index < length && text[*index] >= '0' && text[*index] <= '9' && number < MACHINE_MEMORY_SIZE) {
+        number = 10 * number + (text[*index] - '0');
+        *index += 1;
+    }
+    return (*index == start) ? -1 : number;
+}
+
+/*
+ * Moves the given index to the first character of the next line of the given text.
+ * Returns 1 if the rest of the current line contains only spaces, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * const char *text     the text to read from.
+ * size_t length        the number of characters in the text.
+ * size_t *index        a pointer to the index in the current line.
+ */
+int skip_line(const char *text, size_t length, size_t *index) {
+    int only_spaces = 1;
+
+    while (*index < length && text[*index] != '\n') {
+        if (text[*index] != ' ' && text[*index] != '\t' && text[*index] != '\r') {
+            only_spaces = 0;
+        }
+        *index += 1;
+    }
+    if (*index < length) {
+        *index += 1;
+    }
+    return only_spaces;
+}
+
+/*
+ * Adds the symbols of the given entries/externals file to the given symbols. Each
+ * line of the file contains the name of a label and an address. Returns 1 if the
+ * file was loaded, and 0 if it doesn't exist or it's not in this format.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *symbols   a pointer to the symbols.
+ * char *file_path          the path to the entries/externals file.
+ */
+int load_symbols_file(LoadedSymbols *symbols, char *file_path) {
+    size_t length;
+    char *contents = map_file(file_path, &length);
+    size_t index = 0;
+    size_t name_start;
+    size_t name_end;
+    long address;
+
+    if (contents == NULL) {
+        return 0;
+    }
+    while (index < length) {
+        name_start = index;
+        while (index < length && contents[index] != ' ' && contents[index] != '\n') {
+            index++;
+        }
+        name_end = index;
+        address = read_number(contents, length, &index);
+        if (name_end == name_start || address < 0 || !skip_line(contents, length, &index)) {
+            unmap_file(contents, length);
+            return 0;
+        }
+        add_loaded_symbol(symbols, contents + name_start, (int) (name_end - name_start), (int) address);
+    }
+    unmap_file(contents, length);
+    return 1;
+}
+
+/*
+ * Decodes the given lines of words of an object file line by line, to the given
+ * array. Each line contains two base 64 digits, and may also contain spaces and a
+ * carriage return. Returns 1 if there are exactly 'no_of_words' valid lines, and
+ * 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * const char *text         the lines of the words, without the header line.
+ * size_t length            the number of characters in the text.
+ * unsigned short *words    the array to store the decoded words in.
+ * int no_of_words          the number of words that the text should contain.
+ */
+int decode_lines(const char *text, size_t length, unsigned short *words, int no_of_words) {
+    size_t index = 0;
+    unsigned int upper_digit;
+    unsigned int lower_digit;
+    int word_index = 0;
+
+    while (index < length) {
+        while (index < length && (text[index] == ' ' || text[index] == '\t')) {
+            index++;
+        }
+        /* skip empty lines */
+        if (index < length && (text[index] == '\n' || text[index] == '\r')) {
+            skip_line(text, length, &index);
+            continue;
+        }
+        if (index + 1 >= length || word_index == no_of_words) {
+            return 0;
+        }
+        upper_digit = decode_base_64_digit(text[index]);
+        lower_digit = decode_base_64_digit(text[index + 1]);
+        index += 2;
+        if (upper_digit == INVALID_BASE_64_DIGIT || lower_digit == INVALID_BASE_64_DIGIT ||
+            !skip_line(text, length, &index)) {
+            return 0;
+        }
+        words[word_index++] = (unsigned short) ((upper_digit << 6) | lower_digit);
+    }
+    return word_index == no_of_words;
+}
+
+/*
+ * Loads the words of the given object file (in base 64) to the memory of the given
+ * image, starting from the load address. Returns 1 if the file was loaded, and 0 if
+ * it doesn't exist or it's not in this format.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the image.
+ * char *file_path      the path to the object file.
+ */
+int load_text_object(MachineImage *image, char *file_path) {
+    size_t length;
+    char *contents = map_file(file_path, &length);
+    size_t index = 0;
+    long code_words;
+    long data_words;
+    unsigned short *words;
+    int loaded_flag;
+
+    if (contents == NULL) {
+        return 0;
+    }
+    /* the header line contains the number of code words and the number of data words */
+    code_words = read_number(contents, length, &index);
+    data_words = read_number(contents, length, &index);
+    if (code_words < 0 || data_words < 0 || !skip_line(contents, length, &index) ||
+        LOAD_ADDRESS + code_words + data_words > MACHINE_MEMORY_SIZE) {
+        unmap_file(contents, length);
+        return 0;
+    }
+    image->load_address = LOAD_ADDRESS;
+    image->code_words = (int) code_words;
+    image->data_words = (int) data_words;
+    words = (image->memory) + LOAD_ADDRESS;
+
+    /* an object file that the assembler created is decoded in blocks, and any other file line by line */
+    loaded_flag = ((length - index) == BASE_64_LINE_LENGTH * (size_t) (code_words + data_words) &&
+                   decode_base_64_words(contents + index, length - index, words) == code_words + data_words) ||
+                  decode_lines(contents + index, length - index, words, (int) (code_words + data_words));
+    unmap_file(contents, length);
+    return loaded_flag;
+}
+
+/*
+ * Returns the 16-bit little-endian word that starts in the given bytes.
+ *
+ * Parameters:
+ * -----------
+ * const unsigned char *bytes   the bytes of the word.
+ */
+unsigned int read_binary_word(const unsigned char *bytes) {
+    return (unsigned int) bytes[0] | ((unsigned int) bytes[1] << 8);
+}
+
+/*
+ * Adds the rows of a table of a binary object file to the given symbols. Returns 1
+ * if the name of each row is inside the names of the file, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *symbols           a pointer to the symbols.
+ * const unsigned char *table       the first row of the table.
+ * int no_of_rows                   the number of rows in the table.
+ * char *names                      the names of the labels of the file.
+ * int strings_size                 the number of bytes in the names.
+ */
+int load_binary_symbols(LoadedSymbols *symbols, const unsigned char *table, int no_of_rows, char *names,
+                        int strings_size) {
+    int index;
+    int name_offset;
+
+    for (index = 0; index < no_of_rows; index++) {
+        name_offset = (int) read_binary_word(table + index * OBJECT_SYMBOL_SIZE);
+        if (name_offset >= strings_size) {
+            return 0;
+        }
+        add_loaded_symbol(symbols, names + name_offset, (int) strlen(names + name_offset),
+                          (int) read_binary_word(table + index * OBJECT_SYMBOL_SIZE + 2));
+    }
+    return 1;
+}
+
+/*
+ * Loads the given binary object file to the given image: its words are copied to the
+ * memory of the image starting from the load address in the header, and its entries
+ * and external references are added to the symbols of the image. Returns 1 if the
+ * file was loaded, and 0 if it doesn't exist or it's not a valid binary object file.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the image.
+ * char *file_path      the path to the binary object file.
+ */
+int load_binary_object(MachineImage *image, char *file_path) {
+    size_t length;
+    char *contents = map_file(file_path, &length);
+    const unsigned char *bytes = (const unsigned char *) contents;
+    const unsigned char *words;
+    size_t expected_length;
+    int no_of_words;
+    int no_of_entries;
+    int no_of_externals;
+    int strings_size;
+    int index;
+    int loaded_flag;
+
+    if (contents == NULL) {
+        return 0;
+    }
+    if (length < OBJECT_HEADER_SIZE || memcmp(bytes, BINARY_OBJECT_MAGIC, BINARY_OBJECT_MAGIC_LENGTH) != 0 ||
+        read_binary_word(bytes + 4) != BINARY_OBJECT_VERSION) {
+        unmap_file(contents, length);
+        return 0;
+    }
+    image->load_address = (int) read_binary_word(bytes + 6);
+    image->code_words = (int) read_binary_word(bytes + 8);
+    image->data_words = (int) read_binary_word(bytes + 10);
+    no_of_entries = (int) read_binary_word(bytes + 12);
+    no_of_externals = (int) read_binary_word(bytes + 14);
+    strings_size = (int) read_binary_word(bytes + 16);
+    no_of_words = (image->code_words) + (image->data_words);
+
+    /* the sizes in the header must match the size of the file, and the last name must end in the file */
+    expected_length = OBJECT_HEADER_SIZE + 2 * (size_t) no_of_words +
+                      OBJECT_SYMBOL_SIZE * (size_t) (no_of_entries + no_of_externals) + (size_t) strings_size;
+    if (expected_length != length || (image->load_address) + no_of_words > MACHINE_MEMORY_SIZE ||
+        (strings_size > 0 && contents[length - 1] != 0)) {
+        unmap_file(contents, length);
+        return 0;
+    }
+    /* the words are copied to the memory as they are */
+    words = bytes + OBJECT_HEADER_SIZE;
+    for (index = 0; index < no_of_words; index++) {
+        (image->memory)[(image->load_address) + index] = (unsigned short) read_binary_word(words + 2 * index);
+    }
+    words += 2 * no_of_words;
+    loaded_flag = load_binary_symbols(&(image->entries), words, no_of_entries,
+                                      contents + length - strings_size, strings_size) &&
+                  load_binary_symbols(&(image->externals), words + OBJECT_SYMBOL_SIZE * no_of_entries,
+                                      no_of_externals, contents + length - strings_size, strings_size);
+    unmap_file(contents, length);
+    return loaded_flag;
+}
+
+/*
+ * Returns a pointer to a new MachineImage that contains the given program. If the
+ * program has a binary object file, the image is loaded from it, and otherwise, the
+ * image is loaded from the object file, the entries file and the externals file. If
+ * the program has no valid object file, the function returns NULL. The user should
+ * free the image with 'free_machine_image'.
+ *
+ * Parameters:
+ * -----------
+ * char *file_path  a path to the output files of the program, without an extension.
+ */
+MachineImage *load_machine_image(char *file_path) {
+    MachineImage *image = calloc(1, sizeof(MachineImage));
+    char *binary_object_file_path = create_file_path(file_path, OUTPUT_BINARY_OBJECT_FILE_EXTENSION);
+    char *object_file_path = create_file_path(file_path, OUTPUT_OBJECT_FILE_EXTENSION);
+    char *entries_file_path = create_file_path(file_path, OUTPUT_ENTRIES_FILE_EXTENSION);
+    char *externals_file_path = create_file_path(file_path, OUTPUT_EXTERNALS_FILE_EXTENSION);
+    int loaded_flag;
+
+    if (image == NULL || (image->memory = calloc(MACHINE_MEMORY_SIZE, sizeof(unsigned short))) == NULL) {
+        printf("Could not allocate memory for the machine image!\n");
+        exit(0);
+    }
+    loaded_flag = load_binary_object(image, binary_object_file_path);
+    if (!loaded_flag) {
+        /* the binary object file may have been loaded partially */
+        free_loaded_symbols(&(image->entries));
+        free_loaded_symbols(&(image->externals));
+        loaded_flag = load_text_object(image, object_file_path);
+        /* a program without entries or externals doesn't have these files */
+        load_symbols_file(&(image->entries), entries_file_path);
+        load_symbols_file(&(image->externals), externals_file_path);
+    }
+    free(binary_object_file_path);
+    free(object_file_path);
+    free(entries_file_path);
+    free(externals_file_path);
+    if (!loaded_flag) {
+        free_machine_image(image);
+        return NULL;
+    }
+    return image;
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the memory and the
+ * symbols of the given image, and in the end frees the image itself.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the image.
+ */
+void free_machine_image(MachineImage *image) {
+    free(image->memory);
+    free_loaded_symbols(&(image->entries));
+    free_loaded_symbols(&(image->externals));
+    free(image);
+}
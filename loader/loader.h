@@ -0,0 +1,126 @@
+#ifndef ASSEMBLER_SIMULATOR_LOADER_H
+#define ASSEMBLER_SIMULATOR_LOADER_H
+
+#include <stddef.h>
+#include "../types.h"
+
+#define OBJECT_HEADER_SIZE 20 /* the number of bytes in the header of a binary object file */
+#define OBJECT_SYMBOL_SIZE 4 /* the number of bytes in a row of a table of a binary object file */
+
+/*
+ * Returns a pointer to the contents of the given file, mapped to the memory, and
+ * stores the number of bytes of the file in the given length. If the file can't be
+ * opened or it's empty, the function returns NULL. The user should unmap the file
+ * with 'unmap_file'.
+ *
+ * Parameters:
+ * -----------
+ * char *file_path      the path to the file.
+ * size_t *length       a pointer to store the length of the file in.
+ */
+char *map_file(char *file_path, size_t *length);
+
+/*
+ * Unmaps the contents of a file that was mapped with 'map_file'.
+ *
+ * Parameters:
+ * -----------
+ * char *contents       the contents of the file.
+ * size_t length        the number of bytes of the file.
+ */
+void unmap_file(char *contents, size_t length);
+
+/*
+ * Adds a symbol with the given name and address to the end of the given symbols.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *symbols   a pointer to the symbols.
+ * char *name               the characters of the name, not necessarily null-terminated.
+ * int length               the number of characters in the name.
+ * int address              the address of the symbol.
+ */
+void add_loaded_symbol(LoadedSymbols *symbols, char *name, int length, int address);
+
+/*
+ * Returns the address of the first symbol with the given name, or -1
+ * if there is no symbol with the given name.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *symbols   a pointer to the symbols.
+ * char *name               the name of the symbol.
+ */
+int get_loaded_symbol_address(LoadedSymbols *symbols, char *name);
+
+/*
+ * Frees the dynamic memory that was allocated to contain the given
+ * symbols, and makes them empty.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *symbols   a pointer to the symbols.
+ */
+void free_loaded_symbols(LoadedSymbols *symbols);
+
+/*
+ * Adds the symbols of the given entries/externals file to the given symbols. Each
+ * line of the file contains the name of a label and an address. Returns 1 if the
+ * file was loaded, and 0 if it doesn't exist or it's not in this format.
+ *
+ * Parameters:
+ * -----------
+ * LoadedSymbols *symbols   a pointer to the symbols.
+ * char *file_path          the path to the entries/externals file.
+ */
+int load_symbols_file(LoadedSymbols *symbols, char *file_path);
+
+/*
+ * Loads the words of the given object file (in base 64) to the memory of the given
+ * image, starting from the load address. Returns 1 if the file was loaded, and 0 if
+ * it doesn't exist or it's not in this format.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the image.
+ * char *file_path      the path to the object file.
+ */
+int load_text_object(MachineImage *image, char *file_path);
+
+/*
+ * Loads the given binary object file to the given image: its words are copied to the
+ * memory of the image starting from the load address in the header, and its entries
+ * and external references are added to the symbols of the image. Returns 1 if the
+ * file was loaded, and 0 if it doesn't exist or it's not a valid binary object file.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the image.
+ * char *file_path      the path to the binary object file.
+ */
+int load_binary_object(MachineImage *image, char *file_path);
+
+/*
+ * Returns a pointer to a new MachineImage that contains the given program. If the
+ * program has a binary object file, the image is loaded from it, and otherwise, the
+ * image is loaded from the object file, the entries file and the externals file. If
+ * the program has no valid object file, the function returns NULL. The user should
+ * free the image with 'free_machine_image'.
+ *
+ * Parameters:
+ * -----------
+ * char *file_path  a path to the output files of the program, without an extension.
+ */
+MachineImage *load_machine_image(char *file_path);
+
+/*
+ * Frees the dynamic memory that was allocated to contain the memory and the
+ * symbols of the given image, and in the end frees the image itself.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the image.
+ */
+void free_machine_image(MachineImage *image);
+
+#endif
@@ -1,8 +1,30 @@
+#include <string.h>
+#include "absolutes.h"
+#include "segments.h"
 #include "compiler.h"
+#include "incremental.h"
 
 int main(int argc, char *argv[]) {
     int index;
+    int watch_flag = 0; /* indicates if the program is watched and assembled again whenever it changes */
+
+    /* the options apply to all the programs */
+    for (index = 1; index < argc; index++) {
+        if (strcmp(argv[index], BINARY_OBJECT_OPTION) == 0) {
+            BINARY_OBJECT_FLAG = 1;
+        } else if (strcmp(argv[index], WATCH_OPTION) == 0) {
+            watch_flag = 1;
+        }
+    }
     for (index = 1; index < argc; index++) {
+        if (strcmp(argv[index], BINARY_OBJECT_OPTION) == 0 || strcmp(argv[index], WATCH_OPTION) == 0) {
+            continue;
+        }
+        /* only a single program is watched */
+        if (watch_flag) {
+            watch_program(argv[index]);
+            return 0;
+        }
         compile(argv[index]);
     }
     return 0;
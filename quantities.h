@@ -10,21 +10,26 @@
 #define NO_OF_OPERATIONS_TYPE_1 9     /* the number of commands that take 1 operand */
 #define NO_OF_OPERATIONS_TYPE_2 5     /* the number of commands that take 2 operands */
 
-#define MAX_COMMAND_LENGTH 80      /* the maximum amount of characters in a sentence (line) of the program */
-#define MAX_FIELD_LENGTH 80         /* the maximum amount of characters in a field of a command */
-
 #define MAX_NO_OF_COMMANDS 1500     /* the maximum number of commands that can be in the program */
 #define MAX_NO_OF_DATA 1500         /* the maximum number of data declarations that can be in the program */
 
 #define NO_OF_FIELDS_IN_MACRO_CALL_OR_END 1 /* the number of fields in a macro call or an end of a macro definition */
 #define NO_OF_ADDRESSING_METHODS 3 /* the number of addressing methods that exists in the program */
+#define NO_OF_ADDRESSING_INDEXES (NO_OF_ADDRESSING_METHODS + 1) /* the number of addressing methods, including a missing operand */
 
 #define MIN_NO_OF_WORDS_IN_COMMAND 1 /* the minimum number of memory words a command can use */
 #define MAX_NO_OF_WORDS_IN_COMMAND 3 /* the maximum number of memory words a command can use */
+#define MAX_FUSED_COMMANDS 3 /* the maximum number of commands that the threaded interpreter fuses to a single handler */
 
 #define MAX_NO_OF_CHARS_IN_64_ENCODING 3 /* the maximum number of characters in the conversion of the assembly code to base 64 */
-#define MAX_FILE_NAME_LENGTH 200 /* the maximum length of the name of a program's file */
+#define OBJECT_WORD_LINE_LENGTH 3 /* the number of characters in the line of a word in an object file, with its new line */
+#define MAX_OBJECT_HEADER_LENGTH 32 /* the maximum number of characters in the first line of an object file */
 #define NO_OF_MEMORY_WORDS_IN_PROGRAM 1024 /* the maximum number of memory words in a program */
+#define MEMORY_WORD_MASK 0xFFF /* the 12 bits of a memory word */
+#define MAX_NUMBER_VALUE MEMORY_WORD_MASK /* the largest absolute value of a number that fits in a memory word */
+#define MACHINE_MEMORY_SIZE 4096 /* the number of memory words of the machine, that a 12-bit word can address */
+#define RETURN_STACK_SIZE 256 /* the maximum number of nested subroutine calls in the machine */
+#define CHECKPOINT_MAGIC_LENGTH 8 /* the number of characters that start a checkpoint file */
 
 #define MIN_REGISTER_NUMBER 0 /* the lowest number a register can have */
 #define MAX_REGISTER_NUMBER 7 /* the largest number a register can have */
@@ -1,7 +1,10 @@
 #ifndef ASSEMBLER_SIMULATOR_SEGMENTS_H
 #define ASSEMBLER_SIMULATOR_SEGMENTS_H
 
+#include <stdio.h>
 #include "quantities.h"
+#include "data_structures/segment.h"
+#include "data_structures/output_buffer.h"
 
 /* the instruction counter of the program */
 extern int IC;
@@ -13,11 +16,18 @@ extern int final_DC;
 extern int LOAD_ADDRESS;
 /* indicates if an error has occurred in the program */
 extern int ERROR_FLAG;
+/* indicates if the binary object file of the program is created */
+extern int BINARY_OBJECT_FLAG;
 
 /* the encoding of the program's code */
-extern unsigned int code_segment[MAX_NO_OF_COMMANDS][1];
+extern Segment code_segment;
 /* the encoding of the program's data */
-extern unsigned int data_segment[MAX_NO_OF_COMMANDS][1];
+extern Segment data_segment;
+
+/* the stream that the errors of the program are copied to, or NULL if they are only printed */
+extern FILE *diagnostics_file;
+/* the buffer that the errors of the program are appended to instead of being printed, or NULL */
+extern OutputBuffer *diagnostics_buffer;
 
 /* all the possible operations in the program */
 extern const Operation operations[NO_OF_OPERATIONS];
@@ -0,0 +1,774 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "batch.h"
+#include "simulator.h"
+#include "../absolutes.h"
+#include "../compiler.h"
+#include "../command_analysis/helpers.h"
+#include "../disassembler/disassembler.h"
+#include "../error_detection/errors.h"
+#include "../loader/loader.h"
+
+/*
+ * Allocates an array of the given number of elements of the given size, in which
+ * all the bytes are 0, and exits if the memory can't be allocated.
+ *
+ * Parameters:
+ * -----------
+ * size_t no_of_elements    the number of elements.
+ * size_t element_size      the size of each element.
+ */
+void *allocate_lanes(size_t no_of_elements, size_t element_size) {
+    void *lanes = calloc(no_of_elements, element_size);
+
+    if (lanes == NULL) {
+        printf("Could not allocate memory for the lanes!\n");
+        exit(0);
+    }
+    return lanes;
+}
+
+/*
+ * Returns a pointer to a new BatchMachine with the given number of lanes, that execute
+ * the given loaded program from its load address. Each lane has its own copy of the
+ * memory of the image, its own input and its own output. The user should free it
+ * with 'free_batch_machine'.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the loaded program.
+ * int no_of_lanes      the number of lanes.
+ * FILE **inputs        the stream that each lane reads characters from.
+ * FILE **outputs       the stream that each lane prints characters to.
+ */
+BatchMachine *create_batch_machine(MachineImage *image, int no_of_lanes, FILE **inputs, FILE **outputs) {
+    BatchMachine *batch = allocate_lanes(1, sizeof(BatchMachine));
+    int address;
+    int lane;
+
+    batch->no_of_lanes = no_of_lanes;
+    batch->memory = allocate_lanes((size_t) MACHINE_MEMORY_SIZE * no_of_lanes, sizeof(unsigned short));
+    batch->registers = allocate_lanes((size_t) NO_OF_REGISTERS * no_of_lanes, sizeof(unsigned short));
+    batch->zero_flags = allocate_lanes(no_of_lanes, sizeof(unsigned short));
+    batch->negative_flags = allocate_lanes(no_of_lanes, sizeof(unsigned short));
+    batch->program_counters = allocate_lanes(no_of_lanes, sizeof(unsigned short));
+    batch->return_stacks = allocate_lanes((size_t) RETURN_STACK_SIZE * no_of_lanes, sizeof(int));
+    batch->stack_depths = allocate_lanes(no_of_lanes, sizeof(int));
+    batch->executed_instructions = allocate_lanes(no_of_lanes, sizeof(unsigned long));
+    batch->states = allocate_lanes(no_of_lanes, sizeof(int));
+    batch->running = allocate_lanes(no_of_lanes, sizeof(unsigned short));
+    batch->error_msgs = allocate_lanes(no_of_lanes, sizeof(char *));
+    batch->error_addresses = allocate_lanes(no_of_lanes, sizeof(int));
+    batch->mask = allocate_lanes(no_of_lanes, sizeof(unsigned short));
+    batch->operand_rows = allocate_lanes((size_t) NO_OF_OPERAND_ROWS * no_of_lanes, sizeof(unsigned short));
+    batch->operand_constants = allocate_lanes(NO_OF_OPERAND_ROWS, sizeof(int));
+    batch->written_words = create_word_bitmap();
+    batch->inputs = inputs;
+    batch->outputs = outputs;
+    for (address = 0; address < MACHINE_MEMORY_SIZE; address++) {
+        for (lane = 0; lane < no_of_lanes; lane++) {
+            LANE_WORD(batch, address, lane) = (image->memory)[address];
+        }
+    }
+    for (address = 0; address < NO_OF_OPERAND_ROWS; address++) {
+        (batch->operand_constants)[address] = -1;
+    }
+    for (lane = 0; lane < no_of_lanes; lane++) {
+        (batch->program_counters)[lane] = (unsigned short) (image->load_address);
+        (batch->states)[lane] = MACHINE_RUNNING;
+        (batch->running)[lane] = ALL_LANE_BITS;
+    }
+    return batch;
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the lanes of the given
+ * batch machine (but not its streams), and in the end frees the machine itself.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ */
+void free_batch_machine(BatchMachine *batch) {
+    free(batch->memory);
+    free(batch->registers);
+    free(batch->zero_flags);
+    free(batch->negative_flags);
+    free(batch->program_counters);
+    free(batch->return_stacks);
+    free(batch->stack_depths);
+    free(batch->executed_instructions);
+    free(batch->states);
+    free(batch->running);
+    free(batch->error_msgs);
+    free(batch->error_addresses);
+    free(batch->mask);
+    free(batch->operand_rows);
+    free(batch->operand_constants);
+    free(batch->written_words);
+    free(batch);
+}
+
+/*
+ * Stores the program counter of the group in each lane of the group, and adds the
+ * commands that the group executed since it was selected to each of its lanes.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ */
+void flush_group(BatchMachine *batch) {
+    unsigned short *mask = batch->mask;
+    int lane;
+
+    for (lane = 0; lane < (batch->no_of_lanes); lane++) {
+        (batch->program_counters)[lane] = BLEND_LANE((batch->program_counters)[lane], batch->group_address,
+                                                     mask[lane]);
+        (batch->executed_instructions)[lane] += (mask[lane] & 1) * (batch->group_steps);
+    }
+    batch->group_steps = 0;
+}
+
+/*
+ * Flushes the group, and ends it, so the lanes that execute the next command are
+ * selected again.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ */
+void end_group(BatchMachine *batch) {
+    flush_group(batch);
+    batch->group_flag = 0;
+}
+
+/*
+ * Ends the group, and stops each of its lanes because of the given error in the
+ * command it executes.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ * char *error_msg      the error message.
+ * int address          the address of the command that caused the error.
+ */
+void set_lane_faults(BatchMachine *batch, char *error_msg, int address) {
+    int lane;
+
+    end_group(batch);
+    for (lane = 0; lane < (batch->no_of_lanes); lane++) {
+        if ((batch->mask)[lane]) {
+            (batch->states)[lane] = MACHINE_FAULT;
+            (batch->running)[lane] = 0;
+            (batch->error_msgs)[lane] = error_msg;
+            (batch->error_addresses)[lane] = address;
+        }
+    }
+}
+
+/*
+ * Returns a scratch row in which all the lanes have the given value. The row is
+ * filled only if it doesn't have the value already.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch      a pointer to the batch machine.
+ * int scratch_index        the index of the scratch row.
+ * unsigned short value     the value.
+ */
+unsigned short *get_constant_row(BatchMachine *batch, int scratch_index, unsigned short value) {
+    unsigned short *row = (batch->operand_rows) + scratch_index * (batch->no_of_lanes);
+    int lane;
+
+    if ((batch->operand_constants)[scratch_index] != value) {
+        for (lane = 0; lane < (batch->no_of_lanes); lane++) {
+            row[lane] = value;
+        }
+        (batch->operand_constants)[scratch_index] = value;
+    }
+    return row;
+}
+
+/*
+ * Returns the row of the values of the given operand in all the lanes: a row of the
+ * memory or of the registers, or a scratch row that is filled with an immediate
+ * value. If the operand is an external label that was not linked, the lanes of the
+ * group stop with an error and the function returns NULL.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ * int addressing       the addressing code of the operand.
+ * int word_address     the address of the memory word of the operand.
+ * int register_shift   the index of the first bit of a register in the memory word.
+ * int address          the address of the command.
+ * int scratch_index    the index of the scratch row that the operand may use.
+ */
+unsigned short *get_value_row(BatchMachine *batch, int addressing, int word_address, int register_shift,
+                              int address, int scratch_index) {
+    unsigned short *row;
+    unsigned int value;
+
+    if (addressing != IMMEDIATE_ADDRESSING_CODE) {
+        row = get_address_row(batch, addressing, word_address, register_shift, address, scratch_index);
+        if (row == NULL || addressing == REGISTER_ADDRESSING_CODE) {
+            return row;
+        }
+        /* all the lanes of the group read the same label */
+        return (batch->memory) + row[batch->leader] * (batch->no_of_lanes);
+    }
+    value = decode_bit_field(LANE_WORD(batch, word_address, batch->leader), ENCODING_OPERAND_LENGTH,
+                             ENCODING_OPERAND_SHIFT);
+    /* an immediate value is a signed number in the bits of the operand */
+    if (value >= (1 << (ENCODING_OPERAND_LENGTH - 1))) {
+        value = (value - (1 << ENCODING_OPERAND_LENGTH)) & MEMORY_WORD_MASK;
+    }
+    return get_constant_row(batch, scratch_index, (unsigned short) value);
+}
+
+/*
+ * Returns the row of the addresses that the given operand refers to in all the
+ * lanes: the row of a register, or a scratch row that is filled with the address of
+ * a label. If the operand is an external label that was not linked, the lanes of
+ * the group stop with an error and the function returns NULL.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ * int addressing       the addressing code of the operand (a label or a register).
+ * int word_address     the address of the memory word of the operand.
+ * int register_shift   the index of the first bit of a register in the memory word.
+ * int address          the address of the command.
+ * int scratch_index    the index of the scratch row that the operand may use.
+ */
+unsigned short *get_address_row(BatchMachine *batch, int addressing, int word_address, int register_shift,
+                                int address, int scratch_index) {
+    unsigned int word = LANE_WORD(batch, word_address, batch->leader);
+
+    if (addressing == REGISTER_ADDRESSING_CODE) {
+        return (batch->registers) + (decode_bit_field(word, ENCODING_REGISTER_LENGTH, register_shift) %
+                                     NO_OF_REGISTERS) * (batch->no_of_lanes);
+    }
+    if (decode_bit_field(word, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT) == ARE_EXTERNAL_CODE) {
+        set_lane_faults(batch, UNRESOLVED_EXTERNAL_OPERAND, address);
+        return NULL;
+    }
+    return get_constant_row(batch, scratch_index,
+                            (unsigned short) decode_bit_field(word, ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT));
+}
+
+/*
+ * Returns 1 if all the lanes of the group have the same value in the given row, and
+ * 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch      a pointer to the batch machine.
+ * unsigned short *row      the row.
+ */
+int is_uniform_row(BatchMachine *batch, unsigned short *row) {
+    unsigned short value = row[batch->leader];
+    unsigned short differences = 0;
+    int lane;
+
+    for (lane = 0; lane < (batch->no_of_lanes); lane++) {
+        differences |= (row[lane] ^ value) & (batch->mask)[lane];
+    }
+    return differences == 0;
+}
+
+/*
+ * Ends the group after its lanes took different branches: each lane of the group
+ * that has no bit set in the given flags jumps to its address in the given row of
+ * targets, and the other lanes continue to the next command.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch      a pointer to the batch machine.
+ * unsigned short *targets  the address that each lane jumps to.
+ * unsigned short *flags    all the bits are set in each lane that doesn't jump, or NULL if all the lanes jump.
+ */
+void diverge_group(BatchMachine *batch, unsigned short *targets, unsigned short *flags) {
+    unsigned short *mask = batch->mask;
+    int lane;
+
+    end_group(batch);
+    for (lane = 0; lane < (batch->no_of_lanes); lane++) {
+        (batch->program_counters)[lane] = BLEND_LANE((batch->program_counters)[lane], targets[lane],
+                                                     mask[lane] & ((flags == NULL) ? ALL_LANE_BITS : ~flags[lane]));
+    }
+}
+
+/*
+ * Removes from the group each lane whose word in the given address is different from
+ * the word of the leader (because a lane changed it), so it executes its own command
+ * in another group.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ * int word_address     the address of a word of the next command of the group.
+ */
+void separate_lanes(BatchMachine *batch, int word_address) {
+    unsigned short *row = (batch->memory) + word_address * (batch->no_of_lanes);
+    unsigned short word = row[batch->leader];
+    int lane;
+
+    if (is_uniform_row(batch, row)) {
+        return;
+    }
+    flush_group(batch);
+    for (lane = 0; lane < (batch->no_of_lanes); lane++) {
+        (batch->mask)[lane] &= (unsigned short) ((row[lane] == word) ? ALL_LANE_BITS : 0);
+    }
+    /* the separated lanes wait in the command, so the group ends after it */
+    batch->lowest_waiting_address = batch->group_address;
+}
+
+/*
+ * Selects the lanes of a new group, and returns one of them, or -1 if no lane is
+ * running. The running lane with the lowest program counter is selected with all
+ * the running lanes that have the same program counter, so lanes that took
+ * different branches merge again when they reach the same address.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch              a pointer to the batch machine.
+ * unsigned long max_instructions   the maximum number of commands of each lane, or 0 for no limit.
+ */
+int select_lanes(BatchMachine *batch, unsigned long max_instructions) {
+    unsigned short *mask = batch->mask;
+    unsigned short *running = batch->running;
+    unsigned short *program_counters = batch->program_counters;
+    unsigned short lowest = NO_LANE_ADDRESS; /* the lowest program counter of a running lane */
+    unsigned short waiting = NO_LANE_ADDRESS; /* the lowest program counter of a running lane out of the group */
+    unsigned short candidate;
+    unsigned long budget = ULONG_MAX;
+    int lane;
+
+    if (max_instructions != 0) {
+        for (lane = 0; lane < (batch->no_of_lanes); lane++) {
+            if ((batch->executed_instructions)[lane] >= max_instructions) {
+                running[lane] = 0;
+            }
+        }
+    }
+    for (lane = 0; lane < (batch->no_of_lanes); lane++) {
+        candidate = BLEND_LANE(NO_LANE_ADDRESS, program_counters[lane], running[lane]);
+        lowest = (candidate < lowest) ? candidate : lowest;
+    }
+    if (lowest == NO_LANE_ADDRESS) {
+        return -1;
+    }
+    for (lane = 0; lane < (batch->no_of_lanes); lane++) {
+        mask[lane] = (unsigned short) (((program_counters[lane] == lowest) ? ALL_LANE_BITS : 0) & running[lane]);
+        candidate = BLEND_LANE(NO_LANE_ADDRESS, program_counters[lane], running[lane] & ~mask[lane]);
+        waiting = (candidate < waiting) ? candidate : waiting;
+        if (max_instructions != 0 && mask[lane] &&
+            max_instructions - (batch->executed_instructions)[lane] < budget) {
+            budget = max_instructions - (batch->executed_instructions)[lane];
+        }
+    }
+    for (lane = 0; !mask[lane]; lane++) {
+    }
+    batch->leader = lane;
+    batch->group_flag = 1;
+    batch->group_address = lowest;
+    batch->group_steps = 0;
+    batch->group_budget = budget;
+    batch->lowest_waiting_address = waiting;
+    return lane;
+}
+
+/*
+ * Executes the next command of the group, like 'step_machine' in each of its lanes,
+ * and returns 1. If no group is selected, a new group is selected first. The group
+ * ends when its lanes take different branches, when it reaches the address of a
+ * lane that waits, or when one of its lanes stops. Returns 0 if no lane is running.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch              a pointer to the batch machine.
+ * unsigned long max_instructions   the maximum number of commands of each lane, or 0 for no limit.
+ */
+int step_batch(BatchMachine *batch, unsigned long max_instructions) {
+    const DecodingTemplate *template;
+    unsigned short *mask = batch->mask;
+    unsigned short *src_row = NULL;
+    unsigned short *dest_row = NULL;
+    unsigned short taken; /* the bits of the lanes that take a branch */
+    unsigned short not_taken; /* the bits of the lanes that don't take a branch */
+    int no_of_lanes = batch->no_of_lanes;
+    int address;
+    int src_word; /* the address of the memory word of the source operand */
+    int dest_word; /* the address of the memory word of the destination operand */
+    int memory_words;
+    int word_index;
+    int lane;
+    int stack_flag = 0; /* indicates if the return stack of a lane of the group is full or empty */
+    int character;
+
+    if (!(batch->group_flag) && select_lanes(batch, max_instructions) < 0) {
+        return 0;
+    }
+    address = batch->group_address;
+    if (address >= MACHINE_MEMORY_SIZE) {
+        set_lane_faults(batch, PROGRAM_COUNTER_OVERFLOW, address);
+        return 1;
+    }
+    template = get_decoding_template(LANE_WORD(batch, address, batch->leader));
+    memory_words = ((template->opcode) == NO_OPCODE || address + (template->memory_words) > MACHINE_MEMORY_SIZE)
+                   ? 1 : template->memory_words;
+    /* the lanes have the same words, unless a lane changed them */
+    for (word_index = 0; word_index < memory_words; word_index++) {
+        if (is_word_marked(batch->written_words, address + word_index)) {
+            separate_lanes(batch, address + word_index);
+        }
+    }
+    if ((template->opcode) == NO_OPCODE) {
+        set_lane_faults(batch, ILLEGAL_INSTRUCTION, address);
+        return 1;
+    }
+    if (address + (template->memory_words) > MACHINE_MEMORY_SIZE) {
+        set_lane_faults(batch, PROGRAM_COUNTER_OVERFLOW, address);
+        return 1;
+    }
+    src_word = address + 1;
+    /* two registers are stored in the same memory word */
+    dest_word = ((template->src_addressing) == 0 || ((template->src_addressing) == REGISTER_ADDRESSING_CODE &&
+                                                     (template->dest_addressing) == REGISTER_ADDRESSING_CODE))
+                ? src_word : src_word + 1;
+    batch->group_address = address + memory_words;
+    batch->group_steps++;
+    batch->group_budget--;
+    if ((template->src_addressing) != 0) {
+        src_row = ((template->opcode) == LEA_OPCODE)
+                  ? get_address_row(batch, template->src_addressing, src_word, ENCODING_SRC_REGISTER_SHIFT, address, 0)
+                  : get_value_row(batch, template->src_addressing, src_word, ENCODING_SRC_REGISTER_SHIFT, address, 0);
+        if (src_row == NULL) {
+            return 1;
+        }
+    }
+    if ((template->dest_addressing) != 0) {
+        dest_row = ((template->opcode) == JMP_OPCODE || (template->opcode) == BNE_OPCODE ||
+                    (template->opcode) == JSR_OPCODE)
+                   ? get_address_row(batch, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT,
+                                     address, 1)
+                   : get_value_row(batch, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT,
+                                   address, 1);
+        if (dest_row == NULL) {
+            return 1;
+        }
+        /* a label that a lane writes to may become a word of a command with other values in other lanes */
+        if ((template->dest_addressing) == LABEL_ADDRESSING_CODE && (template->opcode) != CMP_OPCODE &&
+            (template->opcode) != PRN_OPCODE && dest_row >= (batch->memory) &&
+            dest_row < (batch->memory) + MACHINE_MEMORY_SIZE * no_of_lanes) {
+            mark_word(batch->written_words, (int) ((dest_row - (batch->memory)) / no_of_lanes));
+        }
+    }
+
+    /* the loops over the lanes have no branches, so the compiler may execute them with vector instructions */
+    switch (template->opcode) {
+        case MOV_OPCODE:
+        case LEA_OPCODE:
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                dest_row[lane] = BLEND_LANE(dest_row[lane], src_row[lane], mask[lane]);
+            }
+            break;
+        case CMP_OPCODE:
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                (batch->zero_flags)[lane] = BLEND_LANE((batch->zero_flags)[lane],
+                                                       (src_row[lane] == dest_row[lane]) ? ALL_LANE_BITS : 0,
+                                                       mask[lane]);
+                (batch->negative_flags)[lane] = BLEND_LANE((batch->negative_flags)[lane],
+                                                           ((src_row[lane] - dest_row[lane]) & NEGATIVE_WORD_BIT)
+                                                           ? ALL_LANE_BITS : 0, mask[lane]);
+            }
+            break;
+        case ADD_OPCODE:
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                dest_row[lane] = BLEND_LANE(dest_row[lane], (dest_row[lane] + src_row[lane]) & MEMORY_WORD_MASK,
+                                            mask[lane]);
+            }
+            break;
+        case SUB_OPCODE:
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                dest_row[lane] = BLEND_LANE(dest_row[lane], (dest_row[lane] - src_row[lane]) & MEMORY_WORD_MASK,
+                                            mask[lane]);
+            }
+            break;
+        case NOT_OPCODE:
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                dest_row[lane] = BLEND_LANE(dest_row[lane], ~dest_row[lane] & MEMORY_WORD_MASK, mask[lane]);
+            }
+            break;
+        case CLR_OPCODE:
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                dest_row[lane] = BLEND_LANE(dest_row[lane], 0, mask[lane]);
+            }
+            break;
+        case INC_OPCODE:
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                dest_row[lane] = BLEND_LANE(dest_row[lane], (dest_row[lane] + 1) & MEMORY_WORD_MASK, mask[lane]);
+            }
+            break;
+        case DEC_OPCODE:
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                dest_row[lane] = BLEND_LANE(dest_row[lane], (dest_row[lane] - 1) & MEMORY_WORD_MASK, mask[lane]);
+            }
+            break;
+        case JMP_OPCODE:
+            if ((template->dest_addressing) != REGISTER_ADDRESSING_CODE || is_uniform_row(batch, dest_row)) {
+                batch->group_address = dest_row[batch->leader];
+            } else {
+                diverge_group(batch, dest_row, NULL);
+            }
+            break;
+        case BNE_OPCODE:
+            taken = 0;
+            not_taken = 0;
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                taken |= mask[lane] & ~(batch->zero_flags)[lane];
+                not_taken |= mask[lane] & (batch->zero_flags)[lane];
+            }
+            if (taken && !not_taken &&
+                ((template->dest_addressing) != REGISTER_ADDRESSING_CODE || is_uniform_row(batch, dest_row))) {
+                batch->group_address = dest_row[batch->leader];
+            } else if (taken) {
+                diverge_group(batch, dest_row, batch->zero_flags);
+            }
+            break;
+        case JSR_OPCODE:
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                stack_flag |= (mask[lane] && (batch->stack_depths)[lane] == RETURN_STACK_SIZE);
+            }
+            if (stack_flag) {
+                end_group(batch);
+            }
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                if (!mask[lane]) {
+                    continue;
+                }
+                if ((batch->stack_depths)[lane] == RETURN_STACK_SIZE) {
+                    (batch->states)[lane] = MACHINE_FAULT;
+                    (batch->running)[lane] = 0;
+                    (batch->error_msgs)[lane] = RETURN_STACK_OVERFLOW;
+                    (batch->error_addresses)[lane] = address;
+                    continue;
+                }
+                (batch->return_stacks)[((batch->stack_depths)[lane])++ * no_of_lanes + lane] = address + memory_words;
+                if (stack_flag) {
+                    (batch->program_counters)[lane] = dest_row[lane];
+                }
+            }
+            if (!stack_flag) {
+                if ((template->dest_addressing) != REGISTER_ADDRESSING_CODE || is_uniform_row(batch, dest_row)) {
+                    batch->group_address = dest_row[batch->leader];
+                } else {
+                    diverge_group(batch, dest_row, NULL);
+                }
+            }
+            break;
+        case RED_OPCODE:
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                if (mask[lane]) {
+                    character = fgetc((batch->inputs)[lane]);
+                    /* the end of the input is read as -1 */
+                    dest_row[lane] = (unsigned short) ((character == EOF) ? MEMORY_WORD_MASK
+                                                                          : character & MEMORY_WORD_MASK);
+                }
+            }
+            break;
+        case PRN_OPCODE:
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                if (mask[lane]) {
+                    fputc(dest_row[lane] & CHARACTER_MASK, (batch->outputs)[lane]);
+                }
+            }
+            break;
+        case RTS_OPCODE:
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                stack_flag |= (mask[lane] && (batch->stack_depths)[lane] == 0);
+            }
+            /* the return addresses are stored in a scratch row */
+            dest_row = batch->operand_rows;
+            (batch->operand_constants)[0] = -1;
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                if (!mask[lane]) {
+                    continue;
+                }
+                if ((batch->stack_depths)[lane] == 0) {
+                    (batch->states)[lane] = MACHINE_FAULT;
+                    (batch->running)[lane] = 0;
+                    (batch->error_msgs)[lane] = RETURN_STACK_UNDERFLOW;
+                    (batch->error_addresses)[lane] = address;
+                    continue;
+                }
+                dest_row[lane] = (unsigned short) (batch->return_stacks)[--((batch->stack_depths)[lane]) *
+                                                                         no_of_lanes + lane];
+            }
+            if (!stack_flag && is_uniform_row(batch, dest_row)) {
+                batch->group_address = dest_row[batch->leader];
+            } else {
+                /* the lanes that stopped don't use their program counters */
+                diverge_group(batch, dest_row, NULL);
+            }
+            break;
+        case STOP_OPCODE:
+            end_group(batch);
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                if (mask[lane]) {
+                    (batch->states)[lane] = MACHINE_STOPPED;
+                    (batch->running)[lane] = 0;
+                }
+            }
+            break;
+    }
+    /* the lanes that wait in the next address of the group (or after it) may join it */
+    if ((batch->group_flag) &&
+        ((batch->group_budget) == 0 || (batch->group_address) >= (batch->lowest_waiting_address))) {
+        end_group(batch);
+    }
+    return 1;
+}
+
+/*
+ * Executes commands in the lanes of the given batch machine until all of them stop,
+ * or have executed the given number of commands. Returns the total number of commands
+ * that the lanes executed.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch              a pointer to the batch machine.
+ * unsigned long max_instructions   the maximum number of commands of each lane, or 0 for no limit.
+ */
+unsigned long run_batch(BatchMachine *batch, unsigned long max_instructions) {
+    unsigned long executed = 0;
+    int lane;
+
+    while (step_batch(batch, max_instructions) > 0) {
+    }
+    for (lane = 0; lane < (batch->no_of_lanes); lane++) {
+        executed += (batch->executed_instructions)[lane];
+    }
+    return executed;
+}
+
+/*
+ * Executes the given program in a batch machine with a lane for each of the given
+ * input files, and prints the error of each lane that stopped because of an error.
+ * Returns the total number of commands that the lanes executed.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image              a pointer to the loaded program.
+ * char **input_paths               the path to the input file of each lane.
+ * int no_of_lanes                  the number of lanes.
+ * unsigned long max_instructions   the maximum number of commands of each lane, or 0 for no limit.
+ */
+unsigned long execute_batch(MachineImage *image, char **input_paths, int no_of_lanes,
+                            unsigned long max_instructions) {
+    FILE *inputs[MAX_BATCH_LANES];
+    FILE *outputs[MAX_BATCH_LANES];
+    BatchMachine *batch;
+    unsigned long executed;
+    char *output_path;
+    int lane;
+
+    for (lane = 0; lane < no_of_lanes; lane++) {
+        output_path = create_file_path(input_paths[lane], BATCH_OUTPUT_EXTENSION);
+        inputs[lane] = fopen(input_paths[lane], "r");
+        outputs[lane] = fopen(output_path, "w");
+        if (inputs[lane] == NULL || outputs[lane] == NULL) {
+            printf("%s: could not open the input file or the file %s\n", input_paths[lane], output_path);
+            exit(0);
+        }
+        free(output_path);
+    }
+    batch = create_batch_machine(image, no_of_lanes, inputs, outputs);
+    executed = run_batch(batch, max_instructions);
+    for (lane = 0; lane < no_of_lanes; lane++) {
+        if ((batch->states)[lane] == MACHINE_FAULT) {
+            printf("%s: Address: %d\t|  Error: %s\n", input_paths[lane], (batch->error_addresses)[lane],
+                   (batch->error_msgs)[lane]);
+        }
+        fclose(inputs[lane]);
+        fclose(outputs[lane]);
+    }
+    free_batch_machine(batch);
+    return executed;
+}
+
+/*
+ * Executes the given program once for each input file in the given list (a path in
+ * each line), in batches of up to MAX_BATCH_LANES lanes. Each lane prints to a file
+ * with the path of its input and the extension ".out". The error of each lane that
+ * stopped because of an error is printed, and the statistics of all the lanes are
+ * printed in the end. Returns the number of lanes that were executed.
+ *
+ * Parameters:
+ * -----------
+ * char *program_path               the path to the output files of the program, without an extension.
+ * char *list_path                  the path to the list of the input files.
+ * unsigned long max_instructions   the maximum number of commands of each lane, or 0 for no limit.
+ */
+int run_batch_program(char *program_path, char *list_path, unsigned long max_instructions) {
+    MachineImage *image;
+    FILE *list;
+    char line[MAX_BATCH_PATH_LENGTH];
+    char *input_paths[MAX_BATCH_LANES];
+    unsigned long executed = 0;
+    clock_t start;
+    double seconds;
+    int no_of_lanes = 0; /* the number of lanes of the current batch */
+    int total_lanes = 0;
+    int end_of_list = 0;
+    int lane;
+
+    if ((image = load_machine_image(program_path)) == NULL) {
+        printf("%s: the program has no valid object file\n", program_path);
+        return 0;
+    }
+    if ((list = fopen(list_path, "r")) == NULL) {
+        printf("%s: the list of the input files can't be read\n", list_path);
+        free_machine_image(image);
+        return 0;
+    }
+    start = clock();
+    while (!end_of_list) {
+        end_of_list = (fgets(line, MAX_BATCH_PATH_LENGTH, list) == NULL);
+        if (!end_of_list) {
+            line[strcspn(line, "\r\n")] = '\0';
+            if (line[0] == '\0') {
+                continue;
+            }
+            input_paths[no_of_lanes] = malloc(strlen(line) + 1);
+            if (input_paths[no_of_lanes] == NULL) {
+                printf("Could not allocate memory for the path!\n");
+                exit(0);
+            }
+            strcpy(input_paths[no_of_lanes++], line);
+        }
+        if (no_of_lanes == MAX_BATCH_LANES || (end_of_list && no_of_lanes > 0)) {
+            executed += execute_batch(image, input_paths, no_of_lanes, max_instructions);
+            for (lane = 0; lane < no_of_lanes; lane++) {
+                free(input_paths[lane]);
+            }
+            total_lanes += no_of_lanes;
+            no_of_lanes = 0;
+        }
+    }
+    seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+    fprintf(stderr, "Executed %s: %lu instructions in %d lanes in %.3f seconds", program_path, executed,
+            total_lanes, seconds);
+    if (seconds > 0) {
+        fprintf(stderr, " (%.0f instructions per second)", (double) executed / seconds);
+    }
+    fprintf(stderr, "\n");
+    fclose(list);
+    free_machine_image(image);
+    return total_lanes;
+}
@@ -0,0 +1,242 @@
+#ifndef ASSEMBLER_SIMULATOR_BATCH_H
+#define ASSEMBLER_SIMULATOR_BATCH_H
+
+#include <stdio.h>
+#include "../types.h"
+
+#define BATCH_OPTION "-b" /* the command line option that executes the programs once for each input in a list */
+#define BATCH_OUTPUT_EXTENSION ".out" /* the extension of the file that a lane prints to, after the path of its input */
+#define MAX_BATCH_LANES 256 /* the maximum number of lanes that are executed together */
+#define MAX_BATCH_PATH_LENGTH 1024 /* the maximum number of characters in a path of the input list */
+#define NO_OF_OPERAND_ROWS 2 /* the number of scratch rows for operands that are not in the memory */
+#define ALL_LANE_BITS 0xFFFF /* the mask of a lane that executes the current command */
+#define NO_LANE_ADDRESS 0xFFFF /* greater than the program counter of any running lane */
+
+/* the value of the given word in the given lane */
+#define LANE_WORD(batch, address, lane) (((batch)->memory)[(address) * ((batch)->no_of_lanes) + (lane)])
+
+/* the new value of a word in the lanes of the mask, and the old value in the other lanes */
+#define BLEND_LANE(old_value, new_value, lane_mask) \
+    ((unsigned short) (((old_value) & ~(lane_mask)) | ((new_value) & (lane_mask))))
+
+/*
+ * Allocates an array of the given number of elements of the given size, in which
+ * all the bytes are 0, and exits if the memory can't be allocated.
+ *
+ * Parameters:
+ * -----------
+ * size_t no_of_elements    the number of elements.
+ * size_t element_size      the size of each element.
+ */
+void *allocate_lanes(size_t no_of_elements, size_t element_size);
+
+/*
+ * Returns a pointer to a new BatchMachine with the given number of lanes, that execute
+ * the given loaded program from its load address. Each lane has its own copy of the
+ * memory of the image, its own input and its own output. The user should free it
+ * with 'free_batch_machine'.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the loaded program.
+ * int no_of_lanes      the number of lanes.
+ * FILE **inputs        the stream that each lane reads characters from.
+ * FILE **outputs       the stream that each lane prints characters to.
+ */
+BatchMachine *create_batch_machine(MachineImage *image, int no_of_lanes, FILE **inputs, FILE **outputs);
+
+/*
+ * Frees the dynamic memory that was allocated to contain the lanes of the given
+ * batch machine (but not its streams), and in the end frees the machine itself.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ */
+void free_batch_machine(BatchMachine *batch);
+
+/*
+ * Stores the program counter of the group in each lane of the group, and adds the
+ * commands that the group executed since it was selected to each of its lanes.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ */
+void flush_group(BatchMachine *batch);
+
+/*
+ * Flushes the group, and ends it, so the lanes that execute the next command are
+ * selected again.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ */
+void end_group(BatchMachine *batch);
+
+/*
+ * Ends the group, and stops each of its lanes because of the given error in the
+ * command it executes.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ * char *error_msg      the error message.
+ * int address          the address of the command that caused the error.
+ */
+void set_lane_faults(BatchMachine *batch, char *error_msg, int address);
+
+/*
+ * Returns a scratch row in which all the lanes have the given value. The row is
+ * filled only if it doesn't have the value already.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch      a pointer to the batch machine.
+ * int scratch_index        the index of the scratch row.
+ * unsigned short value     the value.
+ */
+unsigned short *get_constant_row(BatchMachine *batch, int scratch_index, unsigned short value);
+
+/*
+ * Returns the row of the values of the given operand in all the lanes: a row of the
+ * memory or of the registers, or a scratch row that is filled with an immediate
+ * value. If the operand is an external label that was not linked, the lanes of the
+ * group stop with an error and the function returns NULL.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ * int addressing       the addressing code of the operand.
+ * int word_address     the address of the memory word of the operand.
+ * int register_shift   the index of the first bit of a register in the memory word.
+ * int address          the address of the command.
+ * int scratch_index    the index of the scratch row that the operand may use.
+ */
+unsigned short *get_value_row(BatchMachine *batch, int addressing, int word_address, int register_shift,
+                              int address, int scratch_index);
+
+/*
+ * Returns the row of the addresses that the given operand refers to in all the
+ * lanes: the row of a register, or a scratch row that is filled with the address of
+ * a label. If the operand is an external label that was not linked, the lanes of
+ * the group stop with an error and the function returns NULL.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ * int addressing       the addressing code of the operand (a label or a register).
+ * int word_address     the address of the memory word of the operand.
+ * int register_shift   the index of the first bit of a register in the memory word.
+ * int address          the address of the command.
+ * int scratch_index    the index of the scratch row that the operand may use.
+ */
+unsigned short *get_address_row(BatchMachine *batch, int addressing, int word_address, int register_shift,
+                                int address, int scratch_index);
+
+/*
+ * Returns 1 if all the lanes of the group have the same value in the given row, and
+ * 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch      a pointer to the batch machine.
+ * unsigned short *row      the row.
+ */
+int is_uniform_row(BatchMachine *batch, unsigned short *row);
+
+/*
+ * Ends the group after its lanes took different branches: each lane of the group
+ * that has no bit set in the given flags jumps to its address in the given row of
+ * targets, and the other lanes continue to the next command.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch      a pointer to the batch machine.
+ * unsigned short *targets  the address that each lane jumps to.
+ * unsigned short *flags    all the bits are set in each lane that doesn't jump, or NULL if all the lanes jump.
+ */
+void diverge_group(BatchMachine *batch, unsigned short *targets, unsigned short *flags);
+
+/*
+ * Removes from the group each lane whose word in the given address is different from
+ * the word of the leader (because a lane changed it), so it executes its own command
+ * in another group.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch  a pointer to the batch machine.
+ * int word_address     the address of a word of the next command of the group.
+ */
+void separate_lanes(BatchMachine *batch, int word_address);
+
+/*
+ * Selects the lanes of a new group, and returns one of them, or -1 if no lane is
+ * running. The running lane with the lowest program counter is selected with all
+ * the running lanes that have the same program counter, so lanes that took
+ * different branches merge again when they reach the same address.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch              a pointer to the batch machine.
+ * unsigned long max_instructions   the maximum number of commands of each lane, or 0 for no limit.
+ */
+int select_lanes(BatchMachine *batch, unsigned long max_instructions);
+
+/*
+ * Executes the next command of the group, like 'step_machine' in each of its lanes,
+ * and returns 1. If no group is selected, a new group is selected first. The group
+ * ends when its lanes take different branches, when it reaches the address of a
+ * lane that waits, or when one of its lanes stops. Returns 0 if no lane is running.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch              a pointer to the batch machine.
+ * unsigned long max_instructions   the maximum number of commands of each lane, or 0 for no limit.
+ */
+int step_batch(BatchMachine *batch, unsigned long max_instructions);
+
+/*
+ * Executes commands in the lanes of the given batch machine until all of them stop,
+ * or have executed the given number of commands. Returns the total number of commands
+ * that the lanes executed.
+ *
+ * Parameters:
+ * -----------
+ * BatchMachine *batch              a pointer to the batch machine.
+ * unsigned long max_instructions   the maximum number of commands of each lane, or 0 for no limit.
+ */
+unsigned long run_batch(BatchMachine *batch, unsigned long max_instructions);
+
+/*
+ * Executes the given program in a batch machine with a lane for each of the given
+ * input files, and prints the error of each lane that stopped because of an error.
+ * Returns the total number of commands that the lanes executed.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image              a pointer to the loaded program.
+ * char **input_paths               the path to the input file of each lane.
+ * int no_of_lanes                  the number of lanes.
+ * unsigned long max_instructions   the maximum number of commands of each lane, or 0 for no limit.
+ */
+unsigned long execute_batch(MachineImage *image, char **input_paths, int no_of_lanes,
+                            unsigned long max_instructions);
+
+/*
+ * Executes the given program once for each input file in the given list (a path in
+ * each line), in batches of up to MAX_BATCH_LANES lanes. Each lane prints to a file
+ * with the path of its input and the extension ".out". The error of each lane that
+ * stopped because of an error is printed, and the statistics of all the lanes are
+ * printed in the end. Returns the number of lanes that were executed.
+ *
+ * Parameters:
+ * -----------
+ * char *program_path               the path to the output files of the program, without an extension.
+ * char *list_path                  the path to the list of the input files.
+ * unsigned long max_instructions   the maximum number of commands of each lane, or 0 for no limit.
+ */
+int run_batch_program(char *program_path, char *list_path, unsigned long max_instructions);
+
+#endif
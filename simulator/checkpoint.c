@@ -0,0 +1,241 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "checkpoint.h"
+#include "simulator.h"
+#include "threaded.h"
+
+/*
+ * Executes the given machine until it reaches the checkpoint: until it executed the
+ * given number of commands, or until its program counter is the given breakpoint,
+ * whichever comes first. The commands are executed with the given threaded program,
+ * or with 'step_machine' if it's NULL. Returns 1 if the machine reached the checkpoint
+ * and it's still running, and 0 if it stopped before it (or reached the limit of the
+ * number of commands first).
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine                         a pointer to the machine.
+ * ThreadedProgram *program                 a pointer to the threaded program of the machine, or NULL.
+ * unsigned long checkpoint_instructions    the number of commands before the checkpoint, or 0 if it has no such limit.
+ * int breakpoint                           the address of the breakpoint, or NO_BREAKPOINT.
+ * unsigned long max_instructions           the maximum number of commands to execute, or 0 for no limit.
+ */
+int run_to_checkpoint(Machine *machine, ThreadedProgram *program, unsigned long checkpoint_instructions,
+                      int breakpoint, unsigned long max_instructions) {
+    unsigned long limit = checkpoint_instructions;
+
+    if (max_instructions != 0 && (limit == 0 || max_instructions < limit)) {
+        limit = max_instructions;
+    }
+    if (program != NULL) {
+        set_threaded_breakpoint(program, breakpoint);
+        run_threaded(machine, program, limit);
+        clear_threaded_breakpoint(program, breakpoint);
+    } else {
+        while ((machine->state) == MACHINE_RUNNING && (machine->program_counter) != breakpoint &&
+               (limit == 0 || (machine->executed_instructions) < limit)) {
+            step_machine(machine);
+        }
+    }
+    if ((machine->state) != MACHINE_RUNNING) {
+        return 0;
+    }
+    return (machine->program_counter) == breakpoint ||
+           (checkpoint_instructions != 0 && (machine->executed_instructions) == checkpoint_instructions);
+}
+
+/*
+ * Writes a checkpoint file with the state of the given machine, that executes the
+ * given program. The positions of the input and the output streams are stored if
+ * the streams are files. Returns 1 if the file was written, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine         a pointer to the machine.
+ * MachineImage *image      a pointer to the loaded program.
+ * char *checkpoint_path    the path to the checkpoint file.
+ */
+int write_checkpoint(Machine *machine, MachineImage *image, char *checkpoint_path) {
+    MachineCheckpoint *checkpoint = calloc(1, sizeof(MachineCheckpoint));
+    FILE *file;
+    int written;
+
+    if (checkpoint == NULL) {
+        printf("Could not allocate memory for the checkpoint!\n");
+        exit(0);
+    }
+    memcpy(checkpoint->magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_LENGTH);
+    checkpoint->memory_size = MACHINE_MEMORY_SIZE;
+    checkpoint->no_of_registers = NO_OF_REGISTERS;
+    checkpoint->return_stack_size = RETURN_STACK_SIZE;
+    checkpoint->load_address = image->load_address;
+    checkpoint->code_words = image->code_words;
+    checkpoint->data_words = image->data_words;
+    memcpy(checkpoint->registers, machine->registers, NO_OF_REGISTERS * sizeof(unsigned short));
+    checkpoint->program_counter = machine->program_counter;
+    checkpoint->zero_flag = machine->zero_flag;
+    checkpoint->negative_flag = machine->negative_flag;
+    memcpy(checkpoint->return_stack, machine->return_stack, (machine->stack_depth) * sizeof(int));
+    checkpoint->stack_depth = machine->stack_depth;
+    checkpoint->executed_instructions = machine->executed_instructions;
+    /* the position of a stream that is not a file (a pipe or a terminal) is -1 */
+    checkpoint->input_offset = ftell(machine->input);
+    checkpoint->output_offset = ftell(machine->output);
+    memcpy(checkpoint->memory, machine->memory, MACHINE_MEMORY_SIZE * sizeof(unsigned short));
+
+    if ((file = fopen(checkpoint_path, "wb")) == NULL) {
+        free(checkpoint);
+        return 0;
+    }
+    written = (fwrite(checkpoint, sizeof(MachineCheckpoint), 1, file) == 1);
+    written = (fclose(file) == 0) && written;
+    free(checkpoint);
+    return written;
+}
+
+/*
+ * Returns 1 if the given mapped file is a checkpoint of this machine, and its state
+ * can be executed: the program counter and each return address are addresses of the
+ * machine (or the address after its memory), and each register and memory word fits
+ * in a memory word. Returns 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * MachineCheckpoint *checkpoint    a pointer to the mapped checkpoint.
+ */
+int is_valid_checkpoint(MachineCheckpoint *checkpoint) {
+    int index;
+
+    if (memcmp(checkpoint->magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_LENGTH) != 0 ||
+        (checkpoint->memory_size) != MACHINE_MEMORY_SIZE || (checkpoint->no_of_registers) != NO_OF_REGISTERS ||
+        (checkpoint->return_stack_size) != RETURN_STACK_SIZE || (checkpoint->stack_depth) < 0 ||
+        (checkpoint->stack_depth) > RETURN_STACK_SIZE || (checkpoint->load_address) < 0 ||
+        (checkpoint->code_words) < 0 || (checkpoint->data_words) < 0 ||
+        (checkpoint->load_address) + (checkpoint->code_words) + (checkpoint->data_words) > MACHINE_MEMORY_SIZE) {
+        return 0;
+    }
+    /* the interpreters index their commands with these addresses without checking them */
+    if ((checkpoint->program_counter) < 0 || (checkpoint->program_counter) > MACHINE_MEMORY_SIZE) {
+        return 0;
+    }
+    for (index = 0; index < (checkpoint->stack_depth); index++) {
+        if ((checkpoint->return_stack)[index] < 0 || (checkpoint->return_stack)[index] > MACHINE_MEMORY_SIZE) {
+            return 0;
+        }
+    }
+    for (index = 0; index < NO_OF_REGISTERS; index++) {
+        if ((checkpoint->registers)[index] > MEMORY_WORD_MASK) {
+            return 0;
+        }
+    }
+    for (index = 0; index < MACHINE_MEMORY_SIZE; index++) {
+        if ((checkpoint->memory)[index] > MEMORY_WORD_MASK) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Maps the given checkpoint file to the memory, stores a pointer to it in the given
+ * pointer, and returns a pointer to a new image of the program of the checkpoint.
+ * The memory of the image is the memory in the mapped file, so nothing is copied
+ * before the program uses it. The mapping is private, so the program never changes
+ * the file. If the file can't be mapped, or it's not a valid checkpoint of this
+ * machine, the function returns NULL. The user should free the image with 'unmap_checkpoint'.
+ *
+ * Parameters:
+ * -----------
+ * char *checkpoint_path            the path to the checkpoint file.
+ * MachineCheckpoint **checkpoint   a pointer that receives the mapped checkpoint.
+ */
+MachineImage *map_checkpoint(char *checkpoint_path, MachineCheckpoint **checkpoint) {
+    MachineImage *image;
+    MachineCheckpoint *mapped;
+    struct stat file_status;
+    int descriptor = open(checkpoint_path, O_RDONLY);
+
+    if (descriptor < 0) {
+        return NULL;
+    }
+    if (fstat(descriptor, &file_status) != 0 || file_status.st_size != (off_t) sizeof(MachineCheckpoint)) {
+        close(descriptor);
+        return NULL;
+    }
+    mapped = mmap(NULL, sizeof(MachineCheckpoint), PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (mapped == MAP_FAILED) {
+        return NULL;
+    }
+    if (!is_valid_checkpoint(mapped)) {
+        munmap(mapped, sizeof(MachineCheckpoint));
+        return NULL;
+    }
+    if ((image = calloc(1, sizeof(MachineImage))) == NULL) {
+        printf("Could not allocate memory for the image!\n");
+        exit(0);
+    }
+    image->memory = mapped->memory;
+    image->load_address = mapped->load_address;
+    image->code_words = mapped->code_words;
+    image->data_words = mapped->data_words;
+    *checkpoint = mapped;
+    return image;
+}
+
+/*
+ * Sets the state of the given machine, that was created with the image of the given
+ * checkpoint, to the state in the checkpoint. The characters that the program read
+ * before the checkpoint are skipped in the input (by seeking a file, and by reading
+ * them from any other stream). If the output is a file that already contains the
+ * characters that the program printed before the checkpoint, the program continues
+ * it after them.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine                 a pointer to the machine.
+ * MachineCheckpoint *checkpoint    a pointer to the mapped checkpoint.
+ */
+void resume_checkpoint(Machine *machine, MachineCheckpoint *checkpoint) {
+    struct stat file_status;
+    long index;
+
+    memcpy(machine->registers, checkpoint->registers, NO_OF_REGISTERS * sizeof(unsigned short));
+    machine->program_counter = checkpoint->program_counter;
+    machine->zero_flag = checkpoint->zero_flag;
+    machine->negative_flag = checkpoint->negative_flag;
+    memcpy(machine->return_stack, checkpoint->return_stack, (checkpoint->stack_depth) * sizeof(int));
+    machine->stack_depth = checkpoint->stack_depth;
+    machine->executed_instructions = checkpoint->executed_instructions;
+    machine->state = MACHINE_RUNNING;
+    if ((checkpoint->input_offset) > 0 && fseek(machine->input, checkpoint->input_offset, SEEK_SET) != 0) {
+        index = 0;
+        while (index < (checkpoint->input_offset) && getc(machine->input) != EOF) {
+            index++;
+        }
+    }
+    if ((checkpoint->output_offset) > 0 && fstat(fileno(machine->output), &file_status) == 0 &&
+        S_ISREG(file_status.st_mode) && file_status.st_size >= (off_t) (checkpoint->output_offset)) {
+        fseek(machine->output, checkpoint->output_offset, SEEK_SET);
+    }
+}
+
+/*
+ * Unmaps the given checkpoint, and frees the given image, that was created with it.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image              a pointer to the image of the checkpoint.
+ * MachineCheckpoint *checkpoint    a pointer to the mapped checkpoint.
+ */
+void unmap_checkpoint(MachineImage *image, MachineCheckpoint *checkpoint) {
+    munmap(checkpoint, sizeof(MachineCheckpoint));
+    free(image);
+}
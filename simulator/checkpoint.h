@@ -0,0 +1,96 @@
+#ifndef ASSEMBLER_SIMULATOR_CHECKPOINT_H
+#define ASSEMBLER_SIMULATOR_CHECKPOINT_H
+
+#include "../types.h"
+
+#define CHECKPOINT_OPTION "-w" /* the command line option that writes a checkpoint file */
+#define CHECKPOINT_INSTRUCTIONS_OPTION "-i" /* the command line option that writes the checkpoint after a number of commands */
+#define BREAKPOINT_OPTION "-a" /* the command line option that writes the checkpoint when the program reaches an address */
+#define RESUME_OPTION "-r" /* the command line option that resumes checkpoint files instead of executing programs */
+#define CHECKPOINT_MAGIC "ASMCHKPT" /* the CHECKPOINT_MAGIC_LENGTH characters that start a checkpoint file */
+
+/*
+ * Executes the given machine until it reaches the checkpoint: until it executed the
+ * given number of commands, or until its program counter is the given breakpoint,
+ * whichever comes first. The commands are executed with the given threaded program,
+ * or with 'step_machine' if it's NULL. Returns 1 if the machine reached the checkpoint
+ * and it's still running, and 0 if it stopped before it (or reached the limit of the
+ * number of commands first).
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine                         a pointer to the machine.
+ * ThreadedProgram *program                 a pointer to the threaded program of the machine, or NULL.
+ * unsigned long checkpoint_instructions    the number of commands before the checkpoint, or 0 if it has no such limit.
+ * int breakpoint                           the address of the breakpoint, or NO_BREAKPOINT.
+ * unsigned long max_instructions           the maximum number of commands to execute, or 0 for no limit.
+ */
+int run_to_checkpoint(Machine *machine, ThreadedProgram *program, unsigned long checkpoint_instructions,
+                      int breakpoint, unsigned long max_instructions);
+
+/*
+ * Writes a checkpoint file with the state of the given machine, that executes the
+ * given program. The positions of the input and the output streams are stored if
+ * the streams are files. Returns 1 if the file was written, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine         a pointer to the machine.
+ * MachineImage *image      a pointer to the loaded program.
+ * char *checkpoint_path    the path to the checkpoint file.
+ */
+int write_checkpoint(Machine *machine, MachineImage *image, char *checkpoint_path);
+
+/*
+ * Returns 1 if the given mapped file is a checkpoint of this machine, and its state
+ * can be executed: the program counter and each return address are addresses of the
+ * machine (or the address after its memory), and each register and memory word fits
+ * in a memory word. Returns 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * MachineCheckpoint *checkpoint    a pointer to the mapped checkpoint.
+ */
+int is_valid_checkpoint(MachineCheckpoint *checkpoint);
+
+/*
+ * Maps the given checkpoint file to the memory, stores a pointer to it in the given
+ * pointer, and returns a pointer to a new image of the program of the checkpoint.
+ * The memory of the image is the memory in the mapped file, so nothing is copied
+ * before the program uses it. The mapping is private, so the program never changes
+ * the file. If the file can't be mapped, or it's not a valid checkpoint of this
+ * machine, the function returns NULL. The user should free the image with 'unmap_checkpoint'.
+ *
+ * Parameters:
+ * -----------
+ * char *checkpoint_path            the path to the checkpoint file.
+ * MachineCheckpoint **checkpoint   a pointer that receives the mapped checkpoint.
+ */
+MachineImage *map_checkpoint(char *checkpoint_path, MachineCheckpoint **checkpoint);
+
+/*
+ * Sets the state of the given machine, that was created with the image of the given
+ * checkpoint, to the state in the checkpoint. The characters that the program read
+ * before the checkpoint are skipped in the input (by seeking a file, and by reading
+ * them from any other stream). If the output is a file that already contains the
+ * characters that the program printed before the checkpoint, the program continues
+ * it after them.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine                 a pointer to the machine.
+ * MachineCheckpoint *checkpoint    a pointer to the mapped checkpoint.
+ */
+void resume_checkpoint(Machine *machine, MachineCheckpoint *checkpoint);
+
+/*
+ * Unmaps the given checkpoint, and frees the given image, that was created with it.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image              a pointer to the image of the checkpoint.
+ * MachineCheckpoint *checkpoint    a pointer to the mapped checkpoint.
+ */
+void unmap_checkpoint(MachineImage *image, MachineCheckpoint *checkpoint);
+
+#endif
@@ -0,0 +1,1108 @@
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+#include "jit.h"
+#include "simulator.h"
+#include "threaded.h"
+#include "../absolutes.h"
+#include "../command_analysis/helpers.h"
+#include "../disassembler/disassembler.h"
+#include "../loader/loader.h"
+
+#ifdef JIT_SUPPORTED
+#include <sys/mman.h>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+/* the numbers of the registers of the host */
+#define HOST_RAX 0
+#define HOST_RCX 1
+#define HOST_RDX 2
+#define HOST_RBX 3 /* the memory of the machine */
+#define HOST_RBP 5 /* the machine */
+#define HOST_RSI 6 /* the number of commands that may still be executed */
+#define HOST_RDI 7 /* the JIT program */
+#define HOST_R8 8 /* the first of the eight registers of the machine */
+
+/* the native code that enters a block: it takes the JIT program, the machine and the block */
+typedef unsigned int (*JitEntry)(JitProgram *jit, Machine *machine, unsigned char *block);
+
+/*
+ * Writes the given byte to the end of the code of the given JIT program.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit      a pointer to the JIT program.
+ * unsigned int byte    the byte to write.
+ */
+void emit_byte(JitProgram *jit, unsigned int byte) {
+    (jit->code)[(jit->code_length)++] = (unsigned char) (byte & 0xFF);
+}
+
+/*
+ * Writes the given number to the end of the code of the given JIT program, as 4
+ * bytes, starting from its lower byte.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit  a pointer to the JIT program.
+ * long value       the number to write.
+ */
+void emit_int32(JitProgram *jit, long value) {
+    unsigned long bits = (unsigned long) value;
+
+    emit_byte(jit, (unsigned int) bits);
+    emit_byte(jit, (unsigned int) (bits >> 8));
+    emit_byte(jit, (unsigned int) (bits >> 16));
+    emit_byte(jit, (unsigned int) (bits >> 24));
+}
+
+/*
+ * Writes the given opcode (of one or two bytes) after its REX prefix, if it needs one.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit          a pointer to the JIT program.
+ * int wide                 indicates if the instruction uses 64-bit operands.
+ * unsigned int opcode      the opcode of the instruction.
+ * int reg                  the register in the 'reg' field of the ModRM byte.
+ * int base                 the register in the 'rm' field of the ModRM byte.
+ */
+void emit_opcode(JitProgram *jit, int wide, unsigned int opcode, int reg, int base) {
+    unsigned int rex = 0x40 | (wide ? 0x08 : 0) | ((reg >> 3) << 2) | (base >> 3);
+
+    if (rex != 0x40) {
+        emit_byte(jit, rex);
+    }
+    if (opcode > 0xFF) {
+        emit_byte(jit, opcode >> 8);
+    }
+    emit_byte(jit, opcode);
+}
+
+/*
+ * Writes an instruction whose operands are two registers.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit          a pointer to the JIT program.
+ * int wide                 indicates if the instruction uses 64-bit operands.
+ * unsigned int opcode      the opcode of the instruction.
+ * int reg                  the register (or the opcode extension) in the 'reg' field.
+ * int rm                   the register in the 'rm' field.
+ */
+void emit_register_instruction(JitProgram *jit, int wide, unsigned int opcode, int reg, int rm) {
+    emit_opcode(jit, wide, opcode, reg, rm);
+    emit_byte(jit, 0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+/*
+ * Writes an instruction whose operands are a register and the memory in the given
+ * displacement from the given base register.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit          a pointer to the JIT program.
+ * int prefix               indicates if the instruction uses 16-bit operands.
+ * int wide                 indicates if the instruction uses 64-bit operands.
+ * unsigned int opcode      the opcode of the instruction.
+ * int reg                  the register (or the opcode extension) in the 'reg' field.
+ * int base                 the base register of the memory operand.
+ * long displacement        the displacement of the memory operand.
+ */
+void emit_memory_instruction(JitProgram *jit, int prefix, int wide, unsigned int opcode, int reg, int base,
+                             long displacement) {
+    if (prefix) {
+        emit_byte(jit, 0x66);
+    }
+    emit_opcode(jit, wide, opcode, reg, base);
+    emit_byte(jit, 0x80 | ((reg & 7) << 3) | (base & 7));
+    emit_int32(jit, displacement);
+}
+
+/*
+ * Writes an instruction that stores the given number in the given 32-bit register.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit  a pointer to the JIT program.
+ * int reg          the register.
+ * long value       the number.
+ */
+void emit_move_immediate(JitProgram *jit, int reg, long value) {
+    if (reg >= 8) {
+        emit_byte(jit, 0x41);
+    }
+    emit_byte(jit, 0xB8 + (reg & 7));
+    emit_int32(jit, value);
+}
+
+/*
+ * Writes a jump (or a conditional jump) to the given code, and returns the address
+ * of its 4-byte relative target, so it could be patched later.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit          a pointer to the JIT program.
+ * unsigned int opcode      the opcode of the jump (0xE9 for a jump, 0x0F8x for a conditional jump).
+ * unsigned char *target    the code to jump to, or NULL if it will be patched later.
+ */
+unsigned char *emit_jump(JitProgram *jit, unsigned int opcode, unsigned char *target) {
+    unsigned char *relative;
+
+    if (opcode > 0xFF) {
+        emit_byte(jit, opcode >> 8);
+    }
+    emit_byte(jit, opcode);
+    relative = (jit->code) + (jit->code_length);
+    emit_int32(jit, (target == NULL) ? 0 : (long) (target - (relative + 4)));
+    return relative;
+}
+
+/*
+ * Overwrites the 4 bytes in the given address of the code with the given number,
+ * starting from its lower byte.
+ *
+ * Parameters:
+ * -----------
+ * unsigned char *site  the address of the 4 bytes.
+ * long value           the number to write.
+ */
+void patch_int32(unsigned char *site, long value) {
+    unsigned long bits = (unsigned long) value;
+
+    site[0] = (unsigned char) (bits & 0xFF);
+    site[1] = (unsigned char) ((bits >> 8) & 0xFF);
+    site[2] = (unsigned char) ((bits >> 16) & 0xFF);
+    site[3] = (unsigned char) ((bits >> 24) & 0xFF);
+}
+
+/*
+ * Patches the relative target of a jump to the given code.
+ *
+ * Parameters:
+ * -----------
+ * unsigned char *relative  the address of the 4-byte relative target of the jump.
+ * unsigned char *target    the code to jump to.
+ */
+void patch_jump(unsigned char *relative, unsigned char *target) {
+    patch_int32(relative, (long) (target - (relative + 4)));
+}
+
+/*
+ * Writes the code that loads the value of the given operand to the given register
+ * of the host.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit      a pointer to the JIT program.
+ * int addressing       the addressing code of the operand.
+ * int value            the register number, the immediate value or the address of the operand.
+ * int reg              the register of the host.
+ */
+void emit_load_operand(JitProgram *jit, int addressing, int value, int reg) {
+    if (addressing == REGISTER_ADDRESSING_CODE) {
+        emit_register_instruction(jit, 0, 0x89, HOST_R8 + value, reg);
+    } else if (addressing == IMMEDIATE_ADDRESSING_CODE) {
+        emit_move_immediate(jit, reg, value);
+    } else {
+        /* movzx reg, word [memory + 2 * address] */
+        emit_memory_instruction(jit, 0, 0, 0x0FB7, reg, HOST_RBX, 2L * value);
+    }
+}
+
+/*
+ * Writes the code that stores the given register of the host in the given operand.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit      a pointer to the JIT program.
+ * int addressing       the addressing code of the operand (a label or a register).
+ * int value            the register number or the address of the operand.
+ * int reg              the register of the host.
+ */
+void emit_store_operand(JitProgram *jit, int addressing, int value, int reg) {
+    if (addressing == REGISTER_ADDRESSING_CODE) {
+        emit_register_instruction(jit, 0, 0x89, reg, HOST_R8 + value);
+    } else {
+        emit_memory_instruction(jit, 1, 0, 0x89, reg, HOST_RBX, 2L * value);
+    }
+}
+
+/*
+ * Writes the code that leaves the translated code to the given address, through
+ * the exit with the given index.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit      a pointer to the JIT program.
+ * int address          the address that the machine continues from.
+ * int exit_index       the index of the exit, or a negative code.
+ */
+void emit_leave(JitProgram *jit, int address, int exit_index) {
+    emit_move_immediate(jit, HOST_RAX, address);
+    emit_move_immediate(jit, HOST_RDX, exit_index);
+    emit_jump(jit, 0xE9, jit->epilogue);
+}
+
+/*
+ * Writes the code that continues to the given address: a direct jump to its block if
+ * it was already translated, and otherwise an exit that is patched when it's translated.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit      a pointer to the JIT program.
+ * int address          the address to continue from.
+ */
+void emit_known_exit(JitProgram *jit, int address) {
+    if ((jit->blocks)[address] != NULL) {
+        emit_jump(jit, 0xE9, (jit->blocks)[address]);
+        return;
+    }
+    if ((jit->no_of_exits) == (jit->exits_capacity)) {
+        jit->exits_capacity = (jit->exits_capacity) ? 2 * (jit->exits_capacity) : JIT_INITIAL_NO_OF_EXITS;
+        jit->exits = realloc(jit->exits, (jit->exits_capacity) * sizeof(JitExit));
+        if (jit->exits == NULL) {
+            printf("Could not allocate memory for the JIT program!\n");
+            exit(0);
+        }
+    }
+    (jit->exits)[jit->no_of_exits].site = (jit->code) + (jit->code_length);
+    (jit->exits)[jit->no_of_exits].target = address;
+    emit_leave(jit, address, (jit->no_of_exits)++);
+}
+
+/*
+ * Writes the code that continues to the address in the RAX register: a jump to its
+ * block if it was translated, and otherwise an exit to the machine.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit  a pointer to the JIT program.
+ */
+void emit_indirect_exit(JitProgram *jit) {
+    /* mov rcx, [jit + blocks] */
+    emit_memory_instruction(jit, 0, 1, 0x8B, HOST_RCX, HOST_RDI, (long) offsetof(JitProgram, blocks));
+    /* mov rcx, [rcx + 8 * rax] */
+    emit_byte(jit, 0x48);
+    emit_byte(jit, 0x8B);
+    emit_byte(jit, 0x0C);
+    emit_byte(jit, 0xC1);
+    /* test rcx, rcx; jz +2; jmp rcx */
+    emit_register_instruction(jit, 1, 0x85, HOST_RCX, HOST_RCX);
+    emit_byte(jit, 0x74);
+    emit_byte(jit, 0x02);
+    emit_byte(jit, 0xFF);
+    emit_byte(jit, 0xE1);
+    emit_move_immediate(jit, HOST_RDX, JIT_INDIRECT_EXIT);
+    emit_jump(jit, 0xE9, jit->epilogue);
+}
+
+/*
+ * Writes the code that leaves the translated code before the command in the given
+ * address, which was counted as executed, so the machine executes it (and finds its error).
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit      a pointer to the JIT program.
+ * int address          the address of the command.
+ */
+void emit_refund_exit(JitProgram *jit, int address) {
+    /* add rsi, 1 */
+    emit_register_instruction(jit, 1, 0x81, 0, HOST_RSI);
+    emit_int32(jit, 1);
+    emit_leave(jit, address, JIT_STEP_EXIT);
+}
+
+/*
+ * Writes the native code of the given command, which is not the last command of its
+ * block (so it doesn't jump).
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit                      a pointer to the JIT program.
+ * const DecodingTemplate *template     the decoding template of the command.
+ * int *values                          the values of the source and destination operands.
+ */
+void emit_command(JitProgram *jit, const DecodingTemplate *template, int *values) {
+    int src = template->src_addressing;
+    int dest = template->dest_addressing;
+
+    switch (template->opcode) {
+        case MOV_OPCODE:
+            emit_load_operand(jit, src, values[0], HOST_RAX);
+            emit_store_operand(jit, dest, values[1], HOST_RAX);
+            break;
+        case LEA_OPCODE:
+            emit_move_immediate(jit, HOST_RAX, values[0]);
+            emit_store_operand(jit, dest, values[1], HOST_RAX);
+            break;
+        case CMP_OPCODE:
+            emit_load_operand(jit, src, values[0], HOST_RAX);
+            emit_load_operand(jit, dest, values[1], HOST_RCX);
+            /* the zero flag is set if the operands are equal */
+            emit_move_immediate(jit, HOST_RDX, 0);
+            emit_register_instruction(jit, 0, 0x39, HOST_RCX, HOST_RAX);
+            emit_register_instruction(jit, 0, 0x0F94, 0, HOST_RDX);
+            emit_memory_instruction(jit, 0, 0, 0x89, HOST_RDX, HOST_RBP, (long) offsetof(Machine, zero_flag));
+            /* the negative flag is the sign bit of their difference */
+            emit_register_instruction(jit, 0, 0x29, HOST_RCX, HOST_RAX);
+            emit_register_instruction(jit, 0, 0x81, 4, HOST_RAX);
+            emit_int32(jit, NEGATIVE_WORD_BIT);
+            emit_move_immediate(jit, HOST_RDX, 0);
+            emit_register_instruction(jit, 0, 0x0F95, 0, HOST_RDX);
+            emit_memory_instruction(jit, 0, 0, 0x89, HOST_RDX, HOST_RBP, (long) offsetof(Machine, negative_flag));
+            break;
+        case ADD_OPCODE:
+        case SUB_OPCODE:
+            emit_load_operand(jit, src, values[0], HOST_RAX);
+            emit_load_operand(jit, dest, values[1], HOST_RCX);
+            emit_register_instruction(jit, 0, ((template->opcode) == ADD_OPCODE) ? 0x01 : 0x29, HOST_RAX, HOST_RCX);
+            emit_register_instruction(jit, 0, 0x81, 4, HOST_RCX);
+            emit_int32(jit, MEMORY_WORD_MASK);
+            emit_store_operand(jit, dest, values[1], HOST_RCX);
+            break;
+        case NOT_OPCODE:
+        case INC_OPCODE:
+        case DEC_OPCODE:
+            emit_load_operand(jit, dest, values[1], HOST_RCX);
+            if ((template->opcode) == NOT_OPCODE) {
+                emit_register_instruction(jit, 0, 0xF7, 2, HOST_RCX);
+            } else {
+                /* add ecx, 1 or sub ecx, 1 */
+                emit_register_instruction(jit, 0, 0x81, ((template->opcode) == INC_OPCODE) ? 0 : 5, HOST_RCX);
+                emit_int32(jit, 1);
+            }
+            emit_register_instruction(jit, 0, 0x81, 4, HOST_RCX);
+            emit_int32(jit, MEMORY_WORD_MASK);
+            emit_store_operand(jit, dest, values[1], HOST_RCX);
+            break;
+        case CLR_OPCODE:
+            emit_move_immediate(jit, HOST_RCX, 0);
+            emit_store_operand(jit, dest, values[1], HOST_RCX);
+            break;
+    }
+}
+
+/*
+ * Writes the native code of the given jump, subroutine call or subroutine return,
+ * which is the last command of its block.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit                      a pointer to the JIT program.
+ * const DecodingTemplate *template     the decoding template of the command.
+ * int *values                          the values of the source and destination operands.
+ * int address                          the address of the command.
+ */
+void emit_control_command(JitProgram *jit, const DecodingTemplate *template, int *values, int address) {
+    int next_address = address + (template->memory_words);
+    unsigned char *not_taken = NULL; /* the relative target of the jump over the taken branch of 'bne' */
+    unsigned char *valid_depth;
+
+    if ((template->opcode) == BNE_OPCODE) {
+        /* cmp dword [machine + zero_flag], 0; jne not_taken */
+        emit_memory_instruction(jit, 0, 0, 0x83, 7, HOST_RBP, (long) offsetof(Machine, zero_flag));
+        emit_byte(jit, 0);
+        not_taken = emit_jump(jit, 0x0F85, NULL);
+    } else if ((template->opcode) == JSR_OPCODE) {
+        /* mov ecx, [machine + stack_depth]; cmp ecx, RETURN_STACK_SIZE; jne valid_depth */
+        emit_memory_instruction(jit, 0, 0, 0x8B, HOST_RCX, HOST_RBP, (long) offsetof(Machine, stack_depth));
+        emit_register_instruction(jit, 0, 0x81, 7, HOST_RCX);
+        emit_int32(jit, RETURN_STACK_SIZE);
+        valid_depth = emit_jump(jit, 0x0F85, NULL);
+        emit_refund_exit(jit, address);
+        patch_jump(valid_depth, (jit->code) + (jit->code_length));
+        /* mov dword [machine + return_stack + 4 * rcx], next_address */
+        emit_byte(jit, 0xC7);
+        emit_byte(jit, 0x84);
+        emit_byte(jit, 0x8D);
+        emit_int32(jit, (long) offsetof(Machine, return_stack));
+        emit_int32(jit, next_address);
+        /* add ecx, 1; mov [machine + stack_depth], ecx */
+        emit_register_instruction(jit, 0, 0x81, 0, HOST_RCX);
+        emit_int32(jit, 1);
+        emit_memory_instruction(jit, 0, 0, 0x89, HOST_RCX, HOST_RBP, (long) offsetof(Machine, stack_depth));
+    } else if ((template->opcode) == RTS_OPCODE) {
+        /* mov ecx, [machine + stack_depth]; test ecx, ecx; jnz valid_depth */
+        emit_memory_instruction(jit, 0, 0, 0x8B, HOST_RCX, HOST_RBP, (long) offsetof(Machine, stack_depth));
+        emit_register_instruction(jit, 0, 0x85, HOST_RCX, HOST_RCX);
+        valid_depth = emit_jump(jit, 0x0F85, NULL);
+        emit_refund_exit(jit, address);
+        patch_jump(valid_depth, (jit->code) + (jit->code_length));
+        /* sub ecx, 1; mov [machine + stack_depth], ecx; mov eax, [machine + return_stack + 4 * rcx] */
+        emit_register_instruction(jit, 0, 0x81, 5, HOST_RCX);
+        emit_int32(jit, 1);
+        emit_memory_instruction(jit, 0, 0, 0x89, HOST_RCX, HOST_RBP, (long) offsetof(Machine, stack_depth));
+        emit_byte(jit, 0x8B);
+        emit_byte(jit, 0x84);
+        emit_byte(jit, 0x8D);
+        emit_int32(jit, (long) offsetof(Machine, return_stack));
+        emit_indirect_exit(jit);
+        return;
+    }
+    /* the target of a jump to a label is known, and the target of a jump to a register is computed */
+    if ((template->dest_addressing) == LABEL_ADDRESSING_CODE) {
+        emit_known_exit(jit, values[1]);
+    } else {
+        emit_load_operand(jit, template->dest_addressing, values[1], HOST_RAX);
+        emit_indirect_exit(jit);
+    }
+    if (not_taken != NULL) {
+        patch_jump(not_taken, (jit->code) + (jit->code_length));
+        emit_known_exit(jit, next_address);
+    }
+}
+
+/*
+ * Makes the buffer of the given JIT program executable and read-only, or writable
+ * and not executable, so the buffer is never writable and executable at the same
+ * time. The protection is changed only if it's different.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit          a pointer to the JIT program.
+ * int executable_flag      indicates if the buffer is made executable (1) or writable (0).
+ */
+void protect_jit_code(JitProgram *jit, int executable_flag) {
+#ifdef JIT_SUPPORTED
+    if ((jit->executable) == executable_flag) {
+        return;
+    }
+    if (mprotect(jit->code, jit->code_capacity, executable_flag ? (PROT_READ | PROT_EXEC) : (PROT_READ | PROT_WRITE))
+        != 0) {
+        printf("Could not change the protection of the JIT code!\n");
+        exit(0);
+    }
+    jit->executable = executable_flag;
+#endif
+}
+
+/*
+ * Returns a pointer to a new JitProgram for the given loaded program, with an empty
+ * executable buffer. The blocks of the program are translated when they are executed
+ * for the first time. If the JIT is not supported, or the buffer can't be allocated,
+ * the function returns NULL. The user should free it with 'free_jit_program'.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the loaded program.
+ */
+JitProgram *create_jit_program(MachineImage *image) {
+#ifdef JIT_SUPPORTED
+    JitProgram *jit = calloc(1, sizeof(JitProgram));
+    void *code;
+
+    if (jit == NULL || (jit->blocks = calloc(MACHINE_MEMORY_SIZE + 1, sizeof(unsigned char *))) == NULL ||
+        (jit->untranslatable = calloc(MACHINE_MEMORY_SIZE + 1, sizeof(unsigned char))) == NULL ||
+        (jit->invalidations = calloc(MACHINE_MEMORY_SIZE + 1, sizeof(int))) == NULL ||
+        (jit->word_links = calloc(MACHINE_MEMORY_SIZE, sizeof(int))) == NULL) {
+        printf("Could not allocate memory for the JIT program!\n");
+        exit(0);
+    }
+    /* the buffer is writable until the code in it is executed */
+    code = mmap(NULL, JIT_CODE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code == MAP_FAILED) {
+        free(jit->blocks);
+        free(jit->untranslatable);
+        free(jit->invalidations);
+        free(jit->word_links);
+        free(jit);
+        return NULL;
+    }
+    jit->code = code;
+    jit->code_capacity = JIT_CODE_SIZE;
+    jit->cached_words = create_word_bitmap();
+    jit->code_start = image->load_address;
+    jit->code_end = (image->load_address) + (image->code_words);
+    flush_jit_program(jit);
+    return jit;
+#else
+    return NULL;
+#endif
+}
+
+/*
+ * Frees the executable buffer and the tables of the given JIT program, and in the
+ * end frees the program itself.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit  a pointer to the JIT program.
+ */
+void free_jit_program(JitProgram *jit) {
+#ifdef JIT_SUPPORTED
+    munmap(jit->code, jit->code_capacity);
+#endif
+    free(jit->blocks);
+    free(jit->untranslatable);
+    free(jit->invalidations);
+    free(jit->exits);
+    free(jit->translated_blocks);
+    free(jit->cached_words);
+    free(jit->word_links);
+    free(jit->links);
+    free(jit);
+}
+
+/*
+ * Empties the executable buffer of the given JIT program, and writes the code that
+ * enters the translated blocks and the code that leaves them in its beginning.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit  a pointer to the JIT program.
+ */
+void flush_jit_program(JitProgram *jit) {
+    const int saved_registers[] = {HOST_RBX, HOST_RBP, 12, 13, 14, 15};
+    int index;
+
+    protect_jit_code(jit, 0);
+    memset(jit->blocks, 0, (MACHINE_MEMORY_SIZE + 1) * sizeof(unsigned char *));
+    memset(jit->untranslatable, 0, (MACHINE_MEMORY_SIZE + 1) * sizeof(unsigned char));
+    memset(jit->cached_words, 0, WORD_BITMAP_SIZE);
+    for (index = 0; index < MACHINE_MEMORY_SIZE; index++) {
+        (jit->word_links)[index] = NO_JIT_LINK;
+    }
+    jit->no_of_links = 0;
+    jit->free_link = NO_JIT_LINK;
+    jit->no_of_exits = 0;
+    jit->no_of_blocks = 0;
+    jit->code_length = 0;
+
+    /* the entry saves the registers that the caller expects to keep, and loads the state of the machine */
+    for (index = 0; index < 6; index++) {
+        if (saved_registers[index] >= 8) {
+            emit_byte(jit, 0x41);
+        }
+        emit_byte(jit, 0x50 + (saved_registers[index] & 7));
+    }
+    /* mov rbp, rsi (the machine) */
+    emit_register_instruction(jit, 1, 0x89, HOST_RSI, HOST_RBP);
+    /* mov rbx, [machine + memory]; mov rsi, [jit + remaining] */
+    emit_memory_instruction(jit, 0, 1, 0x8B, HOST_RBX, HOST_RBP, (long) offsetof(Machine, memory));
+    emit_memory_instruction(jit, 0, 1, 0x8B, HOST_RSI, HOST_RDI, (long) offsetof(JitProgram, remaining));
+    for (index = 0; index < NO_OF_REGISTERS; index++) {
+        emit_memory_instruction(jit, 0, 0, 0x0FB7, HOST_R8 + index, HOST_RBP,
+                                (long) (offsetof(Machine, registers) + index * sizeof(unsigned short)));
+    }
+    /* jmp rdx (the block) */
+    emit_byte(jit, 0xFF);
+    emit_byte(jit, 0xE2);
+
+    /* the epilogue stores the state of the machine, and returns the address in eax */
+    jit->epilogue = (jit->code) + (jit->code_length);
+    emit_memory_instruction(jit, 0, 0, 0x89, HOST_RDX, HOST_RDI, (long) offsetof(JitProgram, exit_index));
+    emit_memory_instruction(jit, 0, 1, 0x89, HOST_RSI, HOST_RDI, (long) offsetof(JitProgram, remaining));
+    for (index = 0; index < NO_OF_REGISTERS; index++) {
+        emit_memory_instruction(jit, 1, 0, 0x89, HOST_R8 + index, HOST_RBP,
+                                (long) (offsetof(Machine, registers) + index * sizeof(unsigned short)));
+    }
+    for (index = 5; index >= 0; index--) {
+        if (saved_registers[index] >= 8) {
+            emit_byte(jit, 0x41);
+        }
+        emit_byte(jit, 0x58 + (saved_registers[index] & 7));
+    }
+    emit_byte(jit, 0xC3);
+    jit->blocks_start = jit->code_length;
+    jit->no_of_flushes++;
+}
+
+/*
+ * Returns 1 if the command in the given address can be translated, and stores its
+ * decoding template and the value of each of its operands (a register number, an
+ * immediate value or the address of a label). Commands that print, read, stop the
+ * program, write to its code, or use an external label that was not linked, are
+ * not translated.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit                      a pointer to the JIT program.
+ * Machine *machine                     a pointer to the machine.
+ * int address                          the address of the first word of the command.
+ * const DecodingTemplate **template    a pointer to store the decoding template in.
+ * int *values                          an array to store the values of the source and destination operands in.
+ */
+int decode_jit_command(JitProgram *jit, Machine *machine, int address, const DecodingTemplate **template,
+                       int *values) {
+    int addressing[2];
+    int shifts[2];
+    int word_addresses[2];
+    int written_address;
+    int index;
+    unsigned int word;
+
+    if (address < (jit->code_start) || address >= (jit->code_end)) {
+        return 0;
+    }
+    *template = get_decoding_template((machine->memory)[address]);
+    if (((*template)->opcode) == NO_OPCODE || address + ((*template)->memory_words) > (jit->code_end) ||
+        ((*template)->opcode) == RED_OPCODE || ((*template)->opcode) == PRN_OPCODE ||
+        ((*template)->opcode) == STOP_OPCODE) {
+        return 0;
+    }
+    written_address = get_written_address(machine->memory, address);
+    if (written_address >= (jit->code_start) && written_address < (jit->code_end)) {
+        return 0;
+    }
+    addressing[0] = (*template)->src_addressing;
+    addressing[1] = (*template)->dest_addressing;
+    shifts[0] = ENCODING_SRC_REGISTER_SHIFT;
+    shifts[1] = ENCODING_DEST_REGISTER_SHIFT;
+    word_addresses[0] = address + 1;
+    /* two registers are stored in the same memory word */
+    word_addresses[1] = (addressing[0] == 0 || (addressing[0] == REGISTER_ADDRESSING_CODE &&
+                                                addressing[1] == REGISTER_ADDRESSING_CODE)) ? address + 1 : address + 2;
+    for (index = 0; index < 2; index++) {
+        values[index] = 0;
+        if (addressing[index] == 0) {
+            continue;
+        }
+        word = (machine->memory)[word_addresses[index]];
+        if (addressing[index] == REGISTER_ADDRESSING_CODE) {
+            values[index] = decode_bit_field(word, ENCODING_REGISTER_LENGTH, shifts[index]) % NO_OF_REGISTERS;
+        } else if (addressing[index] == IMMEDIATE_ADDRESSING_CODE) {
+            values[index] = (int) read_operand(machine, addressing[index], word_addresses[index], shifts[index],
+                                               address);
+        } else if (decode_bit_field(word, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT) == ARE_EXTERNAL_CODE) {
+            return 0;
+        } else {
+            values[index] = decode_bit_field(word, ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT);
+        }
+    }
+    return 1;
+}
+
+/*
+ * Adds the given translated block to the list of the blocks of the given word. A link
+ * that was removed from its list is used again before the array of the links grows.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit      a pointer to the JIT program.
+ * int block_index      the index of the block in the translated blocks.
+ * int address          the address of a word that the block was translated from.
+ */
+void link_jit_block(JitProgram *jit, int block_index, int address) {
+    int link = jit->free_link;
+
+    if (link != NO_JIT_LINK) {
+        jit->free_link = (jit->links)[link].next;
+    } else {
+        if ((jit->no_of_links) == (jit->links_capacity)) {
+            jit->links_capacity = (jit->links_capacity) ? 2 * (jit->links_capacity) : JIT_INITIAL_NO_OF_LINKS;
+            jit->links = realloc(jit->links, (jit->links_capacity) * sizeof(JitBlockLink));
+            if (jit->links == NULL) {
+                printf("Could not allocate memory for the JIT program!\n");
+                exit(0);
+            }
+        }
+        link = (jit->no_of_links)++;
+    }
+    (jit->links)[link].block = block_index;
+    (jit->links)[link].next = (jit->word_links)[address];
+    (jit->word_links)[address] = link;
+}
+
+/*
+ * Translates the basic block that starts in the given address, and returns a pointer
+ * to its native code. The block ends with a jump, a subroutine call or return, or
+ * before a command that can't be translated. If the block was already translated,
+ * its code is returned, and if its first command can't be translated, or the block
+ * was invalidated too many times, the function returns NULL.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit      a pointer to the JIT program.
+ * Machine *machine     a pointer to the machine.
+ * int address          the address of the first command of the block.
+ */
+unsigned char *get_jit_block(JitProgram *jit, Machine *machine, int address) {
+    const DecodingTemplate *templates[JIT_MAX_BLOCK_COMMANDS];
+    int values[JIT_MAX_BLOCK_COMMANDS][2];
+    int addresses[JIT_MAX_BLOCK_COMMANDS];
+    unsigned char *block;
+    unsigned char *enough_commands;
+    JitBlock *record;
+    int no_of_commands = 0;
+    int command_address = address;
+    int opcode;
+    int index;
+
+    if (address < 0 || address > MACHINE_MEMORY_SIZE || (jit->untranslatable)[address] ||
+        (jit->invalidations)[address] >= JIT_MAX_INVALIDATIONS) {
+        return NULL;
+    }
+    if ((jit->blocks)[address] != NULL) {
+        return (jit->blocks)[address];
+    }
+    /* find the commands of the block */
+    while (no_of_commands < JIT_MAX_BLOCK_COMMANDS &&
+           decode_jit_command(jit, machine, command_address, &templates[no_of_commands], values[no_of_commands])) {
+        addresses[no_of_commands] = command_address;
+        opcode = templates[no_of_commands]->opcode;
+        command_address += templates[no_of_commands++]->memory_words;
+        if (opcode == JMP_OPCODE || opcode == BNE_OPCODE || opcode == JSR_OPCODE || opcode == RTS_OPCODE) {
+            break;
+        }
+    }
+    if (no_of_commands == 0) {
+        (jit->untranslatable)[address] = 1;
+        return NULL;
+    }
+    protect_jit_code(jit, 0);
+    if ((jit->code_length) + (no_of_commands + 1) * JIT_MAX_COMMAND_CODE_SIZE > (jit->code_capacity)) {
+        flush_jit_program(jit);
+    }
+    block = (jit->code) + (jit->code_length);
+    (jit->blocks)[address] = block;
+
+    /* the block is executed only if all its commands may be executed: cmp rsi, n; jae enough_commands */
+    emit_register_instruction(jit, 1, 0x81, 7, HOST_RSI);
+    emit_int32(jit, no_of_commands);
+    enough_commands = emit_jump(jit, 0x0F83, NULL);
+    /* the block and its words are recorded, so it's invalidated when one of them is changed */
+    if ((jit->no_of_blocks) == (jit->blocks_capacity)) {
+        jit->blocks_capacity = (jit->blocks_capacity) ? 2 * (jit->blocks_capacity) : JIT_INITIAL_NO_OF_BLOCKS;
+        jit->translated_blocks = realloc(jit->translated_blocks, (jit->blocks_capacity) * sizeof(JitBlock));
+        if (jit->translated_blocks == NULL) {
+            printf("Could not allocate memory for the JIT program!\n");
+            exit(0);
+        }
+    }
+    record = &(jit->translated_blocks)[(jit->no_of_blocks)++];
+    record->code = block;
+    record->leave = (jit->code) + (jit->code_length);
+    record->start = address;
+    record->end = command_address;
+    for (index = address; index < command_address; index++) {
+        mark_word(jit->cached_words, index);
+        link_jit_block(jit, (jit->no_of_blocks) - 1, index);
+    }
+    emit_leave(jit, address, JIT_BUDGET_EXIT);
+    patch_jump(enough_commands, (jit->code) + (jit->code_length));
+    /* sub rsi, n */
+    emit_register_instruction(jit, 1, 0x81, 5, HOST_RSI);
+    emit_int32(jit, no_of_commands);
+
+    for (index = 0; index < no_of_commands; index++) {
+        opcode = templates[index]->opcode;
+        if (opcode == JMP_OPCODE || opcode == BNE_OPCODE || opcode == JSR_OPCODE || opcode == RTS_OPCODE) {
+            emit_control_command(jit, templates[index], values[index], addresses[index]);
+            return block;
+        }
+        emit_command(jit, templates[index], values[index]);
+    }
+    /* the block ends before a command that is not translated */
+    emit_known_exit(jit, command_address);
+    return block;
+}
+
+/*
+ * Invalidates each translated block that was translated from the given address, after
+ * the word in the address was changed. Only the blocks in the list of the word are
+ * visited, and the list is emptied. The block is removed from the blocks of the
+ * addresses, and its first instruction is patched to leave the translated code, so
+ * the blocks that jump to it directly find its new translation. A block that is
+ * invalidated JIT_MAX_INVALIDATIONS times is not translated again, and its commands
+ * are interpreted.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit      a pointer to the JIT program.
+ * int address          the address of the word that was changed.
+ */
+void invalidate_jit_word(JitProgram *jit, int address) {
+    JitBlock *record;
+    int link = (jit->word_links)[address];
+    int next_link;
+    int index;
+
+    (jit->word_links)[address] = NO_JIT_LINK;
+    for (; link != NO_JIT_LINK; link = next_link) {
+        record = &(jit->translated_blocks)[(jit->links)[link].block];
+        next_link = (jit->links)[link].next;
+        (jit->links)[link].next = jit->free_link;
+        jit->free_link = link;
+        /* a block that was invalidated through another word is still in the lists of its other words */
+        if ((record->code) == NULL) {
+            continue;
+        }
+        protect_jit_code(jit, 0);
+        /* the block jumps to the exit that its budget check leaves through, which reports an indirect exit */
+        patch_int32((record->leave) + 6, JIT_INDIRECT_EXIT);
+        (record->code)[0] = 0xE9;
+        patch_jump((record->code) + 1, record->leave);
+        (jit->blocks)[record->start] = NULL;
+        (jit->invalidations)[record->start]++;
+        record->code = NULL;
+    }
+    /* a command that could not be translated may be translatable now */
+    for (index = address - MAX_NO_OF_WORDS_IN_COMMAND + 1; index <= address; index++) {
+        if (index >= 0) {
+            (jit->untranslatable)[index] = 0;
+        }
+    }
+}
+
+/*
+ * Executes the given program in the given machine with the translated blocks, like
+ * 'run_machine'. A command that is not translated is executed by 'step_machine', and
+ * if it changes the value of a word that a block was translated from, the block is
+ * invalidated and translated again when it's executed. Returns the state of the machine.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine                 a pointer to the machine.
+ * JitProgram *jit                  a pointer to the JIT program of the machine.
+ * unsigned long max_instructions   the maximum number of commands to execute, or 0 for no limit.
+ */
+int run_jit(Machine *machine, JitProgram *jit, unsigned long max_instructions) {
+    JitEntry enter;
+    unsigned char *entry_code = jit->code;
+    unsigned char *block;
+    unsigned char *site;
+    unsigned long initial_executed = machine->executed_instructions;
+    unsigned long budget; /* the number of commands that may be executed */
+    unsigned long no_of_flushes;
+    unsigned long executed;
+    int step_flag = 0; /* indicates if the next command is executed by 'step_machine' */
+    int address;
+    int written_address;
+    int written_word = 0; /* the word in the written address before the command was executed */
+    int target;
+
+    if ((machine->state) != MACHINE_RUNNING) {
+        return machine->state;
+    }
+    /* the buffer is converted to a function without converting an object pointer to a function pointer */
+    memcpy(&enter, &entry_code, sizeof(enter));
+    if (max_instructions == 0) {
+        budget = ULONG_MAX;
+    } else {
+        budget = (max_instructions > initial_executed) ? max_instructions - initial_executed : 0;
+    }
+    jit->remaining = budget;
+
+    while ((machine->state) == MACHINE_RUNNING && (jit->remaining) > 0) {
+        address = machine->program_counter;
+        block = step_flag ? NULL : get_jit_block(jit, machine, address);
+        step_flag = 0;
+        if (block != NULL) {
+            protect_jit_code(jit, 1);
+            machine->program_counter = (int) enter(jit, machine, block);
+            if ((jit->exit_index) == JIT_BUDGET_EXIT || (jit->exit_index) == JIT_STEP_EXIT) {
+                step_flag = 1;
+            } else if ((jit->exit_index) >= 0) {
+                /* link the exit to its target, unless the buffer was emptied while the target was translated */
+                site = (jit->exits)[jit->exit_index].site;
+                target = (jit->exits)[jit->exit_index].target;
+                no_of_flushes = jit->no_of_flushes;
+                block = get_jit_block(jit, machine, target);
+                if (block != NULL && no_of_flushes == (jit->no_of_flushes)) {
+                    protect_jit_code(jit, 0);
+                    site[0] = 0xE9;
+                    patch_jump(site + 1, block);
+                }
+            }
+            continue;
+        }
+        /* a command that is not translated may change the words of translated blocks */
+        written_address = (address >= 0 && address < MACHINE_MEMORY_SIZE) ?
+                          get_written_address(machine->memory, address) : -1;
+        if (written_address >= 0) {
+            written_word = (machine->memory)[written_address];
+        }
+        executed = machine->executed_instructions;
+        step_machine(machine);
+        jit->remaining -= (machine->executed_instructions) - executed;
+        /* a store of the same value doesn't change the commands of the blocks */
+        if (written_address >= 0 && is_word_marked(jit->cached_words, written_address) &&
+            (machine->memory)[written_address] != written_word) {
+            invalidate_jit_word(jit, written_address);
+        }
+    }
+    machine->executed_instructions = initial_executed + (budget - (jit->remaining));
+    return machine->state;
+}
+
+/*
+ * Returns 1 if the given machines have the same state: the same memory, registers,
+ * program counter, flags, return stack and number of executed commands. Otherwise,
+ * the function prints the first difference and returns 0.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the first machine.
+ * Machine *reference   a pointer to the second machine.
+ */
+int compare_machines(Machine *machine, Machine *reference) {
+    int index;
+
+    if ((machine->executed_instructions) != (reference->executed_instructions) ||
+        (machine->program_counter) != (reference->program_counter) || (machine->state) != (reference->state)) {
+        printf("Lockstep: the program counters differ after %lu instructions (%d, %d)\n",
+               reference->executed_instructions, machine->program_counter, reference->program_counter);
+        return 0;
+    }
+    for (index = 0; index < NO_OF_REGISTERS; index++) {
+        if ((machine->registers)[index] != (reference->registers)[index]) {
+            printf("Lockstep: register %d differs after %lu instructions (%d, %d)\n", index,
+                   reference->executed_instructions, (machine->registers)[index], (reference->registers)[index]);
+            return 0;
+        }
+    }
+    if ((machine->zero_flag) != (reference->zero_flag) || (machine->negative_flag) != (reference->negative_flag) ||
+        (machine->stack_depth) != (reference->stack_depth) ||
+        memcmp(machine->return_stack, reference->return_stack, (machine->stack_depth) * sizeof(int)) != 0) {
+        printf("Lockstep: the flags or the return stack differ after %lu instructions\n",
+               reference->executed_instructions);
+        return 0;
+    }
+    for (index = 0; index < MACHINE_MEMORY_SIZE; index++) {
+        if ((machine->memory)[index] != (reference->memory)[index]) {
+            printf("Lockstep: the memory word in address %d differs after %lu instructions\n", index,
+                   reference->executed_instructions);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Returns a new temporary file that contains the given characters, from its beginning.
+ *
+ * Parameters:
+ * -----------
+ * char *characters     the characters.
+ * size_t length        the number of characters.
+ */
+FILE *create_input_file(char *characters, size_t length) {
+    FILE *file = tmpfile();
+
+    if (file == NULL) {
+        printf("Could not create a temporary file!\n");
+        exit(0);
+    }
+    if (length > 0) {
+        fwrite(characters, sizeof(char), length, file);
+    }
+    rewind(file);
+    return file;
+}
+
+/*
+ * Returns 1 if one of the code words of the given program is the first word of a
+ * 'red' command, and 0 otherwise, so the input is read only for a program that
+ * reads it.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the loaded program.
+ */
+int reads_input(MachineImage *image) {
+    int address;
+
+    for (address = image->load_address; address < (image->load_address) + (image->code_words); address++) {
+        if ((get_decoding_template((image->memory)[address])->opcode) == RED_OPCODE) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Executes the given program with the JIT and with 'step_machine' in lockstep, in two
+ * separate machines, and compares their states after each chunk of commands. The sizes
+ * of the chunks vary, so the blocks are interrupted in different commands. The input
+ * is read only if the program has a 'red' command, and otherwise both machines read
+ * an empty input. Returns 1 if the states were always equal, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *program_path               the path to the program, without an extension.
+ * unsigned long max_instructions   the maximum number of commands to execute, or 0 for no limit.
+ */
+int run_lockstep(char *program_path, unsigned long max_instructions) {
+    MachineImage *image = load_machine_image(program_path);
+    MachineImage *reference_image = load_machine_image(program_path);
+    FILE *files[4]; /* the input and the output of each machine */
+    Machine *machine;
+    Machine *reference;
+    JitProgram *jit;
+    char *input = NULL;
+    size_t length = 0;
+    unsigned long chunk = 1;
+    unsigned long limit;
+    int character;
+    int equal_flag = 1;
+    int index;
+
+    if (image == NULL || reference_image == NULL || (jit = create_jit_program(image)) == NULL) {
+        printf("%s: the program can't be executed with the JIT\n", program_path);
+        return 0;
+    }
+    /* both machines read the same input, and a program that doesn't read doesn't wait for it */
+    if (reads_input(image)) {
+        while ((character = getchar()) != EOF) {
+            input = realloc(input, length + 1);
+            if (input == NULL) {
+                printf("Could not allocate memory for the input!\n");
+                exit(0);
+            }
+            input[length++] = (char) character;
+        }
+    }
+    files[0] = create_input_file(input, length);
+    files[1] = create_input_file(input, length);
+    files[2] = create_input_file(NULL, 0);
+    files[3] = create_input_file(NULL, 0);
+    machine = create_machine(image, files[0], files[2]);
+    reference = create_machine(reference_image, files[1], files[3]);
+
+    while ((reference->state) == MACHINE_RUNNING && equal_flag) {
+        limit = (reference->executed_instructions) + chunk;
+        if (max_instructions != 0 && limit > max_instructions) {
+            limit = max_instructions;
+        }
+        run_jit(machine, jit, limit);
+        run_machine(reference, limit);
+        equal_flag = compare_machines(machine, reference);
+        if (limit == max_instructions) {
+            break;
+        }
+        chunk = (chunk * 7 + 3) % LOCKSTEP_MAX_CHUNK + 1;
+    }
+    /* the machines must print the same characters */
+    rewind(files[2]);
+    rewind(files[3]);
+    while (equal_flag && (character = fgetc(files[2])) != EOF) {
+        if (character != fgetc(files[3])) {
+            equal_flag = 0;
+        }
+        putchar(character);
+    }
+    if (equal_flag && fgetc(files[3]) != EOF) {
+        equal_flag = 0;
+    }
+    printf("%s: the JIT and the interpreter %s after %lu instructions\n", program_path,
+           equal_flag ? "agree" : "disagree", reference->executed_instructions);
+
+    for (index = 0; index < 4; index++) {
+        fclose(files[index]);
+    }
+    free(input);
+    free_machine(machine);
+    free_machine(reference);
+    free_jit_program(jit);
+    free_machine_image(image);
+    free_machine_image(reference_image);
+    return equal_flag;
+}
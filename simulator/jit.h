@@ -0,0 +1,183 @@
+#ifndef ASSEMBLER_SIMULATOR_JIT_H
+#define ASSEMBLER_SIMULATOR_JIT_H
+
+#include "../types.h"
+
+/* the blocks are translated to x86-64 code, which is executed with the System V calling convention */
+#if defined(__x86_64__) && defined(__linux__)
+#define JIT_SUPPORTED
+#endif
+
+#define JIT_OPTION "-j" /* the command line option that executes the programs with the JIT */
+#define LOCKSTEP_OPTION "-c" /* the command line option that compares the JIT with the interpreter */
+
+#define JIT_CODE_SIZE (1 << 20) /* the number of bytes in the executable buffer */
+#define JIT_MAX_BLOCK_COMMANDS 64 /* the maximum number of commands in a translated block */
+#define JIT_MAX_COMMAND_CODE_SIZE 96 /* the maximum number of bytes that a single command is translated to */
+#define JIT_INITIAL_NO_OF_EXITS 64 /* the number of exits that can be stored after the first growth */
+#define JIT_INITIAL_NO_OF_BLOCKS 64 /* the number of blocks that can be stored after the first growth */
+#define JIT_INITIAL_NO_OF_LINKS 256 /* the number of links of blocks to words that can be stored after the first growth */
+#define NO_JIT_LINK (-1) /* the end of a list of the blocks of a word */
+#define JIT_BUDGET_EXIT (-2) /* the exit of a block that can't be executed with the remaining commands */
+#define JIT_STEP_EXIT (-3) /* the exit before a command that fails, so the machine executes it and finds its error */
+#define JIT_INDIRECT_EXIT (-1) /* the exit of a block to an address that was computed by the block */
+#define JIT_MAX_INVALIDATIONS 16 /* the number of times a block is translated again before it's only interpreted */
+#define LOCKSTEP_MAX_CHUNK 997 /* the maximum number of commands between two comparisons in the lockstep test */
+
+/*
+ * Makes the buffer of the given JIT program executable and read-only, or writable
+ * and not executable, so the buffer is never writable and executable at the same
+ * time. The protection is changed only if it's different.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit          a pointer to the JIT program.
+ * int executable_flag      indicates if the buffer is made executable (1) or writable (0).
+ */
+void protect_jit_code(JitProgram *jit, int executable_flag);
+
+/*
+ * Returns a pointer to a new JitProgram for the given loaded program, with an empty
+ * executable buffer. The blocks of the program are translated when they are executed
+ * for the first time. If the JIT is not supported, or the buffer can't be allocated,
+ * the function returns NULL. The user should free it with 'free_jit_program'.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the loaded program.
+ */
+JitProgram *create_jit_program(MachineImage *image);
+
+/*
+ * Frees the executable buffer and the tables of the given JIT program, and in the
+ * end frees the program itself.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit  a pointer to the JIT program.
+ */
+void free_jit_program(JitProgram *jit);
+
+/*
+ * Empties the executable buffer of the given JIT program, and writes the code that
+ * enters the translated blocks and the code that leaves them in its beginning.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit  a pointer to the JIT program.
+ */
+void flush_jit_program(JitProgram *jit);
+
+/*
+ * Returns 1 if the command in the given address can be translated, and stores its
+ * decoding template and the value of each of its operands (a register number, an
+ * immediate value or the address of a label). Commands that print, read, stop the
+ * program, write to its code, or use an external label that was not linked, are
+ * not translated.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit                      a pointer to the JIT program.
+ * Machine *machine                     a pointer to the machine.
+ * int address                          the address of the first word of the command.
+ * const DecodingTemplate **template    a pointer to store the decoding template in.
+ * int *values                          an array to store the values of the source and destination operands in.
+ */
+int decode_jit_command(JitProgram *jit, Machine *machine, int address, const DecodingTemplate **template,
+                       int *values);
+
+/*
+ * Adds the given translated block to the list of the blocks of the given word. A link
+ * that was removed from its list is used again before the array of the links grows.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit      a pointer to the JIT program.
+ * int block_index      the index of the block in the translated blocks.
+ * int address          the address of a word that the block was translated from.
+ */
+void link_jit_block(JitProgram *jit, int block_index, int address);
+
+/*
+ * Translates the basic block that starts in the given address, and returns a pointer
+ * to its native code. The block ends with a jump, a subroutine call or return, or
+ * before a command that can't be translated. If the block was already translated,
+ * its code is returned, and if its first command can't be translated, or the block
+ * was invalidated too many times, the function returns NULL.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit      a pointer to the JIT program.
+ * Machine *machine     a pointer to the machine.
+ * int address          the address of the first command of the block.
+ */
+unsigned char *get_jit_block(JitProgram *jit, Machine *machine, int address);
+
+/*
+ * Invalidates each translated block that was translated from the given address, after
+ * the word in the address was changed. Only the blocks in the list of the word are
+ * visited, and the list is emptied. The block is removed from the blocks of the
+ * addresses, and its first instruction is patched to leave the translated code, so
+ * the blocks that jump to it directly find its new translation. A block that is
+ * invalidated JIT_MAX_INVALIDATIONS times is not translated again, and its commands
+ * are interpreted.
+ *
+ * Parameters:
+ * -----------
+ * JitProgram *jit      a pointer to the JIT program.
+ * int address          the address of the word that was changed.
+ */
+void invalidate_jit_word(JitProgram *jit, int address);
+
+/*
+ * Executes the given program in the given machine with the translated blocks, like
+ * 'run_machine'. A command that is not translated is executed by 'step_machine', and
+ * if it changes the value of a word that a block was translated from, the block is
+ * invalidated and translated again when it's executed. Returns the state of the machine.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine                 a pointer to the machine.
+ * JitProgram *jit                  a pointer to the JIT program of the machine.
+ * unsigned long max_instructions   the maximum number of commands to execute, or 0 for no limit.
+ */
+int run_jit(Machine *machine, JitProgram *jit, unsigned long max_instructions);
+
+/*
+ * Returns 1 if the given machines have the same state: the same memory, registers,
+ * program counter, flags, return stack and number of executed commands. Otherwise,
+ * the function prints the first difference and returns 0.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the first machine.
+ * Machine *reference   a pointer to the second machine.
+ */
+int compare_machines(Machine *machine, Machine *reference);
+
+/*
+ * Returns 1 if one of the code words of the given program is the first word of a
+ * 'red' command, and 0 otherwise, so the input is read only for a program that
+ * reads it.
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the loaded program.
+ */
+int reads_input(MachineImage *image);
+
+/*
+ * Executes the given program with the JIT and with 'step_machine' in lockstep, in two
+ * separate machines, and compares their states after each chunk of commands. The sizes
+ * of the chunks vary, so the blocks are interrupted in different commands. The input
+ * is read only if the program has a 'red' command, and otherwise both machines read
+ * an empty input. Returns 1 if the states were always equal, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *program_path               the path to the program, without an extension.
+ * unsigned long max_instructions   the maximum number of commands to execute, or 0 for no limit.
+ */
+int run_lockstep(char *program_path, unsigned long max_instructions);
+
+#endif
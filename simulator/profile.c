@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "profile.h"
+#include "simulator.h"
+#include "threaded.h"
+#include "../segments.h"
+#include "../disassembler/disassembler.h"
+
+/*
+ * Executes the given machine like 'run_machine', and counts in the given profile each
+ * pair and each triple of adjacent commands that were executed one after the other.
+ * Returns the state of the machine.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine                 a pointer to the machine.
+ * Profile *profile                 a pointer to the profile.
+ * unsigned long max_instructions   the maximum number of commands to execute, or 0 for no limit.
+ */
+int run_profiled(Machine *machine, Profile *profile, unsigned long max_instructions) {
+    const DecodingTemplate *template;
+    int previous_opcodes[MAX_FUSED_COMMANDS - 1] = {NO_OPCODE, NO_OPCODE}; /* the last command, and the one before it */
+    int next_address = -1; /* the address after the last command */
+    int address;
+
+    while ((machine->state) == MACHINE_RUNNING &&
+           (max_instructions == 0 || (machine->executed_instructions) < max_instructions)) {
+        address = machine->program_counter;
+        template = (address >= 0 && address < MACHINE_MEMORY_SIZE) ?
+                   get_decoding_template((machine->memory)[address]) : NULL;
+        if (template == NULL || (template->opcode) == NO_OPCODE || address != next_address) {
+            /* a jump, or a word that is not a command, starts a new sequence */
+            previous_opcodes[0] = NO_OPCODE;
+            previous_opcodes[1] = NO_OPCODE;
+        }
+        if (template != NULL && (template->opcode) != NO_OPCODE) {
+            if (previous_opcodes[0] != NO_OPCODE) {
+                (profile->pairs)[previous_opcodes[0]][template->opcode]++;
+                if (previous_opcodes[1] != NO_OPCODE) {
+                    (profile->triples)[previous_opcodes[1]][previous_opcodes[0]][template->opcode]++;
+                }
+            }
+            previous_opcodes[1] = previous_opcodes[0];
+            previous_opcodes[0] = template->opcode;
+            next_address = address + (template->memory_words);
+        }
+        step_machine(machine);
+    }
+    return machine->state;
+}
+
+/*
+ * Compares two profiled sequences by the number of times that they were executed,
+ * so the most frequent sequence is sorted first.
+ *
+ * Parameters:
+ * -----------
+ * const void *first    a pointer to the first sequence.
+ * const void *second   a pointer to the second sequence.
+ */
+int compare_sequences(const void *first, const void *second) {
+    unsigned long first_count = ((const ProfiledSequence *) first)->count;
+    unsigned long second_count = ((const ProfiledSequence *) second)->count;
+
+    return (first_count < second_count) - (first_count > second_count);
+}
+
+/*
+ * Writes the sequences of the given profile that were executed to the given file,
+ * from the most frequent one. Each line contains the number of times that the
+ * sequence was executed, and the names of its operations. Returns 1 if the file
+ * was written, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *profile_path   the path to the profile file.
+ * Profile *profile     a pointer to the profile.
+ */
+int write_profile(char *profile_path, Profile *profile) {
+    ProfiledSequence *sequences;
+    FILE *output;
+    int no_of_sequences = 0;
+    int first;
+    int second;
+    int third;
+    int index;
+    int opcode_index;
+
+    if ((output = fopen(profile_path, "w")) == NULL) {
+        return 0;
+    }
+    sequences = malloc(sizeof(ProfiledSequence) * (NO_OF_OPERATIONS * NO_OF_OPERATIONS * (NO_OF_OPERATIONS + 1)));
+    if (sequences == NULL) {
+        printf("Could not allocate memory for the profile!\n");
+        exit(0);
+    }
+    for (first = 0; first < NO_OF_OPERATIONS; first++) {
+        for (second = 0; second < NO_OF_OPERATIONS; second++) {
+            if ((profile->pairs)[first][second] > 0) {
+                sequences[no_of_sequences].count = (profile->pairs)[first][second];
+                sequences[no_of_sequences].opcodes[0] = first;
+                sequences[no_of_sequences].opcodes[1] = second;
+                sequences[no_of_sequences++].length = 2;
+            }
+            for (third = 0; third < NO_OF_OPERATIONS; third++) {
+                if ((profile->triples)[first][second][third] > 0) {
+                    sequences[no_of_sequences].count = (profile->triples)[first][second][third];
+                    sequences[no_of_sequences].opcodes[0] = first;
+                    sequences[no_of_sequences].opcodes[1] = second;
+                    sequences[no_of_sequences].opcodes[2] = third;
+                    sequences[no_of_sequences++].length = 3;
+                }
+            }
+        }
+    }
+    qsort(sequences, no_of_sequences, sizeof(ProfiledSequence), compare_sequences);
+    for (index = 0; index < no_of_sequences; index++) {
+        fprintf(output, "%lu", sequences[index].count);
+        for (opcode_index = 0; opcode_index < sequences[index].length; opcode_index++) {
+            fprintf(output, " %s", operations[sequences[index].opcodes[opcode_index]].name);
+        }
+        fprintf(output, "\n");
+    }
+    free(sequences);
+    fclose(output);
+    return 1;
+}
+
+/*
+ * Returns the handler of the operation with the given name, or -1 if there's no
+ * such operation.
+ *
+ * Parameters:
+ * -----------
+ * char *name   the name of the operation.
+ */
+int get_operation_handler(char *name) {
+    int opcode;
+
+    for (opcode = 0; opcode < NO_OF_OPERATIONS; opcode++) {
+        if (strcmp(operations[opcode].name, name) == 0) {
+            return operation_handlers[opcode];
+        }
+    }
+    return -1;
+}
+
+/*
+ * Returns a bit for each fusion pattern of the threaded interpreter that is one of
+ * the most frequent sequences in the given profile file, or PROFILE_NOT_READ if the
+ * file can't be read. A line that is not a valid sequence is skipped. The profile
+ * only selects among the fixed fusion patterns, so a frequent sequence that has no
+ * fused handler is executed without fusion.
+ *
+ * Parameters:
+ * -----------
+ * char *profile_path   the path to the profile file.
+ */
+int read_profile_fusions(char *profile_path) {
+    char line[MAX_PROFILE_LINE_LENGTH];
+    char names[MAX_FUSED_COMMANDS][MAX_PROFILED_NAME_LENGTH + 1];
+    int handlers[MAX_FUSED_COMMANDS];
+    unsigned long count;
+    FILE *input;
+    int fusions = 0;
+    int no_of_sequences = 0;
+    int length;
+    int index;
+    int pattern_index;
+
+    if ((input = fopen(profile_path, "r")) == NULL) {
+        return PROFILE_NOT_READ;
+    }
+    while (no_of_sequences < MAX_PROFILED_SEQUENCES && fgets(line, MAX_PROFILE_LINE_LENGTH, input) != NULL) {
+        length = sscanf(line, "%lu %8s %8s %8s", &count, names[0], names[1], names[2]) - 1;
+        if (length < 2) {
+            continue;
+        }
+        no_of_sequences++;
+        for (index = 0; index < length; index++) {
+            handlers[index] = get_operation_handler(names[index]);
+        }
+        /* a sequence of other operations (or of unknown operations) is not fused */
+        for (pattern_index = 0; pattern_index < NO_OF_FUSION_PATTERNS; pattern_index++) {
+            if (fusion_patterns[pattern_index].length == length &&
+                memcmp(fusion_patterns[pattern_index].handlers, handlers, sizeof(int) * length) == 0) {
+                fusions |= 1 << pattern_index;
+            }
+        }
+    }
+    fclose(input);
+    return fusions;
+}
@@ -0,0 +1,74 @@
+#ifndef ASSEMBLER_SIMULATOR_PROFILE_H
+#define ASSEMBLER_SIMULATOR_PROFILE_H
+
+#include <stdio.h>
+#include "../types.h"
+
+#define PROFILE_OPTION "-p" /* the command line option that writes a profile of the executed programs to a file */
+#define FUSION_OPTION "-f" /* the command line option that selects the fused handlers with a profile file */
+#define MAX_PROFILED_SEQUENCES 16 /* the number of the most frequent sequences of a profile that are fused */
+#define MAX_PROFILED_NAME_LENGTH 8 /* the maximum number of characters in a name of an operation in a profile file */
+#define MAX_PROFILE_LINE_LENGTH 64 /* the maximum number of characters in a line of a profile file that are read */
+#define PROFILE_NOT_READ (-1) /* the profile file can't be read */
+
+/*
+ * Executes the given machine like 'run_machine', and counts in the given profile each
+ * pair and each triple of adjacent commands that were executed one after the other.
+ * Returns the state of the machine.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine                 a pointer to the machine.
+ * Profile *profile                 a pointer to the profile.
+ * unsigned long max_instructions   the maximum number of commands to execute, or 0 for no limit.
+ */
+int run_profiled(Machine *machine, Profile *profile, unsigned long max_instructions);
+
+/*
+ * Compares two profiled sequences by the number of times that they were executed,
+ * so the most frequent sequence is sorted first.
+ *
+ * Parameters:
+ * -----------
+ * const void *first    a pointer to the first sequence.
+ * const void *second   a pointer to the second sequence.
+ */
+int compare_sequences(const void *first, const void *second);
+
+/*
+ * Writes the sequences of the given profile that were executed to the given file,
+ * from the most frequent one. Each line contains the number of times that the
+ * sequence was executed, and the names of its operations. Returns 1 if the file
+ * was written, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *profile_path   the path to the profile file.
+ * Profile *profile     a pointer to the profile.
+ */
+int write_profile(char *profile_path, Profile *profile);
+
+/*
+ * Returns the handler of the operation with the given name, or -1 if there's no
+ * such operation.
+ *
+ * Parameters:
+ * -----------
+ * char *name   the name of the operation.
+ */
+int get_operation_handler(char *name);
+
+/*
+ * Returns a bit for each fusion pattern of the threaded interpreter that is one of
+ * the most frequent sequences in the given profile file, or PROFILE_NOT_READ if the
+ * file can't be read. A line that is not a valid sequence is skipped. The profile
+ * only selects among the fixed fusion patterns, so a frequent sequence that has no
+ * fused handler is executed without fusion.
+ *
+ * Parameters:
+ * -----------
+ * char *profile_path   the path to the profile file.
+ */
+int read_profile_fusions(char *profile_path);
+
+#endif
@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "simulator.h"
+#include "threaded.h"
+#include "jit.h"
+#include "profile.h"
+#include "batch.h"
+#include "checkpoint.h"
+#include "../loader/loader.h"
+
+int main(int argc, char *argv[]) {
+    MachineImage *image;
+    Machine *machine;
+    ThreadedProgram *program;
+    JitProgram *jit;
+    MachineCheckpoint *checkpoint = NULL; /* the mapped checkpoint that the machine resumes from, if any */
+    Profile *profile = NULL; /* the sequences that were executed, if a profile is written */
+    char *profile_path = NULL;
+    char *batch_list = NULL; /* the list of the input files, if each program is executed in a batch */
+    char *checkpoint_path = NULL; /* the checkpoint file to write, if a checkpoint is written */
+    unsigned long checkpoint_instructions = 0; /* the number of commands before the checkpoint, or 0 */
+    int breakpoint = NO_BREAKPOINT; /* the address that the checkpoint is written in, if any */
+    int resume_flag = 0; /* indicates if the arguments are checkpoint files to resume */
+    int fusions = ALL_FUSION_PATTERNS; /* the sequences that the threaded interpreter fuses */
+    unsigned long max_instructions = 0; /* the maximum number of commands of each program, or 0 for no limit */
+    clock_t start;
+    double seconds;
+    int step_flag = 0; /* indicates if the commands are decoded and executed one by one */
+    int jit_flag = 0; /* indicates if the commands are translated to native code */
+    int lockstep_flag = 0; /* indicates if the JIT is compared with the interpreter */
+    int index;
+
+    /* each argument is a path to the output files of a program, without an extension */
+    for (index = 1; index < argc; index++) {
+        if (strcmp(argv[index], INSTRUCTIONS_LIMIT_OPTION) == 0 && index + 1 < argc) {
+            max_instructions = strtoul(argv[++index], NULL, 10);
+            continue;
+        }
+        if (strcmp(argv[index], STEP_DISPATCH_OPTION) == 0) {
+            step_flag = 1;
+            continue;
+        }
+        if (strcmp(argv[index], JIT_OPTION) == 0) {
+            jit_flag = 1;
+            continue;
+        }
+        if (strcmp(argv[index], LOCKSTEP_OPTION) == 0) {
+            lockstep_flag = 1;
+            continue;
+        }
+        if (strcmp(argv[index], PROFILE_OPTION) == 0 && index + 1 < argc) {
+            profile_path = argv[++index];
+            if (profile == NULL && (profile = calloc(1, sizeof(Profile))) == NULL) {
+                printf("Could not allocate memory for the profile!\n");
+                exit(0);
+            }
+            continue;
+        }
+        if (strcmp(argv[index], FUSION_OPTION) == 0 && index + 1 < argc) {
+            fusions = read_profile_fusions(argv[++index]);
+            if (fusions == PROFILE_NOT_READ) {
+                printf("%s: the profile file can't be read\n", argv[index]);
+                fusions = ALL_FUSION_PATTERNS;
+            }
+            continue;
+        }
+        if (strcmp(argv[index], BATCH_OPTION) == 0 && index + 1 < argc) {
+            batch_list = argv[++index];
+            continue;
+        }
+        if (strcmp(argv[index], CHECKPOINT_OPTION) == 0 && index + 1 < argc) {
+            checkpoint_path = argv[++index];
+            continue;
+        }
+        if (strcmp(argv[index], CHECKPOINT_INSTRUCTIONS_OPTION) == 0 && index + 1 < argc) {
+            checkpoint_instructions = strtoul(argv[++index], NULL, 10);
+            continue;
+        }
+        if (strcmp(argv[index], BREAKPOINT_OPTION) == 0 && index + 1 < argc) {
+            breakpoint = atoi(argv[++index]);
+            continue;
+        }
+        if (strcmp(argv[index], RESUME_OPTION) == 0) {
+            resume_flag = 1;
+            continue;
+        }
+        if (batch_list != NULL) {
+            run_batch_program(argv[index], batch_list, max_instructions);
+            continue;
+        }
+        if (lockstep_flag) {
+            run_lockstep(argv[index], max_instructions);
+            continue;
+        }
+        if (resume_flag) {
+            image = map_checkpoint(argv[index], &checkpoint);
+            if (image == NULL) {
+                printf("%s: the file is not a valid checkpoint of the machine\n", argv[index]);
+                continue;
+            }
+        } else if ((image = load_machine_image(argv[index])) == NULL) {
+            printf("%s: the program has no valid object file\n", argv[index]);
+            continue;
+        }
+        machine = create_machine(image, stdin, stdout);
+        if (checkpoint != NULL) {
+            resume_checkpoint(machine, checkpoint);
+        }
+        if (checkpoint_path != NULL && checkpoint_instructions == 0 && breakpoint == NO_BREAKPOINT) {
+            printf("%s: the checkpoint needs a number of commands or a breakpoint\n", checkpoint_path);
+            checkpoint_path = NULL;
+        }
+        start = clock();
+        /* a checkpoint is written only by the interpreters, which stop in a breakpoint */
+        jit = (jit_flag && !step_flag && profile == NULL && checkpoint_path == NULL)
+              ? create_jit_program(image) : NULL;
+        if (profile != NULL) {
+            /* the profile counts the commands of the decoding interpreter */
+            run_profiled(machine, profile, max_instructions);
+        } else if (step_flag) {
+            if (checkpoint_path != NULL &&
+                run_to_checkpoint(machine, NULL, checkpoint_instructions, breakpoint, max_instructions) &&
+                !write_checkpoint(machine, image, checkpoint_path)) {
+                printf("%s: could not create the checkpoint file\n", checkpoint_path);
+            }
+            run_machine(machine, max_instructions);
+        } else if (jit != NULL) {
+            /* the time of the translation is a part of the time of the execution */
+            run_jit(machine, jit, max_instructions);
+            free_jit_program(jit);
+        } else {
+            /* the time of the predecoding is a part of the time of the execution */
+            program = predecode_program(machine, image, fusions);
+            if (checkpoint_path != NULL &&
+                run_to_checkpoint(machine, program, checkpoint_instructions, breakpoint, max_instructions) &&
+                !write_checkpoint(machine, image, checkpoint_path)) {
+                printf("%s: could not create the checkpoint file\n", checkpoint_path);
+            }
+            run_threaded(machine, program, max_instructions);
+            free_threaded_program(program);
+        }
+        seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+        fflush(stdout);
+        if ((machine->state) == MACHINE_FAULT) {
+            print_machine_error(machine);
+        }
+        print_machine_statistics(stderr, machine, argv[index], seconds,
+                                 (checkpoint != NULL) ? (checkpoint->executed_instructions) : 0);
+        free_machine(machine);
+        if (checkpoint != NULL) {
+            unmap_checkpoint(image, checkpoint);
+            checkpoint = NULL;
+        } else {
+            free_machine_image(image);
+        }
+    }
+    if (profile != NULL) {
+        if (!write_profile(profile_path, profile)) {
+            printf("%s: could not create the profile file\n", profile_path);
+        }
+        free(profile);
+    }
+    return 0;
+}
@@ -0,0 +1,375 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "simulator.h"
+#include "../absolutes.h"
+#include "../command_analysis/helpers.h"
+#include "../disassembler/disassembler.h"
+#include "../error_detection/errors.h"
+
+/*
+ * Returns a pointer to a new Machine that executes the given loaded program from its
+ * load address. The machine uses the memory of the image, so the program changes the
+ * image. The user should free the machine with 'free_machine' (which doesn't free the image).
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the loaded program.
+ * FILE *input          the stream that the program reads characters from.
+ * FILE *output         the stream that the program prints characters to.
+ */
+Machine *create_machine(MachineImage *image, FILE *input, FILE *output) {
+    Machine *machine = calloc(1, sizeof(Machine));
+
+    if (machine == NULL) {
+        printf("Could not allocate memory for the machine!\n");
+        exit(0);
+    }
+    machine->memory = image->memory;
+    machine->program_counter = image->load_address;
+    machine->state = MACHINE_RUNNING;
+    machine->input = input;
+    machine->output = output;
+    return machine;
+}
+
+/*
+ * Frees the given machine and the bitmap of its written words, but not the memory
+ * of its image.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ */
+void free_machine(Machine *machine) {
+    free(machine->dirty_words);
+    free(machine);
+}
+
+/*
+ * Returns a pointer to a new bitmap with a bit for each address of the memory (and
+ * the address after it), in which no bit is set.
+ */
+unsigned char *create_word_bitmap() {
+    unsigned char *bitmap = calloc(WORD_BITMAP_SIZE, sizeof(unsigned char));
+
+    if (bitmap == NULL) {
+        printf("Could not allocate memory for the bitmap!\n");
+        exit(0);
+    }
+    return bitmap;
+}
+
+/*
+ * Sets the bit of the given address in the given bitmap.
+ *
+ * Parameters:
+ * -----------
+ * unsigned char *bitmap    the bitmap.
+ * int address              the address.
+ */
+void mark_word(unsigned char *bitmap, int address) {
+    bitmap[address / CHAR_BIT] |= (unsigned char) (1 << (address % CHAR_BIT));
+}
+
+/*
+ * Returns 1 if the bit of the given address is set in the given bitmap, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * unsigned char *bitmap    the bitmap.
+ * int address              the address.
+ */
+int is_word_marked(unsigned char *bitmap, int address) {
+    return (bitmap[address / CHAR_BIT] >> (address % CHAR_BIT)) & 1;
+}
+
+/*
+ * Stops the given machine because of the given error in the command it executes.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ * char *error_msg      the error message.
+ * int address          the address of the command that caused the error.
+ */
+void set_machine_fault(Machine *machine, char *error_msg, int address) {
+    machine->state = MACHINE_FAULT;
+    machine->error_msg = error_msg;
+    machine->error_address = address;
+}
+
+/*
+ * Returns the address that the given operand refers to: the address of a label, or
+ * the value of a register. If the operand is an external label that was not linked,
+ * the machine stops with an error and the function returns -1.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ * int addressing       the addressing code of the operand (a label or a register).
+ * int word_address     the address of the memory word of the operand.
+ * int register_shift   the index of the first bit of a register in the memory word.
+ * int address          the address of the command.
+ */
+int get_operand_address(Machine *machine, int addressing, int word_address, int register_shift, int address) {
+    unsigned int word = (machine->memory)[word_address];
+
+    if (addressing == REGISTER_ADDRESSING_CODE) {
+        return (machine->registers)[decode_bit_field(word, ENCODING_REGISTER_LENGTH, register_shift) %
+                                    NO_OF_REGISTERS];
+    }
+    if (decode_bit_field(word, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT) == ARE_EXTERNAL_CODE) {
+        set_machine_fault(machine, UNRESOLVED_EXTERNAL_OPERAND, address);
+        return -1;
+    }
+    return decode_bit_field(word, ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT);
+}
+
+/*
+ * Returns the 12-bit value of the given operand: an immediate number, the word in the
+ * address of a label, or the value of a register. If the operand is an external label
+ * that was not linked, the machine stops with an error and the function returns 0.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ * int addressing       the addressing code of the operand.
+ * int word_address     the address of the memory word of the operand.
+ * int register_shift   the index of the first bit of a register in the memory word.
+ * int address          the address of the command.
+ */
+unsigned int read_operand(Machine *machine, int addressing, int word_address, int register_shift, int address) {
+    unsigned int value;
+    int operand_address;
+
+    if (addressing == IMMEDIATE_ADDRESSING_CODE) {
+        value = decode_bit_field((machine->memory)[word_address], ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT);
+        /* an immediate value is a signed number in the bits of the operand */
+        if (value >= (1 << (ENCODING_OPERAND_LENGTH - 1))) {
+            value = (value - (1 << ENCODING_OPERAND_LENGTH)) & MEMORY_WORD_MASK;
+        }
+        return value;
+    }
+    operand_address = get_operand_address(machine, addressing, word_address, register_shift, address);
+    if (addressing == REGISTER_ADDRESSING_CODE) {
+        return (unsigned int) operand_address;
+    }
+    return (operand_address < 0) ? 0 : (machine->memory)[operand_address];
+}
+
+/*
+ * Stores the given value in the given operand: in the address of a label, or in a
+ * register. Only the lower 12 bits of the value are stored. A memory word is marked
+ * in the bitmap of the written words, if the machine has one.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ * int addressing       the addressing code of the operand (a label or a register).
+ * int word_address     the address of the memory word of the operand.
+ * int register_shift   the index of the first bit of a register in the memory word.
+ * int address          the address of the command.
+ * unsigned int value   the value to store.
+ */
+void write_operand(Machine *machine, int addressing, int word_address, int register_shift, int address,
+                   unsigned int value) {
+    unsigned int word = (machine->memory)[word_address];
+    int operand_address;
+
+    if (addressing == REGISTER_ADDRESSING_CODE) {
+        (machine->registers)[decode_bit_field(word, ENCODING_REGISTER_LENGTH, register_shift) % NO_OF_REGISTERS] =
+                (unsigned short) (value & MEMORY_WORD_MASK);
+        return;
+    }
+    operand_address = get_operand_address(machine, addressing, word_address, register_shift, address);
+    if (operand_address >= 0) {
+        (machine->memory)[operand_address] = (unsigned short) (value & MEMORY_WORD_MASK);
+        if (machine->dirty_words != NULL) {
+            mark_word(machine->dirty_words, operand_address);
+        }
+    }
+}
+
+/*
+ * Decodes the command in the program counter of the given machine and executes it.
+ * The first word of the command is decoded with the decoding table of the disassembler,
+ * and its operands are decoded from their memory words, with the layout that the
+ * assembler encodes them with. Returns the state of the machine after the command.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ */
+int step_machine(Machine *machine) {
+    const DecodingTemplate *template;
+    int address = machine->program_counter;
+    int src_word = address + 1; /* the address of the memory word of the source operand */
+    int dest_word; /* the address of the memory word of the destination operand */
+    int target; /* the address that a jump command jumps to */
+    unsigned int src_value;
+    unsigned int dest_value;
+    int character;
+
+    if (address < 0 || address >= MACHINE_MEMORY_SIZE) {
+        set_machine_fault(machine, PROGRAM_COUNTER_OVERFLOW, address);
+        return machine->state;
+    }
+    template = get_decoding_template((machine->memory)[address]);
+    if ((template->opcode) == NO_OPCODE) {
+        set_machine_fault(machine, ILLEGAL_INSTRUCTION, address);
+        return machine->state;
+    }
+    if (address + (template->memory_words) > MACHINE_MEMORY_SIZE) {
+        set_machine_fault(machine, PROGRAM_COUNTER_OVERFLOW, address);
+        return machine->state;
+    }
+    /* two registers are stored in the same memory word */
+    dest_word = ((template->src_addressing) == 0 || ((template->src_addressing) == REGISTER_ADDRESSING_CODE &&
+                                                     (template->dest_addressing) == REGISTER_ADDRESSING_CODE))
+                ? src_word : src_word + 1;
+    machine->program_counter = address + (template->memory_words);
+    machine->executed_instructions++;
+
+    switch (template->opcode) {
+        case MOV_OPCODE:
+            src_value = read_operand(machine, template->src_addressing, src_word, ENCODING_SRC_REGISTER_SHIFT, address);
+            write_operand(machine, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT, address,
+                          src_value);
+            break;
+        case CMP_OPCODE:
+            src_value = read_operand(machine, template->src_addressing, src_word, ENCODING_SRC_REGISTER_SHIFT, address);
+            dest_value = read_operand(machine, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT,
+                                      address);
+            machine->zero_flag = (src_value == dest_value);
+            machine->negative_flag = (((src_value - dest_value) & NEGATIVE_WORD_BIT) != 0);
+            break;
+        case ADD_OPCODE:
+        case SUB_OPCODE:
+            src_value = read_operand(machine, template->src_addressing, src_word, ENCODING_SRC_REGISTER_SHIFT, address);
+            dest_value = read_operand(machine, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT,
+                                      address);
+            write_operand(machine, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT, address,
+                          ((template->opcode) == ADD_OPCODE) ? dest_value + src_value : dest_value - src_value);
+            break;
+        case NOT_OPCODE:
+        case INC_OPCODE:
+        case DEC_OPCODE:
+            dest_value = read_operand(machine, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT,
+                                      address);
+            if ((template->opcode) == NOT_OPCODE) {
+                dest_value = ~dest_value;
+            } else {
+                dest_value = ((template->opcode) == INC_OPCODE) ? dest_value + 1 : dest_value - 1;
+            }
+            write_operand(machine, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT, address,
+                          dest_value);
+            break;
+        case CLR_OPCODE:
+            write_operand(machine, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT, address, 0);
+            break;
+        case LEA_OPCODE:
+            target = get_operand_address(machine, template->src_addressing, src_word, ENCODING_SRC_REGISTER_SHIFT,
+                                         address);
+            write_operand(machine, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT, address,
+                          (unsigned int) target);
+            break;
+        case JMP_OPCODE:
+        case BNE_OPCODE:
+        case JSR_OPCODE:
+            target = get_operand_address(machine, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT,
+                                         address);
+            if ((template->opcode) == BNE_OPCODE && machine->zero_flag) {
+                break;
+            }
+            if ((template->opcode) == JSR_OPCODE) {
+                if ((machine->stack_depth) == RETURN_STACK_SIZE) {
+                    set_machine_fault(machine, RETURN_STACK_OVERFLOW, address);
+                    break;
+                }
+                (machine->return_stack)[(machine->stack_depth)++] = machine->program_counter;
+            }
+            machine->program_counter = target;
+            break;
+        case RED_OPCODE:
+            character = fgetc(machine->input);
+            /* the end of the input is read as -1 */
+            write_operand(machine, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT, address,
+                          (character == EOF) ? MEMORY_WORD_MASK : (unsigned int) character);
+            break;
+        case PRN_OPCODE:
+            dest_value = read_operand(machine, template->dest_addressing, dest_word, ENCODING_DEST_REGISTER_SHIFT,
+                                      address);
+            if ((machine->state) == MACHINE_RUNNING) {
+                fputc((int) (dest_value & CHARACTER_MASK), machine->output);
+            }
+            break;
+        case RTS_OPCODE:
+            if ((machine->stack_depth) == 0) {
+                set_machine_fault(machine, RETURN_STACK_UNDERFLOW, address);
+                break;
+            }
+            machine->program_counter = (machine->return_stack)[--(machine->stack_depth)];
+            break;
+        case STOP_OPCODE:
+            machine->state = MACHINE_STOPPED;
+            break;
+    }
+    return machine->state;
+}
+
+/*
+ * Executes commands in the given machine until it stops, or until it has executed the
+ * given number of commands. Returns the state of the machine.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine                 a pointer to the machine.
+ * unsigned long max_instructions   the maximum number of commands to execute, or 0 for no limit.
+ */
+int run_machine(Machine *machine, unsigned long max_instructions) {
+    while ((machine->state) == MACHINE_RUNNING &&
+           (max_instructions == 0 || (machine->executed_instructions) < max_instructions)) {
+        step_machine(machine);
+    }
+    return machine->state;
+}
+
+/*
+ * Prints the error that stopped the given machine, and the address it was found in.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ */
+void print_machine_error(Machine *machine) {
+    printf("Address: %d\t|  Error: %s\n", machine->error_address, machine->error_msg);
+}
+
+/*
+ * Prints the number of commands that the given machine executed, the time it took and
+ * the number of commands per second, so the speed of the machine can be measured. If
+ * the machine resumed a checkpoint, the commands that were executed before it are
+ * counted in the total, but not in the speed.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                         the stream to print to.
+ * Machine *machine                     a pointer to the machine.
+ * char *program_path                   the path to the program, without an extension.
+ * double seconds                       the time that the execution took.
+ * unsigned long resumed_instructions   the number of commands before the resumed checkpoint, or 0.
+ */
+void print_machine_statistics(FILE *output, Machine *machine, char *program_path, double seconds,
+                              unsigned long resumed_instructions) {
+    unsigned long instructions = (machine->executed_instructions) - resumed_instructions;
+
+    fprintf(output, "Executed %s: %lu instructions", program_path, machine->executed_instructions);
+    if (resumed_instructions > 0) {
+        fprintf(output, " (%lu since the checkpoint)", instructions);
+    }
+    fprintf(output, " in %.3f seconds", seconds);
+    if (seconds > 0) {
+        fprintf(output, " (%.0f instructions per second)", (double) instructions / seconds);
+    }
+    fprintf(output, "\n");
+}
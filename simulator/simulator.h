@@ -0,0 +1,190 @@
+#ifndef ASSEMBLER_SIMULATOR_SIMULATOR_H
+#define ASSEMBLER_SIMULATOR_SIMULATOR_H
+
+#include <stdio.h>
+#include <limits.h>
+#include "../types.h"
+
+#define MACHINE_RUNNING 0 /* the machine executes commands */
+#define MACHINE_STOPPED 1 /* the machine executed a 'stop' command */
+#define MACHINE_FAULT 2 /* the machine stopped because of an error */
+
+#define MOV_OPCODE 0
+#define CMP_OPCODE 1
+#define ADD_OPCODE 2
+#define SUB_OPCODE 3
+#define NOT_OPCODE 4
+#define CLR_OPCODE 5
+#define LEA_OPCODE 6
+#define INC_OPCODE 7
+#define DEC_OPCODE 8
+#define JMP_OPCODE 9
+#define BNE_OPCODE 10
+#define RED_OPCODE 11
+#define PRN_OPCODE 12
+#define JSR_OPCODE 13
+#define RTS_OPCODE 14
+#define STOP_OPCODE 15
+
+#define INSTRUCTIONS_LIMIT_OPTION "-n" /* the command line option that limits the number of executed commands */
+#define NEGATIVE_WORD_BIT 0x800 /* the sign bit of a memory word */
+#define CHARACTER_MASK 0xFF /* the bits of a memory word that 'prn' prints as a character */
+#define WORD_BITMAP_SIZE (MACHINE_MEMORY_SIZE / CHAR_BIT + 1) /* the number of bytes of a bitmap of the memory words */
+
+/*
+ * Returns a pointer to a new Machine that executes the given loaded program from its
+ * load address. The machine uses the memory of the image, so the program changes the
+ * image. The user should free the machine with 'free_machine' (which doesn't free the image).
+ *
+ * Parameters:
+ * -----------
+ * MachineImage *image  a pointer to the loaded program.
+ * FILE *input          the stream that the program reads characters from.
+ * FILE *output         the stream that the program prints characters to.
+ */
+Machine *create_machine(MachineImage *image, FILE *input, FILE *output);
+
+/*
+ * Frees the given machine and the bitmap of its written words, but not the memory
+ * of its image.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ */
+void free_machine(Machine *machine);
+
+/*
+ * Returns a pointer to a new bitmap with a bit for each address of the memory (and
+ * the address after it), in which no bit is set.
+ */
+unsigned char *create_word_bitmap();
+
+/*
+ * Sets the bit of the given address in the given bitmap.
+ *
+ * Parameters:
+ * -----------
+ * unsigned char *bitmap    the bitmap.
+ * int address              the address.
+ */
+void mark_word(unsigned char *bitmap, int address);
+
+/*
+ * Returns 1 if the bit of the given address is set in the given bitmap, and 0 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * unsigned char *bitmap    the bitmap.
+ * int address              the address.
+ */
+int is_word_marked(unsigned char *bitmap, int address);
+
+/*
+ * Stops the given machine because of the given error in the command it executes.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ * char *error_msg      the error message.
+ * int address          the address of the command that caused the error.
+ */
+void set_machine_fault(Machine *machine, char *error_msg, int address);
+
+/*
+ * Returns the address that the given operand refers to: the address of a label, or
+ * the value of a register. If the operand is an external label that was not linked,
+ * the machine stops with an error and the function returns -1.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ * int addressing       the addressing code of the operand (a label or a register).
+ * int word_address     the address of the memory word of the operand.
+ * int register_shift   the index of the first bit of a register in the memory word.
+ * int address          the address of the command.
+ */
+int get_operand_address(Machine *machine, int addressing, int word_address, int register_shift, int address);
+
+/*
+ * Returns the 12-bit value of the given operand: an immediate number, the word in the
+ * address of a label, or the value of a register. If the operand is an external label
+ * that was not linked, the machine stops with an error and the function returns 0.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ * int addressing       the addressing code of the operand.
+ * int word_address     the address of the memory word of the operand.
+ * int register_shift   the index of the first bit of a register in the memory word.
+ * int address          the address of the command.
+ */
+unsigned int read_operand(Machine *machine, int addressing, int word_address, int register_shift, int address);
+
+/*
+ * Stores the given value in the given operand: in the address of a label, or in a
+ * register. Only the lower 12 bits of the value are stored. A memory word is marked
+ * in the bitmap of the written words, if the machine has one.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ * int addressing       the addressing code of the operand (a label or a register).
+ * int word_address     the address of the memory word of the operand.
+ * int register_shift   the index of the first bit of a register in the memory word.
+ * int address          the address of the command.
+ * unsigned int value   the value to store.
+ */
+void write_operand(Machine *machine, int addressing, int word_address, int register_shift, int address,
+                   unsigned int value);
+
+/*
+ * Decodes the command in the program counter of the given machine and executes it.
+ * The first word of the command is decoded with the decoding table of the disassembler,
+ * and its operands are decoded from their memory words, with the layout that the
+ * assembler encodes them with. Returns the state of the machine after the command.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ */
+int step_machine(Machine *machine);
+
+/*
+ * Executes commands in the given machine until it stops, or until it has executed the
+ * given number of commands. Returns the state of the machine.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine                 a pointer to the machine.
+ * unsigned long max_instructions   the maximum number of commands to execute, or 0 for no limit.
+ */
+int run_machine(Machine *machine, unsigned long max_instructions);
+
+/*
+ * Prints the error that stopped the given machine, and the address it was found in.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ */
+void print_machine_error(Machine *machine);
+
+/*
+ * Prints the number of commands that the given machine executed, the time it took and
+ * the number of commands per second, so the speed of the machine can be measured. If
+ * the machine resumed a checkpoint, the commands that were executed before it are
+ * counted in the total, but not in the speed.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                         the stream to print to.
+ * Machine *machine                     a pointer to the machine.
+ * char *program_path                   the path to the program, without an extension.
+ * double seconds                       the time that the execution took.
+ * unsigned long resumed_instructions   the number of commands before the resumed checkpoint, or 0.
+ */
+void print_machine_statistics(FILE *output, Machine *machine, char *program_path, double seconds,
+                              unsigned long resumed_instructions);
+
+#endif
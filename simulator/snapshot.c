@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "snapshot.h"
+#include "simulator.h"
+#include "threaded.h"
+
+/*
+ * Returns a pointer to a new snapshot of the given machine, with a copy of its whole
+ * memory, and starts marking the words that the machine writes after it. The user
+ * should free it with 'free_snapshot'.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ */
+MachineSnapshot *take_snapshot(Machine *machine) {
+    MachineSnapshot *snapshot = malloc(sizeof(MachineSnapshot));
+
+    if (snapshot == NULL) {
+        printf("Could not allocate memory for the snapshot!\n");
+        exit(0);
+    }
+    memcpy(snapshot->memory, machine->memory, MACHINE_MEMORY_SIZE * sizeof(unsigned short));
+    memcpy(snapshot->registers, machine->registers, NO_OF_REGISTERS * sizeof(unsigned short));
+    memcpy(snapshot->return_stack, machine->return_stack, (machine->stack_depth) * sizeof(int));
+    snapshot->program_counter = machine->program_counter;
+    snapshot->zero_flag = machine->zero_flag;
+    snapshot->negative_flag = machine->negative_flag;
+    snapshot->stack_depth = machine->stack_depth;
+    snapshot->executed_instructions = machine->executed_instructions;
+    snapshot->state = machine->state;
+    snapshot->error_msg = machine->error_msg;
+    snapshot->error_address = machine->error_address;
+    /* the words that were written before the snapshot are a part of it */
+    if (machine->dirty_words == NULL) {
+        machine->dirty_words = create_word_bitmap();
+    } else {
+        memset(machine->dirty_words, 0, WORD_BITMAP_SIZE);
+    }
+    return snapshot;
+}
+
+/*
+ * Restores the given snapshot in the given machine, and returns the number of memory
+ * words that were copied back. Only the words that the machine wrote since the
+ * snapshot was taken (or last restored) are copied, so the time of the restore is
+ * proportional to the work of the machine, and not to the size of its memory. If the
+ * machine executes a threaded program, each copied word that a command was predecoded
+ * from is predecoded again.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine             a pointer to the machine, that the snapshot was taken of.
+ * MachineSnapshot *snapshot    a pointer to the snapshot.
+ * ThreadedProgram *program     a pointer to the threaded program of the machine, or NULL.
+ */
+int restore_snapshot(Machine *machine, MachineSnapshot *snapshot, ThreadedProgram *program) {
+    unsigned char *dirty_words = machine->dirty_words;
+    int restored_words = 0;
+    int index;
+    int address;
+
+    for (index = 0; index < MACHINE_MEMORY_SIZE / CHAR_BIT; index++) {
+        if (dirty_words[index] == 0) {
+            continue;
+        }
+        for (address = index * CHAR_BIT; address < (index + 1) * CHAR_BIT; address++) {
+            if (is_word_marked(dirty_words, address)) {
+                (machine->memory)[address] = (snapshot->memory)[address];
+                restored_words++;
+            }
+        }
+    }
+    /* the commands are predecoded after all the words were copied back */
+    for (index = 0; index < MACHINE_MEMORY_SIZE / CHAR_BIT; index++) {
+        if (dirty_words[index] == 0) {
+            continue;
+        }
+        for (address = index * CHAR_BIT; program != NULL && address < (index + 1) * CHAR_BIT; address++) {
+            if (is_word_marked(dirty_words, address) && is_word_marked(program->cached_words, address)) {
+                restore_threaded_word(program, machine, address);
+            }
+        }
+        dirty_words[index] = 0;
+    }
+    memcpy(machine->registers, snapshot->registers, NO_OF_REGISTERS * sizeof(unsigned short));
+    memcpy(machine->return_stack, snapshot->return_stack, (snapshot->stack_depth) * sizeof(int));
+    machine->program_counter = snapshot->program_counter;
+    machine->zero_flag = snapshot->zero_flag;
+    machine->negative_flag = snapshot->negative_flag;
+    machine->stack_depth = snapshot->stack_depth;
+    machine->executed_instructions = snapshot->executed_instructions;
+    machine->state = snapshot->state;
+    machine->error_msg = snapshot->error_msg;
+    machine->error_address = snapshot->error_address;
+    return restored_words;
+}
+
+/*
+ * Frees the given snapshot.
+ *
+ * Parameters:
+ * -----------
+ * MachineSnapshot *snapshot    a pointer to the snapshot.
+ */
+void free_snapshot(MachineSnapshot *snapshot) {
+    free(snapshot);
+}
@@ -0,0 +1,48 @@
+#ifndef ASSEMBLER_SIMULATOR_SNAPSHOT_H
+#define ASSEMBLER_SIMULATOR_SNAPSHOT_H
+
+#include "../types.h"
+
+/*
+ * The step interpreter and the threaded interpreter mark the words that a machine
+ * writes after a snapshot. The JIT doesn't mark them, so a machine that restores
+ * snapshots is executed with the interpreters.
+ */
+
+/*
+ * Returns a pointer to a new snapshot of the given machine, with a copy of its whole
+ * memory, and starts marking the words that the machine writes after it. The user
+ * should free it with 'free_snapshot'.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine.
+ */
+MachineSnapshot *take_snapshot(Machine *machine);
+
+/*
+ * Restores the given snapshot in the given machine, and returns the number of memory
+ * words that were copied back. Only the words that the machine wrote since the
+ * snapshot was taken (or last restored) are copied, so the time of the restore is
+ * proportional to the work of the machine, and not to the size of its memory. If the
+ * machine executes a threaded program, each copied word that a command was predecoded
+ * from is predecoded again.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine             a pointer to the machine, that the snapshot was taken of.
+ * MachineSnapshot *snapshot    a pointer to the snapshot.
+ * ThreadedProgram *program     a pointer to the threaded program of the machine, or NULL.
+ */
+int restore_snapshot(Machine *machine, MachineSnapshot *snapshot, ThreadedProgram *program);
+
+/*
+ * Frees the given snapshot.
+ *
+ * Parameters:
+ * -----------
+ * MachineSnapshot *snapshot    a pointer to the snapshot.
+ */
+void free_snapshot(MachineSnapshot *snapshot);
+
+#endif
@@ -0,0 +1,630 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "threaded.h"
+#include "simulator.h"
+#include "../absolutes.h"
+#include "../command_analysis/helpers.h"
+#include "../disassembler/disassembler.h"
+#include "../error_detection/errors.h"
+
+/* the handler of each operation, in the order of their opcodes ('lea' moves the address of its label) */
+const int operation_handlers[NO_OF_OPERATIONS] = {THREADED_MOV, THREADED_CMP, THREADED_ADD, THREADED_SUB,
+                                                  THREADED_NOT, THREADED_CLR, THREADED_MOV, THREADED_INC,
+                                                  THREADED_DEC, THREADED_JMP, THREADED_BNE, THREADED_RED,
+                                                  THREADED_PRN, THREADED_JSR, THREADED_RTS, THREADED_STOP};
+
+/* the sequences of adjacent commands that have a fused handler, with the longer sequences first */
+const FusionPattern fusion_patterns[NO_OF_FUSION_PATTERNS] = {
+        {{THREADED_INC, THREADED_CMP, THREADED_BNE}, 3, THREADED_INC_CMP_BNE},
+        {{THREADED_DEC, THREADED_CMP, THREADED_BNE}, 3, THREADED_DEC_CMP_BNE},
+        {{THREADED_CMP, THREADED_BNE}, 2, THREADED_CMP_BNE},
+        {{THREADED_MOV, THREADED_ADD}, 2, THREADED_MOV_ADD},
+        {{THREADED_MOV, THREADED_MOV}, 2, THREADED_MOV_MOV}};
+
+/*
+ * Returns the address of the memory word that the command in the given address
+ * writes to, if it writes to a label, and -1 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * unsigned short *memory   the memory of the machine.
+ * int address              the address of the first word of the command.
+ */
+int get_written_address(unsigned short *memory, int address) {
+    const DecodingTemplate *template = get_decoding_template(memory[address]);
+    int dest_word;
+
+    if ((template->opcode) == NO_OPCODE || (template->dest_addressing) != LABEL_ADDRESSING_CODE ||
+        (template->opcode) == CMP_OPCODE || (template->opcode) == PRN_OPCODE || (template->opcode) == JMP_OPCODE ||
+        (template->opcode) == BNE_OPCODE || (template->opcode) == JSR_OPCODE ||
+        address + (template->memory_words) > MACHINE_MEMORY_SIZE) {
+        return -1;
+    }
+    /* the word of a label destination is the last word of the command */
+    dest_word = address + (template->memory_words) - 1;
+    return decode_bit_field(memory[dest_word], ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT);
+}
+
+/*
+ * Returns a pointer to the value of the given operand: the register, the word in the
+ * address of a label, or the given storage, with the immediate value. If 'by_address'
+ * is set, a label operand is resolved to its address, which is stored in the storage.
+ * If the operand is an external label that was not linked, the function returns NULL.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine             a pointer to the machine.
+ * int addressing               the addressing code of the operand.
+ * int word_address             the address of the memory word of the operand.
+ * int register_shift           the index of the first bit of a register in the memory word.
+ * int by_address               indicates if a label operand is resolved to its address.
+ * unsigned short *storage      a pointer to the storage for an immediate value or an address.
+ */
+unsigned short *resolve_operand_value(Machine *machine, int addressing, int word_address, int register_shift,
+                                      int by_address, unsigned short *storage) {
+    unsigned int word = (machine->memory)[word_address];
+
+    if (addressing == REGISTER_ADDRESSING_CODE) {
+        return &(machine->registers)[decode_bit_field(word, ENCODING_REGISTER_LENGTH, register_shift) %
+                                     NO_OF_REGISTERS];
+    }
+    if (addressing == IMMEDIATE_ADDRESSING_CODE) {
+        *storage = (unsigned short) read_operand(machine, addressing, word_address, register_shift, word_address);
+        return storage;
+    }
+    if (decode_bit_field(word, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT) == ARE_EXTERNAL_CODE) {
+        return NULL;
+    }
+    if (by_address) {
+        *storage = (unsigned short) decode_bit_field(word, ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT);
+        return storage;
+    }
+    return &(machine->memory)[decode_bit_field(word, ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT)];
+}
+
+/*
+ * Predecodes the command in the given address to its ThreadedCommand, and marks the
+ * words it was predecoded from. If the command is not valid, or uses an external label
+ * that was not linked, it's decoded from the memory whenever it's executed, so its
+ * error is found by 'step_machine'. A command that writes to the code is also executed
+ * by 'step_machine', so the commands it changes are predecoded again.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ * Machine *machine             a pointer to the machine.
+ * int address                  the address of the first word of the command.
+ */
+void predecode_command(ThreadedProgram *program, Machine *machine, int address) {
+    ThreadedCommand *command = &(program->commands)[address];
+    const DecodingTemplate *template = get_decoding_template((machine->memory)[address]);
+    int src_word = address + 1;
+    int dest_word;
+    int jump_flag; /* indicates if the destination of the command is the address it jumps to */
+    int written_address;
+    int index;
+
+    command->handler = THREADED_DECODE;
+    command->single_handler = THREADED_DECODE;
+    command->size = 1;
+    command->span = 1;
+    /* a command that doesn't write a memory word marks the address after the memory */
+    command->dirty_byte = (machine->dirty_words) + MACHINE_MEMORY_SIZE / CHAR_BIT;
+    command->dirty_bit = (unsigned char) (1 << (MACHINE_MEMORY_SIZE % CHAR_BIT));
+    if ((template->opcode) == NO_OPCODE || address + (template->memory_words) > (program->code_end)) {
+        return;
+    }
+    /* two registers are stored in the same memory word */
+    dest_word = ((template->src_addressing) == 0 || ((template->src_addressing) == REGISTER_ADDRESSING_CODE &&
+                                                     (template->dest_addressing) == REGISTER_ADDRESSING_CODE))
+                ? src_word : src_word + 1;
+    jump_flag = ((template->opcode) == JMP_OPCODE || (template->opcode) == BNE_OPCODE ||
+                 (template->opcode) == JSR_OPCODE);
+    command->src = NULL;
+    command->dest = NULL;
+    if ((template->src_addressing) != 0) {
+        command->src = resolve_operand_value(machine, template->src_addressing, src_word,
+                                             ENCODING_SRC_REGISTER_SHIFT, (template->opcode) == LEA_OPCODE,
+                                             &(command->src_value));
+        if (command->src == NULL) {
+            return;
+        }
+    }
+    if ((template->dest_addressing) != 0) {
+        command->dest = resolve_operand_value(machine, template->dest_addressing, dest_word,
+                                              ENCODING_DEST_REGISTER_SHIFT, jump_flag, &(command->dest_value));
+        if (command->dest == NULL) {
+            return;
+        }
+    }
+    written_address = get_written_address(machine->memory, address);
+    if (written_address >= (program->code_start) && written_address < (program->code_end)) {
+        /* the command is skipped as a whole by the sweep, but it's executed by 'step_machine' */
+        command->size = template->memory_words;
+        command->span = command->size;
+        return;
+    }
+    if (written_address >= 0) {
+        command->dirty_byte = (machine->dirty_words) + written_address / CHAR_BIT;
+        command->dirty_bit = (unsigned char) (1 << (written_address % CHAR_BIT));
+    }
+    command->handler = operation_handlers[template->opcode];
+    command->single_handler = command->handler;
+    command->size = template->memory_words;
+    command->span = command->size;
+    for (index = 0; index < (command->size); index++) {
+        mark_word(program->cached_words, address + index);
+    }
+}
+
+/*
+ * Predecodes again each command that was predecoded from the given address, after
+ * the word in the address was changed, and fuses again each sequence that contains
+ * it. The other predecoded commands are kept.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ * Machine *machine             a pointer to the machine.
+ * int address                  the address of the word that was changed.
+ */
+void invalidate_threaded_word(ThreadedProgram *program, Machine *machine, int address) {
+    ThreadedCommand *command;
+    int command_address;
+
+    for (command_address = address - MAX_NO_OF_WORDS_IN_COMMAND + 1; command_address <= address; command_address++) {
+        if (command_address < 0) {
+            continue;
+        }
+        command = &(program->commands)[command_address];
+        if ((command->single_handler) != THREADED_DECODE && command_address + (command->size) > address) {
+            predecode_command(program, machine, command_address);
+        }
+    }
+    for (command_address = address - MAX_FUSED_WORDS + 1; command_address <= address; command_address++) {
+        if (command_address >= 0) {
+            fuse_command(program, command_address);
+        }
+    }
+}
+
+/*
+ * Predecodes again each command that the sweep found in the given address or in the
+ * words before it, after the word in the address was restored to its value before
+ * the program started, and fuses again each sequence that contains it. Unlike
+ * 'invalidate_threaded_word', a command that was decoded from the memory since
+ * the word was changed is predecoded again, so the commands are the commands that
+ * were predecoded from the restored memory.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ * Machine *machine             a pointer to the machine.
+ * int address                  the address of the word that was restored.
+ */
+void restore_threaded_word(ThreadedProgram *program, Machine *machine, int address) {
+    int command_address;
+
+    for (command_address = address - MAX_NO_OF_WORDS_IN_COMMAND + 1; command_address <= address; command_address++) {
+        if (command_address >= 0 && is_word_marked(program->command_starts, command_address)) {
+            predecode_command(program, machine, command_address);
+        }
+    }
+    for (command_address = address - MAX_FUSED_WORDS + 1; command_address <= address; command_address++) {
+        if (command_address >= 0) {
+            fuse_command(program, command_address);
+        }
+    }
+}
+
+/*
+ * Fuses the predecoded command in the given address with the commands after it, if
+ * they match one of the fusion patterns of the program, so the sequence is executed
+ * with a single dispatch. Otherwise, the command gets back its own handler.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ * int address                  the address of the first word of the command.
+ */
+void fuse_command(ThreadedProgram *program, int address) {
+    ThreadedCommand *commands = program->commands;
+    const FusionPattern *pattern;
+    int next_address;
+    int index;
+    int length;
+
+    commands[address].handler = commands[address].single_handler;
+    commands[address].span = commands[address].size;
+    if (address == (program->breakpoint)) {
+        commands[address].handler = THREADED_BREAK;
+        return;
+    }
+    if (commands[address].single_handler == THREADED_DECODE) {
+        return;
+    }
+    for (index = 0; index < NO_OF_FUSION_PATTERNS; index++) {
+        pattern = &fusion_patterns[index];
+        if (!(((program->fusions) >> index) & 1)) {
+            continue;
+        }
+        next_address = address;
+        for (length = 0; length < (pattern->length); length++) {
+            if (next_address >= (program->code_end) ||
+                commands[next_address].single_handler != (pattern->handlers)[length]) {
+                break;
+            }
+            next_address += commands[next_address].size;
+        }
+        /* a sequence is not fused over the breakpoint, so the interpreter dispatches it */
+        if (length == (pattern->length) &&
+            ((program->breakpoint) <= address || (program->breakpoint) >= next_address)) {
+            commands[address].handler = pattern->fused_handler;
+            commands[address].span = next_address - address;
+            return;
+        }
+    }
+}
+
+/*
+ * Stops the threaded interpreter before it executes the command in the given address:
+ * the command gets the handler of a breakpoint, and each sequence that contains it
+ * after its first command is executed without fusion, so the interpreter dispatches
+ * the command. The breakpoint is kept when the program changes the command and it's
+ * predecoded again.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ * int address                  the address of the breakpoint.
+ */
+void set_threaded_breakpoint(ThreadedProgram *program, int address) {
+    int command_address;
+
+    if (address < 0 || address > MACHINE_MEMORY_SIZE) {
+        return;
+    }
+    program->breakpoint = address;
+    for (command_address = address - MAX_FUSED_WORDS + 1; command_address <= address; command_address++) {
+        if (command_address >= 0) {
+            fuse_command(program, command_address);
+        }
+    }
+}
+
+/*
+ * Removes the breakpoint in the given address, and fuses again the sequences that
+ * contain it.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ * int address                  the address of the breakpoint.
+ */
+void clear_threaded_breakpoint(ThreadedProgram *program, int address) {
+    int command_address;
+
+    if (address < 0 || address > MACHINE_MEMORY_SIZE) {
+        return;
+    }
+    program->breakpoint = NO_BREAKPOINT;
+    for (command_address = address - MAX_FUSED_WORDS + 1; command_address <= address; command_address++) {
+        if (command_address >= 0) {
+            fuse_command(program, command_address);
+        }
+    }
+}
+
+/*
+ * Returns a pointer to a new ThreadedProgram with the commands of the given program,
+ * predecoded for the given machine. The commands are found in a single sweep of the
+ * code words, and any other address is decoded from the memory when it's executed.
+ * After the sweep, the commands that match the given fusion patterns are fused.
+ * The commands mark the words they write in the bitmap of the written words of the
+ * machine, which is created if the machine doesn't have one. The user should free
+ * it with 'free_threaded_program'.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine that executes the program.
+ * MachineImage *image  a pointer to the loaded program.
+ * int fusions          a bit for each fusion pattern to apply.
+ */
+ThreadedProgram *predecode_program(Machine *machine, MachineImage *image, int fusions) {
+    ThreadedProgram *program = calloc(1, sizeof(ThreadedProgram));
+    int address;
+
+    if (program == NULL ||
+        (program->commands = calloc(MACHINE_MEMORY_SIZE + 1, sizeof(ThreadedCommand))) == NULL) {
+        printf("Could not allocate memory for the threaded program!\n");
+        exit(0);
+    }
+    for (address = 0; address <= MACHINE_MEMORY_SIZE; address++) {
+        (program->commands)[address].handler = THREADED_DECODE;
+        (program->commands)[address].single_handler = THREADED_DECODE;
+        (program->commands)[address].size = 1;
+        (program->commands)[address].span = 1;
+    }
+    program->fusions = fusions;
+    program->breakpoint = NO_BREAKPOINT;
+    /* the predecoded commands mark the words they write in the bitmap of the machine */
+    if (machine->dirty_words == NULL) {
+        machine->dirty_words = create_word_bitmap();
+    }
+    program->cached_words = create_word_bitmap();
+    program->command_starts = create_word_bitmap();
+    program->code_start = image->load_address;
+    program->code_end = (image->load_address) + (image->code_words);
+
+    address = program->code_start;
+    while (address < (program->code_end)) {
+        predecode_command(program, machine, address);
+        mark_word(program->command_starts, address);
+        address += (program->commands)[address].size;
+    }
+    /* the commands are fused after all of them were predecoded */
+    address = program->code_start;
+    while (address < (program->code_end)) {
+        fuse_command(program, address);
+        address += (program->commands)[address].size;
+    }
+    return program;
+}
+
+/*
+ * Frees the dynamic memory that was allocated to contain the commands of the
+ * given threaded program, and in the end frees the program itself.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ */
+void free_threaded_program(ThreadedProgram *program) {
+    free(program->commands);
+    free(program->cached_words);
+    free(program->command_starts);
+    free(program);
+}
+
+/* each handler is a label, and the next command is dispatched in the end of the handler */
+#ifdef COMPUTED_GOTO_DISPATCH
+#define HANDLER(name) handle_##name:
+#define FALLBACK_HANDLER(name) handle_##name:
+#define DISPATCH_COMMAND() if (remaining == 0) { goto finish; } remaining--; __extension__ ({ goto *(command->label); })
+#define BEGIN_DISPATCH() DISPATCH_COMMAND();
+#define END_DISPATCH()
+#else
+#define HANDLER(name) case name:
+#define FALLBACK_HANDLER(name) case name: handle_##name:
+#define DISPATCH_COMMAND() continue
+#define BEGIN_DISPATCH() for (;;) { if (remaining == 0) { goto finish; } remaining--; switch (command->handler) {
+#define END_DISPATCH() } }
+#endif
+
+/* marks the memory word that the given command writes in the bitmap of the written words */
+#define MARK_WRITTEN(command) (*((command)->dirty_byte) |= (command)->dirty_bit)
+
+/* a fused handler that doesn't fit in the remaining commands executes only its first command */
+#define RESERVE_FUSED(commands, first_handler) if (remaining < (commands)) { goto first_handler; } remaining -= (commands)
+
+/*
+ * Executes the predecoded commands of the given program in the given machine, like
+ * 'run_machine'. Each handler dispatches the next command with a computed goto when
+ * the compiler supports it, and with a switch otherwise. A fused handler executes a
+ * sequence of adjacent commands, and counts each of them. When a command changes a
+ * word that a command was predecoded from, only the commands of that word are
+ * predecoded again. Each handler that writes a memory word marks it in the bitmap
+ * of the written words of the machine. The interpreter stops before a command that
+ * has a breakpoint. Returns the state of the machine.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine                 a pointer to the machine.
+ * ThreadedProgram *program         a pointer to the program, predecoded for the machine.
+ * unsigned long max_instructions   the maximum number of commands to execute, or 0 for no limit.
+ */
+int run_threaded(Machine *machine, ThreadedProgram *program, unsigned long max_instructions) {
+#ifdef COMPUTED_GOTO_DISPATCH
+    static const void *const handler_labels[NO_OF_THREADED_HANDLERS] = {
+            __extension__ &&handle_THREADED_MOV, __extension__ &&handle_THREADED_CMP,
+            __extension__ &&handle_THREADED_ADD, __extension__ &&handle_THREADED_SUB,
+            __extension__ &&handle_THREADED_NOT, __extension__ &&handle_THREADED_CLR,
+            __extension__ &&handle_THREADED_INC, __extension__ &&handle_THREADED_DEC,
+            __extension__ &&handle_THREADED_JMP, __extension__ &&handle_THREADED_BNE,
+            __extension__ &&handle_THREADED_RED, __extension__ &&handle_THREADED_PRN,
+            __extension__ &&handle_THREADED_JSR, __extension__ &&handle_THREADED_RTS,
+            __extension__ &&handle_THREADED_STOP, __extension__ &&handle_THREADED_DECODE,
+            __extension__ &&handle_THREADED_INC_CMP_BNE, __extension__ &&handle_THREADED_DEC_CMP_BNE,
+            __extension__ &&handle_THREADED_CMP_BNE, __extension__ &&handle_THREADED_MOV_ADD,
+            __extension__ &&handle_THREADED_MOV_MOV, __extension__ &&handle_THREADED_BREAK};
+#endif
+    ThreadedCommand *commands = program->commands;
+    ThreadedCommand *command;
+    ThreadedCommand *next; /* the second command of a fused sequence */
+    ThreadedCommand *last; /* the third command of a fused sequence */
+    unsigned long initial_executed = machine->executed_instructions;
+    unsigned long budget; /* the number of commands that may be executed */
+    unsigned long remaining;
+    unsigned long executed;
+    int address;
+    int written_address;
+    int character;
+
+    if ((machine->state) != MACHINE_RUNNING) {
+        return machine->state;
+    }
+#ifdef COMPUTED_GOTO_DISPATCH
+    for (address = 0; address <= MACHINE_MEMORY_SIZE; address++) {
+        commands[address].label = handler_labels[commands[address].handler];
+    }
+#endif
+    if (max_instructions == 0) {
+        budget = ULONG_MAX;
+    } else {
+        budget = (max_instructions > initial_executed) ? max_instructions - initial_executed : 0;
+    }
+    remaining = budget;
+    command = commands + (machine->program_counter);
+
+    BEGIN_DISPATCH()
+    FALLBACK_HANDLER(THREADED_MOV)
+        *(command->dest) = *(command->src);
+        MARK_WRITTEN(command);
+        command += command->size;
+        DISPATCH_COMMAND();
+    FALLBACK_HANDLER(THREADED_CMP)
+        machine->zero_flag = (*(command->src) == *(command->dest));
+        machine->negative_flag = (((*(command->src) - *(command->dest)) & NEGATIVE_WORD_BIT) != 0);
+        command += command->size;
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_ADD)
+        *(command->dest) = (unsigned short) ((*(command->dest) + *(command->src)) & MEMORY_WORD_MASK);
+        MARK_WRITTEN(command);
+        command += command->size;
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_SUB)
+        *(command->dest) = (unsigned short) ((*(command->dest) - *(command->src)) & MEMORY_WORD_MASK);
+        MARK_WRITTEN(command);
+        command += command->size;
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_NOT)
+        *(command->dest) = (unsigned short) (~*(command->dest) & MEMORY_WORD_MASK);
+        MARK_WRITTEN(command);
+        command += command->size;
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_CLR)
+        *(command->dest) = 0;
+        MARK_WRITTEN(command);
+        command += command->size;
+        DISPATCH_COMMAND();
+    FALLBACK_HANDLER(THREADED_INC)
+        *(command->dest) = (unsigned short) ((*(command->dest) + 1) & MEMORY_WORD_MASK);
+        MARK_WRITTEN(command);
+        command += command->size;
+        DISPATCH_COMMAND();
+    FALLBACK_HANDLER(THREADED_DEC)
+        *(command->dest) = (unsigned short) ((*(command->dest) - 1) & MEMORY_WORD_MASK);
+        MARK_WRITTEN(command);
+        command += command->size;
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_JMP)
+        command = commands + *(command->dest);
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_BNE)
+        command = (machine->zero_flag) ? command + (command->size) : commands + *(command->dest);
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_RED)
+        character = fgetc(machine->input);
+        /* the end of the input is read as -1 */
+        *(command->dest) = (unsigned short) ((character == EOF) ? MEMORY_WORD_MASK : character & MEMORY_WORD_MASK);
+        MARK_WRITTEN(command);
+        command += command->size;
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_PRN)
+        fputc(*(command->dest) & CHARACTER_MASK, machine->output);
+        command += command->size;
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_JSR)
+        if ((machine->stack_depth) == RETURN_STACK_SIZE) {
+            set_machine_fault(machine, RETURN_STACK_OVERFLOW, (int) (command - commands));
+            goto finish;
+        }
+        (machine->return_stack)[(machine->stack_depth)++] = (int) (command - commands) + (command->size);
+        command = commands + *(command->dest);
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_RTS)
+        if ((machine->stack_depth) == 0) {
+            set_machine_fault(machine, RETURN_STACK_UNDERFLOW, (int) (command - commands));
+            goto finish;
+        }
+        command = commands + (machine->return_stack)[--(machine->stack_depth)];
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_STOP)
+        machine->state = MACHINE_STOPPED;
+        command += command->size;
+        goto finish;
+    HANDLER(THREADED_DECODE)
+        address = (int) (command - commands);
+        /* a command that was not predecoded may change the words of predecoded commands */
+        written_address = (address < MACHINE_MEMORY_SIZE) ? get_written_address(machine->memory, address) : -1;
+        machine->program_counter = address;
+        executed = machine->executed_instructions;
+        step_machine(machine);
+        /* a command that stops the machine before it's executed is not counted */
+        if ((machine->executed_instructions) == executed) {
+            remaining++;
+        }
+        if (written_address >= 0 && is_word_marked(program->cached_words, written_address)) {
+            invalidate_threaded_word(program, machine, written_address);
+#ifdef COMPUTED_GOTO_DISPATCH
+            for (address = written_address - MAX_FUSED_WORDS + 1; address <= written_address; address++) {
+                if (address >= 0) {
+                    commands[address].label = handler_labels[commands[address].handler];
+                }
+            }
+#endif
+        }
+        command = commands + (machine->program_counter);
+        if ((machine->state) != MACHINE_RUNNING) {
+            goto finish;
+        }
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_INC_CMP_BNE)
+        RESERVE_FUSED(2, handle_THREADED_INC);
+        next = command + (command->size);
+        last = next + (next->size);
+        *(command->dest) = (unsigned short) ((*(command->dest) + 1) & MEMORY_WORD_MASK);
+        MARK_WRITTEN(command);
+        machine->zero_flag = (*(next->src) == *(next->dest));
+        machine->negative_flag = (((*(next->src) - *(next->dest)) & NEGATIVE_WORD_BIT) != 0);
+        command = (machine->zero_flag) ? last + (last->size) : commands + *(last->dest);
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_DEC_CMP_BNE)
+        RESERVE_FUSED(2, handle_THREADED_DEC);
+        next = command + (command->size);
+        last = next + (next->size);
+        *(command->dest) = (unsigned short) ((*(command->dest) - 1) & MEMORY_WORD_MASK);
+        MARK_WRITTEN(command);
+        machine->zero_flag = (*(next->src) == *(next->dest));
+        machine->negative_flag = (((*(next->src) - *(next->dest)) & NEGATIVE_WORD_BIT) != 0);
+        command = (machine->zero_flag) ? last + (last->size) : commands + *(last->dest);
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_CMP_BNE)
+        RESERVE_FUSED(1, handle_THREADED_CMP);
+        next = command + (command->size);
+        machine->zero_flag = (*(command->src) == *(command->dest));
+        machine->negative_flag = (((*(command->src) - *(command->dest)) & NEGATIVE_WORD_BIT) != 0);
+        command = (machine->zero_flag) ? next + (next->size) : commands + *(next->dest);
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_MOV_ADD)
+        RESERVE_FUSED(1, handle_THREADED_MOV);
+        next = command + (command->size);
+        *(command->dest) = *(command->src);
+        *(next->dest) = (unsigned short) ((*(next->dest) + *(next->src)) & MEMORY_WORD_MASK);
+        MARK_WRITTEN(command);
+        MARK_WRITTEN(next);
+        command = next + (next->size);
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_MOV_MOV)
+        RESERVE_FUSED(1, handle_THREADED_MOV);
+        next = command + (command->size);
+        *(command->dest) = *(command->src);
+        *(next->dest) = *(next->src);
+        MARK_WRITTEN(command);
+        MARK_WRITTEN(next);
+        command = next + (next->size);
+        DISPATCH_COMMAND();
+    HANDLER(THREADED_BREAK)
+        /* the command in the breakpoint is not executed */
+        remaining++;
+        goto finish;
+    END_DISPATCH()
+
+finish:
+    if ((machine->state) != MACHINE_FAULT) {
+        machine->program_counter = (int) (command - commands);
+    }
+    machine->executed_instructions = initial_executed + (budget - remaining);
+    return machine->state;
+}
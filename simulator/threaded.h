@@ -0,0 +1,203 @@
+#ifndef ASSEMBLER_SIMULATOR_THREADED_H
+#define ASSEMBLER_SIMULATOR_THREADED_H
+
+#include "../types.h"
+
+#define THREADED_MOV 0
+#define THREADED_CMP 1
+#define THREADED_ADD 2
+#define THREADED_SUB 3
+#define THREADED_NOT 4
+#define THREADED_CLR 5
+#define THREADED_INC 6
+#define THREADED_DEC 7
+#define THREADED_JMP 8
+#define THREADED_BNE 9
+#define THREADED_RED 10
+#define THREADED_PRN 11
+#define THREADED_JSR 12
+#define THREADED_RTS 13
+#define THREADED_STOP 14
+#define THREADED_DECODE 15 /* the command is decoded from the memory and executed by 'step_machine' */
+#define THREADED_INC_CMP_BNE 16 /* the fused handlers, which execute a sequence of adjacent commands */
+#define THREADED_DEC_CMP_BNE 17
+#define THREADED_CMP_BNE 18
+#define THREADED_MOV_ADD 19
+#define THREADED_MOV_MOV 20
+#define THREADED_BREAK 21 /* the interpreter stops before the command, in a breakpoint */
+#define NO_OF_THREADED_HANDLERS 22
+#define NO_BREAKPOINT (-1) /* the address of the breakpoint of a program that doesn't stop before any command */
+
+#define NO_OF_FUSION_PATTERNS 5 /* the number of sequences that have a fused handler */
+#define ALL_FUSION_PATTERNS ((1 << NO_OF_FUSION_PATTERNS) - 1) /* the bits of all the fusion patterns */
+#define MAX_FUSED_WORDS (MAX_FUSED_COMMANDS * MAX_NO_OF_WORDS_IN_COMMAND) /* the maximum number of words of a fused sequence */
+
+#define STEP_DISPATCH_OPTION "-s" /* the command line option that executes the programs with 'step_machine' */
+
+/* the handler of each opcode */
+extern const int operation_handlers[NO_OF_OPERATIONS];
+
+/* the sequences of adjacent commands that have a fused handler, and the bit of each of them is its index */
+extern const FusionPattern fusion_patterns[NO_OF_FUSION_PATTERNS];
+
+/* GCC can jump to the address of a label, so each handler jumps directly to the next one (unless
+ * SWITCH_DISPATCH is defined, which builds the portable dispatch) */
+#if defined(__GNUC__) && !defined(SWITCH_DISPATCH)
+#define COMPUTED_GOTO_DISPATCH
+#endif
+
+/*
+ * Returns the address of the memory word that the command in the given address
+ * writes to, if it writes to a label, and -1 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * unsigned short *memory   the memory of the machine.
+ * int address              the address of the first word of the command.
+ */
+int get_written_address(unsigned short *memory, int address);
+
+/*
+ * Returns a pointer to the value of the given operand: the register, the word in the
+ * address of a label, or the given storage, with the immediate value. If 'by_address'
+ * is set, a label operand is resolved to its address, which is stored in the storage.
+ * If the operand is an external label that was not linked, the function returns NULL.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine             a pointer to the machine.
+ * int addressing               the addressing code of the operand.
+ * int word_address             the address of the memory word of the operand.
+ * int register_shift           the index of the first bit of a register in the memory word.
+ * int by_address               indicates if a label operand is resolved to its address.
+ * unsigned short *storage      a pointer to the storage for an immediate value or an address.
+ */
+unsigned short *resolve_operand_value(Machine *machine, int addressing, int word_address, int register_shift,
+                                      int by_address, unsigned short *storage);
+
+/*
+ * Predecodes the command in the given address to its ThreadedCommand, and marks the
+ * words it was predecoded from. If the command is not valid, or uses an external label
+ * that was not linked, it's decoded from the memory whenever it's executed, so its
+ * error is found by 'step_machine'. A command that writes to the code is also executed
+ * by 'step_machine', so the commands it changes are predecoded again.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ * Machine *machine             a pointer to the machine.
+ * int address                  the address of the first word of the command.
+ */
+void predecode_command(ThreadedProgram *program, Machine *machine, int address);
+
+/*
+ * Predecodes again each command that was predecoded from the given address, after
+ * the word in the address was changed, and fuses again each sequence that contains
+ * it. The other predecoded commands are kept.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ * Machine *machine             a pointer to the machine.
+ * int address                  the address of the word that was changed.
+ */
+void invalidate_threaded_word(ThreadedProgram *program, Machine *machine, int address);
+
+/*
+ * Predecodes again each command that the sweep found in the given address or in the
+ * words before it, after the word in the address was restored to its value before
+ * the program started, and fuses again each sequence that contains it. Unlike
+ * 'invalidate_threaded_word', a command that was decoded from the memory since
+ * the word was changed is predecoded again, so the commands are the commands that
+ * were predecoded from the restored memory.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ * Machine *machine             a pointer to the machine.
+ * int address                  the address of the word that was restored.
+ */
+void restore_threaded_word(ThreadedProgram *program, Machine *machine, int address);
+
+/*
+ * Fuses the predecoded command in the given address with the commands after it, if
+ * they match one of the fusion patterns of the program, so the sequence is executed
+ * with a single dispatch. Otherwise, the command gets back its own handler.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ * int address                  the address of the first word of the command.
+ */
+void fuse_command(ThreadedProgram *program, int address);
+
+/*
+ * Stops the threaded interpreter before it executes the command in the given address:
+ * the command gets the handler of a breakpoint, and each sequence that contains it
+ * after its first command is executed without fusion, so the interpreter dispatches
+ * the command. The breakpoint is kept when the program changes the command and it's
+ * predecoded again.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ * int address                  the address of the breakpoint.
+ */
+void set_threaded_breakpoint(ThreadedProgram *program, int address);
+
+/*
+ * Removes the breakpoint in the given address, and fuses again the sequences that
+ * contain it.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ * int address                  the address of the breakpoint.
+ */
+void clear_threaded_breakpoint(ThreadedProgram *program, int address);
+
+/*
+ * Returns a pointer to a new ThreadedProgram with the commands of the given program,
+ * predecoded for the given machine. The commands are found in a single sweep of the
+ * code words, and any other address is decoded from the memory when it's executed.
+ * After the sweep, the commands that match the given fusion patterns are fused.
+ * The commands mark the words they write in the bitmap of the written words of the
+ * machine, which is created if the machine doesn't have one. The user should free
+ * it with 'free_threaded_program'.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine     a pointer to the machine that executes the program.
+ * MachineImage *image  a pointer to the loaded program.
+ * int fusions          a bit for each fusion pattern to apply.
+ */
+ThreadedProgram *predecode_program(Machine *machine, MachineImage *image, int fusions);
+
+/*
+ * Frees the dynamic memory that was allocated to contain the commands of the
+ * given threaded program, and in the end frees the program itself.
+ *
+ * Parameters:
+ * -----------
+ * ThreadedProgram *program     a pointer to the threaded program.
+ */
+void free_threaded_program(ThreadedProgram *program);
+
+/*
+ * Executes the predecoded commands of the given program in the given machine, like
+ * 'run_machine'. Each handler dispatches the next command with a computed goto when
+ * the compiler supports it, and with a switch otherwise. When a command changes a
+ * word that a command was predecoded from, only the commands of that word are
+ * predecoded again. Each handler that writes a memory word marks it in the bitmap
+ * of the written words of the machine. The interpreter stops before a command that
+ * has a breakpoint. Returns the state of the machine.
+ *
+ * Parameters:
+ * -----------
+ * Machine *machine                 a pointer to the machine.
+ * ThreadedProgram *program         a pointer to the program, predecoded for the machine.
+ * unsigned long max_instructions   the maximum number of commands to execute, or 0 for no limit.
+ */
+int run_threaded(Machine *machine, ThreadedProgram *program, unsigned long max_instructions);
+
+#endif
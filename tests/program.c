@@ -0,0 +1,56 @@
+#include <stdio.h>
+#include <string.h>
+#include "../library.h"
+
+#define NO_OF_TESTS 6 /* the number of programs that are assembled by the test */
+#define TEST_BUFFER_SIZE 1024 /* the size of each buffer of the result */
+
+int main(void) {
+    /* the programs, the status that assembling each of them should return, and the expected start of its errors */
+    const char *sources[NO_OF_TESTS] = {
+            "stop\n",
+            "mcro m\ninc @r1\n\nendmcro\nm\nstop\n",
+            "mcro m\n\nendmcro\nm\nstop\n",
+            "endmcro\nstop\n",
+            "X: .data\nstop\n",
+            "S: .string\nstop\n"
+    };
+    const int statuses[NO_OF_TESTS] = {
+            ASSEMBLY_SUCCEEDED, ASSEMBLY_SUCCEEDED, ASSEMBLY_SUCCEEDED, ASSEMBLY_FAILED, ASSEMBLY_FAILED, ASSEMBLY_FAILED
+    };
+    const char *diagnostics[NO_OF_TESTS] = {
+            "",
+            "",
+            "",
+            "Row: 1\t|  Error: Undefined command!",
+            "Row: 1\t|  Error: Missing arguments!",
+            "Row: 1\t|  Error: Missing arguments!"
+    };
+    unsigned short words[TEST_BUFFER_SIZE];
+    char entries[TEST_BUFFER_SIZE];
+    char externals[TEST_BUFFER_SIZE];
+    char errors[TEST_BUFFER_SIZE];
+    AssemblyResult result;
+    int status;
+    int failures = 0;
+    int index;
+
+    for (index = 0; index < NO_OF_TESTS; index++) {
+        result.words = words;
+        result.capacity = TEST_BUFFER_SIZE;
+        result.entries.buffer = entries;
+        result.entries.capacity = TEST_BUFFER_SIZE;
+        result.externals.buffer = externals;
+        result.externals.capacity = TEST_BUFFER_SIZE;
+        result.diagnostics.buffer = errors;
+        result.diagnostics.capacity = TEST_BUFFER_SIZE;
+
+        status = assemble_buffer(sources[index], strlen(sources[index]), &result);
+        if (status != statuses[index] || strncmp(errors, diagnostics[index], strlen(diagnostics[index])) != 0) {
+            printf("Test %d failed: status %d, errors: %s\n", index + 1, status, errors);
+            failures++;
+        }
+    }
+    printf("%d of %d tests passed\n", NO_OF_TESTS - failures, NO_OF_TESTS);
+    return failures ? 1 : 0;
+}
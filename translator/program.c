@@ -0,0 +1,11 @@
+#include "translator.h"
+
+int main(int argc, char *argv[]) {
+    int index;
+
+    /* each argument is a path to the output files of a program, without an extension */
+    for (index = 1; index < argc; index++) {
+        translate_program(argv[index]);
+    }
+    return 0;
+}
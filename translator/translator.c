@@ -0,0 +1,373 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "translator.h"
+#include "../absolutes.h"
+#include "../quantities.h"
+#include "../compiler.h"
+#include "../command_analysis/helpers.h"
+#include "../disassembler/disassembler.h"
+#include "../error_detection/errors.h"
+#include "../loader/loader.h"
+#include "../simulator/simulator.h"
+
+/*
+ * Stores the C expression of the given operand in the given text: the element of the
+ * registers array, a number, or the element of the memory array. Returns 0 if the
+ * operand is an external label that was not linked, and 1 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *text               the text to store the expression in (of MAX_OPERAND_TEXT_LENGTH characters).
+ * unsigned short *memory   the memory of the program.
+ * int addressing           the addressing code of the operand.
+ * int word_address         the address of the memory word of the operand.
+ * int register_shift       the index of the first bit of a register in the memory word.
+ */
+int format_operand(char *text, unsigned short *memory, int addressing, int word_address, int register_shift) {
+    unsigned int word = memory[word_address];
+    unsigned int value = decode_bit_field(word, ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT);
+
+    if (addressing == REGISTER_ADDRESSING_CODE) {
+        sprintf(text, "registers[%d]", decode_bit_field(word, ENCODING_REGISTER_LENGTH, register_shift) %
+                                       NO_OF_REGISTERS);
+        return 1;
+    }
+    if (addressing == IMMEDIATE_ADDRESSING_CODE) {
+        /* an immediate value is a signed number in the bits of the operand */
+        if (value >= (1 << (ENCODING_OPERAND_LENGTH - 1))) {
+            value = (value - (1 << ENCODING_OPERAND_LENGTH)) & MEMORY_WORD_MASK;
+        }
+        sprintf(text, "%u", value);
+        return 1;
+    }
+    if (decode_bit_field(word, ENCODING_ARE_LENGTH, ENCODING_ARE_SHIFT) == ARE_EXTERNAL_CODE) {
+        return 0;
+    }
+    sprintf(text, "memory[%u]", value);
+    return 1;
+}
+
+/*
+ * Returns the address of the memory word that the command in the given address
+ * writes to, if it writes to a label, and -1 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * unsigned short *memory               the memory of the program.
+ * const DecodingTemplate *template     the decoding template of the command.
+ * int address                          the address of the first word of the command.
+ */
+int get_label_destination(unsigned short *memory, const DecodingTemplate *template, int address) {
+    if ((template->opcode) == NO_OPCODE || (template->dest_addressing) != LABEL_ADDRESSING_CODE ||
+        (template->opcode) == CMP_OPCODE || (template->opcode) == PRN_OPCODE || (template->opcode) == JMP_OPCODE ||
+        (template->opcode) == BNE_OPCODE || (template->opcode) == JSR_OPCODE) {
+        return -1;
+    }
+    /* the word of a label destination is the last word of the command */
+    return decode_bit_field(memory[address + (template->memory_words) - 1], ENCODING_OPERAND_LENGTH,
+                            ENCODING_OPERAND_SHIFT);
+}
+
+/*
+ * Returns 1 if a command of the given program writes to its code words, and 0 otherwise.
+ * The translated commands are fixed, so such a program can't be translated.
+ *
+ * Parameters:
+ * -----------
+ * Disassembly *disassembly     a pointer to the disassembly of the program, after its commands were scanned.
+ */
+int is_self_modifying(Disassembly *disassembly) {
+    MachineImage *image = disassembly->image;
+    int code_end = (image->load_address) + (image->code_words);
+    int written_address;
+    int address;
+
+    for (address = image->load_address; address < code_end; address++) {
+        if (!(disassembly->command_starts)[address]) {
+            continue;
+        }
+        written_address = get_label_destination(image->memory, get_decoding_template((image->memory)[address]),
+                                                address);
+        if (written_address >= (image->load_address) && written_address < code_end) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Prints the beginning of the C file: the state of the machine as static variables,
+ * with the words of the program in the memory array, and the function that reports
+ * an error of the machine.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly of the program.
+ * char *program_path           the path to the program, without an extension.
+ */
+void print_translation_prologue(FILE *output, Disassembly *disassembly, char *program_path) {
+    MachineImage *image = disassembly->image;
+    int memory_end = (image->load_address) + (image->code_words) + (image->data_words);
+    int address;
+    int bits;
+    int bit;
+
+    fprintf(output, "/*\n * The program %s, translated to C. The program is executed when it's compiled\n", program_path);
+    fprintf(output, " * and run, and its optional argument is the maximum number of commands to execute.\n */\n");
+    fprintf(output, "#include <stdio.h>\n#include <stdlib.h>\n#include <limits.h>\n\n");
+    fprintf(output, "/* the label of the command in each address, which stops when the limit is reached */\n");
+    fprintf(output, "#define COMMAND(address) a##address: if (executed == limit) { return 0; } executed++;\n\n");
+
+    /* the words of the program, and the zero words before them */
+    fprintf(output, "/* the state of the machine (not static, so a program doesn't have to use all of it) */\n");
+    fprintf(output, "unsigned short memory[%d] = {", MACHINE_MEMORY_SIZE);
+    for (address = 0; address < memory_end; address++) {
+        fprintf(output, "%s%s%d", (address == 0) ? "" : ",", (address % MEMORY_WORDS_PER_LINE == 0) ? "\n    " : " ",
+                (image->memory)[address]);
+    }
+    fprintf(output, "\n};\n");
+    /* a bit for each value of a word, that indicates if it's a first word of a valid command */
+    fprintf(output, "const unsigned char first_words[%d] = {", (MEMORY_WORD_MASK + 1) / CHAR_BIT);
+    for (address = 0; address < (MEMORY_WORD_MASK + 1) / CHAR_BIT; address++) {
+        for (bits = 0, bit = 0; bit < CHAR_BIT; bit++) {
+            if (get_decoding_template((unsigned int) (address * CHAR_BIT + bit))->opcode != NO_OPCODE) {
+                bits |= 1 << bit;
+            }
+        }
+        fprintf(output, "%s%s%d", (address == 0) ? "" : ",", (address % MEMORY_WORDS_PER_LINE == 0) ? "\n    " : " ",
+                bits);
+    }
+    fprintf(output, "\n};\n");
+    fprintf(output, "unsigned short registers[%d];\n", NO_OF_REGISTERS);
+    fprintf(output, "int zero_flag;\nint negative_flag;\n");
+    fprintf(output, "int return_stack[%d];\nint stack_depth;\n", RETURN_STACK_SIZE);
+    fprintf(output, "unsigned long executed;\nunsigned long limit = ULONG_MAX;\n\n");
+
+    fprintf(output, "static int fault(int address, char *error_msg) {\n");
+    fprintf(output, "    printf(\"Address: %%d\\t|  Error: %%s\\n\", address, error_msg);\n");
+    fprintf(output, "    return 1;\n}\n\n");
+}
+
+/*
+ * Prints the switch that continues the translated program from the address in 'pc',
+ * which is used by the commands whose target is computed while the program runs.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly of the program.
+ */
+void print_dispatch(FILE *output, Disassembly *disassembly) {
+    MachineImage *image = disassembly->image;
+    int code_end = (image->load_address) + (image->code_words);
+    int address;
+
+    fprintf(output, "dispatch:\n    switch (pc) {\n");
+    for (address = image->load_address; address < code_end; address++) {
+        if ((disassembly->command_starts)[address]) {
+            fprintf(output, "        case %d: goto a%d;\n", address, address);
+        }
+    }
+    fprintf(output, "    }\n");
+    /* the machine doesn't execute a word that is not a command if it has reached the limit */
+    fprintf(output, "    if (executed == limit) {\n        return 0;\n    }\n");
+    fprintf(output, "    if (!((first_words[memory[pc] / CHAR_BIT] >> (memory[pc] %% CHAR_BIT)) & 1)) {\n");
+    fprintf(output, "        return fault(pc, \"%s\");\n    }\n", ILLEGAL_INSTRUCTION);
+    fprintf(output, "    return fault(pc, \"%s\");\n", UNTRANSLATED_ADDRESS);
+}
+
+/*
+ * Prints the statement that continues the translated program from the given address:
+ * a jump to its label if it has one, and a jump to the dispatch switch otherwise.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly of the program.
+ * char *indentation            the indentation of the statement.
+ * int address                  the address to continue from.
+ */
+void print_continuation(FILE *output, Disassembly *disassembly, char *indentation, int address) {
+    if (address >= 0 && address < MACHINE_MEMORY_SIZE && (disassembly->command_starts)[address]) {
+        fprintf(output, "%sgoto a%d;\n", indentation, address);
+    } else {
+        fprintf(output, "%spc = %d;\n%sgoto dispatch;\n", indentation, address, indentation);
+    }
+}
+
+/*
+ * Prints the labeled block of the command in the given address, with the command
+ * itself in a comment.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly of the program.
+ * int address                  the address of the first word of the command.
+ */
+void print_translated_command(FILE *output, Disassembly *disassembly, int address) {
+    unsigned short *memory = disassembly->image->memory;
+    const DecodingTemplate *template = get_decoding_template(memory[address]);
+    char src[MAX_OPERAND_TEXT_LENGTH + 1];
+    char dest[MAX_OPERAND_TEXT_LENGTH + 1];
+    int next_address = address + (template->memory_words);
+    int src_word = address + 1;
+    int dest_word;
+    int target = -1; /* the address of a label destination */
+
+    fprintf(output, "    /* ");
+    print_command(output, disassembly, address);
+    fprintf(output, "     */\n    COMMAND(%d)\n", address);
+
+    /* two registers are stored in the same memory word */
+    dest_word = ((template->src_addressing) == 0 || ((template->src_addressing) == REGISTER_ADDRESSING_CODE &&
+                                                     (template->dest_addressing) == REGISTER_ADDRESSING_CODE))
+                ? src_word : src_word + 1;
+    if (((template->src_addressing) != 0 && !format_operand(src, memory, template->src_addressing, src_word,
+                                                            ENCODING_SRC_REGISTER_SHIFT)) ||
+        ((template->dest_addressing) != 0 && !format_operand(dest, memory, template->dest_addressing, dest_word,
+                                                             ENCODING_DEST_REGISTER_SHIFT))) {
+        fprintf(output, "    return fault(%d, \"%s\");\n", address, UNRESOLVED_EXTERNAL_OPERAND);
+        return;
+    }
+    if ((template->dest_addressing) == LABEL_ADDRESSING_CODE) {
+        target = decode_bit_field(memory[dest_word], ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT);
+    }
+
+    switch (template->opcode) {
+        case MOV_OPCODE:
+            fprintf(output, "    %s = %s;\n", dest, src);
+            break;
+        case CMP_OPCODE:
+            fprintf(output, "    zero_flag = (%s == %s);\n", src, dest);
+            fprintf(output, "    negative_flag = ((((unsigned int) %s - %s) & 0x%X) != 0);\n", src, dest,
+                    NEGATIVE_WORD_BIT);
+            break;
+        case ADD_OPCODE:
+        case SUB_OPCODE:
+            fprintf(output, "    %s = (unsigned short) (((unsigned int) %s %c %s) & 0x%X);\n", dest, dest,
+                    ((template->opcode) == ADD_OPCODE) ? '+' : '-', src, MEMORY_WORD_MASK);
+            break;
+        case NOT_OPCODE:
+            fprintf(output, "    %s = (unsigned short) (~(unsigned int) %s & 0x%X);\n", dest, dest, MEMORY_WORD_MASK);
+            break;
+        case CLR_OPCODE:
+            fprintf(output, "    %s = 0;\n", dest);
+            break;
+        case LEA_OPCODE:
+            fprintf(output, "    %s = %d;\n", dest,
+                    decode_bit_field(memory[src_word], ENCODING_OPERAND_LENGTH, ENCODING_OPERAND_SHIFT));
+            break;
+        case INC_OPCODE:
+        case DEC_OPCODE:
+            fprintf(output, "    %s = (unsigned short) (((unsigned int) %s %c 1) & 0x%X);\n", dest, dest,
+                    ((template->opcode) == INC_OPCODE) ? '+' : '-', MEMORY_WORD_MASK);
+            break;
+        case RED_OPCODE:
+            /* the end of the input is read as -1 */
+            fprintf(output, "    character = getchar();\n");
+            fprintf(output, "    %s = (unsigned short) ((character == EOF) ? 0x%X : (character & 0x%X));\n", dest,
+                    MEMORY_WORD_MASK, MEMORY_WORD_MASK);
+            break;
+        case PRN_OPCODE:
+            fprintf(output, "    putchar(%s & 0x%X);\n", dest, CHARACTER_MASK);
+            break;
+        case BNE_OPCODE:
+            fprintf(output, "    if (!zero_flag) {\n");
+            if (target >= 0) {
+                print_continuation(output, disassembly, "        ", target);
+            } else {
+                fprintf(output, "        pc = %s;\n        goto dispatch;\n", dest);
+            }
+            fprintf(output, "    }\n");
+            break;
+        case JSR_OPCODE:
+            fprintf(output, "    if (stack_depth == %d) {\n        return fault(%d, \"%s\");\n    }\n",
+                    RETURN_STACK_SIZE, address, RETURN_STACK_OVERFLOW);
+            fprintf(output, "    return_stack[stack_depth++] = %d;\n", next_address);
+            /* falls through - the subroutine jumps to its destination */
+        case JMP_OPCODE:
+            if (target >= 0) {
+                print_continuation(output, disassembly, "    ", target);
+            } else {
+                fprintf(output, "    pc = %s;\n    goto dispatch;\n", dest);
+            }
+            return;
+        case RTS_OPCODE:
+            fprintf(output, "    if (stack_depth == 0) {\n        return fault(%d, \"%s\");\n    }\n", address,
+                    RETURN_STACK_UNDERFLOW);
+            fprintf(output, "    pc = return_stack[--stack_depth];\n    goto dispatch;\n");
+            return;
+        case STOP_OPCODE:
+            fprintf(output, "    return 0;\n");
+            return;
+    }
+    /* the block of the next command is printed right after this block */
+    if (next_address >= (disassembly->image->load_address) + (disassembly->image->code_words) ||
+        !(disassembly->command_starts)[next_address]) {
+        print_continuation(output, disassembly, "    ", next_address);
+    }
+}
+
+/*
+ * Writes the given loaded program as a C file, that executes it like the machine when
+ * it's compiled: each command is a labeled block, and the blocks follow each other as
+ * the commands do. A jump to a label is a 'goto', and a jump to a register or a return
+ * from a subroutine goes through a switch over the addresses of the commands. Returns
+ * 1 if the file was written, and 0 if the program can't be translated.
+ *
+ * Parameters:
+ * -----------
+ * char *program_path   the path to the program, without an extension.
+ */
+int translate_program(char *program_path) {
+    MachineImage *image = load_machine_image(program_path);
+    Disassembly *disassembly;
+    char *translation_path;
+    FILE *output;
+    int code_end;
+    int address;
+
+    if (image == NULL) {
+        printf("%s: the program has no valid object file\n", program_path);
+        return 0;
+    }
+    disassembly = create_disassembly(image);
+    scan_commands(disassembly);
+    if (is_self_modifying(disassembly)) {
+        printf("%s: the program changes its own code, so it can't be translated\n", program_path);
+        free_disassembly(disassembly);
+        free_machine_image(image);
+        return 0;
+    }
+    translation_path = create_file_path(program_path, TRANSLATION_FILE_EXTENSION);
+    if ((output = fopen(translation_path, "w")) == NULL) {
+        printf("%s: could not create the file %s\n", program_path, translation_path);
+        free(translation_path);
+        free_disassembly(disassembly);
+        free_machine_image(image);
+        return 0;
+    }
+    print_translation_prologue(output, disassembly, program_path);
+
+    fprintf(output, "int main(int argc, char *argv[]) {\n    int pc = %d;\n    int character;\n\n",
+            image->load_address);
+    fprintf(output, "    if (argc > 1 && strtoul(argv[1], NULL, 10) > 0) {\n");
+    fprintf(output, "        limit = strtoul(argv[1], NULL, 10);\n    }\n    (void) character;\n    goto dispatch;\n");
+    print_dispatch(output, disassembly);
+
+    code_end = (image->load_address) + (image->code_words);
+    for (address = image->load_address; address < code_end; address++) {
+        if ((disassembly->command_starts)[address]) {
+            print_translated_command(output, disassembly, address);
+        }
+    }
+    fprintf(output, "}\n");
+    fclose(output);
+    free(translation_path);
+    free_disassembly(disassembly);
+    free_machine_image(image);
+    return 1;
+}
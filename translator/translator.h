@@ -0,0 +1,110 @@
+#ifndef ASSEMBLER_SIMULATOR_TRANSLATOR_H
+#define ASSEMBLER_SIMULATOR_TRANSLATOR_H
+
+#include <stdio.h>
+#include "../types.h"
+
+#define TRANSLATION_FILE_EXTENSION "_translated.c" /* the extension of the C file of a translated program */
+#define MAX_OPERAND_TEXT_LENGTH 16 /* the maximum number of characters in the C expression of an operand */
+#define MEMORY_WORDS_PER_LINE 12 /* the number of initial memory words in a line of the C file */
+
+/*
+ * Stores the C expression of the given operand in the given text: the element of the
+ * registers array, a number, or the element of the memory array. Returns 0 if the
+ * operand is an external label that was not linked, and 1 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * char *text               the text to store the expression in (of MAX_OPERAND_TEXT_LENGTH characters).
+ * unsigned short *memory   the memory of the program.
+ * int addressing           the addressing code of the operand.
+ * int word_address         the address of the memory word of the operand.
+ * int register_shift       the index of the first bit of a register in the memory word.
+ */
+int format_operand(char *text, unsigned short *memory, int addressing, int word_address, int register_shift);
+
+/*
+ * Returns the address of the memory word that the command in the given address
+ * writes to, if it writes to a label, and -1 otherwise.
+ *
+ * Parameters:
+ * -----------
+ * unsigned short *memory               the memory of the program.
+ * const DecodingTemplate *template     the decoding template of the command.
+ * int address                          the address of the first word of the command.
+ */
+int get_label_destination(unsigned short *memory, const DecodingTemplate *template, int address);
+
+/*
+ * Returns 1 if a command of the given program writes to its code words, and 0 otherwise.
+ * The translated commands are fixed, so such a program can't be translated.
+ *
+ * Parameters:
+ * -----------
+ * Disassembly *disassembly     a pointer to the disassembly of the program, after its commands were scanned.
+ */
+int is_self_modifying(Disassembly *disassembly);
+
+/*
+ * Prints the beginning of the C file: the state of the machine as static variables,
+ * with the words of the program in the memory array, and the function that reports
+ * an error of the machine.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly of the program.
+ * char *program_path           the path to the program, without an extension.
+ */
+void print_translation_prologue(FILE *output, Disassembly *disassembly, char *program_path);
+
+/*
+ * Prints the switch that continues the translated program from the address in 'pc',
+ * which is used by the commands whose target is computed while the program runs.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly of the program.
+ */
+void print_dispatch(FILE *output, Disassembly *disassembly);
+
+/*
+ * Prints the statement that continues the translated program from the given address:
+ * a jump to its label if it has one, and a jump to the dispatch switch otherwise.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly of the program.
+ * char *indentation            the indentation of the statement.
+ * int address                  the address to continue from.
+ */
+void print_continuation(FILE *output, Disassembly *disassembly, char *indentation, int address);
+
+/*
+ * Prints the labeled block of the command in the given address, with the command
+ * itself in a comment.
+ *
+ * Parameters:
+ * -----------
+ * FILE *output                 the file to print to.
+ * Disassembly *disassembly     a pointer to the disassembly of the program.
+ * int address                  the address of the first word of the command.
+ */
+void print_translated_command(FILE *output, Disassembly *disassembly, int address);
+
+/*
+ * Writes the given loaded program as a C file, that executes it like the machine when
+ * it's compiled: each command is a labeled block, and the blocks follow each other as
+ * the commands do. A jump to a label is a 'goto', and a jump to a register or a return
+ * from a subroutine goes through a switch over the addresses of the commands. Returns
+ * 1 if the file was written, and 0 if the program can't be translated.
+ *
+ * Parameters:
+ * -----------
+ * char *program_path   the path to the program, without an extension.
+ */
+int translate_program(char *program_path);
+
+#endif
@@ -1,21 +1,27 @@
 #ifndef ASSEMBLER_SIMULATOR_TYPES_H
 #define ASSEMBLER_SIMULATOR_TYPES_H
 
+#include <stdio.h>
 #include "quantities.h"
+#include "data_structures/string_pool.h"
+#include "data_structures/segment.h"
+#include "data_structures/output_buffer.h"
+#include "data_structures/dynamic_array.h"
 
 /*
  * A structure that represent a Macro in the program. Each macro
  * in the program has a name, a starting index, and a finish index.
  * The starting index is the index of the row in the program in which
  * the macro starts, and the finish index is the index of the row in
- * the program in which the macro ends.
+ * the program in which the macro ends. The name of the macro is stored
+ * in the string pool, and macros are compared by the id of their name.
  */
 typedef struct {
-    char name[MAX_FIELD_LENGTH]; /* the name of the macro. */
+    int id; /* the id of the name of the macro in the string pool. */
+    char *name; /* the name of the macro. */
     int start_index; /* the index of the row in the program that the macro starts. */
     int finish_index; /* the index of the row in the program that the macro ends. */
-    int calls[MAX_NO_OF_COMMANDS]; /* the indexes of the rows in the program where the macro have been called.
- * In the end of the list of indexes, there will be a zero */
+    DynamicArray *calls; /* the ProgramLine of each row in the program where the macro has been called */
 } Macro;
 
 /*
@@ -23,10 +29,12 @@ typedef struct {
  * Any label have a unique name, the address which was assigned
  * to it (IC/DC), a field that tells if the label is assigned to a
  * command or a data declaration, and the index of the row the
- * label is found in.
+ * label is found in. The name of the label is stored in the string
+ * pool, and labels are compared by the id of their name.
  */
 typedef struct {
-    char name[MAX_FIELD_LENGTH]; /* the name of the label. */
+    int id; /* the id of the name of the label in the string pool. */
+    char *name; /* the name of the label. */
     int address; /* the address of the label IC/DC (if the label is assigned to a command,
  * then the address is IC, and DC if assigned to data. */
     int type; /* the type (extern/string/data) of the label is an integer. */
@@ -41,16 +49,32 @@ typedef struct {
  * an immediate, then the 'data' is the immediate number.
  * The type of the data could be inferred by the addressing
  * method of the operand, and with that, the user can
- * translate the data to different types.
+ * translate the data to different types. The data is stored in the
+ * same memory block, right after the structure.
  */
 typedef struct {
     int addressing; /* the addressing code of the operand */
     int start; /* the index in which the operand starts in the command */
     int end; /* the index in which the operand ends in the command */
     int ARE; /* the A.R.E bits */
-    char data[MAX_FIELD_LENGTH];
+    int id; /* the id of the operand in the string pool if it's an identifier, and NO_STRING_ID otherwise */
+    int value; /* the number of the operand if it's an immediate or a register */
+    char *data; /* the characters of the operand */
 } Operand;
 
+/*
+ * A ResolvedOperand structure stores an operand of a command after it was analyzed.
+ * Instead of the characters of the operand, it stores its value: the number of an
+ * immediate, the number of a register, or the id of a label in the string pool. The
+ * type of the value could be inferred by the addressing method of the operand. An
+ * operand that the command doesn't have, has an addressing code of 0.
+ */
+typedef struct {
+    unsigned char addressing; /* the addressing code of the operand */
+    unsigned char ARE; /* the A.R.E bits */
+    int value; /* the immediate, the register number or the label id of the operand */
+} ResolvedOperand;
+
 /*
  * The Command structure is a structure that was build
  * to hold the data of each Command in the program, after
@@ -58,31 +82,270 @@ typedef struct {
  * at most two operands. The following data about the command,
  * is sufficient to determine the number of data words the command
  * would be translated to (1-3 words), and the content of each
- * word of data in the translation.
+ * word of data in the translation. A command with a single operand
+ * stores it as its destination operand. The structure is kept small,
+ * so that the commands of the whole program are stored next to each
+ * other in the commands table, and they are passed by pointer.
  */
 typedef struct {
-    int opcode;
-    int type; /* how many operands does the command gets (0, 1, or 2). */
-    Operand first_operand;
-    Operand second_operand;
-    int ARE; /* the A.R.E bits */
+    unsigned char opcode;
+    unsigned char type; /* how many operands does the command gets (0, 1, or 2). */
+    unsigned char ARE; /* the A.R.E bits */
     int index; /* the index of the row in the program that the command is found in. */
-    char data[MAX_COMMAND_LENGTH]; /* all the characters of the command itself. */
+    ResolvedOperand source_operand;
+    ResolvedOperand destination_operand;
 } Command;
 
+/*
+ * A CommandsTable structure stores the Command structures of all the commands in
+ * the program, in the order they appear in the program, in a single memory block.
+ * The 'commands' array grows automatically when a command is added to the table.
+ */
+typedef struct {
+    Command *commands; /* the commands of the program */
+    int length; /* the number of commands in the table */
+    int capacity; /* the number of commands that can be stored before the array has to grow */
+} CommandsTable;
+
+/*
+ * An ObjectHeader structure is the fixed header in the beginning of a binary object
+ * file. It is followed by the code words, the data words, the entries table, the
+ * external references table, and the names of the labels, in this order. All the
+ * fields are 16-bit little-endian words, and the size of the header is a multiple
+ * of 4 bytes, so every table in the file is aligned to its fields.
+ */
+typedef struct {
+    char magic[BINARY_OBJECT_MAGIC_LENGTH]; /* the characters of BINARY_OBJECT_MAGIC, without a null terminator */
+    unsigned short version; /* the version of the binary object format */
+    unsigned short load_address; /* the address that the code words are loaded to */
+    unsigned short code_words; /* the number of code words (the final IC) */
+    unsigned short data_words; /* the number of data words (the final DC) */
+    unsigned short no_of_entries; /* the number of ObjectSymbol structures in the entries table */
+    unsigned short no_of_externals; /* the number of ObjectSymbol structures in the external references table */
+    unsigned short strings_size; /* the number of bytes in the names of the labels, padded to a whole word */
+    unsigned short reserved; /* always 0 */
+} ObjectHeader;
+
+/*
+ * An ObjectSymbol structure is a row in the entries table or in the external references
+ * table of a binary object file. An entry stores the address that the label is defined
+ * in, and an external reference stores the address of the word that the label is used in.
+ */
+typedef struct {
+    unsigned short name_offset; /* the offset of the null-terminated name of the label in the names */
+    unsigned short address; /* the address of the label, or of the word that uses it */
+} ObjectSymbol;
+
+/*
+ * A LoadedSymbols structure stores the symbols that were loaded from the output files
+ * of a program (its entries, or its uses of external labels), in the order they appear
+ * in the file. The names of the symbols are stored in a string pool, so a symbol is
+ * found by its name with a single hash lookup. The arrays grow automatically when a
+ * symbol is added, and a LoadedSymbols with all its fields set to zero is empty.
+ */
+typedef struct {
+    StringPool names; /* the distinct names of the symbols */
+    int *ids; /* the id of the name of each symbol in the pool */
+    int *addresses; /* the address of each symbol */
+    int *first_indexes; /* for each name id, the index of the first symbol with this name */
+    int length; /* the number of symbols */
+    int capacity; /* the number of symbols that can be stored before the arrays have to grow */
+} LoadedSymbols;
+
+/*
+ * A MachineImage structure stores a program after it was loaded from its output files:
+ * the memory of the machine, with the code words of the program starting from its load
+ * address and its data words right after them, and the symbols of the program.
+ */
+typedef struct {
+    unsigned short *memory; /* the MACHINE_MEMORY_SIZE words of the memory of the machine */
+    int load_address; /* the address of the first code word */
+    int code_words; /* the number of code words (the final IC) */
+    int data_words; /* the number of data words (the final DC) */
+    LoadedSymbols entries; /* the entry labels of the program, and the addresses they are defined in */
+    LoadedSymbols externals; /* the external labels of the program, and the addresses they are used in */
+} MachineImage;
+
+/*
+ * A LinkedModule structure stores a module of a linked program: its image, as it was
+ * loaded from its own output files, and its placement in the linked image. The code
+ * words of all the modules are placed one after the other from the load address, and
+ * their data words are placed after the code words of the last module, in the same order.
+ */
+typedef struct {
+    char *path; /* the path to the output files of the module, without an extension */
+    MachineImage *image; /* the module, as it was loaded */
+    int code_address; /* the address of the first code word of the module in the linked image */
+    int data_address; /* the address of the first data word of the module in the linked image */
+    unsigned long signature; /* a hash of the sizes and the modification times of the output files of the module */
+    unsigned long hash[2]; /* a hash of the contents of the output files of the module */
+    long state_offset; /* the offset of the fields of the module in the link state file it was read from */
+} LinkedModule;
+
+/*
+ * A PatchSite structure stores a use of an external label in a module of a linked
+ * program: a word in the linked image that holds the address of an entry label of
+ * another module, and has to be patched whenever the entry label moves.
+ */
+typedef struct {
+    int module_index; /* the index of the module that uses the label */
+    int address; /* the address of the use in the linked image */
+    int next_site; /* the index of the next site of the same label, or -1 */
+} PatchSite;
+
+/*
+ * A LinkState structure stores a linked program between its links: its modules, the
+ * global entry labels, and a reverse index from the name of each label to the sites
+ * that use it, so that a changed module is patched by touching only its own entries
+ * and their sites. Each name has an id in the pool of 'entries', and the arrays of the
+ * names are indexed by this id. The sites of a name are chained through 'next_site',
+ * and the sites that were removed are chained from 'free_sites' to be reused.
+ */
+typedef struct {
+    LinkedModule *modules; /* the modules of the program, as they were read from the link state file */
+    int no_of_modules; /* the number of modules */
+    int code_words; /* the number of code words of the linked program */
+    int data_words; /* the number of data words of the linked program */
+    LoadedSymbols entries; /* each label name once, with the address of its entry in the linked image, or -1 */
+    int *entry_modules; /* for each name, the index of the module that defines its entry, or -1 */
+    int *first_sites; /* for each name, the index of its first site, or -1 */
+    int names_capacity; /* the number of names that can be stored before the arrays have to grow */
+    PatchSite *sites; /* the uses of the external labels of the modules */
+    int no_of_sites; /* the number of sites in the array, including the removed sites */
+    int sites_capacity; /* the number of sites that can be stored before the array has to grow */
+    int free_sites; /* the index of the first removed site, or -1 */
+    int entries_flag; /* indicates if an entry label was added, removed or moved by a patch */
+} LinkState;
+
+/*
+ * A LineRecord structure stores the analysis of a single line of the program, so
+ * that a line that was already analyzed in a previous assembly is not analyzed again.
+ * The analysis of a line depends only on its characters, and therefore all the rows
+ * of the program with the same characters share the same record. The memory words
+ * of a command depend on the labels it uses, so the record keeps the versions of its
+ * label operands, to find out if the command has to be encoded again.
+ */
+typedef struct {
+    int type; /* the definition code of the line, or 0 if the line is empty */
+    char *error_msg; /* the error that was found in the line, or NULL if the line is valid */
+    int label_id; /* the id of the label that the line defines or declares, or NO_STRING_ID */
+    int no_of_words; /* the number of memory words of the command, or of the data of the declaration */
+    Command command; /* the command of the line, if it's a regular command */
+    int encoded; /* the number of the assembly that encoded the command to the 'words' segment, or 0 */
+    int label_versions[2]; /* the versions of the source and destination label operands, when it was encoded */
+    Segment words; /* the memory words of the command, or of the data of the declaration */
+} LineRecord;
+
+/*
+ * A RowState structure stores a row of the program in its previous assembly: the
+ * line of the row, and the counters before the row, so that the next assembly
+ * starts counting from the first row that has changed.
+ */
+typedef struct {
+    int line_id; /* the id of the line of the row in the lines pool */
+    int IC; /* the number of code words before the row */
+    int DC; /* the number of data words before the row */
+    int command_index; /* the number of commands before the row */
+} RowState;
+
+/*
+ * A LabelState structure stores the labels of an identifier of the string pool between
+ * assemblies, so that a label is found without a search in the symbols table, and only
+ * the commands that use a label whose address or type has changed are encoded again.
+ */
+typedef struct {
+    Label *label; /* the first label in the symbols table with the identifier, or NULL */
+    Label *previous_label; /* the label with the identifier that was removed in the current assembly, or NULL */
+    int version; /* increases whenever the label with the identifier changes */
+    int no_of_entries; /* the number of entry declarations of the identifier */
+} LabelState;
+
+/*
+ * An IncrementalState structure stores the analysis of the lines of a program between
+ * its assemblies. Each distinct line that was analyzed has an id in the lines pool,
+ * and its record is stored in the same index of the 'records' array, which grows
+ * automatically when a new line is added to the pool. The state also keeps the rows,
+ * the symbols table and the commands table of the previous assembly, and the next
+ * assembly changes them only from the first row that has changed.
+ */
+typedef struct {
+    StringPool lines_pool; /* the distinct lines that were analyzed */
+    LineRecord *records; /* the record of each line in the pool, in the order of their ids */
+    int capacity; /* the number of records that can be stored before the array has to grow */
+    RowState *rows; /* the state of each row of the previous assembly, and the counters after its last row */
+    int no_of_rows; /* the number of rows in the previous assembly, or 0 if its tables were reset */
+    int rows_capacity; /* the number of rows that can be stored before the array has to grow */
+    DynamicArray *symbols_table; /* the labels of the program, in the order of their rows */
+    CommandsTable commands_table; /* the commands of the program, in the order of their rows */
+    LabelState *labels; /* the state of each identifier of the string pool, in the order of their ids */
+    int labels_capacity; /* the number of identifiers that can be stored before the array has to grow */
+    int valid; /* indicates if the counters, the tables and the segments belong to the rows of the state */
+    int no_of_assemblies; /* the number of assemblies with the state */
+    int first_code_word; /* the first word of the code segment that was changed in the last assembly */
+    int first_data_word; /* the first word of the data segment that was changed in the last assembly */
+    char *source; /* the characters of the program in its previous assembly, or NULL */
+    long source_length; /* the number of characters in the source */
+    DynamicArray *program_lines; /* the lines of the source, or NULL */
+    int no_of_macro_lines; /* the number of program lines that start or end a macro definition */
+    int expanded_flag; /* indicates if the rows of the previous assembly were expanded from macros */
+    int outputs_flag; /* indicates if the object files of the previous assembly were written */
+} IncrementalState;
+
 /*
  * A Field structure represents a segment in the command that stores a crucial value
  * to understand the command. The 'start' field is the index in which the field starts
  * in the command, and the 'end' is the index in which it ends in the command. As an
  * example, the name of the command, the label of the command, and the first operand
  * of the command are fields that will be represented using the Field structure.
+ * The content of the field is a copy of the characters between 'start' and 'end',
+ * and it is stored in the same memory block, right after the structure.
  */
 typedef struct {
-    char content[MAX_FIELD_LENGTH];
+    char *content; /* the characters of the field */
+    int id; /* the id of the identifier in the field (without a label ending character) in the string pool,
+ * and NO_STRING_ID if the field is not an identifier */
     int start; /* the index in which the field starts in the command */
     int end; /* the index in which the field ends in the command */
+    int type; /* the code of the token that the field holds */
+    int value; /* the value of the token that the field holds */
+    int preceding_commas; /* the number of commas between the previous field and this field */
 } Field;
 
+/*
+ * A Token structure represents a single token that the lexer found in a line of the
+ * program. The type of the token is one of the token codes, and its characters are
+ * the characters of the line between 'start' and 'end' (including both of them).
+ * The value of the token depends on its type: the number of an immediate or a register,
+ * the index of the operation of a mnemonic, or the definition code of a directive.
+ */
+typedef struct {
+    int type; /* the code of the token */
+    int start; /* the index in which the token starts in the line */
+    int end; /* the index in which the token ends in the line */
+    int value; /* the value of the token */
+} Token;
+
+/*
+ * A TokensList structure stores the tokens of a single line, in the order they
+ * appear in the line. The 'tokens' array grows automatically when a token is added.
+ */
+typedef struct {
+    Token *tokens; /* the tokens of the line */
+    int length; /* the number of tokens in the list */
+    int capacity; /* the number of tokens that can be stored before the array has to grow */
+} TokensList;
+
+/*
+ * A ProgramLine structure stores a line of the program with the results of the lexer.
+ * Each line is lexed once, when it's read, and every analysis of the line uses its
+ * tokens and its fields instead of lexing the characters of the line again.
+ */
+typedef struct {
+    char *content; /* the characters of the line */
+    TokensList *tokens_list; /* the tokens of the line, including the commas */
+    DynamicArray *positions_array; /* a Field structure for each token of the line, except of the commas */
+} ProgramLine;
+
 /*
  * A structure that defines an Operation in the program. Each Operation structure
  * has its own 'opcode', 'type', and more attributes such as its 'name' and the
@@ -91,56 +354,333 @@ typedef struct {
 typedef struct {
     int opcode; /* the opcode of the operation */
     int type; /* how many operands does the command gets (0, 1, or 2). */
-    char name[MAX_FIELD_LENGTH]; /* the name of the operation */
+    char *name; /* the name of the operation */
     int source_operand_addressing[NO_OF_ADDRESSING_METHODS]; /* the addressing methods that the source operand can accept */
     int destination_operand_addressing[NO_OF_ADDRESSING_METHODS]; /* the addressing methods that the destination operand can accept */
 } Operation;
 
 /*
- * An Encode structure stores the information that will be used to encode
- * a command into the code segment. In fact, the Encode structure already
- * stores the encodings of all the words of the command, and stores how many
- * words the command takes, in the 'type' field, in order to know how many
- * encodings to use.
+ * An EncodingTemplate structure stores the precomputed encoding of the first
+ * memory word of a command, for a specific opcode and a specific pair of
+ * addressing methods, and the number of memory words that such a command
+ * takes. The templates are stored in the encoding table, so that encoding a
+ * command only needs to fill the words of its operands.
  */
 typedef struct {
+    unsigned int first_word; /* the encoding of the first memory word of the command */
     int memory_words; /* how many memory words does the command need. */
-    unsigned int encodings_array[MAX_NO_OF_WORDS_IN_COMMAND]; /* an array of all the encodings words of the command */
-} Encode;
+} EncodingTemplate;
+
+/*
+ * A DecodingTemplate structure stores the decoding of a single value of the first
+ * memory word of a command: the operation and the addressing methods that the word
+ * encodes, and the number of memory words of the command. The templates are stored
+ * in the decoding table, so that a command is decoded with a single lookup.
+ */
+typedef struct {
+    int opcode; /* the opcode of the operation, or NO_OPCODE if the word is not a first word of a valid command */
+    int src_addressing; /* the addressing code of the source operand, or 0 if there's no source operand */
+    int dest_addressing; /* the addressing code of the destination operand, or 0 if there's no destination operand */
+    int memory_words; /* how many memory words does the command need */
+} DecodingTemplate;
+
+/*
+ * A Disassembly structure stores what the disassembler knows about the addresses of
+ * a loaded program: the label that is defined in each address, the external label
+ * that is used in each address, and the addresses that start a command. The names
+ * of the labels are stored in a string pool, and each address stores the id of its name.
+ */
+typedef struct {
+    MachineImage *image; /* the program to disassemble */
+    StringPool names; /* the names of the labels of the program */
+    int *label_ids; /* the id of the label that is defined in each address, or NO_STRING_ID */
+    int *external_ids; /* the id of the external label that is used in each address, or NO_STRING_ID */
+    unsigned char *command_starts; /* indicates if each address is the first word of a command */
+} Disassembly;
+
+/*
+ * A Machine structure stores the state of a program while it's executed: its memory
+ * (the memory of its loaded image, which the program may change), its registers, its
+ * program counter, the flags of the last comparison and the return addresses of the
+ * subroutines that were called. When the machine stops because of an error, the error
+ * and the address of the command are stored in it.
+ */
+typedef struct {
+    unsigned short *memory; /* the MACHINE_MEMORY_SIZE words of the memory of the machine */
+    unsigned short registers[NO_OF_REGISTERS]; /* the values of the registers */
+    int program_counter; /* the address of the next command */
+    int zero_flag; /* indicates if the operands of the last comparison were equal */
+    int negative_flag; /* indicates if the first operand of the last comparison was smaller */
+    int return_stack[RETURN_STACK_SIZE]; /* the return address of each subroutine that was called */
+    int stack_depth; /* the number of return addresses in the stack */
+    unsigned long executed_instructions; /* the number of commands that were executed */
+    int state; /* indicates if the machine is running, stopped or stopped because of an error */
+    char *error_msg; /* the error that stopped the machine, or NULL */
+    int error_address; /* the address of the command that caused the error */
+    FILE *input; /* the stream that the program reads characters from */
+    FILE *output; /* the stream that the program prints characters to */
+    unsigned char *dirty_words; /* a bit for each word that was written since the last snapshot, or NULL */
+} Machine;
+
+/*
+ * A MachineSnapshot structure stores the state of a machine when the snapshot was
+ * taken: a copy of its memory, its registers, its program counter, its flags and its
+ * return addresses. The machine marks the words that it writes after the snapshot,
+ * so only these words are copied back when the snapshot is restored.
+ */
+typedef struct {
+    unsigned short memory[MACHINE_MEMORY_SIZE]; /* the words of the memory of the machine */
+    unsigned short registers[NO_OF_REGISTERS]; /* the values of the registers */
+    int program_counter; /* the address of the next command */
+    int zero_flag; /* indicates if the operands of the last comparison were equal */
+    int negative_flag; /* indicates if the first operand of the last comparison was smaller */
+    int return_stack[RETURN_STACK_SIZE]; /* the return address of each subroutine that was called */
+    int stack_depth; /* the number of return addresses in the stack */
+    unsigned long executed_instructions; /* the number of commands that were executed */
+    int state; /* indicates if the machine is running, stopped or stopped because of an error */
+    char *error_msg; /* the error that stopped the machine, or NULL */
+    int error_address; /* the address of the command that caused the error */
+} MachineSnapshot;
+
+/*
+ * A MachineCheckpoint structure is the layout of a checkpoint file: the state of a
+ * machine while it executes a program, with the boundaries of the code of the program,
+ * the positions of its input and output streams, and its whole memory at the end, so
+ * the file can be mapped back to the memory and executed from the same state. The
+ * sizes of the machine are stored in the file, so a checkpoint of another machine
+ * is not resumed.
+ */
+typedef struct {
+    char magic[CHECKPOINT_MAGIC_LENGTH]; /* the characters that start every checkpoint file */
+    int memory_size; /* the number of words of the memory of the machine */
+    int no_of_registers; /* the number of registers of the machine */
+    int return_stack_size; /* the number of return addresses that the stack can store */
+    int load_address; /* the address of the first code word */
+    int code_words; /* the number of code words */
+    int data_words; /* the number of data words */
+    unsigned short registers[NO_OF_REGISTERS]; /* the values of the registers */
+    int program_counter; /* the address of the next command */
+    int zero_flag; /* indicates if the operands of the last comparison were equal */
+    int negative_flag; /* indicates if the first operand of the last comparison was smaller */
+    int return_stack[RETURN_STACK_SIZE]; /* the return address of each subroutine that was called */
+    int stack_depth; /* the number of return addresses in the stack */
+    unsigned long executed_instructions; /* the number of commands that were executed */
+    long input_offset; /* the number of characters that the program read, or -1 if it's unknown */
+    long output_offset; /* the number of characters that the program printed, or -1 if it's unknown */
+    unsigned short memory[MACHINE_MEMORY_SIZE]; /* the words of the memory of the machine */
+} MachineCheckpoint;
+
+/*
+ * A ThreadedCommand structure stores a command of a program after it was predecoded
+ * for the threaded interpreter: the handler that executes it, and a pointer to the
+ * value of each of its operands, which is a register, a word of the memory, or the
+ * immediate value (or the address of a label) that is stored in the command itself.
+ * A command that is fused with the commands after it has the handler of the whole
+ * sequence, which reads the operands of the other commands from their own entries.
+ */
+typedef struct {
+    const void *label; /* the address of the code of the handler, when it's dispatched with a computed goto */
+    int handler; /* the index of the handler that executes the command (or the fused sequence) */
+    int single_handler; /* the index of the handler that executes the command alone */
+    int size; /* the number of memory words of the command */
+    int span; /* the number of memory words of the fused sequence that starts with the command */
+    unsigned short *src; /* a pointer to the value of the source operand */
+    unsigned short *dest; /* a pointer to the value of the destination operand */
+    unsigned short src_value; /* the immediate value or the address of the source operand */
+    unsigned short dest_value; /* the immediate value or the address of the destination operand */
+    unsigned char *dirty_byte; /* the byte of the bitmap of the written words of the machine that the command marks */
+    unsigned char dirty_bit; /* the bit of the written word in the byte (or of the address after the memory) */
+} ThreadedCommand;
+
+/*
+ * A BatchMachine structure stores the states of many copies of a machine (lanes),
+ * that execute the same program with different inputs. The memory and the registers
+ * are stored by words: the values of a word in all the lanes are adjacent, so a
+ * command is executed for all the lanes that reach it with the same loop. The lanes
+ * that execute the commands together (the group) are selected by a mask, and the
+ * group has a single program counter until its lanes take different branches.
+ */
+typedef struct {
+    int no_of_lanes; /* the number of copies of the machine */
+    unsigned short *memory; /* the MACHINE_MEMORY_SIZE words of each lane, the lanes of each word together */
+    unsigned short *registers; /* the NO_OF_REGISTERS registers of each lane, the lanes of each register together */
+    unsigned short *zero_flags; /* all the bits are set in each lane whose last comparison was equal */
+    unsigned short *negative_flags; /* all the bits are set in each lane whose last comparison was negative */
+    unsigned short *program_counters; /* the address of the next command of each lane */
+    int *return_stacks; /* the RETURN_STACK_SIZE return addresses of each lane, the lanes of each level together */
+    int *stack_depths; /* the number of return addresses of each lane */
+    unsigned long *executed_instructions; /* the number of commands that each lane executed */
+    int *states; /* indicates if each lane is running, stopped or stopped because of an error */
+    unsigned short *running; /* all the bits are set in each lane that may execute more commands */
+    char **error_msgs; /* the error that stopped each lane, or NULL */
+    int *error_addresses; /* the address of the command that stopped each lane because of an error */
+    unsigned short *mask; /* all the bits are set in each lane of the group that executes the current command */
+    int leader; /* a lane of the group, that the words of the commands are read from */
+    int group_flag; /* indicates if the group is selected, so its lanes may not have their program counters */
+    int group_address; /* the address of the next command of the group */
+    unsigned long group_steps; /* the number of commands that the group executed since it was selected */
+    unsigned long group_budget; /* the number of commands that the group may execute before it's selected again */
+    int lowest_waiting_address; /* the lowest program counter of a running lane that is not in the group */
+    unsigned char *written_words; /* the words that a lane may have changed, so the lanes may have other commands */
+    unsigned short *operand_rows; /* scratch rows of lanes, for the operands that are not in the memory */
+    int *operand_constants; /* the value that each scratch row is filled with, or -1 */
+    FILE **inputs; /* the stream that each lane reads characters from */
+    FILE **outputs; /* the stream that each lane prints characters to */
+} BatchMachine;
+
+/*
+ * A FusionPattern structure stores a sequence of adjacent commands that the threaded
+ * interpreter executes with a single fused handler: the handlers of the commands, in
+ * their order in the memory, and the handler of the whole sequence.
+ */
+typedef struct {
+    int handlers[MAX_FUSED_COMMANDS]; /* the handler of each command of the sequence */
+    int length; /* the number of commands in the sequence */
+    int fused_handler; /* the handler that executes the whole sequence */
+} FusionPattern;
+
+/*
+ * A Profile structure stores the number of times that each pair and each triple of
+ * adjacent commands were executed one after the other, by their opcodes.
+ */
+typedef struct {
+    unsigned long pairs[NO_OF_OPERATIONS][NO_OF_OPERATIONS]; /* the counter of each pair of opcodes */
+    unsigned long triples[NO_OF_OPERATIONS][NO_OF_OPERATIONS][NO_OF_OPERATIONS]; /* the counter of each triple */
+} Profile;
+
+/*
+ * A ProfiledSequence structure stores a pair or a triple of adjacent commands of a
+ * profile, by their opcodes, and the number of times that it was executed.
+ */
+typedef struct {
+    unsigned long count; /* the number of times that the sequence was executed */
+    int opcodes[MAX_FUSED_COMMANDS]; /* the opcode of each command of the sequence */
+    int length; /* the number of commands in the sequence */
+} ProfiledSequence;
+
+/*
+ * A ThreadedProgram structure stores a predecoded command for each address of the
+ * memory of a machine, and the boundaries of the code that was predecoded. A command
+ * that was not predecoded is executed by decoding it from the memory. The words that
+ * the commands were predecoded from are marked, so a command is predecoded again
+ * only if one of its own words is changed.
+ */
+typedef struct {
+    ThreadedCommand *commands; /* the command of each address, and an extra command after the memory */
+    int code_start; /* the address of the first code word */
+    int code_end; /* the address after the last code word */
+    unsigned char *cached_words; /* a bit for each word that a predecoded command was decoded from */
+    unsigned char *command_starts; /* a bit for each address that the sweep found a command in */
+    int fusions; /* a bit for each fusion pattern that is applied to the commands */
+    int breakpoint; /* the address that the interpreter stops in, or NO_BREAKPOINT */
+} ThreadedProgram;
+
+/*
+ * A JitExit structure stores an exit of a translated block to a known address that
+ * was not translated when the block was translated. When the target is translated,
+ * the exit is patched to jump to it directly.
+ */
+typedef struct {
+    unsigned char *site; /* the first byte of the code of the exit */
+    int target; /* the address that the exit jumps to */
+} JitExit;
+
+/*
+ * A JitBlock structure stores the addresses of the commands that a block was translated
+ * from, so the block can be invalidated when one of its words is changed.
+ */
+typedef struct {
+    unsigned char *code; /* the native code of the block, or NULL if it was invalidated */
+    unsigned char *leave; /* the code in the block that leaves the translated code to its first address */
+    int start; /* the address of the first command of the block */
+    int end; /* the address after the last command of the block */
+} JitBlock;
+
+/*
+ * A JitBlockLink structure stores a block in the list of the blocks that were translated
+ * from a word, so a change of the word invalidates only the blocks in its list.
+ */
+typedef struct {
+    int block; /* the index of the block in the translated blocks */
+    int next; /* the index of the next link of the list, or NO_JIT_LINK */
+} JitBlockLink;
+
+/*
+ * A JitProgram structure stores the native code that the basic blocks of a program
+ * were translated to, in a buffer that is either writable or executable (and never
+ * both), and the translated block of each address. The fields 'remaining' and 'exit_index' are shared with the native code,
+ * which counts the executed commands and reports the exit it left through. The words
+ * that the blocks were translated from are marked, and each of them has a list of the
+ * blocks that were translated from it, so a change of a word invalidates only its own
+ * blocks.
+ */
+typedef struct {
+    unsigned char *code; /* the executable buffer */
+    size_t code_length; /* the number of bytes of code in the buffer */
+    size_t code_capacity; /* the number of bytes in the buffer */
+    size_t blocks_start; /* the offset of the first block, after the code that enters and leaves the blocks */
+    unsigned char *epilogue; /* the code that returns from the translated code */
+    unsigned char **blocks; /* the translated block of each address, or NULL */
+    unsigned char *untranslatable; /* indicates if the first command in each address can't be translated */
+    int *invalidations; /* the number of times the block that starts in each address was invalidated */
+    JitExit *exits; /* the exits to known addresses that were not translated yet */
+    int no_of_exits; /* the number of exits */
+    int exits_capacity; /* the number of exits that can be stored before the array has to grow */
+    JitBlock *translated_blocks; /* the blocks that were translated since the buffer was emptied */
+    int no_of_blocks; /* the number of translated blocks */
+    int blocks_capacity; /* the number of blocks that can be stored before the array has to grow */
+    unsigned char *cached_words; /* a bit for each word that a translated block was translated from */
+    int *word_links; /* the first link of the list of the blocks of each word, or NO_JIT_LINK */
+    JitBlockLink *links; /* the links of the lists of the blocks of the words */
+    int no_of_links; /* the number of links that were ever used since the buffer was emptied */
+    int links_capacity; /* the number of links that can be stored before the array has to grow */
+    int free_link; /* the first link that was removed from its list and can be used again, or NO_JIT_LINK */
+    unsigned long no_of_flushes; /* the number of times the buffer was emptied because it was full */
+    unsigned long remaining; /* the number of commands that the native code may still execute */
+    int exit_index; /* the index of the exit that the native code left through, or a negative code */
+    int code_start; /* the address of the first code word */
+    int code_end; /* the address after the last code word */
+    int executable; /* indicates if the buffer can be executed, and not written */
+} JitProgram;
 
 /*
- * The FirstMemoryWord structure, is a bit field that stores the encoding
- * of the first memory word in the encoding of the whole command. Each command
- * has the same encoding fields in the first memory word, and this is why the
- * FirstMemoryWord struct has fields such as ARE, dest_operand_addressing and opcode.
+ * A FarmJob structure stores a line of the manifest of a simulation farm: the program
+ * to execute, the file it reads its input from, and the file with the output that it
+ * should print. The paths are stored in string pools, and the id of the program is
+ * also the index of its loaded image.
  */
 typedef struct {
-    unsigned int ARE: 2;
-    unsigned int dest_operand_addressing: 3;
-    unsigned int opcode: 4;
-    unsigned int src_operand_addressing: 3;
-} FirstMemoryWord;
+    int program_id; /* the id of the path to the output files of the program */
+    int input_id; /* the id of the path to the input file */
+    int expected_id; /* the id of the path to the file with the expected output */
+} FarmJob;
 
 /*
- * The NextMemoryWord is a bit field structure that stores information
- * about the encoding of a memory word that is not the first, in the
- * encoding of the whole command, and only if the command don't take two
- * registers as arguments.
+ * A FarmResult structure stores the result of a job of a simulation farm, after a
+ * worker thread executed it, until the results are printed in the order of the jobs.
  */
 typedef struct {
-    unsigned int ARE: 2;
-    unsigned int other: 10;
-} NextMemoryWord;
+    int status; /* indicates if the output was the expected output, or why it wasn't */
+    unsigned long executed_instructions; /* the number of commands that the program executed */
+    char *error_msg; /* the error that stopped the machine, or NULL */
+    int error_address; /* the address of the command that caused the error */
+} FarmResult;
 
 /*
- * The DoubleRegisterMemoryWord is a bit field structure that stores information
- * about the encoding of a memory word that is not the first, in the encoding of
- * the whole command, and only if the command takes two registers as arguments.
+ * An AssemblyResult structure receives the outputs of a program that was assembled
+ * from the memory. All its buffers are owned by the user, and are never allocated or
+ * freed by the assembler. The 'words' array receives the code words and then the data
+ * words, as in the object file, and the text buffers receive the lines of the entries
+ * file, the externals file and the errors of the program, in the same format.
  */
 typedef struct {
-    unsigned int ARE: 2;
-    unsigned int dest_register_number: 5;
-    unsigned int src_register_number: 5;
-} DoubleRegisterMemoryWord;
+    unsigned short *words; /* the memory words of the program, owned by the user */
+    int capacity; /* the number of words that the 'words' array can store */
+    int code_words; /* the number of code words of the program */
+    int data_words; /* the number of data words of the program */
+    OutputBuffer entries; /* the lines of the entries file */
+    OutputBuffer externals; /* the lines of the externals file */
+    OutputBuffer diagnostics; /* the errors of the program */
+} AssemblyResult;
 
 #endif